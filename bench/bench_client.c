@@ -0,0 +1,465 @@
+/*
+ * BENCH_MPI_RANKS 2
+ *
+ * Client API latency micro-benchmarks
+ *
+ * Times the public functions of mpidynres.h in isolation and against the
+ * parameters they scale with:
+ *
+ *  - MPIDYNRES_Send_MPI_Info/MPIDYNRES_Recv_MPI_Info between rank 0 and rank 1
+ *    and MPIDYNRES_Info_serialize/deserialize against key count and value size
+ *  - every session, pset and resource change call against a scheduler running
+ *    in a thread of rank 0, connected with the loopback transport
+ *  - MPI_Session_get_psets against the number of psets a process belongs to
+ *  - the pset lookup behind MPI_Group_from_session_pset against the pset size
+ *
+ * The pset lookup is timed on the protocol level (request, answer size and
+ * the cr ids), because building the MPI group needs a base communicator with
+ * as many ranks as the pset.
+ *
+ * Usage: bench_client [options]
+ *   --iters N          repetitions of every measurement (default 100)
+ *   --max-keys N       largest info object in keys (default 1024)
+ *   --max-psets N      largest number of psets of a process (default 1000)
+ *   --max-pset-size N  largest looked up pset (default 100000)
+ *   --json FILE        write the report to FILE instead of stdout
+ */
+#include <mpi.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/comm.h"
+#include "../src/mpidynres.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+extern MPIDYNRES_transport *g_MPIDYNRES_transport;  // defined in mpidynres.c
+
+#define MAX_RESULTS 256
+
+struct result {
+  char name[0x40];
+  char param[0x20];
+  long value;
+  size_t iters;
+  double mean_us;
+  double p50_us;
+  double p99_us;
+  double max_us;
+};
+
+static struct result results[MAX_RESULTS];
+static size_t num_results;
+
+static long iters = 100;
+static long max_keys = 1024;
+static long max_psets = 1000;
+static long max_pset_size = 100000;
+static char const *json = NULL;
+
+static uint64_t *samples;
+
+static uint64_t now_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static int compare_u64(void const *a, void const *b) {
+  uint64_t x = *(uint64_t const *)a;
+  uint64_t y = *(uint64_t const *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Store the statistics of the first n entries of samples
+ */
+static void add_result(char const *name, char const *param, long value,
+                       size_t n) {
+  double sum = 0.0;
+  struct result *r;
+
+  if (num_results == MAX_RESULTS) {
+    fprintf(stderr, "Too many results\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  r = &results[num_results++];
+  qsort(samples, n, sizeof(uint64_t), compare_u64);
+  for (size_t i = 0; i < n; i++) {
+    sum += samples[i];
+  }
+  snprintf(r->name, sizeof(r->name), "%s", name);
+  snprintf(r->param, sizeof(r->param), "%s", param);
+  r->value = value;
+  r->iters = n;
+  r->mean_us = sum / n / 1000.0;
+  r->p50_us = samples[n / 2] / 1000.0;
+  r->p99_us = samples[(size_t)(0.99 * (n - 1) + 0.5)] / 1000.0;
+  r->max_us = samples[n - 1] / 1000.0;
+}
+
+static MPI_Info make_info(int nkeys, int vlen) {
+  MPI_Info info;
+  char key[0x20];
+  char *val = calloc(vlen + 1, 1);
+
+  memset(val, 'x', vlen);
+  MPI_Info_create(&info);
+  for (int i = 0; i < nkeys; i++) {
+    snprintf(key, sizeof(key), "bench://key_%d", i);
+    MPI_Info_set(info, key, val);
+  }
+  free(val);
+  return info;
+}
+
+/*
+ * INFO SERIALIZATION
+ */
+
+static void bench_info(int rank) {
+  int const value_sizes[] = {8, 64, MPI_MAX_INFO_VAL - 1};
+  int ack = 0;
+  char param[0x20];
+
+  for (int nkeys = 1; nkeys <= max_keys; nkeys *= 4) {
+    for (size_t v = 0; v < sizeof(value_sizes) / sizeof(int); v++) {
+      MPI_Info info = rank == 0 ? make_info(nkeys, value_sizes[v])
+                                : MPI_INFO_NULL;
+      MPI_Info received;
+
+      for (long i = 0; i < iters; i++) {
+        if (rank == 0) {
+          uint64_t start = now_ns();
+          MPIDYNRES_Send_MPI_Info(info, 1, 1, 2, MPI_COMM_WORLD);
+          MPI_Recv(&ack, 1, MPI_INT, 1, 3, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+          samples[i] = now_ns() - start;
+        } else if (rank == 1) {
+          MPIDYNRES_Recv_MPI_Info(&received, 0, 1, 2, MPI_COMM_WORLD,
+                                  MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+          MPI_Info_free(&received);
+          MPI_Send(&ack, 1, MPI_INT, 0, 3, MPI_COMM_WORLD);
+        }
+      }
+      if (rank != 0) {
+        continue;
+      }
+      snprintf(param, sizeof(param), "value_size=%d", value_sizes[v]);
+      add_result("Send_Recv_MPI_Info", param, nkeys, iters);
+
+      uint8_t *buf;
+      size_t bufsize;
+      for (long i = 0; i < iters; i++) {
+        uint64_t start = now_ns();
+        MPIDYNRES_Info_serialize(info, &buf, &bufsize);
+        samples[i] = now_ns() - start;
+        free(buf);
+      }
+      add_result("Info_serialize", param, nkeys, iters);
+
+      MPIDYNRES_Info_serialize(info, &buf, &bufsize);
+      for (long i = 0; i < iters; i++) {
+        uint64_t start = now_ns();
+        MPIDYNRES_Info_deserialize(buf, &received);
+        samples[i] = now_ns() - start;
+        MPI_Info_free(&received);
+      }
+      free(buf);
+      add_result("Info_deserialize", param, nkeys, iters);
+      MPI_Info_free(&info);
+    }
+  }
+}
+
+/*
+ * IN-PROCESS SCHEDULER
+ */
+
+static MPIDYNRES_scheduler *scheduler;
+static pthread_t scheduler_thread;
+
+static void *run_scheduler(void *arg) {
+  (void)arg;
+  MPIDYNRES_scheduler_schedule(scheduler);
+  return NULL;
+}
+
+static void add_pset(char const *name, long size) {
+  pset_node pn = {0};
+
+  snprintf(pn.pset_name, sizeof(pn.pset_name), "%s", name);
+  pn.pset = set_int_init(int_compare);
+  for (long i = 1; i <= size; i++) {
+    set_int_insert(&pn.pset, i);
+  }
+  MPI_Info_create(&pn.pset_info);
+  set_pset_node_insert(&scheduler->pset_name_map, pn);
+}
+
+/*
+ * Start cr 1 as member of mpi://WORLD, num_psets psets of size 1 and one
+ * pset of size lookup_size, then let the scheduler run in its own thread
+ */
+static void phase_begin(long num_psets, long lookup_size) {
+  MPIDYNRES_idle_command command;
+  char name[MPI_MAX_PSET_NAME_LEN];
+
+  add_pset("mpi://WORLD", 1);
+  for (long i = 0; i < num_psets; i++) {
+    snprintf(name, sizeof(name), "bench://member_%ld", i);
+    add_pset(name, 1);
+  }
+  if (lookup_size > 0) {
+    add_pset("bench://lookup", lookup_size);
+  }
+  MPIDYNRES_scheduler_start_cr(scheduler, 1, false, MPIDYNRES_NO_ORIGIN_RC_TAG,
+                               MPI_INFO_NULL, 0.0);
+  MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &command, sizeof(command), 0,
+                           MPIDYNRES_TAG_IDLE_COMMAND, NULL);
+  pthread_create(&scheduler_thread, NULL, run_scheduler, NULL);
+}
+
+/*
+ * Stop cr 1, the scheduler frees all psets containing it and returns
+ */
+static void phase_end() {
+  int unused = 0;
+  MPIDYNRES_transport_send(g_MPIDYNRES_transport, &unused, sizeof(int), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+  pthread_join(scheduler_thread, NULL);
+}
+
+// time call, cleanup is run after the measurement
+#define TIME_CALL(name, call, cleanup)   \
+  do {                                   \
+    for (long i = 0; i < iters; i++) {   \
+      uint64_t start = now_ns();         \
+      call;                              \
+      samples[i] = now_ns() - start;     \
+      cleanup;                           \
+    }                                    \
+    add_result(name, "", 0, iters);      \
+  } while (0)
+
+static void bench_calls() {
+  MPI_Session session;
+  MPI_Info info;
+  MPI_Info hints = make_info(4, 8);
+  MPIDYNRES_RC_type rc_type;
+  MPIDYNRES_RC_tag rc_tag;
+  char pset[MPI_MAX_PSET_NAME_LEN];
+  char const *const kvlist[] = {"a", "1", "b", "2", "c", "3", "d", "4"};
+
+  phase_begin(0, 0);
+
+  for (long i = 0; i < iters; i++) {
+    uint64_t start = now_ns();
+    MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+    samples[i] = now_ns() - start;
+    MPI_Session_finalize(&session);
+  }
+  add_result("MPI_Session_init", "", 0, iters);
+  for (long i = 0; i < iters; i++) {
+    MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+    uint64_t start = now_ns();
+    MPI_Session_finalize(&session);
+    samples[i] = now_ns() - start;
+  }
+  add_result("MPI_Session_finalize", "", 0, iters);
+
+  MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+  TIME_CALL("MPI_Session_get_info", MPI_Session_get_info(session, &info),
+            MPI_Info_free(&info));
+  TIME_CALL("MPI_Session_get_pset_info",
+            MPI_Session_get_pset_info(session, "mpi://WORLD", &info),
+            MPI_Info_free(&info));
+  TIME_CALL("MPI_Session_get_psets",
+            MPI_Session_get_psets(session, MPI_INFO_NULL, &info),
+            MPI_Info_free(&info));
+  for (long i = 0; i < iters; i++) {
+    uint64_t start = now_ns();
+    MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, "mpi://WORLD",
+                             "mpi://SELF", MPIDYNRES_PSET_UNION, pset);
+    samples[i] = now_ns() - start;
+    MPIDYNRES_pset_free(session, pset);
+  }
+  add_result("MPIDYNRES_pset_create_op", "", 0, iters);
+  for (long i = 0; i < iters; i++) {
+    MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, "mpi://WORLD",
+                             "mpi://SELF", MPIDYNRES_PSET_UNION, pset);
+    uint64_t start = now_ns();
+    MPIDYNRES_pset_free(session, pset);
+    samples[i] = now_ns() - start;
+  }
+  add_result("MPIDYNRES_pset_free", "", 0, iters);
+  TIME_CALL("MPIDYNRES_add_scheduling_hints",
+            MPIDYNRES_add_scheduling_hints(session, hints, &info),
+            if (info != MPI_INFO_NULL) MPI_Info_free(&info));
+  // manager_change_prob is 0, so this measures the none answer
+  TIME_CALL("MPIDYNRES_RC_get",
+            MPIDYNRES_RC_get(session, &rc_type, pset, &rc_tag, &info),
+            if (info != MPI_INFO_NULL) MPI_Info_free(&info));
+  TIME_CALL("MPIDYNRES_Info_create_strings",
+            MPIDYNRES_Info_create_strings(8, kvlist, &info),
+            MPI_Info_free(&info));
+  MPI_Session_finalize(&session);
+
+  phase_end();
+  MPI_Info_free(&hints);
+}
+
+static void bench_get_psets_scaling() {
+  MPI_Session session;
+  MPI_Info info;
+
+  for (long num_psets = 1; num_psets <= max_psets; num_psets *= 10) {
+    phase_begin(num_psets, 0);
+    MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+    for (long i = 0; i < iters; i++) {
+      uint64_t start = now_ns();
+      MPI_Session_get_psets(session, MPI_INFO_NULL, &info);
+      samples[i] = now_ns() - start;
+      MPI_Info_free(&info);
+    }
+    add_result("MPI_Session_get_psets", "num_psets", num_psets, iters);
+    MPI_Session_finalize(&session);
+    phase_end();
+  }
+}
+
+static void bench_lookup_scaling() {
+  MPI_Session session;
+  char const name[] = "bench://lookup";
+  int *cr_ids = calloc(max_pset_size, sizeof(int));
+
+  for (long size = 1; size <= max_pset_size; size *= 10) {
+    phase_begin(0, size);
+    MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+    int msg[2] = {session->session_id, sizeof(name)};
+    for (long i = 0; i < iters; i++) {
+      size_t answer_size;
+      uint64_t start = now_ns();
+      MPIDYNRES_transport_send(g_MPIDYNRES_transport, msg, sizeof(msg), 0,
+                               MPIDYNRES_TAG_PSET_LOOKUP);
+      MPIDYNRES_transport_send(g_MPIDYNRES_transport, name, sizeof(name), 0,
+                               MPIDYNRES_TAG_PSET_LOOKUP_NAME);
+      MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &answer_size,
+                               sizeof(size_t), 0,
+                               MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE, NULL);
+      MPIDYNRES_transport_recv(g_MPIDYNRES_transport, cr_ids,
+                               answer_size * sizeof(int), 0,
+                               MPIDYNRES_TAG_PSET_LOOKUP_ANSWER, NULL);
+      samples[i] = now_ns() - start;
+    }
+    add_result("pset_lookup", "pset_size", size, iters);
+    MPI_Session_finalize(&session);
+    phase_end();
+  }
+  free(cr_ids);
+}
+
+static void bench_scheduler_calls() {
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_transport *endpoints[2];
+
+  MPIDYNRES_transport_loopback_create(2, endpoints);
+  g_MPIDYNRES_transport = endpoints[1];
+
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_change_prob", "0");
+  scheduler = MPIDYNRES_scheduler_create(&config, endpoints[0]);
+
+  bench_calls();
+  bench_get_psets_scaling();
+  bench_lookup_scaling();
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  g_MPIDYNRES_transport = NULL;
+  MPIDYNRES_transport_free(endpoints[0]);
+  MPIDYNRES_transport_free(endpoints[1]);
+}
+
+static void print_results() {
+  FILE *out = stdout;
+
+  if (json != NULL) {
+    out = fopen(json, "w");
+    if (out == NULL) {
+      perror("Cannot open json file");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"benchmark\": \"client\",\n");
+  fprintf(out, "  \"iters\": %ld,\n", iters);
+  fprintf(out, "  \"results\": [\n");
+  for (size_t i = 0; i < num_results; i++) {
+    struct result *r = &results[i];
+    fprintf(out, "    {\"name\": \"%s\"", r->name);
+    if (r->param[0] != '\0') {
+      fprintf(out, ", \"param\": \"%s\", \"value\": %ld", r->param, r->value);
+    }
+    fprintf(out,
+            ", \"mean_us\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, "
+            "\"max_us\": %.3f}%s\n",
+            r->mean_us, r->p50_us, r->p99_us, r->max_us,
+            i + 1 < num_results ? "," : "");
+  }
+  fprintf(out, "  ]\n");
+  fprintf(out, "}\n");
+  if (out != stdout) {
+    fclose(out);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int provided;
+  int rank, size;
+
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--iters") == 0) {
+      iters = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--max-keys") == 0) {
+      max_keys = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--max-psets") == 0) {
+      max_psets = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--max-pset-size") == 0) {
+      max_pset_size = atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = argv[i + 1];
+    }
+  }
+  if (size < 2 || provided < MPI_THREAD_MULTIPLE || iters < 1 ||
+      max_pset_size < 1) {
+    if (rank == 0) {
+      fprintf(stderr,
+              "bench_client needs 2 ranks, MPI_THREAD_MULTIPLE, positive "
+              "--iters and positive --max-pset-size\n");
+    }
+    MPI_Finalize();
+    return EXIT_FAILURE;
+  }
+  samples = calloc(iters, sizeof(uint64_t));
+
+  if (rank < 2) {
+    bench_info(rank);
+  }
+  if (rank == 0) {
+    bench_scheduler_calls();
+    print_results();
+  }
+
+  free(samples);
+  MPI_Finalize();
+  return 0;
+}
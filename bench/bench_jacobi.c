@@ -0,0 +1,643 @@
+/*
+ * BENCH_MPI_RANKS 5
+ *
+ * Malleable proxy application benchmark
+ *
+ * A 2D Jacobi stencil on a NX x NY grid, distributed in blocks of rows over
+ * the crs of the current main pset. Every --rc-interval iterations the first
+ * rank asks for resource changes. Added crs join the computation, removed crs
+ * hand over their rows and leave. After --iters iterations the first rank of
+ * the final communicator prints a JSON report containing
+ *
+ *  - the useful work per second (updated grid cells)
+ *  - the time spent computing, asking for resource changes (control plane)
+ *    and reconfiguring
+ *  - for every resource change the time from its detection until the new
+ *    communicator is ready and until the grid is redistributed
+ *
+ * The manager is configured via manager_config, additional keys can be passed
+ * with --manager-config, so the same run can be repeated for every manager.
+ * Before every check, the measured iteration time is passed to the manager
+ * with MPIDYNRES_add_scheduling_hints (used by manager_name=scaling and
+ * manager_name=sla, the latter needs --target-time).
+ *
+ * Usage: bench_jacobi [options]
+ *   --nx N                 grid width (default 1024)
+ *   --ny N                 grid height (default 1024)
+ *   --iters N              number of Jacobi iterations (default 500)
+ *   --rc-interval N        iterations between resource change checks
+ *                          (default 10)
+ *   --initial N            number of initially started crs (default half)
+ *   --change-prob P        manager_change_prob (default 0.3)
+ *   --manager-config K=V   additional manager_config key (repeatable)
+ *   --target-time S        target time per iteration in seconds, passed as
+ *                          scheduling hint
+ *   --seed S               random seed (default 1)
+ *   --json FILE            write the report to FILE instead of stdout
+ */
+#include <mpi.h>
+#include <mpidynres.h>
+#include <mpidynres_sim.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_EVENTS 64
+#define MAX_MANAGER_KEYS 16
+
+struct bench_options {
+  int nx;
+  int ny;
+  int iters;
+  int rc_interval;
+  int initial;
+  double change_prob;
+  char const *manager_keys[MAX_MANAGER_KEYS];
+  int num_manager_keys;
+  double target_time;
+  int seed;
+  char const *json;
+};
+
+static struct bench_options options = {
+    .nx = 1024,
+    .ny = 1024,
+    .iters = 500,
+    .rc_interval = 10,
+    .initial = 0,
+    .change_prob = 0.3,
+    .num_manager_keys = 0,
+    .seed = 1,
+    .json = NULL,
+};
+
+// one resource change as seen by the first rank
+struct reconfig_event {
+  int iter;
+  int type;         // MPIDYNRES_RC_type
+  int size_before;  // number of crs before
+  int size_after;   // number of crs after
+  double comm_ms;   // from detection until the new communicator is ready
+  double redist_ms;  // from detection until the grid is redistributed
+};
+
+// statistics that are handed over to the first rank of the new communicator
+struct run_stats {
+  double t_start;
+  double compute_s;
+  double rc_check_s;
+  double reconfig_s;
+  int num_checks;
+  int num_events;
+  int iter;
+  struct reconfig_event events[MAX_EVENTS];
+};
+
+static MPI_Session session;
+static MPI_Comm main_comm;
+static int main_rank;
+static int main_size;
+static char main_pset[MPI_MAX_PSET_NAME_LEN];
+static struct run_stats stats;
+static double interval_compute_s;  // compute time since the last rc check
+
+// the rows [row_lo, row_hi) of the grid plus one halo row on each side
+static int row_lo, row_hi;
+static double *grid;
+static double *grid_new;
+
+static void block(int n, int size, int rank, int *lo, int *hi) {
+  *lo = (int)((long)n * rank / size);
+  *hi = (int)((long)n * (rank + 1) / size);
+}
+
+static void alloc_grid(int lo, int hi) {
+  size_t cells = (size_t)(hi - lo + 2) * options.nx;
+  row_lo = lo;
+  row_hi = hi;
+  grid = calloc(cells, sizeof(double));
+  grid_new = calloc(cells, sizeof(double));
+  if (grid == NULL || grid_new == NULL) {
+    fprintf(stderr, "Memory Error!\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+}
+
+static void init_grid() {
+  int lo, hi;
+  block(options.ny, main_size, main_rank, &lo, &hi);
+  alloc_grid(lo, hi);
+  // the top boundary is hot, everything else starts cold
+  if (row_lo == 0 && row_hi > 0) {
+    for (int j = 0; j < options.nx; j++) {
+      grid[options.nx + j] = grid_new[options.nx + j] = 1.0;
+    }
+  }
+}
+
+static void jacobi_step() {
+  int nx = options.nx;
+  int rows = row_hi - row_lo;
+  int up = main_rank > 0 ? main_rank - 1 : MPI_PROC_NULL;
+  int down = main_rank + 1 < main_size ? main_rank + 1 : MPI_PROC_NULL;
+
+  // ranks without rows do not take part in the halo exchange chain
+  if (rows == 0) {
+    return;
+  }
+  MPI_Sendrecv(&grid[nx], nx, MPI_DOUBLE, up, 0, &grid[(rows + 1) * nx], nx,
+               MPI_DOUBLE, down, 0, main_comm, MPI_STATUS_IGNORE);
+  MPI_Sendrecv(&grid[rows * nx], nx, MPI_DOUBLE, down, 1, &grid[0], nx,
+               MPI_DOUBLE, up, 1, main_comm, MPI_STATUS_IGNORE);
+
+  for (int i = 1; i <= rows; i++) {
+    int row = row_lo + i - 1;
+    if (row == 0 || row == options.ny - 1) {
+      continue;
+    }
+    for (int j = 1; j < nx - 1; j++) {
+      grid_new[i * nx + j] =
+          0.25 * (grid[(i - 1) * nx + j] + grid[(i + 1) * nx + j] +
+                  grid[i * nx + j - 1] + grid[i * nx + j + 1]);
+    }
+  }
+  double *tmp = grid;
+  grid = grid_new;
+  grid_new = tmp;
+  // boundary rows and columns are not written, keep both buffers in sync
+  for (int i = 1; i <= rows; i++) {
+    int row = row_lo + i - 1;
+    if (row == 0 || row == options.ny - 1) {
+      memcpy(&grid[i * nx], &grid_new[i * nx], nx * sizeof(double));
+    } else {
+      grid[i * nx] = grid_new[i * nx];
+      grid[i * nx + nx - 1] = grid_new[i * nx + nx - 1];
+    }
+  }
+}
+
+/*
+ * Move the rows to the new distribution, every rank of comm has to call this,
+ * ranks without rows pass an empty range
+ */
+static void redistribute(MPI_Comm comm, int new_lo, int new_hi) {
+  int size;
+  int nx = options.nx;
+  MPI_Comm_size(comm, &size);
+
+  int mine[4] = {row_lo, row_hi, new_lo, new_hi};
+  int *all = calloc(4 * size, sizeof(int));
+  int *scounts = calloc(size, sizeof(int));
+  int *sdispls = calloc(size, sizeof(int));
+  int *rcounts = calloc(size, sizeof(int));
+  int *rdispls = calloc(size, sizeof(int));
+  MPI_Allgather(mine, 4, MPI_INT, all, 4, MPI_INT, comm);
+
+  for (int r = 0; r < size; r++) {
+    // old rows of mine that r owns in the new distribution
+    int lo = row_lo > all[4 * r + 2] ? row_lo : all[4 * r + 2];
+    int hi = row_hi < all[4 * r + 3] ? row_hi : all[4 * r + 3];
+    if (lo < hi) {
+      scounts[r] = (hi - lo) * nx;
+      sdispls[r] = (lo - row_lo + 1) * nx;
+    }
+    // old rows of r that I own in the new distribution
+    lo = all[4 * r] > new_lo ? all[4 * r] : new_lo;
+    hi = all[4 * r + 1] < new_hi ? all[4 * r + 1] : new_hi;
+    if (lo < hi) {
+      rcounts[r] = (hi - lo) * nx;
+      rdispls[r] = (lo - new_lo + 1) * nx;
+    }
+  }
+
+  double *old_grid = grid;
+  free(grid_new);
+  alloc_grid(new_lo, new_hi);
+  MPI_Alltoallv(old_grid, scounts, sdispls, MPI_DOUBLE, grid, rcounts, rdispls,
+                MPI_DOUBLE, comm);
+  memcpy(grid_new, grid, (size_t)(new_hi - new_lo + 2) * nx * sizeof(double));
+
+  free(old_grid);
+  free(all);
+  free(scounts);
+  free(sdispls);
+  free(rcounts);
+  free(rdispls);
+}
+
+static void update_main_comm() {
+  MPI_Group group;
+  MPI_Group_from_session_pset(session, main_pset, &group);
+  MPI_Comm_create_from_group(group, NULL, MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL,
+                             &main_comm);
+  MPI_Group_free(&group);
+  MPI_Comm_rank(main_comm, &main_rank);
+  MPI_Comm_size(main_comm, &main_size);
+}
+
+static bool info_contains(MPI_Info info, char const *key) {
+  int contains, unused;
+  if (info == MPI_INFO_NULL) {
+    return false;
+  }
+  MPI_Info_get_valuelen(info, key, &unused, &contains);
+  return contains;
+}
+
+static void accept_rc(MPIDYNRES_RC_tag rc_tag) {
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "jacobi://main_pset", main_pset);
+  MPIDYNRES_RC_accept(session, rc_tag, info);
+  MPI_Info_free(&info);
+}
+
+/*
+ * The new crs are part of the new communicator, hand over the grid and the
+ * statistics from the old ranks
+ */
+static void handle_rc_add(MPIDYNRES_RC_tag rc_tag, char const *delta_pset,
+                          double t_detect, bool joining) {
+  int old_size = main_size;
+  struct reconfig_event ev = {0};
+
+  if (!joining) {
+    if (main_rank == 0) {
+      MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, main_pset, delta_pset,
+                               MPIDYNRES_PSET_UNION, main_pset);
+    }
+    MPI_Bcast(main_pset, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0, main_comm);
+    if (main_rank == 0) {
+      accept_rc(rc_tag);
+    }
+    MPI_Comm_free(&main_comm);
+  }
+  bool was_first = !joining && main_rank == 0;
+  update_main_comm();
+  double t_comm = MPI_Wtime();
+
+  // find the previous first rank, it knows everything about the run
+  int first = was_first ? main_rank : main_size;
+  MPI_Allreduce(MPI_IN_PLACE, &first, 1, MPI_INT, MPI_MIN, main_comm);
+  MPI_Bcast(&stats, sizeof(stats), MPI_BYTE, first, main_comm);
+  MPI_Bcast(&old_size, 1, MPI_INT, first, main_comm);
+  if (joining) {
+    row_lo = row_hi = 0;
+    grid = calloc(options.nx, sizeof(double));
+    grid_new = NULL;
+  }
+
+  int lo, hi;
+  block(options.ny, main_size, main_rank, &lo, &hi);
+  redistribute(main_comm, lo, hi);
+
+  if (was_first) {
+    double t_redist = MPI_Wtime();
+    ev.iter = stats.iter;
+    ev.type = MPIDYNRES_RC_ADD;
+    ev.size_before = old_size;
+    ev.size_after = main_size;
+    ev.comm_ms = (t_comm - t_detect) * 1000.0;
+    ev.redist_ms = (t_redist - t_detect) * 1000.0;
+    stats.reconfig_s += t_redist - t_detect;
+    if (stats.num_events < MAX_EVENTS) {
+      stats.events[stats.num_events++] = ev;
+    }
+  }
+  // the first rank of the new communicator continues recording
+  MPI_Bcast(&stats, sizeof(stats), MPI_BYTE, first, main_comm);
+}
+
+/*
+ * The removed crs hand over their rows inside the old communicator, then the
+ * remaining ones build the new communicator
+ *
+ * @return     whether this cr has to leave
+ */
+static bool handle_rc_sub(MPIDYNRES_RC_tag rc_tag, char const *delta_pset,
+                          double t_detect) {
+  MPI_Info psets;
+  MPI_Comm old_comm = main_comm;
+  int old_size = main_size;
+  bool was_first = main_rank == 0;
+
+  if (main_rank == 0) {
+    MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, main_pset, delta_pset,
+                             MPIDYNRES_PSET_DIFFERENCE, main_pset);
+  }
+  MPI_Bcast(main_pset, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0, old_comm);
+
+  MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+  int leaving = info_contains(psets, delta_pset);
+  MPI_Info_free(&psets);
+
+  // index of this cr among the remaining ones (ranks keep their order)
+  int staying = !leaving;
+  int index;
+  int num_staying;
+  MPI_Exscan(&staying, &index, 1, MPI_INT, MPI_SUM, old_comm);
+  if (main_rank == 0) {
+    index = 0;
+  }
+  MPI_Allreduce(&staying, &num_staying, 1, MPI_INT, MPI_SUM, old_comm);
+
+  int lo = 0, hi = 0;
+  if (staying) {
+    block(options.ny, num_staying, index, &lo, &hi);
+  }
+  redistribute(old_comm, lo, hi);
+  double t_redist = MPI_Wtime();
+
+  if (was_first) {
+    accept_rc(rc_tag);
+    struct reconfig_event ev = {
+        .iter = stats.iter,
+        .type = MPIDYNRES_RC_SUB,
+        .size_before = old_size,
+        .size_after = num_staying,
+        .redist_ms = (t_redist - t_detect) * 1000.0,
+    };
+    if (stats.num_events < MAX_EVENTS) {
+      stats.events[stats.num_events++] = ev;
+    }
+  }
+  MPI_Bcast(&stats, sizeof(stats), MPI_BYTE, 0, old_comm);
+
+  if (leaving) {
+    MPI_Comm_free(&old_comm);
+    return true;
+  }
+  update_main_comm();
+  MPI_Comm_free(&old_comm);
+  double t_comm = MPI_Wtime();
+  if (main_rank == 0 && stats.num_events > 0) {
+    struct reconfig_event *ev = &stats.events[stats.num_events - 1];
+    ev->comm_ms = (t_comm - t_detect) * 1000.0;
+    stats.reconfig_s += t_comm - t_detect;
+  }
+  return false;
+}
+
+/*
+ * Ask for resource changes and apply them
+ *
+ * @return     whether this cr has to leave
+ */
+static bool resource_change_step() {
+  MPIDYNRES_RC_type rc_type = MPIDYNRES_RC_NONE;
+  MPIDYNRES_RC_tag rc_tag;
+  char delta_pset[MPI_MAX_PSET_NAME_LEN] = {0};
+  MPI_Info rc_info;
+  double t_detect;
+
+  double t0 = MPI_Wtime();
+  double iter_time = interval_compute_s / options.rc_interval;
+  MPI_Reduce(main_rank == 0 ? MPI_IN_PLACE : &iter_time, &iter_time, 1,
+             MPI_DOUBLE, MPI_MAX, 0, main_comm);
+  interval_compute_s = 0.0;
+  if (main_rank == 0) {
+    MPI_Info hints, answer;
+    char buf[0x40];
+    MPI_Info_create(&hints);
+    snprintf(buf, sizeof(buf), "%.9f", iter_time);
+    MPI_Info_set(hints, "mpidynres_iter_time", buf);
+    if (options.target_time > 0.0) {
+      snprintf(buf, sizeof(buf), "%.9f", options.target_time);
+      MPI_Info_set(hints, "mpidynres_target_time", buf);
+    }
+    MPIDYNRES_add_scheduling_hints(session, hints, &answer);
+    MPI_Info_free(&hints);
+    if (answer != MPI_INFO_NULL) {
+      MPI_Info_free(&answer);
+    }
+    MPIDYNRES_RC_get(session, &rc_type, delta_pset, &rc_tag, &rc_info);
+    if (rc_info != MPI_INFO_NULL) {
+      MPI_Info_free(&rc_info);
+    }
+  }
+  int msg[2] = {rc_type, rc_tag};
+  MPI_Bcast(msg, 2, MPI_INT, 0, main_comm);
+  MPI_Bcast(delta_pset, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0, main_comm);
+  rc_type = msg[0];
+  rc_tag = msg[1];
+  t_detect = MPI_Wtime();
+  stats.rc_check_s += t_detect - t0;
+  stats.num_checks++;
+
+  switch (rc_type) {
+    case MPIDYNRES_RC_ADD: {
+      handle_rc_add(rc_tag, delta_pset, t_detect, false);
+      return false;
+    }
+    case MPIDYNRES_RC_SUB: {
+      return handle_rc_sub(rc_tag, delta_pset, t_detect);
+    }
+    default: {
+      return false;
+    }
+  }
+}
+
+/*
+ * Sum of the grid, independent of the resource changes, so it can be used to
+ * check the redistribution against a run without changes
+ */
+static double checksum() {
+  double sum = 0.0;
+  for (int i = 1; i <= row_hi - row_lo; i++) {
+    for (int j = 0; j < options.nx; j++) {
+      sum += grid[i * options.nx + j];
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, main_comm);
+  return sum;
+}
+
+static void report(double sum) {
+  FILE *out = stdout;
+  double wall_s = MPI_Wtime() - stats.t_start;
+  double cells = (double)options.iters * (options.nx - 2) * (options.ny - 2);
+
+  if (options.json != NULL) {
+    out = fopen(options.json, "w");
+    if (out == NULL) {
+      perror("Cannot open json file");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"benchmark\": \"jacobi\",\n");
+  fprintf(out,
+          "  \"options\": {\"nx\": %d, \"ny\": %d, \"iters\": %d, "
+          "\"rc_interval\": %d, \"initial\": %d, \"change_prob\": %g, "
+          "\"seed\": %d},\n",
+          options.nx, options.ny, options.iters, options.rc_interval,
+          options.initial, options.change_prob, options.seed);
+  fprintf(out, "  \"final_size\": %d,\n", main_size);
+  fprintf(out, "  \"checksum\": %.10e,\n", sum);
+  fprintf(out, "  \"wall_time_s\": %.6f,\n", wall_s);
+  fprintf(out, "  \"cell_updates_per_s\": %.1f,\n", cells / wall_s);
+  fprintf(out, "  \"compute_s\": %.6f,\n", stats.compute_s);
+  fprintf(out, "  \"rc_check_s\": %.6f,\n", stats.rc_check_s);
+  fprintf(out, "  \"rc_checks\": %d,\n", stats.num_checks);
+  fprintf(out, "  \"reconfig_s\": %.6f,\n", stats.reconfig_s);
+  fprintf(out, "  \"reconfigs\": [\n");
+  for (int i = 0; i < stats.num_events; i++) {
+    struct reconfig_event *ev = &stats.events[i];
+    fprintf(out,
+            "    {\"iter\": %d, \"type\": \"%s\", \"size_before\": %d, "
+            "\"size_after\": %d, \"comm_ready_ms\": %.3f, "
+            "\"redistributed_ms\": %.3f}%s\n",
+            ev->iter, ev->type == MPIDYNRES_RC_ADD ? "add" : "sub",
+            ev->size_before, ev->size_after, ev->comm_ms, ev->redist_ms,
+            i + 1 < stats.num_events ? "," : "");
+  }
+  fprintf(out, "  ]\n");
+  fprintf(out, "}\n");
+  if (out != stdout) {
+    fclose(out);
+  }
+}
+
+int jacobi_main(int argc, char *argv[]) {
+  (void)argc, (void)argv;
+  MPI_Info psets;
+  MPI_Info session_info;
+  int unused;
+  bool leaving = false;
+
+  MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+  MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+
+  if (info_contains(psets, "mpi://WORLD")) {
+    strcpy(main_pset, "mpi://WORLD");
+    update_main_comm();
+    memset(&stats, 0, sizeof(stats));
+    stats.t_start = MPI_Wtime();
+    MPI_Bcast(&stats.t_start, 1, MPI_DOUBLE, 0, main_comm);
+    init_grid();
+  } else {
+    // started by a resource change
+    MPI_Session_get_info(session, &session_info);
+    MPI_Info_get(session_info, "jacobi://main_pset", MPI_MAX_PSET_NAME_LEN - 1,
+                 main_pset, &unused);
+    MPI_Info_free(&session_info);
+    handle_rc_add(0, NULL, 0.0, true);
+  }
+  MPI_Info_free(&psets);
+
+  while (stats.iter < options.iters && !leaving) {
+    double t0 = MPI_Wtime();
+    jacobi_step();
+    stats.compute_s += MPI_Wtime() - t0;
+    interval_compute_s += MPI_Wtime() - t0;
+    stats.iter++;
+    if (stats.iter % options.rc_interval == 0 && stats.iter < options.iters) {
+      leaving = resource_change_step();
+    }
+  }
+
+  if (!leaving) {
+    double sum = checksum();
+    if (main_rank == 0) {
+      report(sum);
+    }
+    MPI_Comm_free(&main_comm);
+  }
+  free(grid);
+  free(grid_new);
+  grid = grid_new = NULL;
+  MPI_Session_finalize(&session);
+  return 0;
+}
+
+static void parse_options(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    char const *arg = argv[i];
+    char const *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (val == NULL) {
+      fprintf(stderr, "Missing value for option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    if (strcmp(arg, "--nx") == 0) {
+      options.nx = atoi(val);
+    } else if (strcmp(arg, "--ny") == 0) {
+      options.ny = atoi(val);
+    } else if (strcmp(arg, "--iters") == 0) {
+      options.iters = atoi(val);
+    } else if (strcmp(arg, "--rc-interval") == 0) {
+      options.rc_interval = atoi(val);
+    } else if (strcmp(arg, "--initial") == 0) {
+      options.initial = atoi(val);
+    } else if (strcmp(arg, "--change-prob") == 0) {
+      options.change_prob = strtod(val, NULL);
+    } else if (strcmp(arg, "--manager-config") == 0) {
+      if (options.num_manager_keys == MAX_MANAGER_KEYS ||
+          strchr(val, '=') == NULL) {
+        fprintf(stderr, "Invalid --manager-config %s\n", val);
+        exit(EXIT_FAILURE);
+      }
+      options.manager_keys[options.num_manager_keys++] = val;
+    } else if (strcmp(arg, "--target-time") == 0) {
+      options.target_time = strtod(val, NULL);
+    } else if (strcmp(arg, "--seed") == 0) {
+      options.seed = atoi(val);
+    } else if (strcmp(arg, "--json") == 0) {
+      options.json = val;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    i++;
+  }
+  if (options.nx < 3 || options.ny < 3 || options.iters < 1 ||
+      options.rc_interval < 1) {
+    fprintf(stderr, "Invalid grid size, --iters or --rc-interval\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Info manager_config;
+  int world_size;
+  int rank;
+  char buf[0x20];
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  parse_options(argc, argv);
+  srand(options.seed + rank);
+
+  if (options.initial < 1 || options.initial > world_size - 1) {
+    options.initial = world_size / 2 > 0 ? world_size / 2 : 1;
+  }
+
+  MPI_Info_create(&manager_config);
+  snprintf(buf, sizeof(buf), "%d", options.initial);
+  MPI_Info_set(manager_config, "manager_initial_number", buf);
+  snprintf(buf, sizeof(buf), "%g", options.change_prob);
+  MPI_Info_set(manager_config, "manager_change_prob", buf);
+  for (int i = 0; i < options.num_manager_keys; i++) {
+    char key[MPI_MAX_INFO_KEY + 1] = {0};
+    char const *eq = strchr(options.manager_keys[i], '=');
+    size_t keylen = eq - options.manager_keys[i];
+    if (keylen > MPI_MAX_INFO_KEY) {
+      keylen = MPI_MAX_INFO_KEY;
+    }
+    memcpy(key, options.manager_keys[i], keylen);
+    MPI_Info_set(manager_config, key, eq + 1);
+  }
+
+  MPIDYNRES_SIM_config config = {
+      .base_communicator = MPI_COMM_WORLD,
+      .manager_config = manager_config,
+  };
+  MPIDYNRES_SIM_start(config, argc, argv, jacobi_main);
+
+  MPI_Info_free(&manager_config);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * BENCH_MPI_RANKS 4
+ *
+ * Offline scheduler replay
+ *
+ * Feeds a call trace recorded with MPIDYNRES_CALL_TRACE into a scheduler on
+ * rank 0 that is connected to loopback endpoints instead of an application.
+ * The calls are handled one after another as fast as possible, so the
+ * scheduler can be profiled (e.g. with perf record) against a recorded
+ * request mix. The jobs of the trace are recreated with their manager_config
+ * and seed, so the scheduler makes the same decisions as in the recorded run.
+ *
+ * Without --trace, a trace is recorded first: every simulated process issues
+ * a mix of MPI_Session_get_psets, MPI_Group_from_session_pset,
+ * MPIDYNRES_pset_create_op, MPIDYNRES_pset_free and MPIDYNRES_RC_get/accept
+ * calls against a random_diff manager.
+ *
+ * Usage: bench_replay [options]
+ *   --trace FILE   replay this trace instead of recording one
+ *   --ops N        calls per computing resource start of the recorded mix
+ *                  (default 200)
+ *   --repeat N     number of replays (default 1)
+ *   --json FILE    write the report to FILE instead of stdout
+ */
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/call_trace.h"
+#include "../src/mpidynres.h"
+#include "../src/mpidynres_sim.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+struct bench_options {
+  char const *trace;
+  long ops;
+  int repeat;
+  char const *json;
+};
+
+static struct bench_options options = {
+    .trace = NULL,
+    .ops = 200,
+    .repeat = 1,
+    .json = NULL,
+};
+
+int bench_main(int argc, char *argv[]) {
+  (void)argc, (void)argv;
+  MPI_Session session;
+  MPI_Info psets;
+  MPI_Group group;
+  char created[MPI_MAX_PSET_NAME_LEN];
+  bool have_created = false;
+
+  MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+  for (long op = 0; op < options.ops; op++) {
+    switch (rand() % 5) {
+      case 0: {
+        if (MPI_Session_get_psets(session, MPI_INFO_NULL, &psets) == 0) {
+          MPI_Info_free(&psets);
+        }
+        break;
+      }
+      case 1: {
+        if (MPI_Group_from_session_pset(session, "mpi://WORLD", &group) == 0) {
+          MPI_Group_free(&group);
+        }
+        break;
+      }
+      case 2: {
+        if (have_created) {
+          MPIDYNRES_pset_free(session, created);
+          have_created = false;
+        } else {
+          have_created =
+              MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, "mpi://SELF",
+                                       "mpi://WORLD", MPIDYNRES_PSET_UNION,
+                                       created) == 0;
+        }
+        break;
+      }
+      default: {
+        MPIDYNRES_RC_type rc_type;
+        MPIDYNRES_RC_tag rc_tag;
+        char delta_pset[MPI_MAX_PSET_NAME_LEN];
+        MPI_Info rc_info;
+
+        if (MPIDYNRES_RC_get(session, &rc_type, delta_pset, &rc_tag,
+                             &rc_info) != 0) {
+          break;
+        }
+        if (rc_info != MPI_INFO_NULL) {
+          MPI_Info_free(&rc_info);
+        }
+        if (rc_type != MPIDYNRES_RC_NONE) {
+          MPIDYNRES_RC_accept(session, rc_tag, MPI_INFO_NULL);
+        }
+        break;
+      }
+    }
+  }
+  if (have_created) {
+    MPIDYNRES_pset_free(session, created);
+  }
+  MPI_Session_finalize(&session);
+  return 0;
+}
+
+static void parse_options(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    char const *arg = argv[i];
+    char const *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (val == NULL) {
+      fprintf(stderr, "Missing value for option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    if (strcmp(arg, "--trace") == 0) {
+      options.trace = val;
+    } else if (strcmp(arg, "--ops") == 0) {
+      options.ops = atol(val);
+    } else if (strcmp(arg, "--repeat") == 0) {
+      options.repeat = atoi(val);
+    } else if (strcmp(arg, "--json") == 0) {
+      options.json = val;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    i++;
+  }
+  if (options.ops < 1 || options.repeat < 1) {
+    fprintf(stderr, "Invalid --ops or --repeat\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+/*
+ * Replay the trace once and add the statistics to total
+ */
+static void replay(FILE *f, MPIDYNRES_call_trace_header *header,
+                   MPIDYNRES_call_trace_stats *total) {
+  int size = header->num_crs + 1;
+  MPIDYNRES_transport **endpoints = calloc(size, sizeof(*endpoints));
+  MPIDYNRES_SIM_config *configs = calloc(header->num_jobs, sizeof(*configs));
+  MPIDYNRES_call_trace_stats stats;
+  if (endpoints == NULL || configs == NULL) {
+    fprintf(stderr, "Memory Error!\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  MPIDYNRES_transport_loopback_create(size, endpoints);
+  for (int i = 0; i < header->num_jobs; i++) {
+    MPIDYNRES_SIM_get_default_config(&configs[i]);
+    configs[i].manager_config = header->manager_configs[i];
+  }
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&configs[0], endpoints[0]);
+  for (int i = 1; i < header->num_jobs; i++) {
+    MPIDYNRES_scheduler_add_job(scheduler, &configs[i]);
+  }
+
+  MPIDYNRES_call_trace_replay(scheduler, endpoints, f, -1, &stats);
+
+  total->num_calls += stats.num_calls;
+  total->num_messages += stats.num_messages;
+  total->handle_time += stats.handle_time;
+  total->diverged |= stats.diverged;
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    total->calls[i] += stats.calls[i];
+    total->time[i] += stats.time[i];
+  }
+
+  MPIDYNRES_scheduler_free(scheduler);
+  for (int i = 0; i < size; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+  free(endpoints);
+  free(configs);
+}
+
+static void print_report(MPIDYNRES_call_trace_header *header,
+                         MPIDYNRES_call_trace_stats *stats) {
+  FILE *out = stdout;
+  if (options.json != NULL) {
+    out = fopen(options.json, "w");
+    if (out == NULL) {
+      perror("Cannot open json file");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+
+  fprintf(out, "{\n");
+  fprintf(out, "  \"benchmark\": \"replay\",\n");
+  fprintf(out, "  \"crs\": %d,\n", header->num_crs);
+  fprintf(out, "  \"jobs\": %d,\n", header->num_jobs);
+  fprintf(out, "  \"repeat\": %d,\n", options.repeat);
+  fprintf(out, "  \"diverged\": %s,\n", stats->diverged ? "true" : "false");
+  fprintf(out, "  \"calls\": %ld,\n", stats->num_calls);
+  fprintf(out, "  \"messages\": %ld,\n", stats->num_messages);
+  fprintf(out, "  \"scheduler_s\": %.6f,\n", stats->handle_time);
+  fprintf(out, "  \"calls_per_s\": %.1f,\n",
+          stats->handle_time > 0.0 ? stats->num_calls / stats->handle_time
+                                   : 0.0);
+  fprintf(out, "  \"calls_by_type\": [\n");
+  bool first = true;
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    if (stats->calls[i] == 0) {
+      continue;
+    }
+    fprintf(out, "%s    {\"name\": \"%s\", \"calls\": %ld, \"mean_us\": %.3f}",
+            first ? "" : ",\n",
+            MPIDYNRES_tag_name(i + MPIDYNRES_TAG_IDLE_COMMAND),
+            stats->calls[i], stats->time[i] * 1e6 / stats->calls[i]);
+    first = false;
+  }
+  fprintf(out, "\n  ]\n");
+  fprintf(out, "}\n");
+  if (out != stdout) {
+    fclose(out);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  char recorded[] = "/tmp/bench_replay_XXXXXX";
+  int rank;
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  parse_options(argc, argv);
+  srand(rank + 1);
+
+  if (options.trace == NULL) {
+    MPIDYNRES_SIM_config config;
+    MPIDYNRES_SIM_get_default_config(&config);
+    MPI_Info_create(&config.manager_config);
+    MPI_Info_set(config.manager_config, "manager_name", "random_diff");
+    MPI_Info_set(config.manager_config, "manager_change_prob", "0.1");
+    MPI_Info_set(config.manager_config, "manager_seed", "1");
+    if (rank == 0) {
+      int fd = mkstemp(recorded);
+      if (fd == -1) {
+        perror("Cannot create trace file");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+      close(fd);
+      setenv(CALL_TRACE_ENVVAR, recorded, 1);
+      options.trace = recorded;
+    }
+    MPIDYNRES_SIM_start(config, argc, argv, bench_main);
+    MPI_Info_free(&config.manager_config);
+  }
+
+  if (rank == 0) {
+    MPIDYNRES_call_trace_header header;
+    MPIDYNRES_call_trace_stats total = {0};
+    FILE *f = fopen(options.trace, "r");
+    if (f == NULL) {
+      perror("Cannot open trace");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPIDYNRES_call_trace_read_header(f, &header);
+    long calls_start = ftell(f);
+    for (int i = 0; i < options.repeat; i++) {
+      fseek(f, calls_start, SEEK_SET);
+      replay(f, &header, &total);
+    }
+    fclose(f);
+    print_report(&header, &total);
+    MPIDYNRES_call_trace_header_free(&header);
+    if (options.trace == recorded) {
+      unlink(recorded);
+    }
+  }
+
+  MPI_Finalize();
+  return 0;
+}
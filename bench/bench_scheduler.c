@@ -0,0 +1,471 @@
+/*
+ * BENCH_MPI_RANKS 4
+ *
+ * Scheduler throughput benchmark
+ *
+ * Every computing resource issues a random mix of client calls against the
+ * scheduler and records the latency of every call. After the simulation the
+ * samples are gathered on rank 0 (the scheduler), which prints a JSON report.
+ *
+ * Usage: bench_scheduler [options]
+ *   --ops N          calls issued per computing resource start (default 1000)
+ *   --rate R         calls per second per computing resource, 0 means as fast
+ *                    as possible (default 0)
+ *   --mix a,b,c,d,e  weights of get_psets, group_from_pset, pset_create_op,
+ *                    rc and pset_free calls (default 4,4,1,1,1)
+ *   --initial N      number of initially started crs (default all)
+ *   --change-prob P  manager_change_prob for the manager (default 0.1)
+ *   --seed S         random seed (default 1)
+ *   --json FILE      write the report to FILE instead of stdout
+ */
+#include <mpi.h>
+#include <mpidynres.h>
+#include <mpidynres_sim.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+enum call_type {
+  CALL_GET_PSETS = 0,
+  CALL_GROUP_FROM_PSET,
+  CALL_PSET_CREATE_OP,
+  CALL_RC_GET,
+  CALL_PSET_FREE,
+  CALL_RC_ACCEPT,
+  NUM_CALL_TYPES,
+};
+
+static char const *const call_names[NUM_CALL_TYPES] = {
+    [CALL_GET_PSETS] = "get_psets",
+    [CALL_GROUP_FROM_PSET] = "group_from_session_pset",
+    [CALL_PSET_CREATE_OP] = "pset_create_op",
+    [CALL_RC_GET] = "rc_get",
+    [CALL_PSET_FREE] = "pset_free",
+    [CALL_RC_ACCEPT] = "rc_accept",
+};
+
+// the weights of the first five call types, rc_accept follows a rc_get
+#define NUM_MIX_TYPES 5
+
+struct bench_options {
+  long ops;
+  double rate;
+  int mix[NUM_MIX_TYPES];
+  int initial;
+  double change_prob;
+  int seed;
+  char const *json;
+};
+
+static struct bench_options options = {
+    .ops = 1000,
+    .rate = 0.0,
+    .mix = {4, 4, 1, 1, 1},
+    .initial = 0,
+    .change_prob = 0.1,
+    .seed = 1,
+    .json = NULL,
+};
+
+// latency samples in nanoseconds, kept over all starts of this rank
+struct samples {
+  uint64_t *ns;
+  size_t size;
+  size_t capacity;
+};
+
+static struct samples samples[NUM_CALL_TYPES];
+static uint64_t num_errors;
+
+static uint64_t now_ns() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+static void record(enum call_type type, uint64_t start, int err) {
+  struct samples *s = &samples[type];
+  if (err) {
+    num_errors++;
+  }
+  if (s->size == s->capacity) {
+    s->capacity = s->capacity ? 2 * s->capacity : 1024;
+    s->ns = realloc(s->ns, s->capacity * sizeof(uint64_t));
+    if (s->ns == NULL) {
+      fprintf(stderr, "Memory Error!\n");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+  s->ns[s->size++] = now_ns() - start;
+}
+
+/*
+ * Remember the largest pset (except mpi://SELF) this cr is part of, it is
+ * used for the group_from_session_pset calls
+ */
+static void update_lookup_pset(MPI_Info psets, char lookup_pset[]) {
+  int nkeys, vlen, flag;
+  int best = 0;
+  char key[MPI_MAX_INFO_KEY + 1];
+  char val[0x20];
+
+  strcpy(lookup_pset, "mpi://SELF");
+  MPI_Info_get_nkeys(psets, &nkeys);
+  for (int i = 0; i < nkeys; i++) {
+    MPI_Info_get_nthkey(psets, i, key);
+    MPI_Info_get_valuelen(psets, key, &vlen, &flag);
+    if (!flag || vlen >= (int)sizeof(val) || strcmp(key, "mpi://SELF") == 0) {
+      continue;
+    }
+    MPI_Info_get(psets, key, vlen, val, &flag);
+    if (atoi(val) > best) {
+      best = atoi(val);
+      strcpy(lookup_pset, key);
+    }
+  }
+}
+
+static enum call_type choose_call(int total_weight) {
+  int r = rand() % total_weight;
+  for (int i = 0; i < NUM_MIX_TYPES; i++) {
+    if (r < options.mix[i]) {
+      return i;
+    }
+    r -= options.mix[i];
+  }
+  return CALL_GET_PSETS;
+}
+
+int bench_main(int argc, char *argv[]) {
+  (void)argc, (void)argv;
+  MPI_Session session;
+  MPI_Info psets;
+  MPI_Group group;
+  char lookup_pset[MPI_MAX_PSET_NAME_LEN];
+  char(*created)[MPI_MAX_PSET_NAME_LEN];
+  size_t num_created = 0;
+  int total_weight = 0;
+  uint64_t start;
+  uint64_t next_call = now_ns();
+  int err;
+
+  for (int i = 0; i < NUM_MIX_TYPES; i++) {
+    total_weight += options.mix[i];
+  }
+  created = calloc(options.ops, MPI_MAX_PSET_NAME_LEN);
+  if (created == NULL) {
+    fprintf(stderr, "Memory Error!\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+
+  MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+  MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+  update_lookup_pset(psets, lookup_pset);
+  MPI_Info_free(&psets);
+
+  for (long op = 0; op < options.ops; op++) {
+    if (options.rate > 0.0) {
+      uint64_t now = now_ns();
+      if (now < next_call) {
+        usleep((next_call - now) / 1000);
+      }
+      next_call += (uint64_t)(1e9 / options.rate);
+    }
+
+    enum call_type type = choose_call(total_weight);
+    if (type == CALL_PSET_FREE && num_created == 0) {
+      type = CALL_PSET_CREATE_OP;
+    }
+
+    switch (type) {
+      case CALL_GET_PSETS: {
+        start = now_ns();
+        err = MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+        record(type, start, err);
+        if (!err) {
+          update_lookup_pset(psets, lookup_pset);
+          MPI_Info_free(&psets);
+        }
+        break;
+      }
+      case CALL_GROUP_FROM_PSET: {
+        start = now_ns();
+        err = MPI_Group_from_session_pset(session, lookup_pset, &group);
+        record(type, start, err);
+        if (err) {
+          // the pset was freed in the meantime
+          strcpy(lookup_pset, "mpi://SELF");
+        } else {
+          MPI_Group_free(&group);
+        }
+        break;
+      }
+      case CALL_PSET_CREATE_OP: {
+        start = now_ns();
+        err = MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, "mpi://SELF",
+                                       "mpi://SELF", MPIDYNRES_PSET_UNION,
+                                       created[num_created]);
+        record(type, start, err);
+        if (!err) {
+          num_created++;
+        }
+        break;
+      }
+      case CALL_PSET_FREE: {
+        num_created--;
+        start = now_ns();
+        err = MPIDYNRES_pset_free(session, created[num_created]);
+        record(type, start, err);
+        break;
+      }
+      case CALL_RC_GET: {
+        MPIDYNRES_RC_type rc_type;
+        MPIDYNRES_RC_tag rc_tag;
+        char delta_pset[MPI_MAX_PSET_NAME_LEN];
+        MPI_Info rc_info;
+
+        start = now_ns();
+        err = MPIDYNRES_RC_get(session, &rc_type, delta_pset, &rc_tag,
+                               &rc_info);
+        record(type, start, err);
+        if (err) {
+          break;
+        }
+        if (rc_info != MPI_INFO_NULL) {
+          MPI_Info_free(&rc_info);
+        }
+        // added crs run this function too, removed crs finish their calls
+        if (rc_type != MPIDYNRES_RC_NONE) {
+          start = now_ns();
+          err = MPIDYNRES_RC_accept(session, rc_tag, MPI_INFO_NULL);
+          record(CALL_RC_ACCEPT, start, err);
+        }
+        break;
+      }
+      default: {
+        break;
+      }
+    }
+  }
+
+  while (num_created > 0) {
+    num_created--;
+    MPIDYNRES_pset_free(session, created[num_created]);
+  }
+  free(created);
+  MPI_Session_finalize(&session);
+  return 0;
+}
+
+static void parse_options(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    char const *arg = argv[i];
+    char const *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (val == NULL) {
+      fprintf(stderr, "Missing value for option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    if (strcmp(arg, "--ops") == 0) {
+      options.ops = atol(val);
+    } else if (strcmp(arg, "--rate") == 0) {
+      options.rate = strtod(val, NULL);
+    } else if (strcmp(arg, "--mix") == 0) {
+      if (sscanf(val, "%d,%d,%d,%d,%d", &options.mix[0], &options.mix[1],
+                 &options.mix[2], &options.mix[3], &options.mix[4]) != 5) {
+        fprintf(stderr, "--mix expects five comma separated weights\n");
+        exit(EXIT_FAILURE);
+      }
+    } else if (strcmp(arg, "--initial") == 0) {
+      options.initial = atoi(val);
+    } else if (strcmp(arg, "--change-prob") == 0) {
+      options.change_prob = strtod(val, NULL);
+    } else if (strcmp(arg, "--seed") == 0) {
+      options.seed = atoi(val);
+    } else if (strcmp(arg, "--json") == 0) {
+      options.json = val;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    i++;
+  }
+
+  int total_weight = 0;
+  for (int i = 0; i < NUM_MIX_TYPES; i++) {
+    if (options.mix[i] < 0) {
+      total_weight = 0;
+      break;
+    }
+    total_weight += options.mix[i];
+  }
+  if (options.ops < 1 || total_weight == 0) {
+    fprintf(stderr, "Invalid --ops or --mix\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+static int compare_u64(void const *a, void const *b) {
+  uint64_t x = *(uint64_t const *)a;
+  uint64_t y = *(uint64_t const *)b;
+  return (x > y) - (x < y);
+}
+
+static double percentile_us(uint64_t const *sorted, size_t n, double p) {
+  size_t idx = (size_t)(p * (n - 1) + 0.5);
+  return sorted[idx] / 1000.0;
+}
+
+static long current_rss_kb() {
+  long pages = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f != NULL) {
+    if (fscanf(f, "%*s %ld", &pages) != 1) {
+      pages = 0;
+    }
+    fclose(f);
+  }
+  return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/*
+ * Gather all samples on rank 0 and print the report
+ */
+static void report(double wall_s, int world_size) {
+  int rank;
+  FILE *out = stdout;
+  uint64_t total_ops = 0;
+  uint64_t total_errors = 0;
+  struct rusage usage;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Reduce(&num_errors, &total_errors, 1, MPI_UINT64_T, MPI_SUM, 0,
+             MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    if (options.json != NULL) {
+      out = fopen(options.json, "w");
+      if (out == NULL) {
+        perror("Cannot open json file");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+      }
+    }
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(out, "{\n");
+    fprintf(out, "  \"benchmark\": \"scheduler\",\n");
+    fprintf(out, "  \"ranks\": %d,\n", world_size);
+    fprintf(out,
+            "  \"options\": {\"ops\": %ld, \"rate\": %g, \"mix\": [%d, %d, "
+            "%d, %d, %d], \"initial\": %d, \"change_prob\": %g, \"seed\": "
+            "%d},\n",
+            options.ops, options.rate, options.mix[0], options.mix[1],
+            options.mix[2], options.mix[3], options.mix[4], options.initial,
+            options.change_prob, options.seed);
+    fprintf(out, "  \"wall_time_s\": %.6f,\n", wall_s);
+    fprintf(out,
+            "  \"scheduler_memory\": {\"max_rss_kb\": %ld, \"rss_kb\": "
+            "%ld},\n",
+            usage.ru_maxrss, current_rss_kb());
+    fprintf(out, "  \"calls\": {\n");
+  }
+
+  for (int type = 0; type < NUM_CALL_TYPES; type++) {
+    int count = samples[type].size;
+    int *counts = NULL;
+    int *displs = NULL;
+    uint64_t *all = NULL;
+    int total = 0;
+
+    if (rank == 0) {
+      counts = calloc(world_size, sizeof(int));
+      displs = calloc(world_size, sizeof(int));
+    }
+    MPI_Gather(&count, 1, MPI_INT, counts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+      for (int i = 0; i < world_size; i++) {
+        displs[i] = total;
+        total += counts[i];
+      }
+      all = malloc((total + 1) * sizeof(uint64_t));
+    }
+    MPI_Gatherv(samples[type].ns, count, MPI_UINT64_T, all, counts, displs,
+                MPI_UINT64_T, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+      fprintf(out, "    \"%s\": {\"count\": %d", call_names[type], total);
+      if (total > 0) {
+        double sum = 0.0;
+        qsort(all, total, sizeof(uint64_t), compare_u64);
+        for (int i = 0; i < total; i++) {
+          sum += all[i];
+        }
+        fprintf(out,
+                ", \"ops_per_s\": %.1f, \"mean_us\": %.3f, \"p50_us\": %.3f, "
+                "\"p99_us\": %.3f, \"p999_us\": %.3f, \"max_us\": %.3f",
+                total / wall_s, sum / total / 1000.0,
+                percentile_us(all, total, 0.5), percentile_us(all, total, 0.99),
+                percentile_us(all, total, 0.999), all[total - 1] / 1000.0);
+      }
+      fprintf(out, "}%s\n", type + 1 < NUM_CALL_TYPES ? "," : "");
+      total_ops += total;
+      free(counts);
+      free(displs);
+      free(all);
+    }
+    free(samples[type].ns);
+  }
+
+  if (rank == 0) {
+    fprintf(out, "  },\n");
+    fprintf(out, "  \"total_ops\": %lu,\n", (unsigned long)total_ops);
+    fprintf(out, "  \"ops_per_s\": %.1f,\n", total_ops / wall_s);
+    fprintf(out, "  \"errors\": %lu\n", (unsigned long)total_errors);
+    fprintf(out, "}\n");
+    if (out != stdout) {
+      fclose(out);
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Info manager_config;
+  int world_size;
+  int rank;
+  char buf[0x20];
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  parse_options(argc, argv);
+  srand(options.seed + rank);
+
+  if (options.initial < 1 || options.initial > world_size - 1) {
+    options.initial = world_size - 1;
+  }
+
+  MPI_Info_create(&manager_config);
+  snprintf(buf, sizeof(buf), "%d", options.initial);
+  MPI_Info_set(manager_config, "manager_initial_number", buf);
+  snprintf(buf, sizeof(buf), "%g", options.change_prob);
+  MPI_Info_set(manager_config, "manager_change_prob", buf);
+
+  MPIDYNRES_SIM_config config = {
+      .base_communicator = MPI_COMM_WORLD,
+      .manager_config = manager_config,
+  };
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  double start = MPI_Wtime();
+  MPIDYNRES_SIM_start(config, argc, argv, bench_main);
+  double wall_s = MPI_Wtime() - start;
+
+  report(wall_s, world_size);
+
+  MPI_Info_free(&manager_config);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,488 @@
+/*
+ * BENCH_MPI_RANKS 9
+ *
+ * Workload trace driver
+ *
+ * Replays the job arrivals of a workload trace against the simulator, so the
+ * managers can be compared on a whole cluster workload instead of a single
+ * application. Every job of the trace becomes a synthetic malleable job that
+ * is submitted with MPIDYNRES_SIM_start_jobs at its (compressed) arrival time.
+ *
+ * A job needs its run time (at its requested size) worth of work. Its speed
+ * follows Amdahl's law with --serial-fraction, so it finishes earlier when it
+ * gets more crs. Every --rc-interval iterations the first rank of a job passes
+ * the time per iteration and its malleability range to the manager
+ * (mpidynres_iter_time, mpidynres_min_procs, mpidynres_max_procs) and asks for
+ * resource changes.
+ *
+ * Traces are read in the Standard Workload Format (files ending in .swf, uses
+ * the submit time, run time and requested processors of every job) or as CSV
+ * with the columns
+ *
+ *   arrival,size,min_size,max_size,run_time
+ *
+ * (times in seconds, lines starting with # are ignored). Without --trace, a
+ * small synthetic workload is used. Sizes are clamped to the available crs.
+ *
+ * The report contains the makespan, the average wait time and slowdown, the
+ * utilization and the statistics of every job (see MPIDYNRES_JOB_REPORT).
+ *
+ * Usage: bench_workload [options]
+ *   --trace FILE           SWF or CSV trace (default: built in workload)
+ *   --compression F        trace seconds per simulated second (default 100)
+ *   --max-jobs N           replay at most N jobs (default 32)
+ *   --malleability F       SWF jobs may run on size / F ... size * F crs
+ *                          (default 2)
+ *   --serial-fraction S    serial fraction of the jobs (default 0.05)
+ *   --rc-interval N        iterations between resource change checks
+ *                          (default 5)
+ *   --manager-config K=V   additional manager_config key (repeatable,
+ *                          default manager_name=scaling)
+ *   --json FILE            write the report to FILE instead of stdout
+ */
+#include <mpi.h>
+#include <mpidynres.h>
+#include <mpidynres_sim.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_JOBS 1024
+#define MAX_MANAGER_KEYS 16
+#define LINE_LEN 0x400
+
+// time per iteration of a job running on a single cr
+#define QUANTUM_S 0.01
+
+struct bench_options {
+  char const *trace;
+  double compression;
+  int max_jobs;
+  double malleability;
+  double serial_fraction;
+  int rc_interval;
+  char const *manager_keys[MAX_MANAGER_KEYS];
+  int num_manager_keys;
+  char const *json;
+};
+
+static struct bench_options options = {
+    .trace = NULL,
+    .compression = 100.0,
+    .max_jobs = 32,
+    .malleability = 2.0,
+    .serial_fraction = 0.05,
+    .rc_interval = 5,
+    .num_manager_keys = 0,
+    .json = NULL,
+};
+
+// a job of the trace, times already compressed
+struct trace_job {
+  double arrival;
+  int size;
+  int min_size;
+  int max_size;
+  int iters;  // number of iterations (of QUANTUM_S at one cr)
+};
+
+static struct trace_job jobs[MAX_JOBS];
+static int num_jobs;
+
+// built in workload: arrival, size, min_size, max_size, run time
+static double const builtin_workload[][5] = {
+    {0.0, 4, 2, 8, 60.0},   {10.0, 2, 1, 4, 40.0}, {20.0, 6, 3, 8, 50.0},
+    {30.0, 1, 1, 2, 30.0},  {40.0, 3, 1, 6, 40.0}, {60.0, 8, 4, 8, 30.0},
+    {80.0, 2, 2, 2, 20.0},  {90.0, 4, 1, 8, 40.0},
+};
+
+static MPI_Session session;
+static MPI_Comm main_comm;
+static int main_rank;
+static int main_size;
+static char main_pset[MPI_MAX_PSET_NAME_LEN];
+
+static double speedup(int procs) {
+  double s = options.serial_fraction;
+  return 1.0 / (s + (1.0 - s) / procs);
+}
+
+static int clamp(int val, int lo, int hi) {
+  return val < lo ? lo : (val > hi ? hi : val);
+}
+
+/*
+ * Compress the times of a job and make its sizes fit into num_crs
+ */
+static void add_job(double arrival, int size, int min_size, int max_size,
+                    double run_time, int num_crs) {
+  if (num_jobs == options.max_jobs || num_jobs == MAX_JOBS) {
+    return;
+  }
+  struct trace_job *job = &jobs[num_jobs++];
+  job->size = clamp(size, 1, num_crs);
+  job->min_size = clamp(min_size, 1, job->size);
+  job->max_size = clamp(max_size, job->size, num_crs);
+  job->arrival = arrival / options.compression;
+  // the work the job does in run_time on its requested size
+  double work = run_time / options.compression * speedup(job->size);
+  job->iters = (int)(work / QUANTUM_S);
+  job->iters = job->iters < 1 ? 1 : job->iters;
+}
+
+static void read_trace(int num_crs) {
+  char line[LINE_LEN];
+  bool swf = strlen(options.trace) > 4 &&
+             strcmp(options.trace + strlen(options.trace) - 4, ".swf") == 0;
+  double first_arrival = -1.0;
+
+  FILE *f = fopen(options.trace, "r");
+  if (f == NULL) {
+    perror("Cannot open trace");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  while (fgets(line, sizeof(line), f) != NULL) {
+    double arrival, run_time;
+    int size, min_size, max_size;
+
+    if (swf) {
+      // job, submit, wait, run time, allocated procs, cpu, memory, requested
+      // procs, ...
+      double v[8];
+      if (line[0] == ';' ||
+          sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %lf", &v[0], &v[1], &v[2],
+                 &v[3], &v[4], &v[5], &v[6], &v[7]) != 8) {
+        continue;
+      }
+      arrival = v[1];
+      run_time = v[3];
+      size = v[7] > 0 ? (int)v[7] : (int)v[4];
+      min_size = (int)(size / options.malleability);
+      max_size = (int)(size * options.malleability);
+    } else {
+      if (line[0] == '#' ||
+          sscanf(line, "%lf,%d,%d,%d,%lf", &arrival, &size, &min_size,
+                 &max_size, &run_time) != 5) {
+        continue;
+      }
+    }
+    if (run_time <= 0.0 || size <= 0) {
+      continue;
+    }
+    if (first_arrival < 0.0) {
+      first_arrival = arrival;
+    }
+    add_job(arrival - first_arrival, size, min_size, max_size, run_time,
+            num_crs);
+  }
+  fclose(f);
+
+  if (num_jobs == 0) {
+    fprintf(stderr, "No jobs in trace %s\n", options.trace);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+}
+
+static bool info_contains(MPI_Info info, char const *key) {
+  int contains, unused;
+  if (info == MPI_INFO_NULL) {
+    return false;
+  }
+  MPI_Info_get_valuelen(info, key, &unused, &contains);
+  return contains;
+}
+
+static void update_main_comm() {
+  MPI_Group group;
+  MPI_Group_from_session_pset(session, main_pset, &group);
+  MPI_Comm_create_from_group(group, NULL, MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL,
+                             &main_comm);
+  MPI_Group_free(&group);
+  MPI_Comm_rank(main_comm, &main_rank);
+  MPI_Comm_size(main_comm, &main_size);
+}
+
+static void accept_rc(MPIDYNRES_RC_tag rc_tag, int iter) {
+  MPI_Info info;
+  char buf[0x20];
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "workload://main_pset", main_pset);
+  snprintf(buf, sizeof(buf), "%d", iter);
+  MPI_Info_set(info, "workload://iter", buf);
+  MPIDYNRES_RC_accept(session, rc_tag, info);
+  MPI_Info_free(&info);
+}
+
+/*
+ * Pass the performance of the job to the manager, ask for resource changes
+ * and apply them
+ *
+ * @return     whether this cr has to leave
+ */
+static bool resource_change_step(struct trace_job *job, int iter) {
+  MPIDYNRES_RC_type rc_type = MPIDYNRES_RC_NONE;
+  MPIDYNRES_RC_tag rc_tag = 0;
+  char delta_pset[MPI_MAX_PSET_NAME_LEN] = {0};
+  MPI_Info rc_info, psets;
+  bool leaving = false;
+
+  if (main_rank == 0) {
+    MPI_Info hints, answer;
+    char buf[0x40];
+    MPI_Info_create(&hints);
+    snprintf(buf, sizeof(buf), "%.9f", QUANTUM_S / speedup(main_size));
+    MPI_Info_set(hints, "mpidynres_iter_time", buf);
+    snprintf(buf, sizeof(buf), "%d", job->min_size);
+    MPI_Info_set(hints, "mpidynres_min_procs", buf);
+    snprintf(buf, sizeof(buf), "%d", job->max_size);
+    MPI_Info_set(hints, "mpidynres_max_procs", buf);
+    MPIDYNRES_add_scheduling_hints(session, hints, &answer);
+    MPI_Info_free(&hints);
+    if (answer != MPI_INFO_NULL) {
+      MPI_Info_free(&answer);
+    }
+    MPIDYNRES_RC_get(session, &rc_type, delta_pset, &rc_tag, &rc_info);
+    if (rc_info != MPI_INFO_NULL) {
+      MPI_Info_free(&rc_info);
+    }
+  }
+  int msg[2] = {rc_type, rc_tag};
+  MPI_Bcast(msg, 2, MPI_INT, 0, main_comm);
+  MPI_Bcast(delta_pset, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0, main_comm);
+  rc_type = msg[0];
+  rc_tag = msg[1];
+
+  if (rc_type == MPIDYNRES_RC_NONE) {
+    return false;
+  }
+  if (main_rank == 0) {
+    MPIDYNRES_pset_create_op(session, MPI_INFO_NULL, main_pset, delta_pset,
+                             rc_type == MPIDYNRES_RC_ADD
+                                 ? MPIDYNRES_PSET_UNION
+                                 : MPIDYNRES_PSET_DIFFERENCE,
+                             main_pset);
+  }
+  MPI_Bcast(main_pset, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0, main_comm);
+  if (rc_type == MPIDYNRES_RC_SUB) {
+    MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+    leaving = !info_contains(psets, main_pset);
+    MPI_Info_free(&psets);
+  }
+  if (main_rank == 0) {
+    accept_rc(rc_tag, iter);
+  }
+  MPI_Comm_free(&main_comm);
+  if (!leaving) {
+    update_main_comm();
+  }
+  return leaving;
+}
+
+static int job_main(int argc, char *argv[]) {
+  (void)argc, (void)argv;
+  MPI_Info psets, session_info;
+  char buf[MPI_MAX_INFO_VAL];
+  int flag;
+  int iter = 0;
+  bool leaving = false;
+
+  MPI_Session_init(MPI_INFO_NULL, MPI_ERRORS_ARE_FATAL, &session);
+  MPI_Session_get_info(session, &session_info);
+  MPI_Info_get(session_info, "mpidynres_job_id", MPI_MAX_INFO_VAL - 1, buf,
+               &flag);
+  struct trace_job *job = &jobs[flag ? atoi(buf) : 0];
+
+  MPI_Session_get_psets(session, MPI_INFO_NULL, &psets);
+  if (info_contains(psets, "mpi://WORLD")) {
+    strcpy(main_pset, "mpi://WORLD");
+  } else {
+    // started by a resource change
+    MPI_Info_get(session_info, "workload://main_pset",
+                 MPI_MAX_PSET_NAME_LEN - 1, main_pset, &flag);
+    MPI_Info_get(session_info, "workload://iter", MPI_MAX_INFO_VAL - 1, buf,
+                 &flag);
+    iter = atoi(buf);
+  }
+  MPI_Info_free(&psets);
+  MPI_Info_free(&session_info);
+  update_main_comm();
+
+  while (iter < job->iters && !leaving) {
+    usleep((useconds_t)(QUANTUM_S / speedup(main_size) * 1e6));
+    iter++;
+    if (iter % options.rc_interval == 0 && iter < job->iters) {
+      leaving = resource_change_step(job, iter);
+    }
+  }
+
+  if (!leaving) {
+    MPI_Comm_free(&main_comm);
+  }
+  MPI_Session_finalize(&session);
+  return 0;
+}
+
+static void report(char const *job_report) {
+  FILE *out = stdout;
+  FILE *in;
+  char line[LINE_LEN];
+
+  if (options.json != NULL) {
+    out = fopen(options.json, "w");
+    if (out == NULL) {
+      perror("Cannot open json file");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"benchmark\": \"workload\",\n");
+  fprintf(out,
+          "  \"options\": {\"trace\": \"%s\", \"compression\": %g, "
+          "\"num_jobs\": %d, \"malleability\": %g, \"serial_fraction\": %g, "
+          "\"rc_interval\": %d},\n",
+          options.trace != NULL ? options.trace : "builtin",
+          options.compression, num_jobs, options.malleability,
+          options.serial_fraction, options.rc_interval);
+  fprintf(out, "  \"report\": ");
+  in = fopen(job_report, "r");
+  if (in == NULL) {
+    perror("Cannot open job report");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+  }
+  while (fgets(line, sizeof(line), in) != NULL) {
+    fputs(line, out);
+  }
+  fclose(in);
+  fprintf(out, "}\n");
+  if (out != stdout) {
+    fclose(out);
+  }
+}
+
+static void parse_options(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    char const *arg = argv[i];
+    char const *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (val == NULL) {
+      fprintf(stderr, "Missing value for option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    if (strcmp(arg, "--trace") == 0) {
+      options.trace = val;
+    } else if (strcmp(arg, "--compression") == 0) {
+      options.compression = strtod(val, NULL);
+    } else if (strcmp(arg, "--max-jobs") == 0) {
+      options.max_jobs = atoi(val);
+    } else if (strcmp(arg, "--malleability") == 0) {
+      options.malleability = strtod(val, NULL);
+    } else if (strcmp(arg, "--serial-fraction") == 0) {
+      options.serial_fraction = strtod(val, NULL);
+    } else if (strcmp(arg, "--rc-interval") == 0) {
+      options.rc_interval = atoi(val);
+    } else if (strcmp(arg, "--manager-config") == 0) {
+      if (options.num_manager_keys == MAX_MANAGER_KEYS ||
+          strchr(val, '=') == NULL) {
+        fprintf(stderr, "Invalid --manager-config %s\n", val);
+        exit(EXIT_FAILURE);
+      }
+      options.manager_keys[options.num_manager_keys++] = val;
+    } else if (strcmp(arg, "--json") == 0) {
+      options.json = val;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", arg);
+      exit(EXIT_FAILURE);
+    }
+    i++;
+  }
+  if (options.compression <= 0.0 || options.max_jobs < 1 ||
+      options.malleability < 1.0 || options.serial_fraction < 0.0 ||
+      options.serial_fraction > 1.0 || options.rc_interval < 1) {
+    fprintf(stderr,
+            "Invalid --compression, --max-jobs, --malleability, "
+            "--serial-fraction or --rc-interval\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Info manager_config;
+  MPI_Info job_configs[MAX_JOBS];
+  MPIDYNRES_SIM_job sim_jobs[MAX_JOBS];
+  char job_report[] = "/tmp/bench_workload_XXXXXX";
+  int world_size;
+  int rank;
+  char buf[0x20];
+
+  MPI_Init(&argc, &argv);
+  MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  parse_options(argc, argv);
+  srand(rank + 1);
+
+  // every rank needs the jobs
+  if (options.trace != NULL) {
+    read_trace(world_size - 1);
+  } else {
+    for (size_t i = 0; i < sizeof(builtin_workload) / sizeof(*builtin_workload);
+         i++) {
+      double const *j = builtin_workload[i];
+      add_job(j[0], j[1], j[2], j[3], j[4], world_size - 1);
+    }
+  }
+
+  MPI_Info_create(&manager_config);
+  MPI_Info_set(manager_config, "manager_name", "scaling");
+  for (int i = 0; i < options.num_manager_keys; i++) {
+    char key[MPI_MAX_INFO_KEY + 1] = {0};
+    char const *eq = strchr(options.manager_keys[i], '=');
+    size_t keylen = eq - options.manager_keys[i];
+    if (keylen > MPI_MAX_INFO_KEY) {
+      keylen = MPI_MAX_INFO_KEY;
+    }
+    memcpy(key, options.manager_keys[i], keylen);
+    MPI_Info_set(manager_config, key, eq + 1);
+  }
+
+  for (int i = 0; i < num_jobs; i++) {
+    MPI_Info_dup(manager_config, &job_configs[i]);
+    snprintf(buf, sizeof(buf), "%d", jobs[i].size);
+    MPI_Info_set(job_configs[i], "manager_initial_number", buf);
+    sim_jobs[i] = (MPIDYNRES_SIM_job){
+        .sim_main = job_main,
+        .manager_config = job_configs[i],
+        .submit_time = jobs[i].arrival,
+    };
+  }
+
+  // the scheduler writes the statistics of the jobs to MPIDYNRES_JOB_REPORT
+  if (rank == 0) {
+    int fd = mkstemp(job_report);
+    if (fd < 0) {
+      perror("Cannot create job report");
+      MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    close(fd);
+    setenv("MPIDYNRES_JOB_REPORT", job_report, 1);
+  }
+
+  MPIDYNRES_SIM_config config = {
+      .base_communicator = MPI_COMM_WORLD,
+      .manager_config = manager_config,
+  };
+  MPIDYNRES_SIM_start_jobs(config, num_jobs, sim_jobs, argc, argv);
+
+  if (rank == 0) {
+    report(job_report);
+    unlink(job_report);
+  }
+
+  for (int i = 0; i < num_jobs; i++) {
+    MPI_Info_free(&job_configs[i]);
+  }
+  MPI_Info_free(&manager_config);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * This file should be included when you want to start a simulated dynamic mpi
+ * session
+ */
+#ifndef MPIDYNRES_SIM_H
+#define MPIDYNRES_SIM_H
+
+#include <mpi.h>
+
+#include "mpidynres.h"
+
+/**
+ * @brief      this struct can be used to change the behaviour of mpidynres and its
+ * scheduling
+ */
+struct MPIDYNRES_SIM_config {
+  /*
+   * The base_communicator contains all computing resources available for the
+   * simulation
+   */
+  MPI_Comm base_communicator;
+  MPI_Info manager_config;
+};
+typedef struct MPIDYNRES_SIM_config MPIDYNRES_SIM_config;
+
+/**
+ * @brief      A job that is simulated next to other jobs, see
+ * MPIDYNRES_SIM_start_jobs
+ */
+struct MPIDYNRES_SIM_job {
+  int (*sim_main)(int, char **);  ///< entry point of the job
+  /*
+   * Manager config of the job, MPI_INFO_NULL to use the one of the simulation
+   * config
+   */
+  MPI_Info manager_config;
+  /*
+   * Seconds after the start of the simulation the job arrives, jobs have to
+   * be given in the order they arrive
+   */
+  double submit_time;
+  /*
+   * Optional, prepares a computing resource for the job (allocate buffers, load
+   * input) and is always called before sim_main is started on it. If the
+   * manager keeps computing resources on standby (manager_standby), it runs
+   * while they are idle, ahead of the resource change that starts them. It
+   * must not call the mpidynres functions.
+   */
+  int (*sim_warmup)(int, char **);
+};
+typedef struct MPIDYNRES_SIM_job MPIDYNRES_SIM_job;
+
+/**
+ * @brief      How the computing resources were used during a simulation, see
+ * MPIDYNRES_SIM_get_utilization
+ *
+ * @details    The cr seconds are summed over all computing resources. A
+ * computing resource is reserved from the proposal of the resource change that
+ * adds it until it is started and shutting down from the proposal of the
+ * resource change that removes it until it returns. Injected start and
+ * shutdown latencies (manager_start_latency, manager_shutdown_latency) count
+ * as reserved and shutting down.
+ */
+struct MPIDYNRES_SIM_utilization {
+  int num_crs;                  ///< number of computing resources
+  double makespan;              ///< seconds the simulation ran
+  double available_cr_seconds;  ///< num_crs * makespan
+  double idle_cr_seconds;
+  double reserved_cr_seconds;
+  double running_cr_seconds;
+  double shutdown_cr_seconds;
+  double cpu_seconds;  ///< CPU time (user + system) of the simulated processes
+  /*
+   * Share of the available cr seconds the computing resources were running or
+   * shutting down
+   */
+  double utilization;
+};
+typedef struct MPIDYNRES_SIM_utilization MPIDYNRES_SIM_utilization;
+
+/*
+ * MPIDYNRES_SIM_get_default_config returns the a default config struct
+ */
+int MPIDYNRES_SIM_get_default_config(MPIDYNRES_SIM_config *o_config);
+
+/*
+ * MPIDYNRES_SIM_start will start the simulation and will call i_sim_main
+ * whenever the current computing resource is started (simulation-wise) Note
+ * that MPI_Init has to be called before this function
+ */
+int MPIDYNRES_SIM_start(MPIDYNRES_SIM_config i_config, int argc, char *argv[],
+                        int i_sim_main(int, char **));
+
+/*
+ * MPIDYNRES_SIM_start_jobs works like MPIDYNRES_SIM_start, but simulates
+ * several jobs that share the computing resources. Every job has its own
+ * mpi://WORLD and its own manager. Jobs are started in the given order as soon
+ * as they arrived (see submit_time) and there are enough free computing
+ * resources for their initial process set.
+ */
+int MPIDYNRES_SIM_start_jobs(MPIDYNRES_SIM_config i_config, int num_jobs,
+                             MPIDYNRES_SIM_job const i_jobs[], int argc,
+                             char *argv[]);
+
+/*
+ * MPIDYNRES_SIM_get_stats returns the metrics of the scheduler (request
+ * latencies per type, resource change decisions and latencies, bytes, live
+ * psets, ...) as a new info object, which has to be freed by the caller. It
+ * can be called by the simulated processes while the simulation runs.
+ */
+int MPIDYNRES_SIM_get_stats(MPI_Info *o_stats);
+
+/*
+ * MPIDYNRES_SIM_get_utilization returns the utilization of the computing
+ * resources during the last simulation. It can be called on all ranks after
+ * MPIDYNRES_SIM_start returned, it returns != 0 if no simulation finished yet.
+ */
+int MPIDYNRES_SIM_get_utilization(MPIDYNRES_SIM_utilization *o_utilization);
+
+/*
+ * You can make your program to automatically run in simulated mode
+ * For that, create a MPIDYNRES_main function instead of the usual main function
+ * Before importing this header, define MPIDYNRES_MAIN
+ * The MPI_Sessions simulation will then use MPI_COMM_WORLD as its Computing
+ * Resource Pool
+ */
+#ifdef MPIDYNRES_MAIN
+#ifndef MPIDYNRES_NUM_INIT_RANKS
+#define MPIDYNRES_NUM_INIT_RANKS 1
+#endif
+extern int MPIDYNRES_main(int argc, char **argv);
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+int main(int argc, char *argv[]) {
+  int err;
+  MPIDYNRES_SIM_config c;
+  char *seed = getenv("MPIDYNRES_SEED");
+
+  srand(seed != NULL ? strtoul(seed, NULL, 0) : time(NULL));
+  // manager_async needs MPI_THREAD_MULTIPLE, it falls back without it
+  int provided;
+  err = MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  if (err) {
+    fprintf(stderr, "Failed to initialize MPI\n");
+    MPI_Finalize();
+    exit(EXIT_FAILURE);
+  }
+  MPIDYNRES_SIM_get_default_config(&c);
+  int r = MPIDYNRES_SIM_start(c, argc, argv, MPIDYNRES_main);
+  MPI_Finalize();
+  return r;
+}
+#endif  // MPIDYNRES_MAIN
+
+#endif  // header guard
@@ -0,0 +1,82 @@
+/*
+ * Include this file in a tool (for example a profiler) that wants to be
+ * notified about the reconfiguration events of a simulation
+ *
+ * A tool registers callbacks for event types in every process it is
+ * interested in. The scheduler (rank 0 of the base communicator) fires the
+ * events it handles, the simulated processes fire the events of their own
+ * calls into libmpidynres, so a tool linked into the simulation sees the
+ * scheduler events on rank 0 and the client events on all other ranks.
+ *
+ * The callbacks are called synchronously from the thread that runs the
+ * scheduler or the simulated process and should return quickly. Registering
+ * and unregistering is not thread safe and should happen before
+ * MPIDYNRES_SIM_start or from inside a callback of the same process.
+ */
+#ifndef MPIDYNRES_TOOL_H
+#define MPIDYNRES_TOOL_H
+
+#include <stdint.h>
+
+/*
+ * Maximum number of callbacks that can be registered at the same time in a
+ * process
+ */
+#define MPIDYNRES_TOOL_MAX_CALLBACKS 32
+
+enum MPIDYNRES_tool_event_type {
+  MPIDYNRES_TOOL_SESSION_INIT,      ///< a session was created
+  MPIDYNRES_TOOL_SESSION_FINALIZE,  ///< a session is finalized
+  MPIDYNRES_TOOL_RC_PROPOSED,       ///< a resource change was proposed
+  MPIDYNRES_TOOL_RC_ACCEPTED,       ///< a resource change was accepted
+  MPIDYNRES_TOOL_CR_STARTED,        ///< a cr was started for a job
+  MPIDYNRES_TOOL_CR_EXITED,         ///< a cr returned from the simulation
+  MPIDYNRES_TOOL_PSET_CREATED,      ///< a process set was created
+  MPIDYNRES_TOOL_PSET_FREED,        ///< a process set was freed
+
+  MPIDYNRES_TOOL_NUM_EVENTS
+};
+typedef enum MPIDYNRES_tool_event_type MPIDYNRES_tool_event_type;
+
+/**
+ * @brief      An event passed to the callbacks, fields that do not apply to
+ * the event type are -1 (or NULL)
+ */
+struct MPIDYNRES_tool_event {
+  MPIDYNRES_tool_event_type type;
+  uint64_t time_ns;       ///< CLOCK_MONOTONIC, comparable on the same node
+  int in_scheduler;       ///< 1 if fired by the scheduler, 0 if by a simulated process
+  int job_id;             ///< the job of the cr
+  int cr_id;              ///< the cr the event is about, or the calling cr
+  int session_id;         ///< the session used by the call
+  int rc_tag;             ///< the tag of the resource change
+  int rc_type;            ///< MPIDYNRES_RC_type of the resource change
+  char const *pset_name;  ///< only valid during the callback
+  int pset_size;          ///< number of crs in the process set
+};
+typedef struct MPIDYNRES_tool_event MPIDYNRES_tool_event;
+
+typedef void MPIDYNRES_tool_callback(MPIDYNRES_tool_event const *event,
+                                     void *user_data);
+
+/*
+ * MPIDYNRES_tool_register registers a callback for an event type, a handle to
+ * unregister it is returned in o_handle
+ */
+int MPIDYNRES_tool_register(MPIDYNRES_tool_event_type type,
+                            MPIDYNRES_tool_callback *callback, void *user_data,
+                            int *o_handle);
+
+/*
+ * MPIDYNRES_tool_unregister removes a callback registered with
+ * MPIDYNRES_tool_register
+ */
+int MPIDYNRES_tool_unregister(int handle);
+
+/*
+ * MPIDYNRES_tool_event_name returns the name of an event type, for example
+ * "rc_proposed"
+ */
+char const *MPIDYNRES_tool_event_name(MPIDYNRES_tool_event_type type);
+
+#endif
@@ -0,0 +1 @@
+../src/mpidynres_tool.h
\ No newline at end of file
@@ -0,0 +1,63 @@
+#!/usr/bin/env bash
+###
+### run_bench.sh — run libmpidynres benchmarks
+###
+### Usage:
+###   run_bench.sh <builddir>
+###
+### Options:
+###   <builddir> build directory from the make file
+###
+### Environment:
+###   BENCH_RANKS  space separated list of rank counts to run every benchmark
+###                with (default: the BENCH_MPI_RANKS value of the source)
+###   BENCH_ARGS   additional arguments passed to every benchmark
+###
+### The JSON reports are written to <builddir>/bench/<name>_<ranks>.json
+
+help() {
+    sed -rn 's/^### ?//;T;p' "$0"
+}
+
+if [[ "$1" == "-h" ]]; then
+    help
+    exit 1
+fi
+
+BUILDDIR="${1:-build}"
+
+export HWLOC_DEBUG_VERBOSE=0
+
+echo "LIBMPIDYNRES BENCHMARKS"
+echo "======================="
+
+failed=0
+for benchsrc in $(ls -1 bench | sed -n '/^bench_.*\.c/p' | sort); do
+    benchname="${benchsrc%.*}"
+    binary="./$BUILDDIR/bench/$benchname"
+
+    if [ ! -f "$binary" ]; then
+        echo "It seems the benchmark $benchname wasn't build, please run \`make benchs\` again"
+        failed=1
+        continue
+    fi
+
+    ranks="$BENCH_RANKS"
+    if [ -z "$ranks" ]; then
+        ranks=$(sed -n 's/^.*BENCH_MPI_RANKS\s\([0-9]\+\)\([^0-9].*\)\?$/\1/gp' "bench/$benchsrc")
+    fi
+
+    for n in $ranks; do
+        json="$BUILDDIR/bench/${benchname}_${n}.json"
+        echo "Running $benchname with $n ranks..."
+        mpirun --oversubscribe -n "$n" "$binary" --json "$json" $BENCH_ARGS < /dev/null > /dev/null
+        if [ "$?" -ne 0 ]; then
+            echo "Benchmark $benchname failed with $n ranks"
+            failed=1
+            continue
+        fi
+        cat "$json"
+    done
+done
+
+exit $failed
@@ -0,0 +1,442 @@
+#include "call_trace.h"
+
+#include <inttypes.h>
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging.h"
+#include "util.h"
+
+struct transport_recorder {
+  MPIDYNRES_transport base;
+  MPIDYNRES_transport *inner;
+  FILE *f;
+  double start_time;
+};
+typedef struct transport_recorder transport_recorder;
+
+/*
+ * Names of the tags used in the trace, so it can be read by humans
+ */
+static char const *const tag_names[MPIDYNRES_NUM_TAGS] = {
+#define TAG_NAME(tag) [MPIDYNRES_TAG_##tag - MPIDYNRES_TAG_IDLE_COMMAND] = #tag
+    TAG_NAME(IDLE_COMMAND),
+    TAG_NAME(DONE_RUNNING),
+    TAG_NAME(SESSION_CREATE),
+    TAG_NAME(SESSION_CREATE_ANSWER),
+    TAG_NAME(SESSION_INFO),
+    TAG_NAME(SESSION_INFO_ANSWER_SIZE),
+    TAG_NAME(SESSION_INFO_ANSWER),
+    TAG_NAME(SESSION_FINALIZE),
+    TAG_NAME(SESSION_FINALIZE_ANSWER),
+    TAG_NAME(GET_PSETS),
+    TAG_NAME(GET_PSETS_INFO_SIZE),
+    TAG_NAME(GET_PSETS_INFO),
+    TAG_NAME(GET_PSETS_ANSWER_SIZE),
+    TAG_NAME(GET_PSETS_ANSWER),
+    TAG_NAME(PSET_INFO),
+    TAG_NAME(PSET_INFO_NAME),
+    TAG_NAME(PSET_INFO_ANSWER_SIZE),
+    TAG_NAME(PSET_INFO_ANSWER),
+    TAG_NAME(PSET_LOOKUP),
+    TAG_NAME(PSET_LOOKUP_NAME),
+    TAG_NAME(PSET_LOOKUP_ANSWER_SIZE),
+    TAG_NAME(PSET_LOOKUP_ANSWER),
+    TAG_NAME(PSET_OP),
+    TAG_NAME(PSET_OP_INFO_SIZE),
+    TAG_NAME(PSET_OP_INFO),
+    TAG_NAME(PSET_OP_ANSWER),
+    TAG_NAME(PSET_FREE),
+    TAG_NAME(SCHED_HINTS),
+    TAG_NAME(SCHED_HINTS_SIZE),
+    TAG_NAME(SCHED_HINTS_INFO),
+    TAG_NAME(SCHED_HINTS_ANSWER_SIZE),
+    TAG_NAME(SCHED_HINTS_ANSWER),
+    TAG_NAME(RC),
+    TAG_NAME(RC_INFO_SIZE),
+    TAG_NAME(RC_INFO),
+    TAG_NAME(RC_ANSWER),
+    TAG_NAME(RC_ACCEPT),
+    TAG_NAME(RC_ACCEPT_INFO_SIZE),
+    TAG_NAME(RC_ACCEPT_INFO),
+    TAG_NAME(GET_STATS),
+    TAG_NAME(GET_STATS_ANSWER_SIZE),
+    TAG_NAME(GET_STATS_ANSWER),
+#undef TAG_NAME
+};
+
+/**
+ * @brief      Get the name of a tag
+ *
+ * @param      tag The tag
+ *
+ * @return     The name without the MPIDYNRES_TAG_ prefix or "UNKNOWN"
+ */
+char const *MPIDYNRES_tag_name(int tag) {
+  int i = tag - MPIDYNRES_TAG_IDLE_COMMAND;
+  if (i < 0 || i >= MPIDYNRES_NUM_TAGS) {
+    return "UNKNOWN";
+  }
+  return tag_names[i];
+}
+
+/**
+ * @brief      Whether a tag starts a call (the other tags are follow-ups or
+ * answers)
+ *
+ * @param      tag The tag
+ *
+ * @return     true if the scheduler dispatches on this tag
+ */
+static bool is_request(int tag) {
+  switch (tag) {
+    case MPIDYNRES_TAG_DONE_RUNNING:
+    case MPIDYNRES_TAG_SESSION_CREATE:
+    case MPIDYNRES_TAG_SESSION_INFO:
+    case MPIDYNRES_TAG_SESSION_FINALIZE:
+    case MPIDYNRES_TAG_GET_PSETS:
+    case MPIDYNRES_TAG_PSET_INFO:
+    case MPIDYNRES_TAG_PSET_LOOKUP:
+    case MPIDYNRES_TAG_PSET_OP:
+    case MPIDYNRES_TAG_PSET_FREE:
+    case MPIDYNRES_TAG_SCHED_HINTS:
+    case MPIDYNRES_TAG_RC:
+    case MPIDYNRES_TAG_RC_ACCEPT:
+    case MPIDYNRES_TAG_GET_STATS:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static int transport_recorder_send(MPIDYNRES_transport *transport,
+                                   void const *buf, size_t size, int dest,
+                                   int tag) {
+  transport_recorder *t = (transport_recorder *)transport;
+  return MPIDYNRES_transport_send(t->inner, buf, size, dest, tag);
+}
+
+static int transport_recorder_recv(MPIDYNRES_transport *transport, void *buf,
+                                   size_t size, int source, int tag,
+                                   MPIDYNRES_transport_status *status) {
+  transport_recorder *t = (transport_recorder *)transport;
+  int err = MPIDYNRES_transport_recv(t->inner, buf, size, source, tag, status);
+  if (err) {
+    return err;
+  }
+
+  fprintf(t->f, "%f %d %d %s %zu ", MPI_Wtime() - t->start_time,
+          status->source, status->tag, MPIDYNRES_tag_name(status->tag),
+          status->size);
+  for (size_t i = 0; i < status->size; i++) {
+    fprintf(t->f, "%02x", ((unsigned char *)buf)[i]);
+  }
+  putc('\n', t->f);
+  return 0;
+}
+
+static int transport_recorder_iprobe(MPIDYNRES_transport *transport,
+                                     int source, int tag, int *flag,
+                                     MPIDYNRES_transport_status *status) {
+  transport_recorder *t = (transport_recorder *)transport;
+  return MPIDYNRES_transport_iprobe(t->inner, source, tag, flag, status);
+}
+
+static void transport_recorder_free(MPIDYNRES_transport *transport) {
+  transport_recorder *t = (transport_recorder *)transport;
+  fflush(t->f);
+  free(t);
+}
+
+/**
+ * @brief      Create a transport that records all received messages
+ *
+ * @details    The messages are sent and received with the inner transport.
+ * Freeing the recorder neither frees the inner transport nor closes the file.
+ *
+ * @param      inner The transport of the scheduler
+ *
+ * @param      f The trace is written to this file
+ *
+ * @return     The new transport endpoint
+ */
+MPIDYNRES_transport *MPIDYNRES_call_trace_recorder_create(
+    MPIDYNRES_transport *inner, FILE *f) {
+  transport_recorder *res = calloc(1, sizeof(transport_recorder));
+  if (res == NULL) {
+    die("Memory Error!\n");
+  }
+  res->base.name = "recorder";
+  res->base.rank = inner->rank;
+  res->base.size = inner->size;
+  res->base.send = transport_recorder_send;
+  res->base.recv = transport_recorder_recv;
+  res->base.iprobe = transport_recorder_iprobe;
+  res->base.free = transport_recorder_free;
+  res->inner = inner;
+  res->f = f;
+  res->start_time = MPI_Wtime();
+  return &res->base;
+}
+
+/**
+ * @brief      Write the jobs of the pool to a trace
+ *
+ * @details    Writes the manager_config and the seed of every job, they are
+ * needed to reproduce the decisions and the names of the psets created by
+ * pset operations. Has to be called before the scheduler starts.
+ *
+ * @param      f The trace
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_call_trace_write_header(FILE *f,
+                                       MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  char key[MPI_MAX_INFO_KEY + 1];
+  char value[MPI_MAX_INFO_VAL + 1];
+  int nkeys, flag;
+
+  fprintf(f, "# time source tag name size data\n");
+  fprintf(f, "# crs %d\n", pool->num_scheduling_processes);
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPI_Info config = pool->jobs[i]->config->manager_config;
+    fprintf(f, "# job %d seed %" PRIu64 "\n", i, pool->jobs[i]->rng_state);
+    if (config == MPI_INFO_NULL) {
+      continue;
+    }
+    MPI_Info_get_nkeys(config, &nkeys);
+    for (int j = 0; j < nkeys; j++) {
+      MPI_Info_get_nthkey(config, j, key);
+      MPI_Info_get(config, key, MPI_MAX_INFO_VAL, value, &flag);
+      if (flag && strcmp(key, MANAGER_SEED_KEY) != 0) {
+        fprintf(f, "# job %d key %s %s\n", i, key, value);
+      }
+    }
+  }
+}
+
+/**
+ * @brief      Read the header of a trace
+ *
+ * @param      f The trace, positioned at its start
+ *
+ * @param      o_header The header is returned here, has to be freed with
+ * MPIDYNRES_call_trace_header_free
+ */
+void MPIDYNRES_call_trace_read_header(FILE *f,
+                                      MPIDYNRES_call_trace_header *o_header) {
+  char *line = NULL;
+  size_t line_size = 0;
+  char key[MPI_MAX_INFO_KEY + 1];
+  char *value;
+  int c, job, pos;
+
+  *o_header = (MPIDYNRES_call_trace_header){0};
+  while ((c = getc(f)) == '#') {
+    if (getline(&line, &line_size, f) == -1) {
+      break;
+    }
+    line[strcspn(line, "\n")] = '\0';
+    if (sscanf(line, " crs %d", &o_header->num_crs) == 1) {
+      continue;
+    }
+    pos = -1;
+    if (sscanf(line, " job %d seed %n", &job, &pos) == 1 && pos > 0) {
+      if (job != o_header->num_jobs) {
+        die("Jobs of the call trace are not in order\n");
+      }
+      o_header->manager_configs =
+          realloc(o_header->manager_configs, (job + 1) * sizeof(MPI_Info));
+      if (o_header->manager_configs == NULL) {
+        die("Memory Error!\n");
+      }
+      MPI_Info_create(&o_header->manager_configs[job]);
+      MPI_Info_set(o_header->manager_configs[job], MANAGER_SEED_KEY,
+                   line + pos);
+      o_header->num_jobs++;
+    } else if (sscanf(line, " job %d key %" STR(MPI_MAX_INFO_KEY) "s %n",
+                      &job, key, &pos) == 2) {
+      if (job != o_header->num_jobs - 1) {
+        die("Jobs of the call trace are not in order\n");
+      }
+      value = line + pos;
+      MPI_Info_set(o_header->manager_configs[job], key, value);
+    }
+  }
+  if (c != EOF) {
+    ungetc(c, f);
+  }
+  free(line);
+  if (o_header->num_crs < 1 || o_header->num_jobs < 1) {
+    die("The call trace has no valid header\n");
+  }
+}
+
+/**
+ * @brief      Free a header read with MPIDYNRES_call_trace_read_header
+ *
+ * @param      header The header
+ */
+void MPIDYNRES_call_trace_header_free(MPIDYNRES_call_trace_header *header) {
+  for (int i = 0; i < header->num_jobs; i++) {
+    MPI_Info_free(&header->manager_configs[i]);
+  }
+  free(header->manager_configs);
+  header->manager_configs = NULL;
+}
+
+/**
+ * @brief      Read the next message of a trace
+ *
+ * @param      f The trace
+ *
+ * @param      o_record The message is returned here, data has to be freed
+ *
+ * @return     false if the end of the trace was reached
+ */
+bool MPIDYNRES_call_trace_read(FILE *f, MPIDYNRES_call_record *o_record) {
+  char name[64];
+  unsigned int byte;
+
+  do {
+    if (fscanf(f, "%lf %d %d %63s %zu", &o_record->time, &o_record->source,
+               &o_record->tag, name, &o_record->size) == 5) {
+      break;
+    }
+    // skip comments and broken lines
+    int c;
+    while ((c = getc(f)) != '\n') {
+      if (c == EOF) {
+        return false;
+      }
+    }
+  } while (true);
+
+  o_record->data = malloc(o_record->size + 1);
+  if (o_record->data == NULL) {
+    die("Memory Error!\n");
+  }
+  for (size_t i = 0; i < o_record->size; i++) {
+    if (fscanf(f, i == 0 ? " %2x" : "%2x", &byte) != 1) {
+      die("Message %s of the call trace is truncated\n", name);
+    }
+    o_record->data[i] = byte;
+  }
+  return true;
+}
+
+/**
+ * @brief      Receive and drop all messages the scheduler sent to the crs
+ *
+ * @param      endpoints The loopback endpoints
+ *
+ * @param      size The number of endpoints
+ */
+static void drain(MPIDYNRES_transport *endpoints[], int size) {
+  static unsigned char *buf = NULL;
+  static size_t buf_size = 0;
+  MPIDYNRES_transport_status status;
+  int flag;
+
+  for (int i = 1; i < size; i++) {
+    while (true) {
+      MPIDYNRES_transport_iprobe(endpoints[i], 0, MPIDYNRES_ANY_TAG, &flag,
+                                 &status);
+      if (!flag) {
+        break;
+      }
+      if (status.size > buf_size) {
+        buf = realloc(buf, status.size);
+        if (buf == NULL) {
+          die("Memory Error!\n");
+        }
+        buf_size = status.size;
+      }
+      MPIDYNRES_transport_recv(endpoints[i], buf, buf_size, 0, status.tag,
+                               NULL);
+    }
+  }
+}
+
+/**
+ * @brief      Feed a trace into a scheduler
+ *
+ * @details    The scheduler has to be connected to endpoints[0] of loopback
+ * endpoints. Every call is sent from the endpoint of its source cr together
+ * with its follow-up messages and handled with
+ * MPIDYNRES_scheduler_handle_next, the answers are dropped. The calls are
+ * replayed as fast as possible, not at the recorded times, and crs are
+ * started and released without their injected latencies. The jobs are
+ * started before the first call. If a call comes from a cr that does not run
+ * (because a decision was different), the replay stops.
+ *
+ * @param      scheduler The scheduler of any job, not started yet
+ *
+ * @param      endpoints The loopback endpoints
+ *
+ * @param      f The trace, positioned after the header
+ *
+ * @param      max_calls The replay stops after this many calls, < 0 to replay
+ * the whole trace
+ *
+ * @param      o_stats The statistics of the replay are returned here
+ */
+void MPIDYNRES_call_trace_replay(MPIDYNRES_scheduler *scheduler,
+                                 MPIDYNRES_transport *endpoints[], FILE *f,
+                                 long max_calls,
+                                 MPIDYNRES_call_trace_stats *o_stats) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int size = scheduler->transport->size;
+  MPIDYNRES_call_record record;
+  bool have_record = MPIDYNRES_call_trace_read(f, &record);
+
+  *o_stats = (MPIDYNRES_call_trace_stats){0};
+  pool->start_time = MPI_Wtime();
+  MPIDYNRES_scheduler_start_pending_jobs(scheduler);
+  MPIDYNRES_scheduler_flush_cr_timers(scheduler);
+  drain(endpoints, size);
+
+  while (have_record) {
+    int tag = record.tag;
+
+    if (max_calls >= 0 && o_stats->num_calls == max_calls) {
+      free(record.data);
+      break;
+    }
+
+    if (!is_request(tag)) {
+      die("Call trace is out of sync: message %s without a call\n",
+          MPIDYNRES_tag_name(tag));
+    }
+    if (record.source < 1 || record.source >= size ||
+        pool->owner[record.source] == MPIDYNRES_NO_JOB) {
+      debug("Replay diverged: call %s from cr %d, which does not run\n",
+            MPIDYNRES_tag_name(tag), record.source);
+      o_stats->diverged = true;
+      free(record.data);
+      break;
+    }
+
+    // the call and its follow-up messages
+    do {
+      MPIDYNRES_transport_send(endpoints[record.source], record.data,
+                               record.size, 0, record.tag);
+      free(record.data);
+      o_stats->num_messages++;
+      have_record = MPIDYNRES_call_trace_read(f, &record);
+    } while (have_record && !is_request(record.tag));
+
+    double start = MPI_Wtime();
+    MPIDYNRES_scheduler_handle_next(scheduler);
+    double elapsed = MPI_Wtime() - start;
+
+    o_stats->num_calls++;
+    o_stats->handle_time += elapsed;
+    o_stats->calls[tag - MPIDYNRES_TAG_IDLE_COMMAND]++;
+    o_stats->time[tag - MPIDYNRES_TAG_IDLE_COMMAND] += elapsed;
+    MPIDYNRES_scheduler_flush_cr_timers(scheduler);
+    drain(endpoints, size);
+  }
+}
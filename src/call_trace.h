@@ -0,0 +1,81 @@
+/*
+ * Recording and replaying the client calls that reach the scheduler
+ *
+ * The recorder is a transport that wraps the transport of the scheduler and
+ * writes every received message to a trace, one line per message with the
+ * time, the source cr, the tag and the content. Follow-up messages of a call
+ * (e.g. the name sent after MPIDYNRES_TAG_PSET_INFO) directly follow the
+ * request, as the scheduler receives them while handling it.
+ *
+ * The replay feeds such a trace into a scheduler that is connected to
+ * loopback endpoints, so the scheduler can be run and profiled without the
+ * application.
+ */
+#ifndef MPIDYNRES_CALL_TRACE_H
+#define MPIDYNRES_CALL_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "comm.h"
+#include "scheduler.h"
+#include "transport.h"
+
+#define CALL_TRACE_ENVVAR "MPIDYNRES_CALL_TRACE"
+
+/**
+ * @brief      A message of a call trace
+ */
+struct MPIDYNRES_call_record {
+  double time;          ///< seconds after the recorder was created
+  int source;           ///< the sending cr
+  int tag;              ///< one of the MPIDYNRES_TAG_*
+  size_t size;          ///< size of data in bytes
+  unsigned char *data;  ///< the message content
+};
+typedef struct MPIDYNRES_call_record MPIDYNRES_call_record;
+
+/**
+ * @brief      The jobs a call trace was recorded with
+ */
+struct MPIDYNRES_call_trace_header {
+  int num_crs;
+  int num_jobs;
+  MPI_Info *manager_configs;  ///< manager_config of every job, including its manager_seed
+};
+typedef struct MPIDYNRES_call_trace_header MPIDYNRES_call_trace_header;
+
+/**
+ * @brief      The result of a replay
+ */
+struct MPIDYNRES_call_trace_stats {
+  long num_calls;
+  long num_messages;
+  double handle_time;  ///< seconds spent inside the scheduler
+  long calls[MPIDYNRES_NUM_TAGS];  ///< calls per request tag
+  double time[MPIDYNRES_NUM_TAGS]; ///< seconds spent per request tag
+  bool diverged;  ///< a call came from a cr that does not run in the replay
+};
+typedef struct MPIDYNRES_call_trace_stats MPIDYNRES_call_trace_stats;
+
+char const *MPIDYNRES_tag_name(int tag);
+
+MPIDYNRES_transport *MPIDYNRES_call_trace_recorder_create(
+    MPIDYNRES_transport *inner, FILE *f);
+
+void MPIDYNRES_call_trace_write_header(FILE *f, MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_call_trace_read_header(FILE *f,
+                                      MPIDYNRES_call_trace_header *o_header);
+
+void MPIDYNRES_call_trace_header_free(MPIDYNRES_call_trace_header *header);
+
+bool MPIDYNRES_call_trace_read(FILE *f, MPIDYNRES_call_record *o_record);
+
+void MPIDYNRES_call_trace_replay(MPIDYNRES_scheduler *scheduler,
+                                 MPIDYNRES_transport *endpoints[], FILE *f,
+                                 long max_calls,
+                                 MPIDYNRES_call_trace_stats *o_stats);
+
+#endif
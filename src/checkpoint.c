@@ -0,0 +1,338 @@
+#include "checkpoint.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "logging.h"
+#include "transport.h"
+#include "util.h"
+
+static FILE *g_checkpoint_journal = NULL;
+static char const *g_checkpoint_path = NULL;
+static long g_checkpoint_header_end = 0;  // offset of the first call
+static double g_checkpoint_interval = CHECKPOINT_DEFAULT_INTERVAL;
+static double g_checkpoint_last = 0.0;  // MPI_Wtime of the last checkpoint
+static long g_checkpoint_calls = -1;    // calls at the last checkpoint
+
+/**
+ * @brief      Get the number of calls the scheduler handled so far
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @return     The number of calls, equal to the calls in the journal
+ */
+static long handled_calls(MPIDYNRES_scheduler *scheduler) {
+  long res = 0;
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    res += scheduler->pool->metrics.requests[i].count;
+  }
+  return res;
+}
+
+/**
+ * @brief      Open the journal if CHECKPOINT_ENVVAR is set
+ *
+ * @details    Has to be called by the scheduler before the schedulers of the
+ * jobs are created. When restoring, the header of the journal is read, its
+ * manager configs (with the seeds) have to be used for the jobs.
+ *
+ * @param      o_header The header of the journal is returned here if the
+ * simulation is restored, otherwise num_jobs is set to 0. Has to be freed with
+ * MPIDYNRES_call_trace_header_free if num_jobs > 0.
+ *
+ * @return     The journal, NULL if checkpoints are disabled. The scheduler
+ * transport has to be wrapped with MPIDYNRES_call_trace_recorder_create on
+ * it.
+ */
+FILE *MPIDYNRES_checkpoint_open(MPIDYNRES_call_trace_header *o_header) {
+  char const *interval = getenv(CHECKPOINT_INTERVAL_ENVVAR);
+
+  *o_header = (MPIDYNRES_call_trace_header){0};
+  g_checkpoint_path = getenv(CHECKPOINT_ENVVAR);
+  if (g_checkpoint_path == NULL) {
+    if (getenv(RESTORE_ENVVAR) != NULL) {
+      die("%s needs %s to be set\n", RESTORE_ENVVAR, CHECKPOINT_ENVVAR);
+    }
+    return NULL;
+  }
+  g_checkpoint_interval =
+      interval != NULL ? atof(interval) : CHECKPOINT_DEFAULT_INTERVAL;
+  g_checkpoint_calls = -1;
+
+  if (getenv(RESTORE_ENVVAR) != NULL) {
+    g_checkpoint_journal = fopen(g_checkpoint_path, "r+");
+    if (g_checkpoint_journal == NULL) {
+      die("Could not open journal %s to restore: %s\n", g_checkpoint_path,
+          strerror(errno));
+    }
+    MPIDYNRES_call_trace_read_header(g_checkpoint_journal, o_header);
+    g_checkpoint_header_end = ftell(g_checkpoint_journal);
+  } else {
+    g_checkpoint_journal = fopen(g_checkpoint_path, "w");
+    if (g_checkpoint_journal == NULL) {
+      die("Could not open journal %s: %s\n", g_checkpoint_path,
+          strerror(errno));
+    }
+  }
+  return g_checkpoint_journal;
+}
+
+/**
+ * @brief      Find the last checkpoint of the journal
+ *
+ * @param      f The journal
+ *
+ * @param      num_crs The number of crs
+ *
+ * @param      o_calls The number of calls before the checkpoint is returned
+ * here, 0 if there is none
+ *
+ * @param      o_owners The owner of every cr at the checkpoint is returned
+ * here (index = cr id)
+ *
+ * @return     The offset after the checkpoint line, the end of the header if
+ * there is none
+ */
+static long find_last_checkpoint(FILE *f, int num_crs, long *o_calls,
+                                 int o_owners[]) {
+  char *line = NULL;
+  size_t line_size = 0;
+  long res = g_checkpoint_header_end;
+  int pos;
+
+  *o_calls = 0;
+  for (int cr = 1; cr <= num_crs; cr++) {
+    o_owners[cr] = MPIDYNRES_NO_JOB;
+  }
+  fseek(f, g_checkpoint_header_end, SEEK_SET);
+  while (getline(&line, &line_size, f) != -1) {
+    long calls;
+    if (line[strlen(line) - 1] != '\n' ||
+        sscanf(line, "# checkpoint calls %ld owners%n", &calls, &pos) != 1) {
+      continue;
+    }
+    // only take complete lines
+    char *p = line + pos;
+    bool complete = true;
+    for (int cr = 1; cr <= num_crs && complete; cr++) {
+      int owner, n;
+      complete = sscanf(p, " %d%n", &owner, &n) == 1;
+      p += n;
+    }
+    if (!complete) {
+      continue;
+    }
+    p = line + pos;
+    for (int cr = 1; cr <= num_crs; cr++) {
+      o_owners[cr] = strtol(p, &p, 10);
+    }
+    *o_calls = calls;
+    res = ftell(f);
+  }
+  free(line);
+  return res;
+}
+
+/**
+ * @brief      Cancel the resource changes that were not accepted
+ *
+ * @details    The crs that asked for them do not know about them after the
+ * restart
+ *
+ * @param      scheduler The scheduler of a job
+ */
+static void cancel_pending_rcs(MPIDYNRES_scheduler *scheduler) {
+  process_state *ps;
+
+  foreach (set_rc_info, &scheduler->rc_map, it) {
+    foreach (set_int, &it.ref->pset, it2) {
+      int cr = *it2.ref;
+      if (it.ref->rc_type == MPIDYNRES_RC_ADD) {
+        scheduler->pool->owner[cr] = MPIDYNRES_NO_JOB;
+        MPIDYNRES_scheduler_set_cr_state(scheduler, cr, idle);
+      } else if (it.ref->rc_type == MPIDYNRES_RC_SUB) {
+        set_int_erase(&scheduler->pending_shutdowns, cr);
+        set_process_state_find_by_id(&scheduler->process_states, cr, &ps);
+        if (ps != NULL) {
+          ps->pending_shutdown = false;
+        }
+        MPIDYNRES_scheduler_set_cr_state(scheduler, cr, running);
+      }
+    }
+  }
+  set_rc_info_free(&scheduler->rc_map);
+  scheduler->rc_map = set_rc_info_init(rc_info_compare);
+  scheduler->pending_resource_change = false;
+}
+
+/**
+ * @brief      Replay the journal up to its last checkpoint
+ *
+ * @param      scheduler The scheduler of any job, not started yet
+ */
+static void restore(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_transport *transport = scheduler->transport;
+  int num_crs = pool->num_scheduling_processes;
+  MPIDYNRES_call_trace_stats stats;
+  long calls;
+  int *owners = calloc(num_crs + 1, sizeof(int));
+  MPIDYNRES_transport **endpoints =
+      calloc(transport->size, sizeof(MPIDYNRES_transport *));
+  if (owners == NULL || endpoints == NULL) {
+    die("Memory Error!\n");
+  }
+
+  long end = find_last_checkpoint(g_checkpoint_journal, num_crs, &calls,
+                                  owners);
+
+  // replay against loopback endpoints, the answers are dropped
+  MPIDYNRES_transport_loopback_create(transport->size, endpoints);
+  for (int i = 0; i < pool->num_jobs; i++) {
+    pool->jobs[i]->transport = endpoints[0];
+  }
+  fseek(g_checkpoint_journal, g_checkpoint_header_end, SEEK_SET);
+  MPIDYNRES_call_trace_replay(scheduler, endpoints, g_checkpoint_journal,
+                              calls, &stats);
+  for (int i = 0; i < pool->num_jobs; i++) {
+    pool->jobs[i]->transport = transport;
+  }
+  for (int i = 0; i < transport->size; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+  free(endpoints);
+
+  if (stats.diverged || stats.num_calls != calls) {
+    die("Could not restore from %s: replayed %ld of %ld calls\n",
+        g_checkpoint_path, stats.num_calls, calls);
+  }
+  for (int cr = 1; cr <= num_crs; cr++) {
+    if (pool->owner[cr] != owners[cr]) {
+      die("Could not restore from %s: cr %d belongs to job %d instead of %d "
+          "after the replay\n",
+          g_checkpoint_path, cr, pool->owner[cr], owners[cr]);
+    }
+  }
+  free(owners);
+
+  // the crs of the replay were warmed up on the loopback endpoints only
+  for (int cr = 1; cr <= num_crs; cr++) {
+    pool->standby[cr] = MPIDYNRES_NO_JOB;
+  }
+
+  // continue the journal after the checkpoint
+  fseek(g_checkpoint_journal, end, SEEK_SET);
+  if (ftruncate(fileno(g_checkpoint_journal), end) != 0) {
+    die("Could not truncate journal %s: %s\n", g_checkpoint_path,
+        strerror(errno));
+  }
+
+  // start the crs again, the applications continue from their checkpoints
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    cancel_pending_rcs(job);
+    foreach (set_int, &job->running_crs, it) {
+      process_state *ps;
+      set_process_state_find_by_id(&job->process_states, *it.ref, &ps);
+      assert(ps != NULL);
+      ps->restored = true;
+      MPIDYNRES_idle_command command = {
+          .command_type = start,
+          .job_id = job->job_id,
+      };
+      MPIDYNRES_transport_send(transport, &command, sizeof(command), *it.ref,
+                               MPIDYNRES_TAG_IDLE_COMMAND);
+    }
+  }
+  MPIDYNRES_scheduler_refill_standby(scheduler);
+  log_info("Restored %ld calls from %s\n", calls, g_checkpoint_path);
+  g_checkpoint_calls = calls;
+}
+
+/**
+ * @brief      Write the header of a new journal or restore from the journal
+ *
+ * @details    Has to be called after all jobs were added and before the
+ * scheduler is started
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      header The header returned by MPIDYNRES_checkpoint_open
+ */
+void MPIDYNRES_checkpoint_start(MPIDYNRES_scheduler *scheduler,
+                                MPIDYNRES_call_trace_header *header) {
+  if (g_checkpoint_journal == NULL) {
+    return;
+  }
+  if (header->num_jobs == 0) {
+    MPIDYNRES_call_trace_write_header(g_checkpoint_journal, scheduler);
+    fflush(g_checkpoint_journal);
+  } else {
+    if (header->num_jobs != scheduler->pool->num_jobs ||
+        header->num_crs != scheduler->pool->num_scheduling_processes) {
+      die("The journal %s was written with %d jobs on %d crs, not %d on %d\n",
+          g_checkpoint_path, header->num_jobs, header->num_crs,
+          scheduler->pool->num_jobs,
+          scheduler->pool->num_scheduling_processes);
+    }
+    restore(scheduler);
+  }
+  g_checkpoint_last = MPI_Wtime();
+}
+
+/**
+ * @brief      Write a checkpoint to the journal
+ *
+ * @details    Has to be called between requests. Nothing is written if no
+ * call was handled since the last checkpoint.
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_checkpoint_write(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  long calls = handled_calls(scheduler);
+
+  g_checkpoint_last = MPI_Wtime();
+  if (g_checkpoint_journal == NULL || calls == g_checkpoint_calls) {
+    return;
+  }
+  fprintf(g_checkpoint_journal, "# checkpoint calls %ld owners", calls);
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    fprintf(g_checkpoint_journal, " %d", pool->owner[cr]);
+  }
+  fprintf(g_checkpoint_journal, "\n");
+  fflush(g_checkpoint_journal);
+  g_checkpoint_calls = calls;
+}
+
+/**
+ * @brief      Write a checkpoint if the interval elapsed
+ *
+ * @details    Called by the scheduler loop between requests
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_checkpoint_poll(MPIDYNRES_scheduler *scheduler) {
+  if (g_checkpoint_journal != NULL &&
+      MPI_Wtime() - g_checkpoint_last >= g_checkpoint_interval) {
+    MPIDYNRES_checkpoint_write(scheduler);
+  }
+}
+
+/**
+ * @brief      Close the journal
+ *
+ * @details    The recorder writing to the journal has to be freed before. The
+ * last checkpoint is written when the scheduler loop ends.
+ */
+void MPIDYNRES_checkpoint_close(void) {
+  if (g_checkpoint_journal == NULL) {
+    return;
+  }
+  fclose(g_checkpoint_journal);
+  g_checkpoint_journal = NULL;
+}
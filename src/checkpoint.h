@@ -0,0 +1,53 @@
+#ifndef MPIDYNRES_CHECKPOINT_H
+#define MPIDYNRES_CHECKPOINT_H
+/*
+ * Restarting a simulation after a crash of the scheduler
+ *
+ * When MPIDYNRES_CHECKPOINT names a file, the scheduler keeps a journal in
+ * it: the call trace of all requests it handled (see call_trace.h), appended
+ * as they arrive. Every MPIDYNRES_CHECKPOINT_INTERVAL seconds and at the end,
+ * a checkpoint line is appended between two requests and the journal is
+ * flushed. It records how many calls the journal has up to there and which
+ * job owns each cr:
+ *
+ *   # checkpoint calls <n> owners <owner of cr 1> <owner of cr 2> ...
+ *
+ * If MPIDYNRES_RESTORE is set as well, MPIDYNRES_SIM_start restores the
+ * scheduler from the journal instead of starting from scratch. The calls up
+ * to the last checkpoint are replayed into the scheduler, which rebuilds the
+ * process sets, process states, resource changes, counters and the private
+ * state of the managers. Replaying the calls without the application takes
+ * microseconds per call. Resource changes that were not accepted yet are
+ * cancelled, and the crs that were running are started again with
+ * mpidynres_restored set in their session info, so the application can pick
+ * up its own checkpoint. The journal is cut after the checkpoint and
+ * continued.
+ *
+ * The managers have to decide the same way when the calls are replayed, which
+ * rules out decisions based on timers or on the wall clock. If the replay
+ * ends up with different owners than the checkpoint, the restore fails.
+ */
+
+#include <stdio.h>
+
+#include "call_trace.h"
+#include "scheduler.h"
+
+#define CHECKPOINT_ENVVAR "MPIDYNRES_CHECKPOINT"
+#define CHECKPOINT_INTERVAL_ENVVAR "MPIDYNRES_CHECKPOINT_INTERVAL"
+#define RESTORE_ENVVAR "MPIDYNRES_RESTORE"
+
+#define CHECKPOINT_DEFAULT_INTERVAL 10.0
+
+FILE *MPIDYNRES_checkpoint_open(MPIDYNRES_call_trace_header *o_header);
+
+void MPIDYNRES_checkpoint_start(MPIDYNRES_scheduler *scheduler,
+                                MPIDYNRES_call_trace_header *header);
+
+void MPIDYNRES_checkpoint_poll(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_checkpoint_write(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_checkpoint_close(void);
+
+#endif
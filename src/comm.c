@@ -8,27 +8,21 @@
 #include "logging.h"
 
 /**
- * @brief      Serialize and Send an MPI Info object
+ * @brief      Serialize an MPI Info object
  *
  * @details    Uses the info_serialized struct to fill a byte buffer with
- * strings and offsets which is then sent via mpi
- *
- * @param      info The info object to send
- *
- * @param      dest The rank of the recipient in the communicator
+ * strings and offsets
  *
- * @param      tag1 The MPI tag used for the first MPI_Send operation (should
- * match the tag1 argument in the MPIDYNRES_Recv_MPI_Info function)
+ * @param      info The info object to serialize (must not be MPI_INFO_NULL)
  *
- * @param      tag2 The MPI tag used for the second MPI_Send operation (should
- * match the tag2 argument in the MPIDYNRES_Recv_MPI_Info function)
+ * @param      o_buf The new buffer is returned here, it has to be freed by the
+ * caller
  *
- * @param      comm The communicator used
+ * @param      o_size The size of the buffer is returned here
  *
  * @return     On error, a value != 0 is returned
  */
-int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
-                            MPI_Comm comm) {
+int MPIDYNRES_Info_serialize(MPI_Info info, uint8_t **o_buf, size_t *o_size) {
   int res;
   int nkeys;
   int vlen;
@@ -36,15 +30,6 @@ int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
   char key[MPI_MAX_INFO_KEY + 1] = {0};
   struct info_serialized *serialized;
 
-  if (info == MPI_INFO_NULL) {
-    size_t bufsize = SIZE_MAX;
-    res = MPI_Send(&bufsize, 1, my_MPI_SIZE_T, dest, tag1, comm);
-    if (res) {
-      return res;
-    }
-    return 0;
-  }
-
   res = MPI_Info_get_nkeys(info, &nkeys);
   if (res) {
     return res;
@@ -55,7 +40,6 @@ int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
   for (int i = 0; i < nkeys; i++) {
     MPI_Info_get_nthkey(info, i, key);
     MPI_Info_get_valuelen(info, key, &vlen, &unused);
-    /* printf("%s\n", key); */
     bufsize += sizeof(char) * (strlen(key) + 1);
     bufsize += sizeof(char) * (vlen + 1);
   }
@@ -84,7 +68,81 @@ int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
     offset += sizeof(char) * (vlen + 1);
   }
 
-  debug("Sending MPI_Info object containing %d keys to rank %d\n", nkeys, dest);
+  *o_buf = buffer;
+  *o_size = bufsize;
+  return 0;
+}
+
+/**
+ * @brief      Deserialize an MPI Info object
+ *
+ * @param      buf A buffer filled by MPIDYNRES_Info_serialize
+ *
+ * @param      o_info The new info object is returned here
+ *
+ * @return     On error, a value != 0 is returned
+ */
+int MPIDYNRES_Info_deserialize(uint8_t *buf, MPI_Info *o_info) {
+  int res;
+  struct info_serialized *serialized = (struct info_serialized *)buf;
+
+  res = MPI_Info_create(o_info);
+  if (res) {
+    return res;
+  }
+  for (size_t i = 0; i < serialized->num_strings / 2; i++) {
+    char *key = (char *)(buf + serialized->strings[2 * i]);
+    char *val = (char *)(buf + serialized->strings[2 * i + 1]);
+    res = MPI_Info_set(*o_info, key, val);
+    if (res) {
+      return res;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief      Serialize and Send an MPI Info object
+ *
+ * @details    Uses the info_serialized struct to fill a byte buffer with
+ * strings and offsets which is then sent via mpi
+ *
+ * @param      info The info object to send
+ *
+ * @param      dest The rank of the recipient in the communicator
+ *
+ * @param      tag1 The MPI tag used for the first MPI_Send operation (should
+ * match the tag1 argument in the MPIDYNRES_Recv_MPI_Info function)
+ *
+ * @param      tag2 The MPI tag used for the second MPI_Send operation (should
+ * match the tag2 argument in the MPIDYNRES_Recv_MPI_Info function)
+ *
+ * @param      comm The communicator used
+ *
+ * @return     On error, a value != 0 is returned
+ */
+int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
+                            MPI_Comm comm) {
+  int res;
+  uint8_t *buffer;
+  size_t bufsize;
+
+  if (info == MPI_INFO_NULL) {
+    bufsize = SIZE_MAX;
+    res = MPI_Send(&bufsize, 1, my_MPI_SIZE_T, dest, tag1, comm);
+    if (res) {
+      return res;
+    }
+    return 0;
+  }
+
+  res = MPIDYNRES_Info_serialize(info, &buffer, &bufsize);
+  if (res) {
+    return res;
+  }
+
+  debug("Sending MPI_Info object containing %zu keys to rank %d\n",
+        ((struct info_serialized *)buffer)->num_strings / 2, dest);
   res = MPI_Send(&bufsize, 1, my_MPI_SIZE_T, dest, tag1, comm);
   if (res) {
     printf("%d\n", res);
@@ -125,7 +183,6 @@ int MPIDYNRES_Recv_MPI_Info(MPI_Info *info, int source, int tag1, int tag2,
                             MPI_Status *status2) {
   int res;
   size_t bufsize;
-  struct info_serialized *serialized;
 
   res = MPI_Recv(&bufsize, 1, my_MPI_SIZE_T, source, tag1, comm, status1);
   if (res) {
@@ -144,184 +201,109 @@ int MPIDYNRES_Recv_MPI_Info(MPI_Info *info, int source, int tag1, int tag2,
     free(buf);
     return res;
   }
-  serialized = (struct info_serialized *)buf;
-  res = MPI_Info_create(info);
+  res = MPIDYNRES_Info_deserialize(buf, info);
   if (res) {
     free(buf);
     return res;
   }
-  for (size_t i = 0; i < serialized->num_strings / 2; i++) {
-    char *key = (char *)(buf + serialized->strings[2 * i]);
-    char *val = (char *)(buf + serialized->strings[2 * i + 1]);
-    res = MPI_Info_set(*info, key, val);
-    if (res) {
-      free(buf);
-      return res;
-    }
-  }
-  debug("Received MPI_Info object containing %d keys from rank %d\n", serialized->num_strings/2, source);
+  debug("Received MPI_Info object containing %zu keys from rank %d\n",
+        ((struct info_serialized *)buf)->num_strings / 2, source);
   free(buf);
   return 0;
 }
 
 /**
- * @brief      Free MPI datatypes used for communication
+ * @brief      Serialize and send an MPI Info object using a transport
  *
- * @details    This function will free all mpi datatypes that were created
- * when calling get_<datatype_name>_datatype()
- */
-void free_all_mpi_datatypes() {
-  // pset type is freed in the applicaion
-  MPI_Datatype types[] = {
-      get_idle_command_datatype(),
-      get_pset_op_datatype(),
-      get_pset_free_datatype(),
-      get_rc_datatype(),
-  };
-  for (size_t i = 0; i < COUNT_OF(types); i++) {
-    MPI_Type_free(&types[i]);
-  }
-}
-
-/**
- * @brief      Get mpi datatype that can send an MPIDYNRES_idle_command struct
+ * @param      transport The transport used
+ *
+ * @param      info The info object to send
  *
- * @details    free_all_mpi_datatypes has to be called when this function was
- * used
+ * @param      dest The rank of the recipient
  *
- * @return     mpi datatype that can send an MPIDYNRES_idle_command struct
- * with
- */
-MPI_Datatype get_idle_command_datatype() {
-  static MPI_Datatype result = NULL;
-
-  static int const lengths[] = {
-      1,  // one enum (int)
-  };
-  static MPI_Aint const displacements[] = {
-      offsetof(MPIDYNRES_idle_command, command_type),
-  };
-  static MPI_Datatype const types[] = {
-      MPI_INT,
-  };
-
-  if (result == NULL) {
-    assert(COUNT_OF(lengths) == COUNT_OF(displacements) &&
-           COUNT_OF(displacements) == COUNT_OF(types));
-
-    MPI_Type_create_struct(COUNT_OF(lengths), lengths, displacements, types,
-                           &result);
-    MPI_Type_commit(&result);
-  }
-  return result;
-}
-
-/**
- * @brief      Get mpi datatype that can send an MPIDYNRES_uri_op_msg struct
+ * @param      tag1 The tag of the message containing the size
  *
- * @details    free_all_mpi_datatypes has to be called when this function was
- * used
+ * @param      tag2 The tag of the message containing the serialized object
  *
- * @return     mpi datatype that can send an MPIDYNRES_uri_op_msg struct
+ * @return     On error, a value != 0 is returned
  */
-MPI_Datatype get_pset_op_datatype() {
-  static MPI_Datatype result = NULL;
+int MPIDYNRES_transport_send_info(MPIDYNRES_transport *transport,
+                                  MPI_Info info, int dest, int tag1,
+                                  int tag2) {
+  int res;
+  uint8_t *buffer;
+  size_t bufsize;
 
-  static int const lengths[] = {
-      MPI_MAX_PSET_NAME_LEN, MPI_MAX_PSET_NAME_LEN,
-      1,  // one enum
-  };
-  static MPI_Aint const displacements[] = {
-      offsetof(MPIDYNRES_pset_op_msg, pset_name1),
-      offsetof(MPIDYNRES_pset_op_msg, pset_name2),
-      offsetof(MPIDYNRES_pset_op_msg, op),
-  };
-  static MPI_Datatype const types[] = {
-      MPI_CHAR,
-      MPI_CHAR,
-      MPI_INT,
-  };
+  if (info == MPI_INFO_NULL) {
+    bufsize = SIZE_MAX;
+    return MPIDYNRES_transport_send(transport, &bufsize, sizeof(bufsize), dest,
+                                    tag1);
+  }
 
-  if (result == NULL) {
-    assert(COUNT_OF(lengths) == COUNT_OF(displacements) &&
-           COUNT_OF(displacements) == COUNT_OF(types));
+  res = MPIDYNRES_Info_serialize(info, &buffer, &bufsize);
+  if (res) {
+    return res;
+  }
 
-    MPI_Type_create_struct(COUNT_OF(lengths), lengths, displacements, types,
-                           &result);
-    MPI_Type_commit(&result);
+  debug("Sending MPI_Info object containing %zu keys to rank %d\n",
+        ((struct info_serialized *)buffer)->num_strings / 2, dest);
+  res = MPIDYNRES_transport_send(transport, &bufsize, sizeof(bufsize), dest,
+                                 tag1);
+  if (res) {
+    free(buffer);
+    return res;
   }
-  return result;
+  res = MPIDYNRES_transport_send(transport, buffer, bufsize, dest, tag2);
+  free(buffer);
+  return res;
 }
 
 /**
- * @brief      Get mpi datatype that can send an MPIDYNRES_rc_msg struct
+ * @brief      Receive and deserialize an MPI Info object using a transport
  *
- * @details    free_all_mpi_datatypes has to be called when this function was
- * used
+ * @param      transport The transport used
  *
- * @return     mpi datatype that can send an MPIDYNRES_rc_msg struct
- */
-MPI_Datatype get_rc_datatype() {
-  static MPI_Datatype result = NULL;
-
-  static int const lengths[] = {
-      1,  // one enum
-      1,
-      MPI_MAX_PSET_NAME_LEN,
-  };
-  static MPI_Aint const displacements[] = {
-      offsetof(MPIDYNRES_RC_msg, type),
-      offsetof(MPIDYNRES_RC_msg, tag),
-      offsetof(MPIDYNRES_RC_msg, pset_name),
-  };
-  static MPI_Datatype const types[] = {
-      MPI_INT,
-      MPI_INT,
-      MPI_CHAR,
-  };
-
-  if (result == NULL) {
-    assert(COUNT_OF(lengths) == COUNT_OF(displacements) &&
-           COUNT_OF(displacements) == COUNT_OF(types));
-
-    MPI_Type_create_struct(COUNT_OF(lengths), lengths, displacements, types,
-                           &result);
-    MPI_Type_commit(&result);
-  }
-  return result;
-}
-
-/**
- * @brief      Get mpi datatype that can send an MPIDYNRES_pset_free_msg
+ * @param      info The info object that will be returned
+ *
+ * @param      source The rank of the sender
+ *
+ * @param      tag1 The tag of the message containing the size
  *
- * @details    free_all_mpi_datatypes has to be called when this function was
- * used
+ * @param      tag2 The tag of the message containing the serialized object
  *
- * @return     mpi datatype that can send an MPIDYNRES_pset_free_msg struct
+ * @return     On error, a value != 0 is returned
  */
-MPI_Datatype get_pset_free_datatype() {
-  static MPI_Datatype result = NULL;
-
-  static int const lengths[] = {
-      1,  // session_id
-      MPI_MAX_PSET_NAME_LEN,
-  };
-  static MPI_Aint const displacements[] = {
-      offsetof(MPIDYNRES_pset_free_msg, session_id),
-      offsetof(MPIDYNRES_pset_free_msg, pset_name),
-  };
-  static MPI_Datatype const types[] = {
-      MPI_INT,
-      MPI_CHAR,
-  };
-
-  if (result == NULL) {
-    assert(COUNT_OF(lengths) == COUNT_OF(displacements) &&
-           COUNT_OF(displacements) == COUNT_OF(types));
+int MPIDYNRES_transport_recv_info(MPIDYNRES_transport *transport,
+                                  MPI_Info *info, int source, int tag1,
+                                  int tag2) {
+  int res;
+  size_t bufsize;
 
-    MPI_Type_create_struct(COUNT_OF(lengths), lengths, displacements, types,
-                           &result);
-    MPI_Type_commit(&result);
+  res = MPIDYNRES_transport_recv(transport, &bufsize, sizeof(bufsize), source,
+                                 tag1, NULL);
+  if (res) {
+    return res;
+  }
+  if (bufsize == SIZE_MAX) {
+    *info = MPI_INFO_NULL;
+    return 0;
   }
-  return result;
+  uint8_t *buf = calloc(bufsize, 1);
+  if (!buf) {
+    die("Memory error!\n");
+  }
+  res = MPIDYNRES_transport_recv(transport, buf, bufsize, source, tag2, NULL);
+  if (res) {
+    free(buf);
+    return res;
+  }
+  res = MPIDYNRES_Info_deserialize(buf, info);
+  if (res) {
+    free(buf);
+    return res;
+  }
+  debug("Received MPI_Info object containing %zu keys from rank %d\n",
+        ((struct info_serialized *)buf)->num_strings / 2, source);
+  free(buf);
+  return 0;
 }
@@ -1,5 +1,5 @@
 /*
- * Structs + MPI_Datatypes for communicating with the resource manager
+ * Structs for communicating with the resource manager
  */
 #ifndef COMM_H
 #define COMM_H
@@ -8,6 +8,7 @@
 #include <mpi.h>
 
 #include "mpidynres.h"
+#include "transport.h"
 #include "util.h"
 
 /*
@@ -65,12 +66,24 @@ enum {
   MPIDYNRES_TAG_RC_ACCEPT, // int[2], session_id, rc_tag
   MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
   MPIDYNRES_TAG_RC_ACCEPT_INFO,
+
+  MPIDYNRES_TAG_GET_STATS,  // placeholder
+  MPIDYNRES_TAG_GET_STATS_ANSWER_SIZE,
+  MPIDYNRES_TAG_GET_STATS_ANSWER,
 };
 
+#define MPIDYNRES_NUM_TAGS \
+  (MPIDYNRES_TAG_GET_STATS_ANSWER - MPIDYNRES_TAG_IDLE_COMMAND + 1)
+
 #define MPIDYNRES_CR_SET_INVALID SIZE_MAX
 
+/*
+ * warm lets an idle cr run the warm-up of a job ahead of time, so that it is
+ * ready when a resource change starts it for this job
+ */
 struct MPIDYNRES_idle_command {
-  enum { start, shutdown } command_type;
+  enum { start, shutdown, warm } command_type;
+  int job_id;  ///< the job the cr is started or warmed up for
 };
 typedef struct MPIDYNRES_idle_command MPIDYNRES_idle_command;
 
@@ -97,11 +110,6 @@ struct MPIDYNRES_pset_free_msg {
 };
 typedef struct MPIDYNRES_pset_free_msg MPIDYNRES_pset_free_msg;
 
-/*
- * This function should be called right before exiting the simulation
- */
-void free_all_mpi_datatypes();
-
 /*
  * Serialization of an MPI_Info object
  */
@@ -110,6 +118,9 @@ struct info_serialized {
   ptrdiff_t strings[];  // difference from the base of this struct
 };
 
+int MPIDYNRES_Info_serialize(MPI_Info info, uint8_t **o_buf, size_t *o_size);
+int MPIDYNRES_Info_deserialize(uint8_t *buf, MPI_Info *o_info);
+
 int MPIDYNRES_Send_MPI_Info(MPI_Info info, int dest, int tag1, int tag2,
                             MPI_Comm comm);
 int MPIDYNRES_Recv_MPI_Info(MPI_Info *info, int source, int tag1, int tag2,
@@ -117,10 +128,11 @@ int MPIDYNRES_Recv_MPI_Info(MPI_Info *info, int source, int tag1, int tag2,
                             MPI_Status *status2);
 
 /*
- * Get MPI_Datatypes, has hidden global state
+ * Same as above, but using a transport instead of a communicator
  */
-MPI_Datatype get_idle_command_datatype();
-MPI_Datatype get_pset_op_datatype();
-MPI_Datatype get_pset_free_datatype();
-MPI_Datatype get_rc_datatype();
+int MPIDYNRES_transport_send_info(MPIDYNRES_transport *transport,
+                                  MPI_Info info, int dest, int tag1, int tag2);
+int MPIDYNRES_transport_recv_info(MPIDYNRES_transport *transport,
+                                  MPI_Info *info, int source, int tag1,
+                                  int tag2);
 #endif
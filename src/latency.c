@@ -0,0 +1,163 @@
+#include "latency.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+/**
+ * @brief      Parse the entries of a latency table
+ *
+ * @param      spec The whole model, for error messages
+ *
+ * @param      pos The entries, a comma separated list of crs:seconds
+ *
+ * @param      latency The entries are added to this model
+ */
+static void parse_table(char const *spec, char const *pos,
+                        MPIDYNRES_latency *latency) {
+  while (*pos != '\0') {
+    int crs;
+    double seconds;
+    int len;
+    if (sscanf(pos, " %d : %lf %n", &crs, &seconds, &len) != 2 || crs < 1 ||
+        seconds < 0.0 ||
+        (latency->num_entries > 0 &&
+         crs <= latency->crs[latency->num_entries - 1])) {
+      die("Invalid latency: %s\n", spec);
+    }
+    latency->crs =
+        realloc(latency->crs, (latency->num_entries + 1) * sizeof(int));
+    latency->seconds =
+        realloc(latency->seconds, (latency->num_entries + 1) * sizeof(double));
+    if (latency->crs == NULL || latency->seconds == NULL) {
+      die("Memory Error\n");
+    }
+    latency->crs[latency->num_entries] = crs;
+    latency->seconds[latency->num_entries] = seconds;
+    latency->num_entries++;
+    pos += len;
+    if (*pos == ',') {
+      pos++;
+    } else if (*pos != '\0') {
+      die("Invalid latency: %s\n", spec);
+    }
+  }
+  if (latency->num_entries == 0) {
+    die("Invalid latency: %s\n", spec);
+  }
+}
+
+/**
+ * @brief      Parse a latency model
+ *
+ * @details    See latency.h for the format, dies if spec is invalid
+ *
+ * @param      spec The model, NULL for no latency
+ *
+ * @param      o_latency The model is returned here, has to be freed with
+ * MPIDYNRES_latency_free
+ */
+void MPIDYNRES_latency_parse(char const *spec, MPIDYNRES_latency *o_latency) {
+  int len = -1;
+
+  *o_latency = (MPIDYNRES_latency){.kind = LATENCY_NONE};
+  if (spec == NULL) {
+    return;
+  }
+
+  if (strncmp(spec, "table:", strlen("table:")) == 0) {
+    o_latency->kind = LATENCY_TABLE;
+    parse_table(spec, spec + strlen("table:"), o_latency);
+    return;
+  }
+
+  if (sscanf(spec, " uniform : %lf : %lf %n", &o_latency->a, &o_latency->b,
+             &len) == 2 &&
+      o_latency->a >= 0.0 && o_latency->b >= o_latency->a) {
+    o_latency->kind = LATENCY_UNIFORM;
+  } else if (sscanf(spec, " normal : %lf : %lf %n", &o_latency->a,
+                    &o_latency->b, &len) == 2 &&
+             o_latency->b >= 0.0) {
+    o_latency->kind = LATENCY_NORMAL;
+  } else if (sscanf(spec, " exp : %lf %n", &o_latency->a, &len) == 1 &&
+             o_latency->a >= 0.0) {
+    o_latency->kind = LATENCY_EXP;
+  } else if (sscanf(spec, " %lf %n", &o_latency->a, &len) == 1 &&
+             o_latency->a >= 0.0) {
+    o_latency->kind = LATENCY_CONSTANT;
+  }
+  if (o_latency->kind == LATENCY_NONE || len < 0 || spec[len] != '\0') {
+    die("Invalid latency: %s\n", spec);
+  }
+}
+
+/**
+ * @brief      Free a latency model
+ *
+ * @param      latency The model
+ */
+void MPIDYNRES_latency_free(MPIDYNRES_latency *latency) {
+  free(latency->crs);
+  free(latency->seconds);
+  *latency = (MPIDYNRES_latency){.kind = LATENCY_NONE};
+}
+
+/**
+ * @brief      Draw a latency from a model
+ *
+ * @param      latency The model
+ *
+ * @param      num_crs The number of crs that are started or shut down
+ * together
+ *
+ * @param      rng_state The state of the random number generator to use
+ *
+ * @return     The latency in seconds, >= 0
+ */
+double MPIDYNRES_latency_draw(MPIDYNRES_latency *latency, int num_crs,
+                              uint64_t *rng_state) {
+  switch (latency->kind) {
+    case LATENCY_NONE: {
+      return 0.0;
+    }
+    case LATENCY_CONSTANT: {
+      return latency->a;
+    }
+    case LATENCY_UNIFORM: {
+      return latency->a +
+             (latency->b - latency->a) * MPIDYNRES_rand_double(rng_state);
+    }
+    case LATENCY_NORMAL: {
+      // box mueller
+      double u1 = MPIDYNRES_rand_double(rng_state);
+      double u2 = MPIDYNRES_rand_double(rng_state);
+      double val = latency->a + sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2) *
+                                    latency->b;
+      return val > 0.0 ? val : 0.0;
+    }
+    case LATENCY_EXP: {
+      return -latency->a * log(MPIDYNRES_rand_double(rng_state));
+    }
+    case LATENCY_TABLE: {
+      int last = latency->num_entries - 1;
+      if (num_crs <= latency->crs[0]) {
+        return latency->seconds[0];
+      }
+      if (num_crs >= latency->crs[last]) {
+        return latency->seconds[last];
+      }
+      int i = 1;
+      while (latency->crs[i] < num_crs) {
+        i++;
+      }
+      double t = (double)(num_crs - latency->crs[i - 1]) /
+                 (latency->crs[i] - latency->crs[i - 1]);
+      return latency->seconds[i - 1] +
+             t * (latency->seconds[i] - latency->seconds[i - 1]);
+    }
+  }
+  return 0.0;
+}
@@ -0,0 +1,51 @@
+#ifndef MPIDYNRES_LATENCY_H
+#define MPIDYNRES_LATENCY_H
+/*
+ * Injected latencies of starting and shutting down crs
+ *
+ * Starting a cr only sends a command in the simulation, while a real system
+ * spawns processes, boots nodes and wires up the network. A latency model
+ * given with the manager_start_latency and manager_shutdown_latency keys of a
+ * job delays the start command of its crs and the release of crs that
+ * returned. The model is one of
+ *  - "<seconds>": a constant latency
+ *  - "uniform:<min>:<max>": uniformly distributed
+ *  - "normal:<mean>:<stddev>": normally distributed, negative values are 0
+ *  - "exp:<mean>": exponentially distributed
+ *  - "table:<crs>:<seconds>,...": depends on the number of crs that are
+ * started or shut down together, linearly interpolated between the entries
+ * and constant outside of them, e.g. "table:1:0.5,16:2,64:5"
+ */
+
+#include <stdint.h>
+
+enum MPIDYNRES_latency_kind {
+  LATENCY_NONE,
+  LATENCY_CONSTANT,
+  LATENCY_UNIFORM,
+  LATENCY_NORMAL,
+  LATENCY_EXP,
+  LATENCY_TABLE,
+};
+
+/**
+ * @brief      A latency model, see MPIDYNRES_latency_parse
+ */
+struct MPIDYNRES_latency {
+  enum MPIDYNRES_latency_kind kind;
+  double a;         ///< constant, min, mean
+  double b;         ///< max, stddev
+  int num_entries;  ///< entries of a table
+  int *crs;         ///< increasing number of crs of the table entries
+  double *seconds;  ///< latency of the table entries
+};
+typedef struct MPIDYNRES_latency MPIDYNRES_latency;
+
+void MPIDYNRES_latency_parse(char const *spec, MPIDYNRES_latency *o_latency);
+
+void MPIDYNRES_latency_free(MPIDYNRES_latency *latency);
+
+double MPIDYNRES_latency_draw(MPIDYNRES_latency *latency, int num_crs,
+                              uint64_t *rng_state);
+
+#endif
@@ -1,13 +1,15 @@
 #include "logging.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <mpi.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
-#include <tgmath.h>
 #include <time.h>
+#include <unistd.h>
 
+#include "trace.h"
 #include "util.h"
 
 /**
@@ -16,163 +18,135 @@
 FILE *g_statelogfile = NULL;
 enum cr_state *g_states = NULL;
 size_t g_num_states = 0;
-clock_t g_start_time = 0;
+FILE *g_decisiontracefile = NULL;
 
-/**
- * State Log output colors
- */
-static char *colors[NUM_CR_STATES] = {
-    [idle] = BLUE,
-    [running] = RED,
-    [reserved] = GREEN,
-    [proposed_shutdown] = GREEN,
-    [accepted_shutdown] = CYAN,
-};
+#define STATELOG_BUFFER_SIZE 0x100000
 
-/**
- * State Log abbreviations
- */
-static int chars[NUM_CR_STATES] = {
-    [idle] = 'I',
-    [running] = 'R',
-    [reserved] = 'P',
-    [proposed_shutdown] = 'S',
-    [accepted_shutdown] = 'A',
-};
+static char *g_statelog_buf = NULL;
+static struct timespec g_statelog_start;
+static enum statelog_event g_statelog_event;
+static uint32_t g_statelog_seq = 0;
 
 /**
- * @brief      Print header of states log into file
- *
- * @details    Print states header into file, with the following columns:
- * timestamp, cr state and event
+ * @brief      Start a new event in the state log
  *
- * @param      f The file to print the header to
+ * @details    The following state changes are recorded as part of this event
  *
- * @param      num_states The number of crs that are tracked
+ * @param      event Why the states change
  */
-void print_states_header(FILE *f, size_t num_states) {
-  size_t max_num_digits =
-      floor(log10(num_states + 1)) + 1;  // highest id is num_states + 1
-  fprintf(f, "TIME       STATE  ");
-  if (num_states >= 18) {
-    for (size_t i = 0; i < num_states - 4; i++) {
-      putc(' ', f);
-    }
-  }
-  fprintf(f, "EVENT\n");
-  for (size_t i = 0; i < num_states + 12 + 20; i++) {
-    putc('-', f);
-  }
-  putc('\n', f);
-  for (ssize_t ndigit = max_num_digits - 1; ndigit >= 0; ndigit--) {
-    fprintf(f, "           ");
-    for (size_t cr_id = 1; cr_id <= num_states; cr_id++) {
-      size_t e = 1;
-      for (ssize_t i = 0; i < ndigit; i++) e *= 10;
-      int digit = (cr_id / e) % 10;
-      if (cr_id >= e) {
-        putc('0' + digit, f);
-      } else {
-        putc(' ', f);
-      }
-    }
-    putc('\n', f);
-  }
-  for (size_t i = 0; i < num_states + 12 + 20; i++) {
-    putc('=', f);
-  }
-  putc('\n', f);
+void log_state_event(enum statelog_event event) {
+  g_statelog_event = event;
+  g_statelog_seq++;
 }
 
 /**
- * @brief      Print current computing resource state line into file
- *
- * @details    Print current cr state into file, different colors and characters
- * for different states. also, a small event can be printet next to the line,
- * for a better overview
- *
- * @param      f The file to write into
+ * @brief      Change the state of a computing resource
  *
- * @param      num_states The number of crs to track
+ * @details    Change state of a specific computing resource with a specific id.
+ * If the state log is active, the change is recorded as part of the current
+ * event (see log_state_event). It is also passed to the trace (see trace.h).
  *
- * @param      states An array of size num_states with cr_states of the crs
+ * @param      job_id The job the cr belongs to
  *
- * @param      eventfmt The format string for the event
+ * @param      cr_id The computing resource id of the cr to change
  *
- * @param      args Arguments for the format string
+ * @param      state The new state of the computing resource
  */
-void print_states(FILE *f, size_t num_states,
-                  enum cr_state states[static num_states], char const *eventfmt,
-                  va_list args) {
-  double diff_ms = (clock() - g_start_time) * 1000.0 / CLOCKS_PER_SEC;
-  if (diff_ms < 1000000.0) {
-    fprintf(f, "%8gms ", diff_ms);
-  } else {
-    fprintf(f, "%8gs  ", diff_ms / 1000.0);
-  }
-  for (size_t i = 0; i < num_states; i++) {
-    fprintf(f, "%s%c%s", colors[states[i]], chars[states[i]], RESET);
-  }
-  putc(' ', f);
-  vfprintf(f, eventfmt, args);
-  putc('\n', f);
-  fflush(f);
-}
+void set_state(int job_id, int cr_id, enum cr_state state) {
+  struct timespec now;
 
-/**
- * @brief      Log the current state contained in the global variables
- *
- * @param      eventfmt A format string for the event
- */
-void log_state(char *eventfmt, ...) {
-  va_list args;
-  if (getenv(STATELOG_ENVVAR)) {
-    va_start(args, eventfmt);
-    print_states(g_statelogfile, g_num_states, g_states, eventfmt, args);
+  if (trace_enabled()) {
+    trace_cr_state(job_id, cr_id, state);
+  }
+  if (g_statelogfile == NULL) {
+    return;
   }
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  statelog_record record = {
+      .time_ns = (now.tv_sec - g_statelog_start.tv_sec) * 1000000000ULL +
+                 now.tv_nsec - g_statelog_start.tv_nsec,
+      .event_seq = g_statelog_seq,
+      .cr_id = cr_id,
+      .old_state = g_states[cr_id - 1],
+      .new_state = state,
+      .event = g_statelog_event,
+      .job_id = job_id,
+  };
+  g_states[cr_id - 1] = state;
+  fwrite(&record, sizeof(record), 1, g_statelogfile);
 }
 
 /**
- * @brief      Change the state of a computing resource
+ * @brief      Write a decision of a manager to the decision trace
  *
- * @details    Change state of a specific computing resource with a specific id.
- * Uses global variables for changing state
+ * @details    Every record is one line with the seconds since the start of the
+ * pool, the job id, the cr that asked (0 for the initial process set), the
+ * type (DECISION_TRACE_INIT, none, add or sub), the number of crs and the cr
+ * ids. The trace can be fed back with the replay manager.
  *
- * @param      cr_id The computing resource id of the cr to change
+ * @param      scheduler The scheduler of the job
  *
- * @param      state The new state of the computing resource
+ * @param      cr_id The cr that asked for the resource change
+ *
+ * @param      type The type of the decision
+ *
+ * @param      pset The crs of the decision, NULL if there are none
  */
-void set_state(int cr_id, enum cr_state state) {
-  // little cache to improve performance
-  static bool statelog_active = false;
-  static bool statelog_checked = false;
-  if (!statelog_checked) {
-    statelog_active = (getenv(STATELOG_ENVVAR) != NULL);
-    statelog_checked = true;
+void trace_decision(MPIDYNRES_scheduler *scheduler, int cr_id,
+                    char const *type, set_int *pset) {
+  FILE *f = g_decisiontracefile;
+  if (f == NULL) {
+    return;
   }
-
-  if (statelog_active) {
-    g_states[cr_id - 1] = state;
+  fprintf(f, "%f %d %d %s %zu", MPI_Wtime() - scheduler->pool->start_time,
+          scheduler->job_id, cr_id, type, pset == NULL ? 0 : pset->size);
+  if (pset != NULL) {
+    foreach (set_int, pset, it) { fprintf(f, " %d", *it.ref); }
   }
+  putc('\n', f);
+  fflush(f);
 }
 
 /**
- * @brief      Open the logfile, intialize globals and print header into file
+ * @brief      Open the logfiles, intialize globals and print header into file
  *
  * @param      scheduler The scheduler
  */
 void init_log(MPIDYNRES_scheduler *scheduler) {
   char *logfile = getenv(STATELOG_ENVVAR);
+  char *tracefile = getenv(DECISION_TRACE_ENVVAR);
+  trace_open(0, scheduler->num_scheduling_processes);
+  if (tracefile) {
+    g_decisiontracefile = fopen(tracefile, "w");
+    if (g_decisiontracefile == NULL) {
+      die("Failed to open decision trace %s: %s\n", tracefile,
+          strerror(errno));
+    }
+    fprintf(g_decisiontracefile, "# time job cr type size crs\n");
+  }
   if (logfile) {
-    g_statelogfile = fopen(logfile, "a+");
+    statelog_header header = {
+        .version = STATELOG_VERSION,
+        .num_crs = scheduler->num_scheduling_processes,
+    };
+    memcpy(header.magic, STATELOG_MAGIC, sizeof(header.magic));
+    g_statelogfile = fopen(logfile, "w");
     if (g_statelogfile == NULL) {
       die("Failed to open logfile %s: %s\n", logfile, strerror(errno));
     }
-    print_states_header(g_statelogfile, scheduler->num_scheduling_processes);
+    // the records are only written out when the buffer is full
+    g_statelog_buf = malloc(STATELOG_BUFFER_SIZE);
+    if (g_statelog_buf != NULL) {
+      setvbuf(g_statelogfile, g_statelog_buf, _IOFBF, STATELOG_BUFFER_SIZE);
+    }
+    fwrite(&header, sizeof(header), 1, g_statelogfile);
+    clock_gettime(CLOCK_MONOTONIC, &g_statelog_start);
     g_num_states = scheduler->num_scheduling_processes;
-    g_start_time = clock();
     g_states =
         calloc(sizeof(enum cr_state), scheduler->num_scheduling_processes);
+    if (g_states == NULL) {
+      die("Memory Error\n");
+    }
     for (int i = 0; i < scheduler->num_scheduling_processes; i++) {
       g_states[i] = idle;
     }
@@ -183,6 +157,8 @@ void init_log(MPIDYNRES_scheduler *scheduler) {
  * @brief      Free global state used for logging
  */
 void free_log() {
+  flush_debug();
+  trace_close();
   if (g_states != NULL) {
     free(g_states);
     g_states = NULL;
@@ -190,64 +166,160 @@ void free_log() {
   if (g_statelogfile != NULL) {
     fclose(g_statelogfile);
     g_statelogfile = NULL;
+    free(g_statelog_buf);
+    g_statelog_buf = NULL;
+  }
+  if (g_decisiontracefile != NULL) {
+    fclose(g_decisiontracefile);
+    g_decisiontracefile = NULL;
   }
 }
 
 MPI_Comm g_debug_comm = MPI_COMM_WORLD;
 
+/*
+ * Larger than any level, so the first call reaches log_write, which reads the
+ * real level
+ */
+int g_log_level = INT_MAX;
+
+#define DEBUG_BUFFER_SIZE 0x10000
+#define DEBUG_FLUSH_INTERVAL_NS 100000000L  // 100 ms
 
 /**
- * @brief      Register an MPI communicator to be used for the debug output
- * prefix
+ * Buffered writer of the debug output of this rank
+ */
+static FILE *g_debug_out = NULL;
+static char g_debug_buf[DEBUG_BUFFER_SIZE];
+static struct timespec g_debug_last_flush;
+static char g_debug_prefix[0x100];
+
+/**
+ * @brief      Read the log level from the environment
  *
- * @param      comm The MPI communicator to use (has to be valid during logging)
+ * @details    MPIDYNRES_LOG_LEVEL can be off, warn, info, debug or the number
+ * of a level, if only MPIDYNRES_DEBUG is set, everything is logged
  */
-void register_debug_comm(MPI_Comm comm) { g_debug_comm = comm; }
+static void read_log_level() {
+  char const *level = getenv(LOG_LEVEL_ENVVAR);
+  char const *const names[] = {
+      [MPIDYNRES_LOG_OFF] = "off",
+      [MPIDYNRES_LOG_WARN] = "warn",
+      [MPIDYNRES_LOG_INFO] = "info",
+      [MPIDYNRES_LOG_DEBUG] = "debug",
+  };
+
+  if (level == NULL) {
+    g_log_level =
+        getenv(DEBUG_ENVVAR) ? MPIDYNRES_LOG_DEBUG : MPIDYNRES_LOG_OFF;
+    return;
+  }
+  for (size_t i = 0; i < COUNT_OF(names); i++) {
+    if (strcmp(level, names[i]) == 0) {
+      g_log_level = i;
+      return;
+    }
+  }
+  g_log_level = atoi(level);
+  if (g_log_level < MPIDYNRES_LOG_OFF) {
+    g_log_level = MPIDYNRES_LOG_OFF;
+  }
+}
 
+/**
+ * @brief      Write the buffered debug output
+ */
+void flush_debug(void) {
+  if (g_debug_out != NULL) {
+    fflush(g_debug_out);
+  }
+}
 
 /**
- * @brief      Print a debug message to stderr, if the DEBUG env var is set
- *
- * @details    Different mpi ranks have different colors
+ * @brief      Open the buffered writer of this rank
  *
- * @param      fmt A format string
+ * @details    The writer uses its own descriptor of stderr with a static
+ * buffer, so messages do not cause a write each. It is flushed at most every
+ * DEBUG_FLUSH_INTERVAL_NS, after warnings and at exit.
  */
-void debug(char *fmt, ...) {
-  static int myrank = -1;
-  static int num_ranks = -1;
-  static char prefix[0x100] = {0};
-  static int prefix_set = false;
-  /*static char const *const colors[] = {*/
-  /*"\033[0;31m", "\033[1;31m", "\033[0;32m", "\033[1;32m",*/
-  /*"\033[0;33m", "\033[01;33", "\033[0;34m", "\033[1;34m",*/
-  /*"\033[0;35m", "\033[1;35m", "\033[0;36m", "\033[1;36m",*/
-  /*};*/
+static void open_debug_out() {
   static char const *const colors[] = {
       "\033[0;31m", "\033[0;32m", "\033[0;33m",
       "\033[0;34m", "\033[0;35m", "\033[0;36m",
   };
-  if (myrank == -1) MPI_Comm_rank(g_debug_comm, &myrank);
-  if (num_ranks == -1) MPI_Comm_size(g_debug_comm, &num_ranks);
-  if (!prefix_set) {
-    snprintf(prefix, sizeof(prefix) - 1, "%slibmpidynres: (%d|%d) says: ",
-             colors[myrank % COUNT_OF(colors)], myrank, num_ranks);
-    prefix_set = true;
-  }
+  int myrank, num_ranks;
+  int fd;
 
-  if (getenv(DEBUG_ENVVAR)) {
-    va_list args;
-    char *buf;
+  MPI_Comm_rank(g_debug_comm, &myrank);
+  MPI_Comm_size(g_debug_comm, &num_ranks);
+  snprintf(g_debug_prefix, sizeof(g_debug_prefix) - 1,
+           "%slibmpidynres: (%d|%d) says: ",
+           colors[myrank % COUNT_OF(colors)], myrank, num_ranks);
 
-    va_start(args, fmt);
+  fd = dup(STDERR_FILENO);
+  g_debug_out = fd == -1 ? NULL : fdopen(fd, "w");
+  if (g_debug_out == NULL) {
+    g_debug_out = stderr;
+    return;
+  }
+  setvbuf(g_debug_out, g_debug_buf, _IOFBF, sizeof(g_debug_buf));
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &g_debug_last_flush);
+  atexit(flush_debug);
+}
 
-    buf = calloc(strlen(fmt) + strlen(prefix) + 0x100, sizeof(char));
-    if (!buf) die("Memory error!");
+/**
+ * @brief      Register an MPI communicator to be used for the debug output
+ * prefix
+ *
+ * @details    Also reads the log level, if it was not read yet
+ *
+ * @param      comm The MPI communicator to use (has to be valid during logging)
+ */
+void register_debug_comm(MPI_Comm comm) {
+  g_debug_comm = comm;
+  if (g_log_level == INT_MAX) {
+    read_log_level();
+  }
+}
 
-    strcpy(buf, prefix);
-    strcat(buf, fmt);
-    strcat(buf, RESET);  // reset color set by prefix
+/**
+ * @brief      Print a debug message to stderr, use it through debug(),
+ * log_info() and log_warn()
+ *
+ * @details    Different mpi ranks have different colors. The message is
+ * formatted directly into the buffer of the writer, no memory is allocated.
+ *
+ * @param      level The level of the message
+ *
+ * @param      fmt A format string
+ */
+void log_write(int level, char const *fmt, ...) {
+  struct timespec now;
+  va_list args;
+
+  if (g_log_level == INT_MAX) {
+    read_log_level();
+  }
+  if (level > g_log_level) {
+    return;
+  }
+  if (g_debug_out == NULL) {
+    open_debug_out();
+  }
 
-    vfprintf(stderr, buf, args);
-    free(buf);
+  va_start(args, fmt);
+  flockfile(g_debug_out);
+  fputs(g_debug_prefix, g_debug_out);
+  vfprintf(g_debug_out, fmt, args);
+  fputs(RESET, g_debug_out);  // reset color set by prefix
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  if (level <= MPIDYNRES_LOG_WARN ||
+      (now.tv_sec - g_debug_last_flush.tv_sec) * 1000000000L + now.tv_nsec -
+              g_debug_last_flush.tv_nsec >=
+          DEBUG_FLUSH_INTERVAL_NS) {
+    fflush(g_debug_out);
+    g_debug_last_flush = now;
   }
+  funlockfile(g_debug_out);
+  va_end(args);
 }
@@ -1,8 +1,11 @@
 /*
  * Under normal circumstances, a library shouldn't log to stdout/stderr
- * That's why libmpidynres only logs to stdout when the env var MPIDYNRES_DEBUG is set
- * When the env var MPIDYNRES_STATELOG is set, a colourful log of the scheduler state is printed
- * to the file specified in MPIDYNRES_STATELOG
+ * That's why libmpidynres only logs to stderr when the env var MPIDYNRES_DEBUG
+ * or MPIDYNRES_LOG_LEVEL is set (see log_write)
+ * When the env var MPIDYNRES_STATELOG is set, every state change of a cr is written to the
+ * binary log specified in MPIDYNRES_STATELOG (see statelog.h)
+ * When the env var MPIDYNRES_DECISION_TRACE is set, every decision of the managers is
+ * written to the file specified in MPIDYNRES_DECISION_TRACE (see trace_decision)
  */
 
 #ifndef LOGGING_H
@@ -12,6 +15,7 @@
 #include <stdio.h>
 
 #include "scheduler.h"
+#include "statelog.h"
 
 #define RED "\033[0;31m"
 #define BOLD_RED "\033[1;31m"
@@ -31,16 +35,15 @@
 
 #define STATELOG_ENVVAR "MPIDYNRES_STATELOG"
 #define DEBUG_ENVVAR "MPIDYNRES_DEBUG"
+#define LOG_LEVEL_ENVVAR "MPIDYNRES_LOG_LEVEL"
+#define JOB_REPORT_ENVVAR "MPIDYNRES_JOB_REPORT"
+#define DECISION_TRACE_ENVVAR "MPIDYNRES_DECISION_TRACE"
 
-enum cr_state {
-  idle,
-  running,
-  reserved,
-  proposed_shutdown,
-  accepted_shutdown,
-
-  NUM_CR_STATES
-};
+/*
+ * Type of the decision trace record of an initial process set, the other
+ * records use the names of the MPIDYNRES_RC_types
+ */
+#define DECISION_TRACE_INIT "init"
 
 /**
  * Globals
@@ -48,23 +51,58 @@ enum cr_state {
 extern FILE *g_statelogfile;
 extern enum cr_state *g_states;
 extern size_t g_num_states;
+extern FILE *g_decisiontracefile;
 
 /**
  * Functions for State logging
  */
-void log_state(char *eventfmt, ...);
 void init_log(MPIDYNRES_scheduler *scheduler);
 void free_log();
-void set_state(int cr_id, enum cr_state state);
-void print_states(FILE *f, size_t num_states,
-                  enum cr_state states[static num_states], char const *eventfmt,
-                  va_list args);
-void print_states_header(FILE *f, size_t num_states);
+void log_state_event(enum statelog_event event);
+void set_state(int job_id, int cr_id, enum cr_state state);
+
+/**
+ * Functions for the decision trace
+ */
+void trace_decision(MPIDYNRES_scheduler *scheduler, int cr_id,
+                    char const *type, set_int *pset);
+
+/*
+ * Levels of the debug output. Calls above MPIDYNRES_LOG_MAX_LEVEL are
+ * compiled out (e.g. -DMPIDYNRES_LOG_MAX_LEVEL=MPIDYNRES_LOG_OFF for release
+ * builds), calls above the level chosen at runtime cost one comparison.
+ */
+#define MPIDYNRES_LOG_OFF 0
+#define MPIDYNRES_LOG_WARN 1
+#define MPIDYNRES_LOG_INFO 2
+#define MPIDYNRES_LOG_DEBUG 3
+
+#ifndef MPIDYNRES_LOG_MAX_LEVEL
+#define MPIDYNRES_LOG_MAX_LEVEL MPIDYNRES_LOG_DEBUG
+#endif
+
+/*
+ * The runtime level, read from the environment by the first call to
+ * log_write (or by register_debug_comm)
+ */
+extern int g_log_level;
+
+#define log_at(level, ...)                                                \
+  do {                                                                    \
+    if ((level) <= MPIDYNRES_LOG_MAX_LEVEL && (level) <= g_log_level) {   \
+      log_write((level), __VA_ARGS__);                                    \
+    }                                                                     \
+  } while (0)
+
+#define log_warn(...) log_at(MPIDYNRES_LOG_WARN, __VA_ARGS__)
+#define log_info(...) log_at(MPIDYNRES_LOG_INFO, __VA_ARGS__)
+#define debug(...) log_at(MPIDYNRES_LOG_DEBUG, __VA_ARGS__)
 
 /**
  * Functions for debug output
  */
 void register_debug_comm(MPI_Comm comm);
-void debug(char *fmt, ...);
+void log_write(int level, char const *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
 
 #endif
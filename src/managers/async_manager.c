@@ -0,0 +1,473 @@
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "logging.h"
+#include "scheduler.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/*
+ * State of the decision slot. The scheduler thread only moves it from
+ * ASYNC_IDLE or ASYNC_READY to ASYNC_REQUESTED, the manager thread only from
+ * ASYNC_REQUESTED to ASYNC_READY.
+ */
+enum async_state {
+  ASYNC_IDLE = 0,   ///< no decision, the manager thread is waiting
+  ASYNC_REQUESTED,  ///< the manager thread is deciding on the snapshot
+  ASYNC_READY,      ///< a decision is ready, the manager thread is waiting
+};
+
+struct async_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;  ///< the real scheduler of the job
+  MPIDYNRES_manager inner;         ///< the manager that makes the decisions
+
+  /*
+   * The inner manager only sees this copy of the scheduler. Before a call,
+   * it is refreshed from the real scheduler. While the manager thread decides,
+   * its pool points to a copy of the pool, so the scheduler thread can go on.
+   */
+  MPIDYNRES_scheduler shadow;
+  MPIDYNRES_pool shadow_pool;
+  MPIDYNRES_scheduler **shadow_jobs;  ///< copies of the other jobs of the pool
+  int num_shadow_jobs;
+
+  pthread_t thread;
+  sem_t wakeup;
+  atomic_bool stop;
+  atomic_int state;  ///< one of enum async_state
+
+  // the decision slot, owned by the manager thread while ASYNC_REQUESTED
+  int src_process_id;
+  MPI_Info rc_info;
+  MPIDYNRES_RC_type rc_type;
+  set_int new_pset;
+};
+typedef struct async_manager async_manager;
+
+/**
+ * @brief      Copy the state a manager can read from one job to another
+ *
+ * @param      dst The copy, its sets are replaced
+ *
+ * @param      src The job
+ */
+static void copy_job(MPIDYNRES_scheduler *dst, MPIDYNRES_scheduler *src) {
+  set_int_free(&dst->running_crs);
+  set_int_free(&dst->pending_shutdowns);
+  set_int_free(&dst->shutting_down_crs);
+  dst->num_scheduling_processes = src->num_scheduling_processes;
+  dst->job_id = src->job_id;
+  dst->initial_size = src->initial_size;
+  dst->standby_size = src->standby_size;
+  dst->job_stats = src->job_stats;
+  dst->config = src->config;
+  dst->running_crs = set_int_copy(&src->running_crs);
+  dst->pending_shutdowns = set_int_copy(&src->pending_shutdowns);
+  dst->shutting_down_crs = set_int_copy(&src->shutting_down_crs);
+}
+
+/**
+ * @brief      Copy the pool, so the manager thread can read it while the
+ * scheduler thread changes the real one
+ *
+ * @details    The owners, states and standby of the crs and the state of the
+ * other jobs are copied. The other jobs have no manager in the copy, their
+ * manager state is changed by the scheduler thread. Timers set on the copy
+ * are dropped, the metrics and the per cr accounting are not copied.
+ *
+ * @param      mgr The manager
+ */
+static void copy_pool(async_manager *mgr) {
+  MPIDYNRES_pool *pool = mgr->scheduler->pool;
+  MPIDYNRES_pool *copy = &mgr->shadow_pool;
+  size_t num_crs = pool->num_scheduling_processes + 1;
+
+  if (copy->num_scheduling_processes != pool->num_scheduling_processes) {
+    copy->owner = realloc(copy->owner, num_crs * sizeof(int));
+    copy->standby = realloc(copy->standby, num_crs * sizeof(int));
+    copy->cr_state = realloc(copy->cr_state, num_crs * sizeof(enum cr_state));
+    if (copy->owner == NULL || copy->standby == NULL ||
+        copy->cr_state == NULL) {
+      die("Memory Error\n");
+    }
+  }
+  copy->num_scheduling_processes = pool->num_scheduling_processes;
+  memcpy(copy->owner, pool->owner, num_crs * sizeof(int));
+  memcpy(copy->standby, pool->standby, num_crs * sizeof(int));
+  memcpy(copy->cr_state, pool->cr_state, num_crs * sizeof(enum cr_state));
+  copy->num_running = pool->num_running;
+  copy->start_time = pool->start_time;
+  set_timer_free(&copy->timers);
+  copy->timers = set_timer_init(timer_compare);
+
+  // jobs can be added after this one was created
+  if (mgr->num_shadow_jobs != pool->num_jobs) {
+    mgr->shadow_jobs =
+        realloc(mgr->shadow_jobs, pool->num_jobs * sizeof(MPIDYNRES_scheduler *));
+    copy->jobs =
+        realloc(copy->jobs, pool->num_jobs * sizeof(MPIDYNRES_scheduler *));
+    if (mgr->shadow_jobs == NULL || copy->jobs == NULL) {
+      die("Memory Error\n");
+    }
+    for (int i = mgr->num_shadow_jobs; i < pool->num_jobs; i++) {
+      mgr->shadow_jobs[i] = calloc(1, sizeof(MPIDYNRES_scheduler));
+      if (mgr->shadow_jobs[i] == NULL) {
+        die("Memory Error\n");
+      }
+      mgr->shadow_jobs[i]->running_crs = set_int_init(int_compare);
+      mgr->shadow_jobs[i]->pending_shutdowns = set_int_init(int_compare);
+      mgr->shadow_jobs[i]->shutting_down_crs = set_int_init(int_compare);
+      mgr->shadow_jobs[i]->pool = copy;
+    }
+    mgr->num_shadow_jobs = pool->num_jobs;
+  }
+  copy->num_jobs = pool->num_jobs;
+  for (int i = 0; i < pool->num_jobs; i++) {
+    if (i == mgr->scheduler->job_id) {
+      copy->jobs[i] = &mgr->shadow;
+      continue;
+    }
+    copy_job(mgr->shadow_jobs[i], pool->jobs[i]);
+    mgr->shadow_jobs[i]->rng_state = pool->jobs[i]->rng_state;
+    mgr->shadow_jobs[i]->manager = NULL;
+    copy->jobs[i] = mgr->shadow_jobs[i];
+  }
+}
+
+/**
+ * @brief      Update the copy of the scheduler the inner manager sees
+ *
+ * @param      mgr The manager
+ *
+ * @param      copy_pool_too whether the pool is copied as well (for the
+ * manager thread) or the real pool and transport are used (for calls on the
+ * scheduler thread)
+ */
+static void refresh_shadow(async_manager *mgr, bool copy_pool_too) {
+  copy_job(&mgr->shadow, mgr->scheduler);
+  if (copy_pool_too) {
+    copy_pool(mgr);
+    mgr->shadow.pool = &mgr->shadow_pool;
+    mgr->shadow.transport = NULL;
+  } else {
+    mgr->shadow.pool = mgr->scheduler->pool;
+    mgr->shadow.transport = mgr->scheduler->transport;
+  }
+}
+
+/**
+ * @brief      Pass back what the inner manager changed during a call on the
+ * scheduler thread
+ *
+ * @param      mgr The manager
+ */
+static void sync_back(async_manager *mgr) {
+  mgr->scheduler->initial_size = mgr->shadow.initial_size;
+  if (mgr->scheduler->standby_size != mgr->shadow.standby_size) {
+    // the refill on the shadow saw the old size of the real job
+    MPIDYNRES_scheduler_set_standby_size(mgr->scheduler,
+                                         mgr->shadow.standby_size);
+  }
+  if (mgr->shadow.rc_staged) {
+    mgr->shadow.rc_staged = false;
+    MPIDYNRES_scheduler_stage_rc(mgr->scheduler, mgr->shadow.staged_rc_type,
+                                 &mgr->shadow.staged_rc_pset);
+    set_int_free(&mgr->shadow.staged_rc_pset);
+  }
+}
+
+/**
+ * @brief      Wait until the manager thread is not deciding
+ *
+ * @details    Only used before calls other than resource change queries, which
+ * are rare
+ *
+ * @param      mgr The manager
+ */
+static void wait_idle(async_manager *mgr) {
+  while (atomic_load_explicit(&mgr->state, memory_order_acquire) ==
+         ASYNC_REQUESTED) {
+    sched_yield();
+  }
+  if (mgr->shadow.rc_staged) {
+    // staged while deciding on the copy of the pool
+    mgr->shadow.rc_staged = false;
+    set_int_free(&mgr->shadow.staged_rc_pset);
+  }
+}
+
+/**
+ * @brief      The manager thread
+ *
+ * @details    Makes one decision per wakeup and publishes it in the slot
+ *
+ * @param      arg The manager
+ *
+ * @return     NULL
+ */
+static void *async_thread(void *arg) {
+  async_manager *mgr = arg;
+
+  for (;;) {
+    while (sem_wait(&mgr->wakeup) != 0) {
+    }
+    if (atomic_load(&mgr->stop)) {
+      break;
+    }
+    if (MPIDYNRES_manager_handle_rc_msg(mgr->inner, mgr->src_process_id,
+                                        &mgr->rc_info, &mgr->rc_type,
+                                        &mgr->new_pset)) {
+      die("An error happened while trying to get resource changes");
+    }
+    atomic_store_explicit(&mgr->state, ASYNC_READY, memory_order_release);
+  }
+  return NULL;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @details    Stops the manager thread and frees the inner manager
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int async_free(MPIDYNRES_manager manager) {
+  async_manager *mgr = (async_manager *)manager;
+
+  atomic_store(&mgr->stop, true);
+  sem_post(&mgr->wakeup);
+  pthread_join(mgr->thread, NULL);
+  sem_destroy(&mgr->wakeup);
+
+  // the thread might have stopped before deciding
+  if (atomic_load(&mgr->state) == ASYNC_READY) {
+    if (mgr->rc_type != MPIDYNRES_RC_NONE) {
+      set_int_free(&mgr->new_pset);
+    }
+    if (mgr->rc_info != MPI_INFO_NULL) {
+      MPI_Info_free(&mgr->rc_info);
+    }
+  }
+  if (mgr->shadow.rc_staged) {
+    set_int_free(&mgr->shadow.staged_rc_pset);
+  }
+  int res = MPIDYNRES_manager_free(mgr->inner);
+
+  set_int_free(&mgr->shadow.running_crs);
+  set_int_free(&mgr->shadow.pending_shutdowns);
+  set_int_free(&mgr->shadow.shutting_down_crs);
+  for (int i = 0; i < mgr->num_shadow_jobs; i++) {
+    set_int_free(&mgr->shadow_jobs[i]->running_crs);
+    set_int_free(&mgr->shadow_jobs[i]->pending_shutdowns);
+    set_int_free(&mgr->shadow_jobs[i]->shutting_down_crs);
+    free(mgr->shadow_jobs[i]);
+  }
+  free(mgr->shadow_jobs);
+  free(mgr->shadow_pool.jobs);
+  free(mgr->shadow_pool.owner);
+  free(mgr->shadow_pool.standby);
+  free(mgr->shadow_pool.cr_state);
+  set_timer_free(&mgr->shadow_pool.timers);
+  free(mgr);
+  return res;
+}
+
+/*
+ * The calls other than resource change queries are passed on synchronously,
+ * after the manager thread finished its current decision
+ */
+static int async_register_scheduling_hints(MPIDYNRES_manager manager,
+                                           int src_process_id,
+                                           MPI_Info scheduling_hints,
+                                           MPI_Info *o_answer) {
+  async_manager *mgr = (async_manager *)manager;
+  wait_idle(mgr);
+  refresh_shadow(mgr, false);
+  int res = MPIDYNRES_manager_register_scheduling_hints(
+      mgr->inner, src_process_id, scheduling_hints, o_answer);
+  sync_back(mgr);
+  return res;
+}
+
+static int async_get_initial_pset(MPIDYNRES_manager manager,
+                                  set_int *o_initial_pset) {
+  async_manager *mgr = (async_manager *)manager;
+  wait_idle(mgr);
+  refresh_shadow(mgr, false);
+  int res = MPIDYNRES_manager_get_initial_pset(mgr->inner, o_initial_pset);
+  sync_back(mgr);
+  return res;
+}
+
+static bool async_may_backfill(MPIDYNRES_manager manager,
+                               MPIDYNRES_scheduler *candidate) {
+  async_manager *mgr = (async_manager *)manager;
+  wait_idle(mgr);
+  refresh_shadow(mgr, false);
+  bool res = MPIDYNRES_manager_may_backfill(mgr->inner, candidate);
+  sync_back(mgr);
+  return res;
+}
+
+static int async_handle_timer(MPIDYNRES_manager manager, int timer_id) {
+  async_manager *mgr = (async_manager *)manager;
+  wait_idle(mgr);
+  refresh_shadow(mgr, false);
+  int res = MPIDYNRES_manager_handle_timer(mgr->inner, timer_id);
+  sync_back(mgr);
+  return res;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    Never waits for the manager thread. If it published a decision,
+ * the decision is returned if it still fits the job (see
+ * MPIDYNRES_scheduler_rc_fits), otherwise RC_NONE is returned. If the manager
+ * thread is idle afterwards, it is asked to decide for this query on a copy
+ * of the current state, the decision is returned to one of the next queries.
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int async_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                               MPI_Info *o_rc_info,
+                               MPIDYNRES_RC_type *o_rc_type,
+                               set_int *o_new_pset) {
+  async_manager *mgr = (async_manager *)manager;
+  int state = atomic_load_explicit(&mgr->state, memory_order_acquire);
+
+  *o_rc_info = MPI_INFO_NULL;
+  *o_rc_type = MPIDYNRES_RC_NONE;
+
+  if (state == ASYNC_READY) {
+    if (mgr->rc_type != MPIDYNRES_RC_NONE &&
+        MPIDYNRES_scheduler_rc_fits(mgr->scheduler, mgr->rc_type,
+                                    &mgr->new_pset)) {
+      *o_rc_info = mgr->rc_info;
+      *o_rc_type = mgr->rc_type;
+      *o_new_pset = mgr->new_pset;
+    } else {
+      if (mgr->rc_type != MPIDYNRES_RC_NONE) {
+        debug("Async decision of job %d does not fit anymore\n",
+              mgr->scheduler->job_id);
+        set_int_free(&mgr->new_pset);
+      }
+      if (mgr->rc_info != MPI_INFO_NULL) {
+        MPI_Info_free(&mgr->rc_info);
+      }
+    }
+    state = ASYNC_IDLE;
+  }
+
+  if (state == ASYNC_IDLE) {
+    if (mgr->shadow.rc_staged) {
+      mgr->shadow.rc_staged = false;
+      set_int_free(&mgr->shadow.staged_rc_pset);
+    }
+    refresh_shadow(mgr, true);
+    mgr->src_process_id = src_process_id;
+    mgr->rc_info = MPI_INFO_NULL;
+    mgr->rc_type = MPIDYNRES_RC_NONE;
+    atomic_store_explicit(&mgr->state, ASYNC_REQUESTED, memory_order_release);
+    sem_post(&mgr->wakeup);
+  }
+  return 0;
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_async_manager_ops = {
+    .name = "async",
+    .init = NULL,  // created with MPIDYNRES_async_manager_create
+    .free = async_free,
+    .register_scheduling_hints = async_register_scheduling_hints,
+    .get_initial_pset = async_get_initial_pset,
+    .handle_rc_msg = async_handle_rc_msg,
+    .may_backfill = async_may_backfill,
+    .handle_timer = async_handle_timer,
+};
+
+/**
+ * @brief      Create a manager that makes its resource change decisions on
+ * its own thread
+ *
+ * @details    The inner manager is created with a copy of the scheduler that
+ * is refreshed before every call. Only handle_rc_msg runs on the manager
+ * thread, it sees a copy of the pool and may only call MPI functions that do
+ * not communicate (infos, logging), so MPI has to be initialized with
+ * MPI_THREAD_MULTIPLE (checked by MPIDYNRES_manager_init). In the copy, the other jobs have no manager and the job
+ * has no transport, so crs can not be warmed up from there (see
+ * MPIDYNRES_scheduler_warm_cr). Timers set and changes staged from
+ * handle_rc_msg are dropped. All other calls run on the scheduler thread as
+ * usual.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      inner_ops The manager that makes the decisions
+ *
+ * @return     The new manager object
+ */
+MPIDYNRES_manager MPIDYNRES_async_manager_create(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_manager_ops const *inner_ops) {
+  async_manager *res = calloc(1, sizeof(async_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->base.ops = &MPIDYNRES_async_manager_ops;
+  res->scheduler = scheduler;
+
+  res->shadow.running_crs = set_int_init(int_compare);
+  res->shadow.pending_shutdowns = set_int_init(int_compare);
+  res->shadow.shutting_down_crs = set_int_init(int_compare);
+  res->shadow.rng_state = scheduler->rng_state;
+  res->shadow_pool.timers = set_timer_init(timer_compare);
+  refresh_shadow(res, false);
+
+  res->inner = inner_ops->init(&res->shadow);
+  if (res->inner == NULL) {
+    die("Could not initialize manager %s\n", inner_ops->name);
+  }
+  res->inner->ops = inner_ops;
+  res->shadow.manager = res->inner;
+  sync_back(res);
+
+  atomic_init(&res->stop, false);
+  atomic_init(&res->state, ASYNC_IDLE);
+  if (sem_init(&res->wakeup, 0, 0) != 0 ||
+      pthread_create(&res->thread, NULL, async_thread, res) != 0) {
+    die("Could not start the manager thread\n");
+  }
+
+  return &res->base;
+}
+
+/**
+ * @brief      Get the manager that makes the decisions
+ *
+ * @param      manager A manager, may be wrapped by
+ * MPIDYNRES_async_manager_create
+ *
+ * @return     The inner manager if manager runs on its own thread, manager
+ * itself otherwise
+ */
+MPIDYNRES_manager MPIDYNRES_async_manager_inner(MPIDYNRES_manager manager) {
+  if (manager->ops != &MPIDYNRES_async_manager_ops) {
+    return manager;
+  }
+  return ((async_manager *)manager)->inner;
+}
@@ -0,0 +1,312 @@
+#include <string.h>
+
+#include "logging.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/*
+ * Keys of the scheduling hints passed with MPIDYNRES_add_scheduling_hints
+ */
+#define HINT_MIN_PROCS "mpidynres_min_procs"
+#define HINT_MAX_PROCS "mpidynres_max_procs"
+
+struct backfill_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+  int num_processes;
+  bool malleable;  ///< whether the job is shrunk and expanded
+  int min_procs;   ///< the job is never shrunk below this size
+  int max_procs;   ///< the job is never expanded beyond this size
+};
+typedef struct backfill_manager backfill_manager;
+
+/**
+ * @brief      Get the backfill manager of a job
+ *
+ * @details    Also finds it if the job runs it on its own thread. Jobs in the
+ * copy of the pool a manager thread sees have no manager.
+ *
+ * @param      job The scheduler of the job
+ *
+ * @return     The manager or NULL if the job uses another manager
+ */
+static backfill_manager *backfill_manager_of(MPIDYNRES_scheduler *job) {
+  if (job->manager == NULL) {
+    return NULL;
+  }
+  MPIDYNRES_manager manager = MPIDYNRES_async_manager_inner(job->manager);
+  if (manager->ops != &MPIDYNRES_backfill_manager_ops) {
+    return NULL;
+  }
+  return (backfill_manager *)manager;
+}
+
+/**
+ * @brief      Get the number of crs the running jobs can give back
+ *
+ * @details    Counts the crs of malleable jobs above their minimum size that
+ * are not already being shut down
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @return     The number of crs
+ */
+static int shrinkable_crs(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int res = 0;
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    backfill_manager *mgr = backfill_manager_of(job);
+    if (mgr == NULL || !mgr->malleable) {
+      continue;
+    }
+    // crs removed by a resource change may already be shutting down
+    int size = job->running_crs.size;
+    foreach (set_int, &job->pending_shutdowns, it) {
+      size -= set_int_count(&job->running_crs, *it.ref);
+    }
+    if (size > mgr->min_procs) {
+      res += size - mgr->min_procs;
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief      Get the number of crs that are being shut down in all jobs
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @return     The number of crs
+ */
+static int pending_shutdowns(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int res = 0;
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    res += pool->jobs[i]->pending_shutdowns.size;
+  }
+  return res;
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @details    The malleability range is read from manager_min_procs and
+ * manager_max_procs, the application can change it with scheduling hints. If
+ * manager_malleable is false, the job is never shrunk or expanded.
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+static MPIDYNRES_manager backfill_init(MPIDYNRES_scheduler *scheduler) {
+  char buf[MPI_MAX_INFO_VAL];
+  backfill_manager *res;
+  res = calloc(1, sizeof(backfill_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->scheduler = scheduler;
+  res->num_processes = scheduler->num_scheduling_processes;
+  res->malleable = true;
+  res->min_procs = 1;
+  res->max_procs = res->num_processes;
+
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_malleable", buf)) {
+    res->malleable = strcmp(buf, "false") != 0 && strcmp(buf, "0") != 0;
+  }
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_min_procs", buf)) {
+    res->min_procs = atoi(buf);
+  }
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_max_procs", buf)) {
+    res->max_procs = atoi(buf);
+  }
+  if (res->min_procs < 1 || res->max_procs < res->min_procs ||
+      res->max_procs > res->num_processes) {
+    die("Invalid manager_min_procs or manager_max_procs\n");
+  }
+
+  return &res->base;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int backfill_free(MPIDYNRES_manager manager) {
+  free(manager);
+  return 0;
+}
+
+/**
+ * @brief      Register the malleability range of the job
+ *
+ * @details    Recognizes mpidynres_min_procs and mpidynres_max_procs, values
+ * outside of the number of crs are clamped
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      scheduling_hints The hints
+ *
+ * @param      o_answer The answer is returned here (always MPI_INFO_NULL)
+ *
+ * @return     if != 0, an error occured
+ */
+static int backfill_register_scheduling_hints(MPIDYNRES_manager manager,
+                                              int src_process_id,
+                                              MPI_Info scheduling_hints,
+                                              MPI_Info *o_answer) {
+  (void)src_process_id;
+  backfill_manager *mgr = (backfill_manager *)manager;
+  char buf[MPI_MAX_INFO_VAL];
+  int in_there;
+
+  *o_answer = MPI_INFO_NULL;
+  if (scheduling_hints == MPI_INFO_NULL) {
+    return 0;
+  }
+
+  MPI_Info_get(scheduling_hints, HINT_MIN_PROCS, MPI_MAX_INFO_VAL - 1, buf,
+               &in_there);
+  if (in_there) {
+    int val = atoi(buf);
+    mgr->min_procs = val < 1 ? 1 : val;
+  }
+  MPI_Info_get(scheduling_hints, HINT_MAX_PROCS, MPI_MAX_INFO_VAL - 1, buf,
+               &in_there);
+  if (in_there) {
+    int val = atoi(buf);
+    mgr->max_procs = val > mgr->num_processes ? mgr->num_processes : val;
+  }
+  if (mgr->max_procs < mgr->min_procs) {
+    mgr->max_procs = mgr->min_procs;
+  }
+  return 0;
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int backfill_get_initial_pset(MPIDYNRES_manager manager,
+                                     set_int *o_initial_pset) {
+  backfill_manager *mgr = (backfill_manager *)manager;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
+
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
+  return 0;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    If a job is waiting and does not fit, the job is shrunk (down
+ * to its minimum size) to make room for it. If no job is waiting, the job is
+ * expanded into the free crs (up to its maximum size).
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int backfill_handle_rc_msg(MPIDYNRES_manager manager,
+                                  int src_process_id, MPI_Info *o_rc_info,
+                                  MPIDYNRES_RC_type *o_rc_type,
+                                  set_int *o_new_pset) {
+  (void)src_process_id;
+  backfill_manager *mgr = (backfill_manager *)manager;
+  MPIDYNRES_scheduler *scheduler = mgr->scheduler;
+  MPIDYNRES_scheduler *head = MPIDYNRES_scheduler_queue_head(scheduler);
+  int current = scheduler->running_crs.size;
+  int num_free = MPIDYNRES_scheduler_num_free(scheduler);
+
+  *o_rc_info = MPI_INFO_NULL;
+  *o_rc_type = MPIDYNRES_RC_NONE;
+  if (!mgr->malleable) {
+    return 0;
+  }
+
+  if (head != NULL) {
+    // make room for the first waiting job
+    int need = MPIDYNRES_manager_initial_number(head) - num_free -
+               pending_shutdowns(scheduler);
+    int sub = current - mgr->min_procs;
+    sub = sub > need ? need : sub;
+    if (sub > 0) {
+      debug("Backfill manager: shrinking job %d by %d for job %d\n",
+            scheduler->job_id, sub, head->job_id);
+      *o_rc_type = MPIDYNRES_RC_SUB;
+      MPIDYNRES_manager_pick_crs(scheduler, sub, false, o_new_pset);
+    }
+  } else {
+    // fill the idle crs
+    int add = mgr->max_procs - current;
+    add = add > num_free ? num_free : add;
+    if (add > 0) {
+      debug("Backfill manager: expanding job %d by %d\n", scheduler->job_id,
+            add);
+      *o_rc_type = MPIDYNRES_RC_ADD;
+      MPIDYNRES_manager_pick_crs(scheduler, add, true, o_new_pset);
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief      Decide whether a job may start before the waiting job
+ *
+ * @details    The reservation of the first waiting job is kept in crs
+ * instead of time (the run times are unknown): the candidate may start if the
+ * crs left free afterwards, together with the crs the malleable jobs can give
+ * back, are still enough for the first waiting job.
+ *
+ * @param      manager The manager of the first waiting job
+ *
+ * @param      candidate The job that fits into the free crs
+ *
+ * @return     true if the candidate may start
+ */
+static bool backfill_may_backfill(MPIDYNRES_manager manager,
+                                  MPIDYNRES_scheduler *candidate) {
+  backfill_manager *mgr = (backfill_manager *)manager;
+  MPIDYNRES_scheduler *head = mgr->scheduler;
+  // both initial sizes were decided when the jobs were checked for free crs
+  int free_after =
+      MPIDYNRES_scheduler_num_free(head) - candidate->initial_size;
+
+  return head->initial_size <=
+         free_after + pending_shutdowns(head) + shrinkable_crs(head);
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_backfill_manager_ops = {
+    .name = "backfill",
+    .init = backfill_init,
+    .free = backfill_free,
+    .register_scheduling_hints = backfill_register_scheduling_hints,
+    .get_initial_pset = backfill_get_initial_pset,
+    .handle_rc_msg = backfill_handle_rc_msg,
+    .may_backfill = backfill_may_backfill,
+};
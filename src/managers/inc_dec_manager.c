@@ -3,6 +3,7 @@
 #include "scheduler_datatypes.h"
 
 struct inc_dec_manager {
+  struct MPIDYNRES_manager_base base;
   MPIDYNRES_scheduler *scheduler;
   int num_processes;
   int next;
@@ -18,7 +19,7 @@ typedef struct inc_dec_manager inc_dec_manager;
  *
  * @return     The new manager object
  */
-MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
+static MPIDYNRES_manager inc_dec_init(MPIDYNRES_scheduler *scheduler) {
   inc_dec_manager *res;
   res = calloc(1, sizeof(inc_dec_manager));
   if (res == NULL) {
@@ -27,7 +28,7 @@ MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
   res->scheduler = scheduler;
   res->num_processes = scheduler->num_scheduling_processes;
 
-  return res;
+  return &res->base;
 }
 
 
@@ -38,7 +39,7 @@ MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
+static int inc_dec_free(MPIDYNRES_manager manager) {
   free(manager);
   return 0;
 }
@@ -47,7 +48,7 @@ int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
 /*
  * No support yet
  */
-int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
+static int inc_dec_register_scheduling_hints(MPIDYNRES_manager manager,
                                                 int src_process_id,
                                                 MPI_Info scheduling_hints,
                                                 MPI_Info *o_answer) {
@@ -62,7 +63,8 @@ int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
 /**
  * @brief      Get initial process set
  *
- * @details    Check for config or default to cr id 1
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids
  *
  * @param      manager The manager used
  *
@@ -70,51 +72,19 @@ int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_get_initial_pset(MPIDYNRES_manager manager,
+static int inc_dec_get_initial_pset(MPIDYNRES_manager manager,
                                        set_int *o_initial_pset) {
   inc_dec_manager *mgr = (inc_dec_manager *)manager;
-  int vlen;
-  int in_there;
-  int num_init = 1;
-  MPI_Info config = mgr->scheduler->config->manager_config;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
 
-  if (config == MPI_INFO_NULL) {
-    in_there = false;
-  } else {
-    MPI_Info_get_valuelen(config, "manager_initial_number", &vlen, &in_there);
-  }
-  if (in_there) {
-    char *value = calloc(vlen+1, sizeof(char));
-    MPI_Info_get(config, "manager_initial_number", vlen, value, &in_there);
-    num_init = atoi(value);
-    free(value);
-    if (num_init < 1 || num_init > mgr->num_processes) {
-      die("Key manager_initial_number is invalid.\n");
-    }
-  } else {
-    if (config == MPI_INFO_NULL) {
-      in_there = false;
-    } else {
-      MPI_Info_get_valuelen(config, "manager_initial_number_random", &vlen, &in_there);
-    }
-    if (in_there) {
-      num_init = 1 + (rand() % (mgr->num_processes - 1));
-    } else {
-      num_init = 1;
-    }
-  }
-
-  // start processes 1...num_init
-  *o_initial_pset = set_int_init(int_compare);
-  for (int i = 0; i < num_init; i++) {
-    set_int_insert(o_initial_pset, i+1);
-  }
+  // start the free processes with the lowest ids
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
 
   if (num_init == mgr->num_processes) {
     mgr->next = mgr->num_processes;
     mgr->increasing = false;
   } else {
-    mgr->next = mgr->num_processes + 1;
+    mgr->next = num_init + 1;
     mgr->increasing = true;
   }
 
@@ -137,13 +107,44 @@ int MPIDYNRES_manager_get_initial_pset(MPIDYNRES_manager manager,
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
+static int inc_dec_handle_rc_msg(MPIDYNRES_manager manager,
                                     int src_process_id,
                                     MPI_Info *o_rc_info,
                                     MPIDYNRES_RC_type *o_rc_type,
                                     set_int *o_new_pset) {
   (void) src_process_id;
   inc_dec_manager *mgr = (inc_dec_manager *)manager;
+  set_int *running = &mgr->scheduler->running_crs;
+  int cr = -1;
+
+  *o_rc_info = MPI_INFO_NULL;
+
+  // skip crs that are used by other jobs, turn around if there is none left
+  for (int turns = 0; turns < 2 && cr < 0; turns++) {
+    if (mgr->increasing) {
+      for (int i = mgr->next; i <= mgr->num_processes && cr < 0; i++) {
+        if (set_int_count(running, i) == 0 &&
+            MPIDYNRES_scheduler_cr_is_free(mgr->scheduler, i)) {
+          cr = i;
+        }
+      }
+    } else {
+      for (int i = mgr->next; i >= 2 && cr < 0; i--) {
+        if (set_int_count(running, i) == 1) {
+          cr = i;
+        }
+      }
+    }
+    if (cr < 0) {
+      mgr->increasing = !mgr->increasing;
+      mgr->next = mgr->increasing ? 2 : mgr->num_processes;
+    }
+  }
+
+  if (cr < 0) {
+    *o_rc_type = MPIDYNRES_RC_NONE;
+    return 0;
+  }
 
   if (mgr->increasing) {
     *o_rc_type = MPIDYNRES_RC_ADD;
@@ -152,20 +153,27 @@ int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
   }
 
   *o_new_pset = set_int_init(int_compare);
-  set_int_insert(o_new_pset, mgr->next);
+  set_int_insert(o_new_pset, cr);
 
   // update next
-  if (mgr->increasing && mgr->next == mgr->num_processes) {
+  if (mgr->increasing && cr == mgr->num_processes) {
     mgr->next = mgr->num_processes;
     mgr->increasing = false;
-  } else if (!mgr->increasing && mgr->next == 2){
+  } else if (!mgr->increasing && cr == 2){
     mgr->next = 2;
     mgr->increasing = true;
   } else {
-    mgr->next += (mgr->increasing ? 1 : -1);
+    mgr->next = cr + (mgr->increasing ? 1 : -1);
   }
 
-  *o_rc_info = MPI_INFO_NULL;
-
   return 0;
 }
+
+MPIDYNRES_manager_ops const MPIDYNRES_inc_dec_manager_ops = {
+    .name = "inc_dec",
+    .init = inc_dec_init,
+    .free = inc_dec_free,
+    .register_scheduling_hints = inc_dec_register_scheduling_hints,
+    .get_initial_pset = inc_dec_get_initial_pset,
+    .handle_rc_msg = inc_dec_handle_rc_msg,
+};
@@ -7,6 +7,7 @@
 #define DEFAULT_CHANGE_PROB 1.0
 
 struct random_diff_manager {
+  struct MPIDYNRES_manager_base base;
   MPIDYNRES_scheduler *scheduler;
   int num_processes;
   double std_dev;
@@ -20,17 +21,19 @@ typedef struct random_diff_manager random_diff_manager;
  * @details    Uses the fisher yates shuffle to generate a permutation
  * https://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle
  *
+ * @param      rng_state The state of the random number generator
+ *
  * @param      size Size of buffer
  *
  * @param      buf  The buffer to shuffle
  */
-void gen_perm(size_t size, int buf[size]) {
+static void gen_perm(uint64_t *rng_state, size_t size, int buf[size]) {
   size_t j, tmp;
 
   for (size_t i = 0; i < size; i++) buf[i] = i + 1;
 
   for (size_t i = size - 1; i + 1 > 0; i--) {
-    j = rand() % (i + 1);
+    j = MPIDYNRES_rand(rng_state) % (i + 1);
     tmp = buf[i];
     buf[i] = buf[j];
     buf[j] = tmp;
@@ -47,20 +50,22 @@ void gen_perm(size_t size, int buf[size]) {
  *
  * @param      size the number of elements in the set
  *
- * @param      looking_for_free_ones whether we look for crs not in running_crs
- * or not
+ * @param      looking_for_free_ones whether we look for free crs (not used by
+ * any job) or for crs in running_crs
  */
 static void gen_set(MPIDYNRES_scheduler *scheduler, set_int *set, size_t size,
                     bool looking_for_free_ones) {
   int perm[scheduler->num_scheduling_processes];
   // generate permutations of [1...num_scheduling_processes]
-  gen_perm(scheduler->num_scheduling_processes, perm);
+  gen_perm(&scheduler->rng_state, scheduler->num_scheduling_processes, perm);
   *set = set_int_init(int_compare);
   debug("after set int init: %zu\n", set->size);
   size_t i = 0, count = 0;
   for (; i < (size_t)scheduler->num_scheduling_processes && count < size; i++) {
-    if (!!looking_for_free_ones ^
-        !!(set_int_count(&scheduler->running_crs, perm[i]) == 1)) {
+    bool is_running = set_int_count(&scheduler->running_crs, perm[i]) == 1;
+    bool is_free =
+        !is_running && MPIDYNRES_scheduler_cr_is_free(scheduler, perm[i]);
+    if (looking_for_free_ones ? is_free : is_running) {
       set_int_insert(set, perm[i]);
       count++;
     }
@@ -74,7 +79,7 @@ static void gen_set(MPIDYNRES_scheduler *scheduler, set_int *set, size_t size,
 /*
  * No support yet
  */
-int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
+static int random_diff_register_scheduling_hints(MPIDYNRES_manager manager,
                                                 int src_process_id,
                                                 MPI_Info scheduling_hints,
                                                 MPI_Info *o_answer) {
@@ -92,9 +97,8 @@ int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
  *
  * @return     The new manager object
  */
-MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
+static MPIDYNRES_manager random_diff_init(MPIDYNRES_scheduler *scheduler) {
   double sqrt_2_pi = 0.7978845608028654;  // sqrt(2/pi)
-  int in_there;
   char buf[MPI_MAX_INFO_VAL];
   random_diff_manager *res;
   res = calloc(1, sizeof(random_diff_manager));
@@ -104,33 +108,21 @@ MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
   res->scheduler = scheduler;
   res->num_processes = scheduler->num_scheduling_processes;
 
-  if (scheduler->config->manager_config != MPI_INFO_NULL) {
-    MPI_Info_get(scheduler->config->manager_config, "manager_std_dev",
-                 MPI_MAX_INFO_VAL - 1, buf, &in_there);
-  } else {
-    in_there = 0;
-  }
-  if (in_there) {
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_std_dev", buf)) {
     res->std_dev = strtod(buf, NULL);
   } else {
     res->std_dev = res->num_processes / sqrt_2_pi / 4.0;
   }
 
-  if (scheduler->config->manager_config != MPI_INFO_NULL) {
-    MPI_Info_get(scheduler->config->manager_config, "manager_change_prob",
-                 MPI_MAX_INFO_VAL - 1, buf, &in_there);
-  } else {
-    in_there = 0;
-  }
   res->change_prob = DEFAULT_CHANGE_PROB;
-  if (in_there) {
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_change_prob", buf)) {
     double tmp = strtod(buf, NULL);
     if (0.0 <= tmp && tmp <= 1.0) {
       res->change_prob = tmp;
     }
   }
 
-  return res;
+  return &res->base;
 }
 
 /**
@@ -140,7 +132,7 @@ MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
+static int random_diff_free(MPIDYNRES_manager manager) {
   free(manager);
   return 0;
 }
@@ -148,7 +140,8 @@ int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
 /**
  * @brief      Get initial process set
  *
- * @details    Check for config or default to cr id 1
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids
  *
  * @param      manager The manager used
  *
@@ -156,54 +149,13 @@ int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_get_initial_pset(MPIDYNRES_manager manager,
+static int random_diff_get_initial_pset(MPIDYNRES_manager manager,
                                        set_int *o_initial_pset) {
   random_diff_manager *mgr = (random_diff_manager *)manager;
-  int vlen;
-  int in_there;
-  int num_init = 1;
-  MPI_Info config = mgr->scheduler->config->manager_config;
-
-  if (config == MPI_INFO_NULL) {
-    in_there = false;
-  } else {
-    MPI_Info_get_valuelen(config, "manager_initial_number", &vlen, &in_there);
-  }
-  if (in_there) {
-    char *value = calloc(vlen + 1, sizeof(char));
-    MPI_Info_get(config, "manager_initial_number", vlen, value, &in_there);
-    num_init = atoi(value);
-    free(value);
-    if (num_init < 1 || num_init > mgr->num_processes) {
-      die("Key manager_initial_number is invalid.\n");
-    }
-  } else {
-    if (config == MPI_INFO_NULL) {
-      in_there = false;
-    } else {
-      MPI_Info_get_valuelen(config, "manager_initial_number_random", &vlen,
-                            &in_there);
-    }
-    if (in_there && mgr->num_processes > 1) {
-      num_init = 1 + (rand() % (mgr->num_processes - 1));
-    } else {
-      num_init = 1;
-    }
-  }
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
 
-  // choose num_init random processes
-  int *perm = calloc(num_init, sizeof(int));
-  if (perm == NULL) {
-    die("Memory Error!");
-  }
-  // generate permutations of [1...num_init]
-  gen_perm(num_init, perm);
-
-  *o_initial_pset = set_int_init(int_compare);
-  for (int i = 0; i < num_init; i++) {
-    set_int_insert(o_initial_pset, perm[i]);
-  }
-  free(perm);
+  // the free crs with the lowest ids
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
 
   return 0;
 }
@@ -223,20 +175,21 @@ int MPIDYNRES_manager_get_initial_pset(MPIDYNRES_manager manager,
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
+static int random_diff_handle_rc_msg(MPIDYNRES_manager manager,
                                     int src_process_id, MPI_Info *o_rc_info,
                                     MPIDYNRES_RC_type *o_rc_type,
                                     set_int *o_new_pset) {
   (void)src_process_id;
   random_diff_manager *mgr = (random_diff_manager *)manager;
+  uint64_t *rng_state = &mgr->scheduler->rng_state;
   int num_running = mgr->scheduler->running_crs.size;
-  int num_free = mgr->scheduler->num_scheduling_processes - num_running;
+  int num_free = MPIDYNRES_scheduler_num_free(mgr->scheduler);
   debug("Num running: %d num free: %d\n", num_running, num_free);
 
-  if ((double)rand() / (double)RAND_MAX < mgr->change_prob) {
+  if (MPIDYNRES_rand_double(rng_state) <= mgr->change_prob) {
     // box mueller normal approx
-    double u1 = (double)rand() / (double)RAND_MAX;
-    double u2 = (double)rand() / (double)RAND_MAX;
+    double u1 = MPIDYNRES_rand_double(rng_state);
+    double u2 = MPIDYNRES_rand_double(rng_state);
     double val = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2) * mgr->std_dev;
     int res = round(val);
 
@@ -269,3 +222,12 @@ int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
 
   return 0;
 }
+
+MPIDYNRES_manager_ops const MPIDYNRES_random_diff_manager_ops = {
+    .name = "random_diff",
+    .init = random_diff_init,
+    .free = random_diff_free,
+    .register_scheduling_hints = random_diff_register_scheduling_hints,
+    .get_initial_pset = random_diff_get_initial_pset,
+    .handle_rc_msg = random_diff_handle_rc_msg,
+};
@@ -0,0 +1,319 @@
+#include <errno.h>
+#include <string.h>
+
+#include "logging.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/**
+ * @brief      A decision read from a decision trace
+ */
+struct replay_record {
+  MPIDYNRES_RC_type type;
+  bool initial;  ///< whether this is the initial process set of the job
+  int size;
+  int *crs;
+};
+typedef struct replay_record replay_record;
+
+struct replay_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+  int num_records;
+  replay_record *records;
+  int next_record;  ///< the record returned by the next resource change
+};
+typedef struct replay_manager replay_manager;
+
+/**
+ * @brief      Parse one line of a decision trace
+ *
+ * @param      line The line
+ *
+ * @param      job_id Only records of this job are accepted
+ *
+ * @param      o_record The record is returned here, crs has to be freed
+ *
+ * @return     true if the line contains a record of the job
+ */
+static bool parse_record(char const *line, int job_id,
+                         replay_record *o_record) {
+  char type[16];
+  double time;
+  int job, cr, size, pos;
+
+  if (line[0] == '#' ||
+      sscanf(line, "%lf %d %d %15s %d%n", &time, &job, &cr, type, &size,
+             &pos) != 5 ||
+      job != job_id) {
+    return false;
+  }
+  if (size < 0) {
+    die("Invalid record in decision trace: %s", line);
+  }
+
+  o_record->initial = strcmp(type, DECISION_TRACE_INIT) == 0;
+  if (o_record->initial || strcmp(type, "none") == 0) {
+    o_record->type = MPIDYNRES_RC_NONE;
+  } else if (strcmp(type, "add") == 0) {
+    o_record->type = MPIDYNRES_RC_ADD;
+  } else if (strcmp(type, "sub") == 0) {
+    o_record->type = MPIDYNRES_RC_SUB;
+  } else {
+    die("Unknown type %s in decision trace\n", type);
+  }
+
+  o_record->size = size;
+  o_record->crs = calloc(size + 1, sizeof(int));
+  if (o_record->crs == NULL) {
+    die("Memory Error\n");
+  }
+  line += pos;
+  for (int i = 0; i < size; i++) {
+    char *end;
+    o_record->crs[i] = strtol(line, &end, 10);
+    if (end == line) {
+      die("Decision trace record is missing crs\n");
+    }
+    line = end;
+  }
+  return true;
+}
+
+/**
+ * @brief      Read the records of a job from a decision trace
+ *
+ * @param      mgr The manager
+ *
+ * @param      path The path of the trace
+ */
+static void load_trace(replay_manager *mgr, char const *path) {
+  FILE *f = fopen(path, "r");
+  char *line = NULL;
+  size_t line_size = 0;
+  replay_record record;
+
+  if (f == NULL) {
+    die("Failed to open decision trace %s: %s\n", path, strerror(errno));
+  }
+  while (getline(&line, &line_size, f) != -1) {
+    if (!parse_record(line, mgr->scheduler->job_id, &record)) {
+      continue;
+    }
+    mgr->records = realloc(mgr->records,
+                           (mgr->num_records + 1) * sizeof(replay_record));
+    if (mgr->records == NULL) {
+      die("Memory Error\n");
+    }
+    mgr->records[mgr->num_records++] = record;
+  }
+  free(line);
+  fclose(f);
+}
+
+/**
+ * @brief      Check whether the crs of a record can be used
+ *
+ * @param      mgr The manager
+ *
+ * @param      record The record
+ *
+ * @param      free_ones whether the crs have to be free or running
+ *
+ * @return     true if all crs are valid
+ */
+static bool record_is_valid(replay_manager *mgr, replay_record *record,
+                            bool free_ones) {
+  MPIDYNRES_scheduler *scheduler = mgr->scheduler;
+
+  for (int i = 0; i < record->size; i++) {
+    int cr = record->crs[i];
+    if (cr < 1 || cr > scheduler->num_scheduling_processes) {
+      return false;
+    }
+    bool is_running = set_int_count(&scheduler->running_crs, cr) == 1;
+    bool is_free = !is_running && MPIDYNRES_scheduler_cr_is_free(scheduler, cr);
+    if (free_ones ? !is_free : !is_running) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief      Copy the crs of a record into a set
+ *
+ * @param      record The record
+ *
+ * @param      o_pset The set is returned here
+ */
+static void record_to_set(replay_record *record, set_int *o_pset) {
+  *o_pset = set_int_init(int_compare);
+  for (int i = 0; i < record->size; i++) {
+    set_int_insert(o_pset, record->crs[i]);
+  }
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @details    Reads the records of this job from the decision trace given by
+ * manager_replay_file. The size of the initial process set is taken from the
+ * trace.
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+static MPIDYNRES_manager replay_init(MPIDYNRES_scheduler *scheduler) {
+  char buf[MPI_MAX_INFO_VAL];
+  replay_manager *res;
+  res = calloc(1, sizeof(replay_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->scheduler = scheduler;
+
+  if (!MPIDYNRES_manager_config_get(scheduler, "manager_replay_file", buf)) {
+    die("The replay manager needs the key manager_replay_file\n");
+  }
+  load_trace(res, buf);
+  debug("Replay manager: %d decisions of job %d in %s\n", res->num_records,
+        scheduler->job_id, buf);
+
+  if (res->num_records > 0 && res->records[0].initial) {
+    if (res->records[0].size < 1 ||
+        res->records[0].size > scheduler->num_scheduling_processes) {
+      die("Invalid initial process set in decision trace\n");
+    }
+    scheduler->initial_size = res->records[0].size;
+  }
+
+  return &res->base;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int replay_free(MPIDYNRES_manager manager) {
+  replay_manager *mgr = (replay_manager *)manager;
+  for (int i = 0; i < mgr->num_records; i++) {
+    free(mgr->records[i].crs);
+  }
+  free(mgr->records);
+  free(mgr);
+  return 0;
+}
+
+/*
+ * The recorded decisions already contain the reaction to the hints
+ */
+static int replay_register_scheduling_hints(MPIDYNRES_manager manager,
+                                            int src_process_id,
+                                            MPI_Info scheduling_hints,
+                                            MPI_Info *o_answer) {
+  (void)manager;
+  (void)src_process_id;
+  (void)scheduling_hints;
+  *o_answer = MPI_INFO_NULL;
+  return 0;
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @details    Uses the recorded initial process set. If there is none or its
+ * crs are not free, the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids are used.
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int replay_get_initial_pset(MPIDYNRES_manager manager,
+                                   set_int *o_initial_pset) {
+  replay_manager *mgr = (replay_manager *)manager;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
+
+  if (mgr->num_records > 0 && mgr->records[0].initial) {
+    mgr->next_record = 1;
+    if (record_is_valid(mgr, &mgr->records[0], true)) {
+      record_to_set(&mgr->records[0], o_initial_pset);
+      return 0;
+    }
+    log_warn("Warning: recorded initial process set of job %d is not free\n",
+          mgr->scheduler->job_id);
+  }
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
+  return 0;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    Returns the recorded decisions in the order they were made, the
+ * recorded times and crs that asked are ignored. Once the trace is exhausted,
+ * or if a recorded decision does not fit the current state (e.g. a cr to be
+ * added is not free), RC_NONE is returned.
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int replay_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                                MPI_Info *o_rc_info,
+                                MPIDYNRES_RC_type *o_rc_type,
+                                set_int *o_new_pset) {
+  (void)src_process_id;
+  replay_manager *mgr = (replay_manager *)manager;
+  replay_record *record;
+
+  *o_rc_info = MPI_INFO_NULL;
+  *o_rc_type = MPIDYNRES_RC_NONE;
+
+  // skip initial process sets of a trace with several starts of the job
+  while (mgr->next_record < mgr->num_records &&
+         mgr->records[mgr->next_record].initial) {
+    mgr->next_record++;
+  }
+  if (mgr->next_record == mgr->num_records) {
+    return 0;
+  }
+  record = &mgr->records[mgr->next_record++];
+
+  if (record->type == MPIDYNRES_RC_NONE || record->size == 0) {
+    return 0;
+  }
+  if (!record_is_valid(mgr, record, record->type == MPIDYNRES_RC_ADD)) {
+    log_warn("Warning: recorded decision %d of job %d does not fit, skipping\n",
+          mgr->next_record - 1, mgr->scheduler->job_id);
+    return 0;
+  }
+  *o_rc_type = record->type;
+  record_to_set(record, o_new_pset);
+  return 0;
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_replay_manager_ops = {
+    .name = "replay",
+    .init = replay_init,
+    .free = replay_free,
+    .register_scheduling_hints = replay_register_scheduling_hints,
+    .get_initial_pset = replay_get_initial_pset,
+    .handle_rc_msg = replay_handle_rc_msg,
+};
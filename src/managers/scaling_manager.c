@@ -0,0 +1,488 @@
+#include <math.h>
+#include <string.h>
+
+#include "logging.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/*
+ * Keys of the scheduling hints passed with MPIDYNRES_add_scheduling_hints
+ */
+#define HINT_ITER_TIME "mpidynres_iter_time"
+#define HINT_SERIAL_TIME "mpidynres_serial_time"
+#define HINT_MIN_PROCS "mpidynres_min_procs"
+#define HINT_MAX_PROCS "mpidynres_max_procs"
+#define HINT_PREFERRED_PROCS "mpidynres_preferred_procs"
+#define HINT_SCALING_MODEL "mpidynres_scaling_model"
+
+/*
+ * Keys of the answer
+ */
+#define ANSWER_SERIAL_FRACTION "mpidynres_serial_fraction"
+#define ANSWER_TARGET_PROCS "mpidynres_target_procs"
+
+#define DEFAULT_MIN_EFFICIENCY 0.5
+
+/**
+ * @brief      How the problem size changes with the number of processes
+ */
+enum scaling_model {
+  AMDAHL = 0,  ///< fixed problem size (strong scaling)
+  GUSTAFSON,   ///< problem size grows with the processes (weak scaling)
+};
+
+/**
+ * @brief      The measurements reported for one number of processes
+ */
+struct size_sample {
+  double iter_time_sum;
+  int iter_time_count;
+  double serial_time_sum;
+  int serial_time_count;
+};
+
+struct scaling_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+  int num_processes;
+  double min_efficiency;
+
+  enum scaling_model model;
+  int min_procs;
+  int max_procs;
+  int preferred_procs;  ///< 0 if not given
+  bool auto_standby;    ///< manager_standby is "auto"
+
+  struct size_sample *samples;  ///< indexed by the number of processes
+};
+typedef struct scaling_manager scaling_manager;
+
+/**
+ * @brief      Estimate the serial fraction of the application
+ *
+ * @details    If the application reports the time spent in serial parts, the
+ * fraction is averaged over all sizes the time was reported for. Otherwise,
+ * for Amdahl's law, iter_time = a + b / p is fitted with least squares over
+ * all sizes and the serial fraction is a / (a + b). For Amdahl's law the
+ * fraction is relative to the execution on a single process, for Gustafson's
+ * law relative to the parallel execution.
+ *
+ * @param      mgr The manager
+ *
+ * @param      o_serial_fraction The estimated fraction is returned here
+ *
+ * @return     whether there were enough samples for an estimate
+ */
+static bool estimate_serial_fraction(scaling_manager *mgr,
+                                     double *o_serial_fraction) {
+  double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0, sum = 0.0;
+  int n = 0;
+
+  for (int p = 1; p <= mgr->num_processes; p++) {
+    struct size_sample *s = &mgr->samples[p];
+    if (s->serial_time_count == 0 || s->iter_time_count == 0) {
+      continue;
+    }
+    double t = s->iter_time_sum / s->iter_time_count;
+    double serial = s->serial_time_sum / s->serial_time_count;
+    if (t <= 0.0 || serial < 0.0 || serial > t) {
+      continue;
+    }
+    if (mgr->model == AMDAHL) {
+      sum += serial / (serial + (t - serial) * p);
+    } else {
+      sum += serial / t;
+    }
+    n++;
+  }
+  if (n > 0) {
+    *o_serial_fraction = sum / n;
+    return true;
+  }
+
+  if (mgr->model != AMDAHL) {
+    return false;
+  }
+
+  for (int p = 1; p <= mgr->num_processes; p++) {
+    struct size_sample *s = &mgr->samples[p];
+    if (s->iter_time_count == 0) {
+      continue;
+    }
+    double x = 1.0 / p;
+    double y = s->iter_time_sum / s->iter_time_count;
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+    n++;
+  }
+  if (n < 2) {
+    return false;
+  }
+  double b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+  double a = (sy - b * sx) / n;
+  // clamp to a valid model
+  a = a < 0.0 ? 0.0 : a;
+  b = b < 0.0 ? 0.0 : b;
+  if (a + b <= 0.0) {
+    return false;
+  }
+  *o_serial_fraction = a / (a + b);
+  return true;
+}
+
+/**
+ * @brief      Get the largest number of processes that keeps the parallel
+ * efficiency above min_efficiency
+ *
+ * @details    Amdahl: E(p) = 1 / (s * p + 1 - s)
+ *             Gustafson: E(p) = 1 - s + s / p
+ *
+ * @param      mgr The manager
+ *
+ * @param      serial_fraction The serial fraction s of the application
+ *
+ * @return     The number of processes (not clamped)
+ */
+static double efficient_size(scaling_manager *mgr, double serial_fraction) {
+  double s = serial_fraction;
+  double e = mgr->min_efficiency;
+
+  if (s <= 0.0) {
+    return mgr->num_processes;
+  }
+  if (mgr->model == AMDAHL) {
+    return 1.0 + (1.0 / e - 1.0) / s;
+  }
+  if (e <= 1.0 - s) {
+    return mgr->num_processes;
+  }
+  return s / (e - 1.0 + s);
+}
+
+/**
+ * @brief      Get the number of sizes iteration times were reported for
+ *
+ * @param      mgr The manager
+ *
+ * @return     The number of sizes
+ */
+static int num_sampled_sizes(scaling_manager *mgr) {
+  int res = 0;
+  for (int p = 1; p <= mgr->num_processes; p++) {
+    res += mgr->samples[p].iter_time_count > 0;
+  }
+  return res;
+}
+
+/**
+ * @brief      Get the number of processes the manager is heading for
+ *
+ * @details    Without an estimate of the serial fraction, the preferred size
+ * is used. Otherwise, for Amdahl's law, the job is moved by one process to get
+ * a second size for the fit. Gustafson's law can only be estimated from the
+ * serial time hint, without it the job keeps its size.
+ *
+ * @param      mgr The manager
+ *
+ * @param      o_serial_fraction The estimated serial fraction is returned here
+ * or NAN if there is no estimate yet
+ *
+ * @return     The target number of processes
+ */
+static int target_size(scaling_manager *mgr, double *o_serial_fraction) {
+  int current = mgr->scheduler->running_crs.size;
+  int lower = mgr->min_procs;
+  int upper = mgr->max_procs;
+  double serial_fraction;
+  int target;
+
+  if (estimate_serial_fraction(mgr, &serial_fraction)) {
+    *o_serial_fraction = serial_fraction;
+    // a tiny serial fraction gives a huge size, clamp before the cast
+    double size = efficient_size(mgr, serial_fraction);
+    size = size < lower ? lower : size;
+    size = size > upper ? upper : size;
+    // the fit is not exact in floating point
+    target = (int)floor(size + 1e-6);
+  } else {
+    *o_serial_fraction = NAN;
+    if (mgr->preferred_procs > 0) {
+      target = mgr->preferred_procs;
+    } else if (mgr->model == AMDAHL &&
+               mgr->samples[current].iter_time_count > 0 &&
+               num_sampled_sizes(mgr) < 2) {
+      // explore, we need a second size to fit the model
+      target = current < upper ? current + 1 : current - 1;
+    } else {
+      target = current;
+    }
+  }
+
+  target = target < lower ? lower : target;
+  target = target > upper ? upper : target;
+  return target;
+}
+
+/**
+ * @brief      Read an integer hint
+ *
+ * @param      hints The hints
+ *
+ * @param      key The key
+ *
+ * @param      o_value The value is returned here, if the key is set
+ */
+static void get_int_hint(MPI_Info hints, char const *key, int *o_value) {
+  char buf[MPI_MAX_INFO_VAL];
+  int in_there;
+
+  MPI_Info_get(hints, key, MPI_MAX_INFO_VAL - 1, buf, &in_there);
+  if (in_there) {
+    *o_value = atoi(buf);
+  }
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+static MPIDYNRES_manager scaling_init(MPIDYNRES_scheduler *scheduler) {
+  char buf[MPI_MAX_INFO_VAL];
+  scaling_manager *res;
+  res = calloc(1, sizeof(scaling_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->scheduler = scheduler;
+  res->num_processes = scheduler->num_scheduling_processes;
+  res->samples = calloc(res->num_processes + 1, sizeof(struct size_sample));
+  if (res->samples == NULL) {
+    die("Memory Error\n");
+  }
+
+  res->model = AMDAHL;
+  res->min_procs = 1;
+  res->max_procs = res->num_processes;
+  res->preferred_procs = 0;
+
+  res->auto_standby =
+      MPIDYNRES_manager_config_get(scheduler, MANAGER_STANDBY_KEY, buf) &&
+      strcmp(buf, "auto") == 0;
+
+  res->min_efficiency = DEFAULT_MIN_EFFICIENCY;
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_min_efficiency", buf)) {
+    double tmp = strtod(buf, NULL);
+    if (0.0 < tmp && tmp <= 1.0) {
+      res->min_efficiency = tmp;
+    }
+  }
+
+  return &res->base;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int scaling_free(MPIDYNRES_manager manager) {
+  scaling_manager *mgr = (scaling_manager *)manager;
+  free(mgr->samples);
+  free(mgr);
+  return 0;
+}
+
+/**
+ * @brief      Register performance hints of the application
+ *
+ * @details    The iteration time (and optionally the time spent in serial
+ * parts of an iteration) is recorded for the current number of running crs.
+ * min/max/preferred number of processes and the scaling model ("amdahl" or
+ * "gustafson") are kept until they are changed. The answer contains the
+ * current estimate of the serial fraction and the target number of
+ * processes. With manager_standby set to "auto", the crs missing to the
+ * target are kept warmed up for the job.
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      scheduling_hints The hints
+ *
+ * @param      o_answer The answer is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int scaling_register_scheduling_hints(MPIDYNRES_manager manager,
+                                             int src_process_id,
+                                             MPI_Info scheduling_hints,
+                                             MPI_Info *o_answer) {
+  (void)src_process_id;
+  scaling_manager *mgr = (scaling_manager *)manager;
+  int current = mgr->scheduler->running_crs.size;
+  char buf[MPI_MAX_INFO_VAL];
+  int in_there;
+
+  *o_answer = MPI_INFO_NULL;
+  if (scheduling_hints == MPI_INFO_NULL) {
+    return 0;
+  }
+
+  // validate all hints before applying them, bad hints change nothing
+  enum scaling_model model = mgr->model;
+  int min_procs = mgr->min_procs;
+  int max_procs = mgr->max_procs;
+  int preferred_procs = mgr->preferred_procs;
+
+  MPI_Info_get(scheduling_hints, HINT_SCALING_MODEL, MPI_MAX_INFO_VAL - 1, buf,
+               &in_there);
+  if (in_there) {
+    if (strcmp(buf, "amdahl") == 0) {
+      model = AMDAHL;
+    } else if (strcmp(buf, "gustafson") == 0) {
+      model = GUSTAFSON;
+    } else {
+      return 1;
+    }
+  }
+
+  get_int_hint(scheduling_hints, HINT_MIN_PROCS, &min_procs);
+  get_int_hint(scheduling_hints, HINT_MAX_PROCS, &max_procs);
+  get_int_hint(scheduling_hints, HINT_PREFERRED_PROCS, &preferred_procs);
+  if (min_procs < 1) {
+    min_procs = 1;
+  }
+  if (max_procs > mgr->num_processes || max_procs < 1) {
+    max_procs = mgr->num_processes;
+  }
+  if (min_procs > max_procs) {
+    return 1;
+  }
+  mgr->model = model;
+  mgr->min_procs = min_procs;
+  mgr->max_procs = max_procs;
+  mgr->preferred_procs = preferred_procs;
+
+  if (current >= 1) {
+    struct size_sample *s = &mgr->samples[current];
+    MPI_Info_get(scheduling_hints, HINT_ITER_TIME, MPI_MAX_INFO_VAL - 1, buf,
+                 &in_there);
+    if (in_there) {
+      s->iter_time_sum += strtod(buf, NULL);
+      s->iter_time_count++;
+    }
+    MPI_Info_get(scheduling_hints, HINT_SERIAL_TIME, MPI_MAX_INFO_VAL - 1, buf,
+                 &in_there);
+    if (in_there) {
+      s->serial_time_sum += strtod(buf, NULL);
+      s->serial_time_count++;
+    }
+  }
+
+  double serial_fraction;
+  int target = target_size(mgr, &serial_fraction);
+  if (mgr->auto_standby) {
+    int missing = target > current ? target - current : 0;
+    MPIDYNRES_scheduler_set_standby_size(mgr->scheduler, missing);
+  }
+  MPI_Info_create(o_answer);
+  if (!isnan(serial_fraction)) {
+    snprintf(buf, COUNT_OF(buf), "%f", serial_fraction);
+    MPI_Info_set(*o_answer, ANSWER_SERIAL_FRACTION, buf);
+  }
+  snprintf(buf, COUNT_OF(buf), "%d", target);
+  MPI_Info_set(*o_answer, ANSWER_TARGET_PROCS, buf);
+
+  return 0;
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int scaling_get_initial_pset(MPIDYNRES_manager manager,
+                                    set_int *o_initial_pset) {
+  scaling_manager *mgr = (scaling_manager *)manager;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
+
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
+  return 0;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    Adds or removes crs (see MPIDYNRES_manager_pick_crs) to reach
+ * the target number of processes, as far as there are free crs
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int scaling_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                                 MPI_Info *o_rc_info,
+                                 MPIDYNRES_RC_type *o_rc_type,
+                                 set_int *o_new_pset) {
+  (void)src_process_id;
+  scaling_manager *mgr = (scaling_manager *)manager;
+  int current = mgr->scheduler->running_crs.size;
+  double serial_fraction;
+  int target = target_size(mgr, &serial_fraction);
+
+  debug("Scaling manager: %d running, target %d\n", current, target);
+
+  *o_rc_info = MPI_INFO_NULL;
+  if (target == current) {
+    *o_rc_type = MPIDYNRES_RC_NONE;
+    return 0;
+  }
+
+  if (target > current) {
+    *o_rc_type = MPIDYNRES_RC_ADD;
+    MPIDYNRES_manager_pick_crs(mgr->scheduler, target - current, true,
+                               o_new_pset);
+    // the other jobs may use all free crs
+    if (o_new_pset->size == 0) {
+      set_int_free(o_new_pset);
+      *o_rc_type = MPIDYNRES_RC_NONE;
+    }
+  } else {
+    *o_rc_type = MPIDYNRES_RC_SUB;
+    MPIDYNRES_manager_pick_crs(mgr->scheduler, current - target, false,
+                               o_new_pset);
+  }
+  return 0;
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_scaling_manager_ops = {
+    .name = "scaling",
+    .init = scaling_init,
+    .free = scaling_free,
+    .register_scheduling_hints = scaling_register_scheduling_hints,
+    .get_initial_pset = scaling_get_initial_pset,
+    .handle_rc_msg = scaling_handle_rc_msg,
+};
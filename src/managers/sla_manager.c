@@ -0,0 +1,300 @@
+#include <math.h>
+
+#include "logging.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/*
+ * Keys of the scheduling hints passed with MPIDYNRES_add_scheduling_hints
+ */
+#define HINT_TARGET_TIME "mpidynres_target_time"
+#define HINT_ITER_TIME "mpidynres_iter_time"
+
+/*
+ * Keys of the answer
+ */
+#define ANSWER_TARGET_PROCS "mpidynres_target_procs"
+
+#define DEFAULT_KP 1.0
+#define DEFAULT_KI 0.2
+#define DEFAULT_KD 0.0
+#define DEFAULT_DEADBAND 0.1
+#define DEFAULT_COOLDOWN 2
+#define DEFAULT_MAX_STEP 2
+
+struct sla_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+  int num_processes;
+
+  // config
+  double kp, ki, kd;
+  double deadband;  ///< relative error that is tolerated
+  int cooldown;     ///< iteration time reports ignored after a change
+  int max_step;     ///< maximum number of crs added or removed at once
+
+  // controller state
+  double target_time;  ///< 0 if not given
+  double integral;
+  double prev_error;
+  int cooldown_left;
+  int pending_delta;  ///< change decided by the controller, not yet issued
+};
+typedef struct sla_manager sla_manager;
+
+/**
+ * @brief      Read a double from the manager config
+ *
+ * @param      scheduler The scheduler
+ *
+ * @param      key The key
+ *
+ * @param      default_value Returned if the key is not set
+ *
+ * @return     The value
+ */
+static double config_double(MPIDYNRES_scheduler *scheduler, char const *key,
+                            double default_value) {
+  char buf[MPI_MAX_INFO_VAL];
+  if (MPIDYNRES_manager_config_get(scheduler, key, buf)) {
+    return strtod(buf, NULL);
+  }
+  return default_value;
+}
+
+/**
+ * @brief      Feed a new iteration time into the controller
+ *
+ * @details    The relative error e = (iter_time - target) / target is fed into
+ * a PID controller, its output is scaled by the number of running crs. Errors
+ * inside the dead band and measurements during the cooldown after a change do
+ * not cause a change.
+ *
+ * @param      mgr The manager
+ *
+ * @param      iter_time The measured time per iteration
+ */
+static void controller_update(sla_manager *mgr, double iter_time) {
+  int current = mgr->scheduler->running_crs.size;
+  int num_free = MPIDYNRES_scheduler_num_free(mgr->scheduler);
+
+  if (mgr->cooldown_left > 0) {
+    mgr->cooldown_left--;
+    return;
+  }
+
+  double error = (iter_time - mgr->target_time) / mgr->target_time;
+  double derivative = error - mgr->prev_error;
+  mgr->prev_error = error;
+  if (fabs(error) <= mgr->deadband) {
+    mgr->pending_delta = 0;
+    return;
+  }
+
+  // anti windup, the integral term alone may at most double or halve
+  mgr->integral += error;
+  if (mgr->ki > 0.0 && fabs(mgr->integral) * mgr->ki > 1.0) {
+    mgr->integral = copysign(1.0 / mgr->ki, mgr->integral);
+  }
+
+  double output =
+      mgr->kp * error + mgr->ki * mgr->integral + mgr->kd * derivative;
+  int delta = (int)lround(output * current);
+  if (delta == 0) {
+    delta = error > 0.0 ? 1 : -1;
+  }
+
+  delta = delta > mgr->max_step ? mgr->max_step : delta;
+  delta = delta < -mgr->max_step ? -mgr->max_step : delta;
+  delta = delta > num_free ? num_free : delta;
+  delta = current + delta < 1 ? 1 - current : delta;
+
+  debug("SLA manager: error %f, output %f, delta %d\n", error, output, delta);
+  mgr->pending_delta = delta;
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+static MPIDYNRES_manager sla_init(MPIDYNRES_scheduler *scheduler) {
+  sla_manager *res;
+  res = calloc(1, sizeof(sla_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->scheduler = scheduler;
+  res->num_processes = scheduler->num_scheduling_processes;
+
+  res->kp = config_double(scheduler, "manager_kp", DEFAULT_KP);
+  res->ki = config_double(scheduler, "manager_ki", DEFAULT_KI);
+  res->kd = config_double(scheduler, "manager_kd", DEFAULT_KD);
+  res->deadband = config_double(scheduler, "manager_deadband", DEFAULT_DEADBAND);
+  res->cooldown =
+      (int)config_double(scheduler, "manager_cooldown", DEFAULT_COOLDOWN);
+  res->max_step =
+      (int)config_double(scheduler, "manager_max_step", DEFAULT_MAX_STEP);
+  if (res->deadband < 0.0 || res->cooldown < 0 || res->max_step < 1) {
+    die("Invalid manager_deadband, manager_cooldown or manager_max_step\n");
+  }
+
+  return &res->base;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int sla_free(MPIDYNRES_manager manager) {
+  free(manager);
+  return 0;
+}
+
+/**
+ * @brief      Register the target and measured iteration time
+ *
+ * @details    mpidynres_target_time sets the target time per iteration,
+ * every mpidynres_iter_time is fed into the controller. The answer contains
+ * the number of processes the controller is heading for.
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      scheduling_hints The hints
+ *
+ * @param      o_answer The answer is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int sla_register_scheduling_hints(MPIDYNRES_manager manager,
+                                         int src_process_id,
+                                         MPI_Info scheduling_hints,
+                                         MPI_Info *o_answer) {
+  (void)src_process_id;
+  sla_manager *mgr = (sla_manager *)manager;
+  char buf[MPI_MAX_INFO_VAL];
+  int in_there;
+
+  *o_answer = MPI_INFO_NULL;
+  if (scheduling_hints == MPI_INFO_NULL) {
+    return 0;
+  }
+
+  MPI_Info_get(scheduling_hints, HINT_TARGET_TIME, MPI_MAX_INFO_VAL - 1, buf,
+               &in_there);
+  if (in_there) {
+    double target_time = strtod(buf, NULL);
+    if (target_time <= 0.0) {
+      return 1;
+    }
+    if (target_time != mgr->target_time) {
+      mgr->target_time = target_time;
+      mgr->integral = 0.0;
+      mgr->prev_error = 0.0;
+    }
+  }
+
+  MPI_Info_get(scheduling_hints, HINT_ITER_TIME, MPI_MAX_INFO_VAL - 1, buf,
+               &in_there);
+  if (in_there && mgr->target_time > 0.0) {
+    controller_update(mgr, strtod(buf, NULL));
+  }
+
+  MPI_Info_create(o_answer);
+  snprintf(buf, COUNT_OF(buf), "%d",
+           (int)mgr->scheduler->running_crs.size + mgr->pending_delta);
+  MPI_Info_set(*o_answer, ANSWER_TARGET_PROCS, buf);
+
+  return 0;
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int sla_get_initial_pset(MPIDYNRES_manager manager,
+                                set_int *o_initial_pset) {
+  sla_manager *mgr = (sla_manager *)manager;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
+
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
+  return 0;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    Issues the change decided by the controller and starts the
+ * cooldown
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int sla_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                             MPI_Info *o_rc_info, MPIDYNRES_RC_type *o_rc_type,
+                             set_int *o_new_pset) {
+  (void)src_process_id;
+  sla_manager *mgr = (sla_manager *)manager;
+  int delta = mgr->pending_delta;
+
+  *o_rc_info = MPI_INFO_NULL;
+  if (delta == 0) {
+    *o_rc_type = MPIDYNRES_RC_NONE;
+    return 0;
+  }
+
+  if (delta > 0) {
+    *o_rc_type = MPIDYNRES_RC_ADD;
+    MPIDYNRES_manager_pick_crs(mgr->scheduler, delta, true, o_new_pset);
+    // the other jobs may use all free crs, try again on the next query
+    if (o_new_pset->size == 0) {
+      set_int_free(o_new_pset);
+      *o_rc_type = MPIDYNRES_RC_NONE;
+      return 0;
+    }
+  } else {
+    *o_rc_type = MPIDYNRES_RC_SUB;
+    MPIDYNRES_manager_pick_crs(mgr->scheduler, -delta, false, o_new_pset);
+  }
+
+  // the job changed, start over
+  mgr->pending_delta = 0;
+  mgr->cooldown_left = mgr->cooldown;
+  mgr->integral = 0.0;
+  mgr->prev_error = 0.0;
+  return 0;
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_sla_manager_ops = {
+    .name = "sla",
+    .init = sla_init,
+    .free = sla_free,
+    .register_scheduling_hints = sla_register_scheduling_hints,
+    .get_initial_pset = sla_get_initial_pset,
+    .handle_rc_msg = sla_handle_rc_msg,
+};
@@ -0,0 +1,217 @@
+#include <string.h>
+
+#include "logging.h"
+#include "scheduler.h"
+#include "scheduler_datatypes.h"
+#include "scheduler_mgmt.h"
+#include "util.h"
+
+/**
+ * @brief      A planned change of the number of crs
+ */
+struct timed_change {
+  double time;  ///< seconds after the start of the job
+  int delta;    ///< crs to add (> 0) or remove (< 0)
+};
+typedef struct timed_change timed_change;
+
+struct timed_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+  int num_changes;
+  timed_change *changes;
+};
+typedef struct timed_manager timed_manager;
+
+/**
+ * @brief      Parse the planned changes
+ *
+ * @details    The format is a comma separated list of time:delta, e.g.
+ * "1.5:2,3:-1" adds two crs 1.5 seconds after the start of the job and
+ * removes one after 3 seconds
+ *
+ * @param      mgr The manager
+ *
+ * @param      value The value of manager_changes
+ */
+static void parse_changes(timed_manager *mgr, char const *value) {
+  char const *pos = value;
+
+  while (*pos != '\0') {
+    timed_change change;
+    int len;
+    if (sscanf(pos, " %lf : %d %n", &change.time, &change.delta, &len) != 2 ||
+        change.time < 0.0) {
+      die("Invalid manager_changes: %s\n", value);
+    }
+    mgr->changes = realloc(mgr->changes,
+                           (mgr->num_changes + 1) * sizeof(timed_change));
+    if (mgr->changes == NULL) {
+      die("Memory Error\n");
+    }
+    mgr->changes[mgr->num_changes++] = change;
+    pos += len;
+    if (*pos == ',') {
+      pos++;
+    } else if (*pos != '\0') {
+      die("Invalid manager_changes: %s\n", value);
+    }
+  }
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @details    Reads the planned changes from manager_changes
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+static MPIDYNRES_manager timed_init(MPIDYNRES_scheduler *scheduler) {
+  char buf[MPI_MAX_INFO_VAL];
+  timed_manager *res;
+  res = calloc(1, sizeof(timed_manager));
+  if (res == NULL) {
+    die("Memory Error\n");
+  }
+  res->scheduler = scheduler;
+
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_changes", buf)) {
+    parse_changes(res, buf);
+  }
+  debug("Timed manager: %d changes for job %d\n", res->num_changes,
+        scheduler->job_id);
+
+  return &res->base;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+static int timed_free(MPIDYNRES_manager manager) {
+  timed_manager *mgr = (timed_manager *)manager;
+  free(mgr->changes);
+  free(mgr);
+  return 0;
+}
+
+/*
+ * The changes are planned ahead, hints are ignored
+ */
+static int timed_register_scheduling_hints(MPIDYNRES_manager manager,
+                                           int src_process_id,
+                                           MPI_Info scheduling_hints,
+                                           MPI_Info *o_answer) {
+  (void)manager;
+  (void)src_process_id;
+  (void)scheduling_hints;
+  *o_answer = MPI_INFO_NULL;
+  return 0;
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @details    Uses the MPIDYNRES_manager_initial_number free crs with the
+ * lowest ids and sets a timer for every planned change
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int timed_get_initial_pset(MPIDYNRES_manager manager,
+                                  set_int *o_initial_pset) {
+  timed_manager *mgr = (timed_manager *)manager;
+  int num_init = MPIDYNRES_manager_initial_number(mgr->scheduler);
+
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, num_init, true, o_initial_pset);
+  for (int i = 0; i < mgr->num_changes; i++) {
+    MPIDYNRES_scheduler_add_timer(mgr->scheduler, mgr->changes[i].time, i);
+  }
+  return 0;
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @details    The decisions are made by the timers, so the manager is only
+ * asked when there is nothing to change
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+static int timed_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                               MPI_Info *o_rc_info,
+                               MPIDYNRES_RC_type *o_rc_type,
+                               set_int *o_new_pset) {
+  (void)manager;
+  (void)src_process_id;
+  (void)o_new_pset;
+  *o_rc_info = MPI_INFO_NULL;
+  *o_rc_type = MPIDYNRES_RC_NONE;
+  return 0;
+}
+
+/**
+ * @brief      Stage a planned change
+ *
+ * @details    Adds as many of the planned crs as are free, or removes as many
+ * as possible while keeping one cr running. The change is returned by the
+ * next resource change query of the job.
+ *
+ * @param      manager The manager used
+ *
+ * @param      timer_id The index of the planned change
+ *
+ * @return     if != 0, an error occured
+ */
+static int timed_handle_timer(MPIDYNRES_manager manager, int timer_id) {
+  timed_manager *mgr = (timed_manager *)manager;
+  MPIDYNRES_scheduler *scheduler = mgr->scheduler;
+  int delta = mgr->changes[timer_id].delta;
+  set_int pset;
+
+  if (delta > 0) {
+    MPIDYNRES_manager_pick_crs(scheduler, delta, true, &pset);
+    if (pset.size > 0) {
+      MPIDYNRES_scheduler_stage_rc(scheduler, MPIDYNRES_RC_ADD, &pset);
+    }
+  } else if (delta < 0) {
+    int max_sub = scheduler->running_crs.size - 1;
+    MPIDYNRES_manager_pick_crs(scheduler, -delta < max_sub ? -delta : max_sub,
+                               false, &pset);
+    if (pset.size > 0) {
+      MPIDYNRES_scheduler_stage_rc(scheduler, MPIDYNRES_RC_SUB, &pset);
+    }
+  } else {
+    return 0;
+  }
+  set_int_free(&pset);
+  return 0;
+}
+
+MPIDYNRES_manager_ops const MPIDYNRES_timed_manager_ops = {
+    .name = "timed",
+    .init = timed_init,
+    .free = timed_free,
+    .register_scheduling_hints = timed_register_scheduling_hints,
+    .get_initial_pset = timed_get_initial_pset,
+    .handle_rc_msg = timed_handle_rc_msg,
+    .handle_timer = timed_handle_timer,
+};
@@ -0,0 +1,367 @@
+#include "metrics.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "call_trace.h"
+#include "logging.h"
+#include "util.h"
+
+#define SUB_BUCKETS (1 << MPIDYNRES_HISTOGRAM_SUB_BITS)
+
+/**
+ * @brief      Get the bucket of a value
+ *
+ * @details    Values below SUB_BUCKETS have a bucket each, above, every power
+ * of two range is split into SUB_BUCKETS buckets
+ *
+ * @param      value The value
+ *
+ * @return     The index of the bucket
+ */
+static int bucket_of(uint64_t value) {
+  if (value < SUB_BUCKETS) {
+    return value;
+  }
+  int shift = 63 - __builtin_clzll(value) - MPIDYNRES_HISTOGRAM_SUB_BITS;
+  return ((shift + 1) << MPIDYNRES_HISTOGRAM_SUB_BITS) +
+         (int)((value >> shift) - SUB_BUCKETS);
+}
+
+/**
+ * @brief      Get the lowest value of a bucket
+ *
+ * @param      bucket The index of the bucket
+ *
+ * @return     The lowest value that is recorded in this bucket
+ */
+static uint64_t bucket_start(int bucket) {
+  if (bucket < SUB_BUCKETS) {
+    return bucket;
+  }
+  int shift = (bucket >> MPIDYNRES_HISTOGRAM_SUB_BITS) - 1;
+  return (uint64_t)((bucket & (SUB_BUCKETS - 1)) + SUB_BUCKETS) << shift;
+}
+
+/**
+ * @brief      Record a value in a histogram
+ *
+ * @param      histogram The histogram
+ *
+ * @param      value_ns The value
+ */
+void MPIDYNRES_histogram_record(MPIDYNRES_histogram *histogram,
+                                uint64_t value_ns) {
+  if (histogram->buckets == NULL) {
+    histogram->buckets =
+        calloc(MPIDYNRES_HISTOGRAM_BUCKETS, sizeof(*histogram->buckets));
+    if (histogram->buckets == NULL) {
+      die("Memory Error\n");
+    }
+  }
+  histogram->buckets[bucket_of(value_ns)]++;
+  histogram->count++;
+  histogram->sum_ns += value_ns;
+  if (value_ns > histogram->max_ns) {
+    histogram->max_ns = value_ns;
+  }
+}
+
+/**
+ * @brief      Get a percentile of the recorded values
+ *
+ * @param      histogram The histogram
+ *
+ * @param      percentile The percentile in [0, 100]
+ *
+ * @return     The highest value of the bucket the percentile falls into (at
+ * most the maximum), 0 if the histogram is empty
+ */
+uint64_t MPIDYNRES_histogram_percentile(MPIDYNRES_histogram *histogram,
+                                        double percentile) {
+  uint64_t seen = 0;
+  uint64_t rank = percentile / 100.0 * histogram->count + 0.5;
+
+  if (histogram->count == 0) {
+    return 0;
+  }
+  if (rank < 1) {
+    rank = 1;
+  }
+  for (int i = 0; i < MPIDYNRES_HISTOGRAM_BUCKETS - 1; i++) {
+    seen += histogram->buckets[i];
+    if (seen >= rank) {
+      uint64_t end = bucket_start(i + 1) - 1;
+      return end < histogram->max_ns ? end : histogram->max_ns;
+    }
+  }
+  return histogram->max_ns;
+}
+
+/**
+ * @brief      Initialize the metrics of a pool
+ *
+ * @param      metrics The metrics
+ *
+ * @param      num_crs The number of crs of the pool
+ */
+void MPIDYNRES_metrics_init(MPIDYNRES_metrics *metrics, int num_crs) {
+  *metrics = (MPIDYNRES_metrics){0};
+  metrics->start_ns = MPIDYNRES_now_ns();
+  metrics->cr_started_ns = calloc(num_crs + 1, sizeof(uint64_t));
+  if (metrics->cr_started_ns == NULL) {
+    die("Memory Error\n");
+  }
+}
+
+/**
+ * @brief      Free the metrics of a pool
+ *
+ * @param      metrics The metrics
+ */
+void MPIDYNRES_metrics_free(MPIDYNRES_metrics *metrics) {
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    free(metrics->requests[i].buckets);
+  }
+  free(metrics->rc_accept.buckets);
+  free(metrics->rc_start.buckets);
+  free(metrics->start_latency.buckets);
+  free(metrics->shutdown_latency.buckets);
+  free(metrics->cr_started_ns);
+  *metrics = (MPIDYNRES_metrics){0};
+}
+
+/**
+ * @brief      Record the arrival of a request
+ *
+ * @details    If it is the first request of a cr that was started by a
+ * resource change, the time since the start is recorded
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      cr_id The cr that sent the request
+ *
+ * @param      start_ns When the request was received (MPIDYNRES_now_ns)
+ */
+void MPIDYNRES_metrics_request_received(MPIDYNRES_scheduler *scheduler,
+                                        int cr_id, uint64_t start_ns) {
+  MPIDYNRES_metrics *metrics = &scheduler->pool->metrics;
+
+  if (metrics->cr_started_ns[cr_id] != 0) {
+    MPIDYNRES_histogram_record(&metrics->rc_start,
+                               start_ns - metrics->cr_started_ns[cr_id]);
+    metrics->cr_started_ns[cr_id] = 0;
+  }
+}
+
+/**
+ * @brief      Record the time it took to handle a request
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      tag The tag of the request
+ *
+ * @param      start_ns When the request was received (MPIDYNRES_now_ns)
+ */
+void MPIDYNRES_metrics_request_handled(MPIDYNRES_scheduler *scheduler,
+                                       int tag, uint64_t start_ns) {
+  int i = tag - MPIDYNRES_TAG_IDLE_COMMAND;
+
+  if (i >= 0 && i < MPIDYNRES_NUM_TAGS) {
+    MPIDYNRES_histogram_record(&scheduler->pool->metrics.requests[i],
+                               MPIDYNRES_now_ns() - start_ns);
+  }
+}
+
+/**
+ * @brief      Set a key of the stats
+ *
+ * @param      stats The info object
+ *
+ * @param      key The key
+ *
+ * @param      fmt A format string for the value
+ */
+__attribute__((format(printf, 3, 4))) static void set_stat(
+    MPI_Info stats, char const *key, char const *fmt, ...) {
+  char value[0x40];
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(value, sizeof(value), fmt, args);
+  va_end(args);
+  MPI_Info_set(stats, key, value);
+}
+
+/**
+ * @brief      Set the keys of a histogram
+ *
+ * @details    <prefix>.count, <prefix>.mean_us, <prefix>.p50_us,
+ * <prefix>.p99_us and <prefix>.max_us
+ *
+ * @param      stats The info object
+ *
+ * @param      prefix The prefix of the keys
+ *
+ * @param      histogram The histogram
+ */
+static void set_histogram_stats(MPI_Info stats, char const *prefix,
+                                MPIDYNRES_histogram *histogram) {
+  char key[MPI_MAX_INFO_KEY];
+
+  snprintf(key, sizeof(key), "%s.count", prefix);
+  set_stat(stats, key, "%lu", (unsigned long)histogram->count);
+  if (histogram->count == 0) {
+    return;
+  }
+  snprintf(key, sizeof(key), "%s.mean_us", prefix);
+  set_stat(stats, key, "%.3f", histogram->sum_ns / 1e3 / histogram->count);
+  snprintf(key, sizeof(key), "%s.p50_us", prefix);
+  set_stat(stats, key, "%.3f",
+           MPIDYNRES_histogram_percentile(histogram, 50) / 1e3);
+  snprintf(key, sizeof(key), "%s.p99_us", prefix);
+  set_stat(stats, key, "%.3f",
+           MPIDYNRES_histogram_percentile(histogram, 99) / 1e3);
+  snprintf(key, sizeof(key), "%s.max_us", prefix);
+  set_stat(stats, key, "%.3f", histogram->max_ns / 1e3);
+}
+
+/**
+ * @brief      Get the metrics of the pool
+ *
+ * @details    The keys of the returned info object are:
+ *  - uptime_s: seconds since the scheduler was created
+ *  - requests: number of handled requests
+ *  - request.<tag>.*: the handling time of the requests per tag (lower case
+ * tag name without prefix), only for tags that were received, see
+ * set_histogram_stats for the suffixes
+ *  - rc.none, rc.add, rc.sub: answered resource change requests by type
+ *  - rc_accept.*: from the answer of a resource change to its accept
+ *  - rc_start.*: from the accept of an RC_ADD to the first request of a
+ * started cr
+ *  - start_latency.*, shutdown_latency.*: the injected latencies of
+ * starting and releasing crs (see latency.h)
+ *  - standby.warmed, standby.hits, standby.misses: warm commands sent and
+ * dynamic starts of crs that were or were not warmed up for their job
+ *  - bytes_in, bytes_out: bytes the scheduler received and sent
+ *  - jobs, running_crs, psets, pset_members: the current state of all jobs
+ *  - max_rss_kb: the peak memory usage of the scheduler process
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      o_stats A new info object is returned here, has to be freed by
+ * the caller
+ */
+void MPIDYNRES_scheduler_get_stats(MPIDYNRES_scheduler *scheduler,
+                                   MPI_Info *o_stats) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_metrics *metrics = &pool->metrics;
+  char key[MPI_MAX_INFO_KEY];
+  uint64_t num_requests = 0;
+  size_t num_psets = 0;
+  size_t num_members = 0;
+  struct rusage usage;
+
+  MPI_Info_create(o_stats);
+  set_stat(*o_stats, "uptime_s", "%.3f",
+           (MPIDYNRES_now_ns() - metrics->start_ns) / 1e9);
+
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    MPIDYNRES_histogram *h = &metrics->requests[i];
+    if (h->count == 0) {
+      continue;
+    }
+    num_requests += h->count;
+    int len = snprintf(key, sizeof(key), "request.%s",
+                       MPIDYNRES_tag_name(i + MPIDYNRES_TAG_IDLE_COMMAND));
+    for (int j = 0; j < len; j++) {
+      key[j] = tolower((unsigned char)key[j]);
+    }
+    set_histogram_stats(*o_stats, key, h);
+  }
+  set_stat(*o_stats, "requests", "%lu", (unsigned long)num_requests);
+
+  set_stat(*o_stats, "rc.none", "%lu",
+           (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_NONE]);
+  set_stat(*o_stats, "rc.add", "%lu",
+           (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_ADD]);
+  set_stat(*o_stats, "rc.sub", "%lu",
+           (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_SUB]);
+  set_histogram_stats(*o_stats, "rc_accept", &metrics->rc_accept);
+  set_histogram_stats(*o_stats, "rc_start", &metrics->rc_start);
+  set_histogram_stats(*o_stats, "start_latency", &metrics->start_latency);
+  set_histogram_stats(*o_stats, "shutdown_latency",
+                      &metrics->shutdown_latency);
+  set_stat(*o_stats, "standby.warmed", "%lu",
+           (unsigned long)metrics->standby_warmed);
+  set_stat(*o_stats, "standby.hits", "%lu",
+           (unsigned long)metrics->standby_hits);
+  set_stat(*o_stats, "standby.misses", "%lu",
+           (unsigned long)metrics->standby_misses);
+
+  set_stat(*o_stats, "bytes_in", "%zu", scheduler->transport->bytes_received);
+  set_stat(*o_stats, "bytes_out", "%zu", scheduler->transport->bytes_sent);
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    num_psets += pool->jobs[i]->pset_name_map.size;
+    foreach (set_pset_node, &pool->jobs[i]->pset_name_map, it) {
+      num_members += it.ref->pset.size;
+    }
+  }
+  set_stat(*o_stats, "jobs", "%d", pool->num_jobs);
+  set_stat(*o_stats, "running_crs", "%d", pool->num_running);
+  set_stat(*o_stats, "psets", "%zu", num_psets);
+  set_stat(*o_stats, "pset_members", "%zu", num_members);
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    set_stat(*o_stats, "max_rss_kb", "%ld", usage.ru_maxrss);
+  }
+}
+
+/**
+ * @brief      Dump the metrics of the pool
+ *
+ * @details    One "key value" line per metric is written to the file in
+ * STATS_ENVVAR or, if it is not set, to the debug output at the info level
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_scheduler_dump_stats(MPIDYNRES_scheduler *scheduler) {
+  char const *path = getenv(STATS_ENVVAR);
+  char key[MPI_MAX_INFO_KEY + 1];
+  char value[MPI_MAX_INFO_VAL + 1];
+  MPI_Info stats;
+  FILE *f = NULL;
+  int nkeys, flag;
+
+  if (path == NULL && !(MPIDYNRES_LOG_INFO <= MPIDYNRES_LOG_MAX_LEVEL &&
+                        MPIDYNRES_LOG_INFO <= g_log_level)) {
+    return;
+  }
+  if (path != NULL) {
+    f = fopen(path, "w");
+    if (f == NULL) {
+      die("Failed to open stats file %s: %s\n", path, strerror(errno));
+    }
+  }
+
+  MPIDYNRES_scheduler_get_stats(scheduler, &stats);
+  MPI_Info_get_nkeys(stats, &nkeys);
+  for (int i = 0; i < nkeys; i++) {
+    MPI_Info_get_nthkey(stats, i, key);
+    MPI_Info_get(stats, key, MPI_MAX_INFO_VAL, value, &flag);
+    if (f != NULL) {
+      fprintf(f, "%s %s\n", key, value);
+    } else {
+      log_info("stats: %s %s\n", key, value);
+    }
+  }
+  MPI_Info_free(&stats);
+  if (f != NULL) {
+    fclose(f);
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef MPIDYNRES_METRICS_H
+#define MPIDYNRES_METRICS_H
+/*
+ * Metrics of the scheduler, to see how the control plane is doing in long
+ * runs
+ *
+ * The scheduler counts the requests per tag with the time spent handling
+ * them, the resource change decisions by type and how long it takes until a
+ * resource change is accepted and until the crs it started send their first
+ * request. Together with the bytes the scheduler transport sent and received
+ * and the live psets, they can be queried with MPIDYNRES_SIM_get_stats (see
+ * MPIDYNRES_scheduler_get_stats for the keys) and are dumped when the
+ * scheduler is freed.
+ */
+
+#include <stdint.h>
+
+#include "comm.h"
+
+#define STATS_ENVVAR "MPIDYNRES_STATS"
+
+/*
+ * Every power of two range of a histogram is split into
+ * 2^MPIDYNRES_HISTOGRAM_SUB_BITS buckets, so the values are recorded with a
+ * relative error below 1/2^MPIDYNRES_HISTOGRAM_SUB_BITS
+ */
+#define MPIDYNRES_HISTOGRAM_SUB_BITS 4
+#define MPIDYNRES_HISTOGRAM_BUCKETS \
+  ((64 - MPIDYNRES_HISTOGRAM_SUB_BITS + 1) << MPIDYNRES_HISTOGRAM_SUB_BITS)
+
+/**
+ * @brief      A log-linear histogram of durations in nanoseconds
+ */
+struct MPIDYNRES_histogram {
+  uint64_t count;
+  uint64_t sum_ns;
+  uint64_t max_ns;
+  uint64_t *buckets;  ///< MPIDYNRES_HISTOGRAM_BUCKETS, allocated on first use
+};
+typedef struct MPIDYNRES_histogram MPIDYNRES_histogram;
+
+/**
+ * @brief      The metrics of all jobs of a pool
+ */
+struct MPIDYNRES_metrics {
+  uint64_t start_ns;  ///< when the metrics were initialized
+  MPIDYNRES_histogram requests[MPIDYNRES_NUM_TAGS];  ///< handling time per request tag
+  MPIDYNRES_histogram rc_accept;  ///< resource change answered until accepted
+  MPIDYNRES_histogram rc_start;   ///< accepted until the first request of a started cr
+  uint64_t rc_decisions[3];       ///< answered resource changes, indexed by MPIDYNRES_RC_type
+  MPIDYNRES_histogram start_latency;     ///< injected start latencies
+  MPIDYNRES_histogram shutdown_latency;  ///< injected shutdown latencies
+  uint64_t standby_warmed;        ///< warm commands sent to idle crs
+  uint64_t standby_hits;          ///< dynamic starts of crs that were warmed up for the job
+  uint64_t standby_misses;        ///< dynamic starts of crs that were not
+  uint64_t *cr_started_ns;        ///< accept time of a dynamically started cr whose first request did not arrive yet, 0 otherwise (index = cr id)
+};
+typedef struct MPIDYNRES_metrics MPIDYNRES_metrics;
+
+#include "scheduler.h"
+
+void MPIDYNRES_histogram_record(MPIDYNRES_histogram *histogram,
+                                uint64_t value_ns);
+
+uint64_t MPIDYNRES_histogram_percentile(MPIDYNRES_histogram *histogram,
+                                        double percentile);
+
+void MPIDYNRES_metrics_init(MPIDYNRES_metrics *metrics, int num_crs);
+
+void MPIDYNRES_metrics_free(MPIDYNRES_metrics *metrics);
+
+void MPIDYNRES_metrics_request_received(MPIDYNRES_scheduler *scheduler,
+                                        int cr_id, uint64_t start_ns);
+
+void MPIDYNRES_metrics_request_handled(MPIDYNRES_scheduler *scheduler,
+                                       int tag, uint64_t start_ns);
+
+void MPIDYNRES_scheduler_get_stats(MPIDYNRES_scheduler *scheduler,
+                                   MPI_Info *o_stats);
+
+void MPIDYNRES_scheduler_dump_stats(MPIDYNRES_scheduler *scheduler);
+
+#endif
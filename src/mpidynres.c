@@ -10,6 +10,8 @@
 
 #include "comm.h"
 #include "logging.h"
+#include "tool.h"
+#include "trace.h"
 #include "util.h"
 
 MPI_Session MPI_SESSION_NULL = NULL;
@@ -18,6 +20,8 @@ int MPIDYNRES_INVALID_SESSION_ID = INT_MAX;
 
 MPI_Comm g_MPIDYNRES_base_comm;  // store the base communicator
 
+MPIDYNRES_transport *g_MPIDYNRES_transport;  // used to talk to the scheduler
+
 jmp_buf g_MPIDYNRES_JMP_BUF;  // store correct return position of simulation
 
 
@@ -51,6 +55,7 @@ the Session (argument has to be freed by caller)
  */
 int MPI_Session_init(MPI_Info info, MPI_Errhandler errhandler,
                      MPI_Session *session) {
+  TRACE_CALL();
   (void)errhandler;
   int unused = 0;
   int err;
@@ -66,18 +71,18 @@ int MPI_Session_init(MPI_Info info, MPI_Errhandler errhandler,
     die("Memory error\n");
   }
 
-  err = MPI_Send(&unused, 1, MPI_INT, 0, MPIDYNRES_TAG_SESSION_CREATE,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &unused, sizeof(int),
+                                 0, MPIDYNRES_TAG_SESSION_CREATE);
   if (err) {
-    debug("Warning: Failed to send session create\n");
+    log_warn("Warning: Failed to send session create\n");
     free(sess);
     return err;
   }
-  err = MPI_Recv(&sess->session_id, 1, MPI_INT, 0,
-                 MPIDYNRES_TAG_SESSION_CREATE_ANSWER, g_MPIDYNRES_base_comm,
-                 MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &sess->session_id,
+                                 sizeof(int), 0,
+                                 MPIDYNRES_TAG_SESSION_CREATE_ANSWER, NULL);
   if (err) {
-    debug("Warning: Failed to recv session id\n");
+    log_warn("Warning: Failed to recv session id\n");
     free(sess);
     return err;
   }
@@ -86,14 +91,14 @@ int MPI_Session_init(MPI_Info info, MPI_Errhandler errhandler,
   } else {
     err = MPI_Info_dup(info, &sess->info);
     if (err) {
-      debug("Warning: Failed to dup info\n");
+      log_warn("Warning: Failed to dup info\n");
       free(sess);
       return err;
     }
   }
   if (sess->session_id == MPIDYNRES_INVALID_SESSION_ID) {
     *session = MPI_SESSION_NULL;
-    debug("Warning: Got Invalid session id\n");
+    log_warn("Warning: Got Invalid session id\n");
     if (sess->info != MPI_INFO_NULL) {
       MPI_Info_free(&sess->info);
     }
@@ -101,6 +106,12 @@ int MPI_Session_init(MPI_Info info, MPI_Errhandler errhandler,
     return 1;
   } else {
     *session = sess;
+    if (tool_wants(MPIDYNRES_TOOL_SESSION_INIT)) {
+      MPIDYNRES_tool_event event =
+          tool_client_event(MPIDYNRES_TOOL_SESSION_INIT);
+      event.session_id = sess->session_id;
+      tool_fire(&event);
+    }
     return 0;
   }
 }
@@ -118,20 +129,29 @@ int MPI_Session_init(MPI_Info info, MPI_Errhandler errhandler,
  * @return     if != 0, an error occured
  */
 int MPI_Session_finalize(MPI_Session *session) {
+  TRACE_CALL();
   int err;
   int answer;
   debug("In MPI_Session_finalize\n");
   if (*session == MPI_SESSION_NULL) {
-    debug("Warning: MPI_Session_finalize called with MPI_SESSION_NULL\n");
+    log_warn("Warning: MPI_Session_finalize called with MPI_SESSION_NULL\n");
     return 0;
   }
-  err = MPI_Send(&((*session)->session_id), 1, MPI_INT, 0,
-                 MPIDYNRES_TAG_SESSION_FINALIZE, g_MPIDYNRES_base_comm);
+  if (tool_wants(MPIDYNRES_TOOL_SESSION_FINALIZE)) {
+    MPIDYNRES_tool_event event =
+        tool_client_event(MPIDYNRES_TOOL_SESSION_FINALIZE);
+    event.session_id = (*session)->session_id;
+    tool_fire(&event);
+  }
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport,
+                                 &((*session)->session_id), sizeof(int), 0,
+                                 MPIDYNRES_TAG_SESSION_FINALIZE);
   if (err) {
     return err;
   }
-  err = MPI_Recv(&answer, 1, MPI_INT, 0, MPIDYNRES_TAG_SESSION_FINALIZE_ANSWER,
-                 g_MPIDYNRES_base_comm, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &answer, sizeof(int),
+                                 0, MPIDYNRES_TAG_SESSION_FINALIZE_ANSWER,
+                                 NULL);
   if (err) {
     return err;
   }
@@ -162,22 +182,22 @@ int MPI_Session_finalize(MPI_Session *session) {
  * @return     if != 0, an error occured
  */
 int MPI_Session_get_info(MPI_Session session, MPI_Info *info_used) {
+  TRACE_CALL();
   int err;
   MPI_Info info;
   if (session == MPI_SESSION_NULL) {
-    debug("Warning: MPI_Session_finalize called with MPI_SESSION_NULL\n");
+    log_warn("Warning: MPI_Session_finalize called with MPI_SESSION_NULL\n");
     *info_used = MPI_INFO_NULL;
     return 1;
   }
-  err = MPI_Send(&(session->session_id), 1, MPI_INT, 0,
-                 MPIDYNRES_TAG_SESSION_INFO, g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &(session->session_id),
+                                 sizeof(int), 0, MPIDYNRES_TAG_SESSION_INFO);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Recv_MPI_Info(
-      &info, 0, MPIDYNRES_TAG_SESSION_INFO_ANSWER_SIZE,
-      MPIDYNRES_TAG_SESSION_INFO_ANSWER, g_MPIDYNRES_base_comm,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(
+      g_MPIDYNRES_transport, &info, 0, MPIDYNRES_TAG_SESSION_INFO_ANSWER_SIZE,
+      MPIDYNRES_TAG_SESSION_INFO_ANSWER);
   if (err) {
     return err;
   }
@@ -238,26 +258,26 @@ int MPI_Session_get_info(MPI_Session session, MPI_Info *info_used) {
  * @return     if != 0, an error occured
  */
 int MPI_Session_get_psets(MPI_Session session, MPI_Info info, MPI_Info *psets) {
+  TRACE_CALL();
   int err;
   if (session == MPI_SESSION_NULL) {
-    debug("Warning: MPI_Session_get_psets called with MPI_SESSION_NULL\n");
+    log_warn("Warning: MPI_Session_get_psets called with MPI_SESSION_NULL\n");
     return 1;
   }
-  err = MPI_Send(&session->session_id, 1, MPI_INT, 0, MPIDYNRES_TAG_GET_PSETS,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &session->session_id,
+                                 sizeof(int), 0, MPIDYNRES_TAG_GET_PSETS);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Send_MPI_Info(info, 0, MPIDYNRES_TAG_GET_PSETS_INFO_SIZE,
-                                MPIDYNRES_TAG_GET_PSETS_INFO,
-                                g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send_info(g_MPIDYNRES_transport, info, 0,
+                                      MPIDYNRES_TAG_GET_PSETS_INFO_SIZE,
+                                      MPIDYNRES_TAG_GET_PSETS_INFO);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Recv_MPI_Info(psets, 0, MPIDYNRES_TAG_GET_PSETS_ANSWER_SIZE,
-                                MPIDYNRES_TAG_GET_PSETS_ANSWER,
-                                g_MPIDYNRES_base_comm, MPI_STATUS_IGNORE,
-                                MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(g_MPIDYNRES_transport, psets, 0,
+                                      MPIDYNRES_TAG_GET_PSETS_ANSWER_SIZE,
+                                      MPIDYNRES_TAG_GET_PSETS_ANSWER);
   if (err) {
     return err;
   }
@@ -283,34 +303,34 @@ int MPI_Session_get_psets(MPI_Session session, MPI_Info info, MPI_Info *psets) {
  */
 int MPI_Session_get_pset_info(MPI_Session session, char const *pset_name,
                               MPI_Info *info) {
+  TRACE_CALL();
   int err;
   int msg[2];
 
   if (session == MPI_SESSION_NULL) {
-    debug("Warning: MPI_Session_get_pset_info called with MPI_SESSION_NULL\n");
+    log_warn("Warning: MPI_Session_get_pset_info called with MPI_SESSION_NULL\n");
     return 1;
   }
   if (pset_name == NULL) {
-    debug("Warning: MPI_Session_get_pset_info called with NULL name\n");
+    log_warn("Warning: MPI_Session_get_pset_info called with NULL name\n");
     return 1;
   }
   msg[0] = session->session_id;
   msg[1] = strlen(pset_name) + 1;
   assert(msg[1] <= MPI_MAX_PSET_NAME_LEN);
-  err = MPI_Send(msg, 2, MPI_INT, 0, MPIDYNRES_TAG_PSET_INFO,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, msg, sizeof(msg), 0,
+                                 MPIDYNRES_TAG_PSET_INFO);
   if (err) {
     return err;
   }
-  err = MPI_Send(pset_name, msg[1], MPI_CHAR, 0, MPIDYNRES_TAG_PSET_INFO_NAME,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, pset_name, msg[1], 0,
+                                 MPIDYNRES_TAG_PSET_INFO_NAME);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Recv_MPI_Info(info, 0, MPIDYNRES_TAG_PSET_INFO_ANSWER_SIZE,
-                                MPIDYNRES_TAG_PSET_INFO_ANSWER,
-                                g_MPIDYNRES_base_comm, MPI_STATUS_IGNORE,
-                                MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(g_MPIDYNRES_transport, info, 0,
+                                      MPIDYNRES_TAG_PSET_INFO_ANSWER_SIZE,
+                                      MPIDYNRES_TAG_PSET_INFO_ANSWER);
   /* int nkeys; */
   /* MPI_Info_get_nkeys(*info, &nkeys); */
   /*   printf("HEY: %d\n", nkeys); */
@@ -338,18 +358,19 @@ int MPI_Session_get_pset_info(MPI_Session session, char const *pset_name,
  */
 int MPI_Group_from_session_pset(MPI_Session session, char const *pset_name,
                                 MPI_Group *newgroup) {
+  TRACE_CALL();
   int err;
   int msg[2];
   size_t answer_size;
   MPI_Group base_group = {0};
 
   if (session == MPI_SESSION_NULL) {
-    debug("Warning: MPI_Group_from_session_pset called with invalid session\n");
+    log_warn("Warning: MPI_Group_from_session_pset called with invalid session\n");
     *newgroup = MPI_GROUP_EMPTY;
     return 0;
   }
   if (pset_name == NULL) {
-    debug("Warning: MPI_Group_from_session_pset called with NULL pset_name\n");
+    log_warn("Warning: MPI_Group_from_session_pset called with NULL pset_name\n");
     *newgroup = MPI_GROUP_EMPTY;
     return 1;
   }
@@ -357,21 +378,21 @@ int MPI_Group_from_session_pset(MPI_Session session, char const *pset_name,
   msg[0] = session->session_id;
   msg[1] = strlen(pset_name) + 1;
   assert(msg[1] < MPI_MAX_PSET_NAME_LEN);
-  err = MPI_Send(msg, 2, MPI_INT, 0, MPIDYNRES_TAG_PSET_LOOKUP,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, msg, sizeof(msg), 0,
+                                 MPIDYNRES_TAG_PSET_LOOKUP);
   if (err) {
     *newgroup = MPI_GROUP_EMPTY;
     return err;
   }
-  err = MPI_Send(pset_name, msg[1], MPI_CHAR, 0, MPIDYNRES_TAG_PSET_LOOKUP_NAME,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, pset_name, msg[1], 0,
+                                 MPIDYNRES_TAG_PSET_LOOKUP_NAME);
   if (err) {
     *newgroup = MPI_GROUP_EMPTY;
     return err;
   }
-  err = MPI_Recv(&answer_size, 1, my_MPI_SIZE_T, 0,
-                 MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE, g_MPIDYNRES_base_comm,
-                 MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &answer_size,
+                                 sizeof(size_t), 0,
+                                 MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE, NULL);
   if (err) {
     *newgroup = MPI_GROUP_EMPTY;
     return err;
@@ -379,7 +400,7 @@ int MPI_Group_from_session_pset(MPI_Session session, char const *pset_name,
   debug("Answer size: %zu\n", answer_size);
 
   if (answer_size == 0) {
-    debug("Warning: THere was a problem getting the set\n");
+    log_warn("Warning: THere was a problem getting the set\n");
     *newgroup = MPI_GROUP_EMPTY;
     return 1;
   }
@@ -388,9 +409,9 @@ int MPI_Group_from_session_pset(MPI_Session session, char const *pset_name,
   if (cr_ids == NULL) {
     die("Memory Error\n");
   }
-  err = MPI_Recv(cr_ids, answer_size, MPI_INT, 0,
-                 MPIDYNRES_TAG_PSET_LOOKUP_ANSWER, g_MPIDYNRES_base_comm,
-                 MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, cr_ids,
+                                 answer_size * sizeof(int), 0,
+                                 MPIDYNRES_TAG_PSET_LOOKUP_ANSWER, NULL);
   if (err) {
     return err;
   }
@@ -447,6 +468,7 @@ int MPI_Group_from_session_pset(MPI_Session session, char const *pset_name,
 int MPI_Comm_create_from_group(MPI_Group group, const char *stringtag,
                                MPI_Info info, MPI_Errhandler errhandler,
                                MPI_Comm *newcomm) {
+  TRACE_CALL();
   (void)stringtag;
   (void)info;
   int size = -1;
@@ -498,31 +520,38 @@ int MPIDYNRES_pset_create_op(MPI_Session session, MPI_Info hints,
                              char const pset1[], char const pset2[],
                              MPIDYNRES_pset_op op,
                              char pset_result[MPI_MAX_PSET_NAME_LEN]) {
+  TRACE_CALL();
   int err;
   MPIDYNRES_pset_op_msg msg = {0};
   msg.session_id = session->session_id;
   msg.op = op;
   strncpy(msg.pset_name1, pset1, MPI_MAX_PSET_NAME_LEN);
   strncpy(msg.pset_name2, pset2, MPI_MAX_PSET_NAME_LEN);
-  err = MPI_Ssend(&msg, 1, get_pset_op_datatype(), 0, MPIDYNRES_TAG_PSET_OP,
-                  g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &msg, sizeof(msg), 0,
+                                 MPIDYNRES_TAG_PSET_OP);
   if (err) {
     return err;
   }
 
-  err = MPIDYNRES_Send_MPI_Info(hints, 0, MPIDYNRES_TAG_PSET_OP_INFO_SIZE,
-                                MPIDYNRES_TAG_PSET_OP_INFO,
-                                g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send_info(g_MPIDYNRES_transport, hints, 0,
+                                      MPIDYNRES_TAG_PSET_OP_INFO_SIZE,
+                                      MPIDYNRES_TAG_PSET_OP_INFO);
   if (err) {
     return err;
   }
 
-  err = MPI_Recv(pset_result, MPI_MAX_PSET_NAME_LEN, MPI_CHAR, 0,
-                 MPIDYNRES_TAG_PSET_OP_ANSWER, g_MPIDYNRES_base_comm,
-                 MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, pset_result,
+                                 MPI_MAX_PSET_NAME_LEN, 0,
+                                 MPIDYNRES_TAG_PSET_OP_ANSWER, NULL);
   if (err) {
     return err;
   }
+  if (pset_result[0] != '\0' && tool_wants(MPIDYNRES_TOOL_PSET_CREATED)) {
+    MPIDYNRES_tool_event event = tool_client_event(MPIDYNRES_TOOL_PSET_CREATED);
+    event.session_id = session->session_id;
+    event.pset_name = pset_result;
+    tool_fire(&event);
+  }
   return 0;
 }
 
@@ -535,15 +564,22 @@ int MPIDYNRES_pset_create_op(MPI_Session session, MPI_Info hints,
  */
 int MPIDYNRES_pset_free(MPI_Session session,
                         char pset_name[MPI_MAX_PSET_NAME_LEN]) {
+  TRACE_CALL();
   int err;
   struct MPIDYNRES_pset_free_msg msg = {0};
   msg.session_id = session->session_id;
   strncpy(msg.pset_name, pset_name, MPI_MAX_PSET_NAME_LEN);
-  err = MPI_Send(&msg, 1, get_pset_free_datatype(), 0, MPIDYNRES_TAG_PSET_FREE,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &msg, sizeof(msg), 0,
+                                 MPIDYNRES_TAG_PSET_FREE);
   if (err) {
     return err;
   }
+  if (tool_wants(MPIDYNRES_TOOL_PSET_FREED)) {
+    MPIDYNRES_tool_event event = tool_client_event(MPIDYNRES_TOOL_PSET_FREED);
+    event.session_id = session->session_id;
+    event.pset_name = msg.pset_name;
+    tool_fire(&event);
+  }
   pset_name[0] = '\0';
   return 0;
 }
@@ -561,23 +597,23 @@ int MPIDYNRES_pset_free(MPI_Session session,
  */
 int MPIDYNRES_add_scheduling_hints(MPI_Session session, MPI_Info hints,
                                    MPI_Info *answer) {
+  TRACE_CALL();
   int err;
-  err = MPI_Ssend(&session->session_id, 1, MPI_INT, 0,
-                  MPIDYNRES_TAG_SCHED_HINTS, g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &session->session_id,
+                                 sizeof(int), 0, MPIDYNRES_TAG_SCHED_HINTS);
   if (err) {
     return err;
   }
 
-  err = MPIDYNRES_Send_MPI_Info(
-      hints, 0, MPIDYNRES_TAG_SCHED_HINTS_SIZE,
-      MPIDYNRES_TAG_SCHED_HINTS_INFO, g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send_info(g_MPIDYNRES_transport, hints, 0,
+                                      MPIDYNRES_TAG_SCHED_HINTS_SIZE,
+                                      MPIDYNRES_TAG_SCHED_HINTS_INFO);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Recv_MPI_Info(
-      answer, 0, MPIDYNRES_TAG_SCHED_HINTS_ANSWER_SIZE,
-      MPIDYNRES_TAG_SCHED_HINTS_ANSWER, g_MPIDYNRES_base_comm,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(g_MPIDYNRES_transport, answer, 0,
+                                      MPIDYNRES_TAG_SCHED_HINTS_ANSWER_SIZE,
+                                      MPIDYNRES_TAG_SCHED_HINTS_ANSWER);
   if (err) {
     return err;
   }
@@ -605,28 +641,39 @@ int MPIDYNRES_add_scheduling_hints(MPI_Session session, MPI_Info hints,
 int MPIDYNRES_RC_get(MPI_Session session, MPIDYNRES_RC_type *rc_type,
                      char delta_pset[MPI_MAX_PSET_NAME_LEN],
                      MPIDYNRES_RC_tag *tag, MPI_Info *info) {
+  TRACE_CALL();
   int err;
   MPIDYNRES_RC_msg answer = {0};
 
-  err = MPI_Send(&session->session_id, 1, MPI_INT, 0, MPIDYNRES_TAG_RC,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &session->session_id,
+                                 sizeof(int), 0, MPIDYNRES_TAG_RC);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Recv_MPI_Info(info, 0, MPIDYNRES_TAG_RC_INFO_SIZE,
-                                MPIDYNRES_TAG_RC_INFO, g_MPIDYNRES_base_comm,
-                                MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(g_MPIDYNRES_transport, info, 0,
+                                      MPIDYNRES_TAG_RC_INFO_SIZE,
+                                      MPIDYNRES_TAG_RC_INFO);
   if (err) {
     return err;
   }
-  err = MPI_Recv(&answer, 1, get_rc_datatype(), 0, MPIDYNRES_TAG_RC_ANSWER,
-                 g_MPIDYNRES_base_comm, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(g_MPIDYNRES_transport, &answer,
+                                 sizeof(answer), 0, MPIDYNRES_TAG_RC_ANSWER,
+                                 NULL);
   if (err) {
     return err;
   }
   strcpy(delta_pset, answer.pset_name);
   *rc_type = answer.type;
   *tag = answer.tag;
+  if (answer.type != MPIDYNRES_RC_NONE &&
+      tool_wants(MPIDYNRES_TOOL_RC_PROPOSED)) {
+    MPIDYNRES_tool_event event = tool_client_event(MPIDYNRES_TOOL_RC_PROPOSED);
+    event.session_id = session->session_id;
+    event.rc_tag = answer.tag;
+    event.rc_type = answer.type;
+    event.pset_name = answer.pset_name;
+    tool_fire(&event);
+  }
   return 0;
 }
 
@@ -644,21 +691,28 @@ int MPIDYNRES_RC_get(MPI_Session session, MPIDYNRES_RC_type *rc_type,
  */
 int MPIDYNRES_RC_accept(MPI_Session session, MPIDYNRES_RC_tag tag,
                         MPI_Info info) {
+  TRACE_CALL();
   int err;
   int msg[2];
   msg[0] = session->session_id;
   msg[1] = tag;
-  err = MPI_Send(&msg, 2, MPI_INT, 0, MPIDYNRES_TAG_RC_ACCEPT,
-                 g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, msg, sizeof(msg), 0,
+                                 MPIDYNRES_TAG_RC_ACCEPT);
   if (err) {
     return err;
   }
-  err = MPIDYNRES_Send_MPI_Info(info, 0, MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
-                                MPIDYNRES_TAG_RC_ACCEPT_INFO,
-                                g_MPIDYNRES_base_comm);
+  err = MPIDYNRES_transport_send_info(g_MPIDYNRES_transport, info, 0,
+                                      MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
+                                      MPIDYNRES_TAG_RC_ACCEPT_INFO);
   if (err) {
     return err;
   }
+  if (tool_wants(MPIDYNRES_TOOL_RC_ACCEPTED)) {
+    MPIDYNRES_tool_event event = tool_client_event(MPIDYNRES_TOOL_RC_ACCEPTED);
+    event.session_id = session->session_id;
+    event.rc_tag = tag;
+    tool_fire(&event);
+  }
   return 0;
 }
 
@@ -2,65 +2,194 @@
 
 #include <mpi.h>
 #include <setjmp.h>
+#include <signal.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/resource.h>
 
+#include "call_trace.h"
+#include "checkpoint.h"
 #include "comm.h"
 #include "mpidynres.h"
 #include "logging.h"
 #include "scheduler.h"
+#include "snapshot.h"
+#include "tool.h"
+#include "trace.h"
 #include "util.h"
 
 extern jmp_buf g_MPIDYNRES_JMP_BUF;     // defined in mpidynres.c
 extern MPI_Comm g_MPIDYNRES_base_comm;  // defined in mpidynres.c
+extern MPIDYNRES_transport *g_MPIDYNRES_transport;  // defined in mpidynres.c
+
+// utilization of the last simulation, see MPIDYNRES_SIM_get_utilization
+static MPIDYNRES_SIM_utilization g_MPIDYNRES_utilization;
+static bool g_MPIDYNRES_utilization_valid = false;
 
 /**
  * @brief      Create, start a scheduler object (using the current process)
  *
  * @detail     This function should only be called by rank 0 as this will start
- * the scheduler
+ * the scheduler. If JOB_REPORT_ENVVAR is set, the utilization report is
+ * written to this file afterwards. If CALL_TRACE_ENVVAR is set, all calls
+ * the scheduler receives are recorded to this file. If CHECKPOINT_ENVVAR is
+ * set, they are also journaled there and the scheduler is restored from the
+ * journal if RESTORE_ENVVAR is set.
  *
  * @param      i_config       The scheduler configuration to be used
+ *
+ * @param      num_jobs       The number of jobs
+ *
+ * @param      i_jobs         The jobs
  */
-static void MPIDYNRES_SIM_start_scheduler(MPIDYNRES_SIM_config *i_config) {
-  MPIDYNRES_scheduler *scheduler = MPIDYNRES_scheduler_create(i_config);
+static void MPIDYNRES_SIM_start_scheduler(MPIDYNRES_SIM_config *i_config,
+                                          int num_jobs,
+                                          MPIDYNRES_SIM_job const i_jobs[]) {
+  MPIDYNRES_SIM_config *configs = calloc(num_jobs, sizeof(MPIDYNRES_SIM_config));
+  if (configs == NULL) {
+    die("Memory Error!\n");
+  }
+
+  // the manager config of a job takes precedence
+  for (int i = 0; i < num_jobs; i++) {
+    configs[i] = *i_config;
+    if (i_jobs[i].manager_config != MPI_INFO_NULL) {
+      configs[i].manager_config = i_jobs[i].manager_config;
+    }
+  }
+
+  // record the calls the scheduler receives
+  MPIDYNRES_transport *transport = g_MPIDYNRES_transport;
+  FILE *call_trace = NULL;
+  char *call_trace_path = getenv(CALL_TRACE_ENVVAR);
+  if (call_trace_path != NULL) {
+    call_trace = fopen(call_trace_path, "w");
+    if (call_trace == NULL) {
+      die("Could not open call trace file %s\n", call_trace_path);
+    }
+    transport = MPIDYNRES_call_trace_recorder_create(transport, call_trace);
+  }
+
+  // journal the calls for restarting, restored jobs use the journaled configs
+  MPIDYNRES_call_trace_header restore_header;
+  MPIDYNRES_transport *journal_transport = transport;
+  FILE *journal = MPIDYNRES_checkpoint_open(&restore_header);
+  if (journal != NULL) {
+    transport = MPIDYNRES_call_trace_recorder_create(transport, journal);
+  }
+  for (int i = 0; i < restore_header.num_jobs && i < num_jobs; i++) {
+    configs[i].manager_config = restore_header.manager_configs[i];
+  }
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&configs[0], transport);
+  scheduler->job_stats.submit_time = i_jobs[0].submit_time;
+  for (int i = 1; i < num_jobs; i++) {
+    if (i_jobs[i].submit_time < i_jobs[i - 1].submit_time) {
+      die("The jobs have to be ordered by their submit time\n");
+    }
+    MPIDYNRES_scheduler *job =
+        MPIDYNRES_scheduler_add_job(scheduler, &configs[i]);
+    job->job_stats.submit_time = i_jobs[i].submit_time;
+  }
+  if (call_trace != NULL) {
+    MPIDYNRES_call_trace_write_header(call_trace, scheduler);
+  }
+  MPIDYNRES_checkpoint_start(scheduler, &restore_header);
   MPIDYNRES_scheduler_start(scheduler);
+  MPIDYNRES_scheduler_get_utilization(scheduler, &g_MPIDYNRES_utilization);
+
+  char *report_path = getenv(JOB_REPORT_ENVVAR);
+  if (report_path != NULL) {
+    FILE *f = fopen(report_path, "w");
+    if (f == NULL) {
+      die("Could not open job report file %s\n", report_path);
+    }
+    MPIDYNRES_scheduler_write_job_report(scheduler, f);
+    fclose(f);
+  }
+
   MPIDYNRES_scheduler_free(scheduler);
+  if (journal != NULL) {
+    MPIDYNRES_transport_free(transport);
+    transport = journal_transport;
+    MPIDYNRES_checkpoint_close();
+  }
+  if (restore_header.num_jobs > 0) {
+    MPIDYNRES_call_trace_header_free(&restore_header);
+  }
+  if (call_trace != NULL) {
+    MPIDYNRES_transport_free(transport);
+    fclose(call_trace);
+  }
+  free(configs);
 }
 
 /**
- * @brief      Receive an idle command via MPI
+ * @brief      Receive an idle command from the scheduler
  *
  * @param      o_command The command that will be received will be written into
  * this pointer
  *
- * @param      base_comm The communicator used for communication
- * this pointer
+ * @param      transport The transport used for communication
  */
 static void MPIDYNRES_SIM_get_idle_command(MPIDYNRES_idle_command *o_command,
-                                MPI_Comm base_comm) {
-  MPI_Datatype MPI_IDLE_COMMAND = get_idle_command_datatype();
+                                MPIDYNRES_transport *transport) {
+  MPIDYNRES_transport_recv(transport, o_command, sizeof(*o_command), 0,
+                           MPIDYNRES_TAG_IDLE_COMMAND, NULL);
+}
 
-  MPI_Recv(o_command, 1, MPI_IDLE_COMMAND, 0, MPIDYNRES_TAG_IDLE_COMMAND,
-           base_comm, MPI_STATUS_IGNORE);
+/**
+ * @brief      Get the CPU time (user + system) the process used so far
+ *
+ * @return     The CPU time in seconds
+ */
+static double MPIDYNRES_cpu_seconds() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0.0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+         usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
 }
 
 /**
  * @brief      Tell the scheduler that the cr has returned from the simulation
  * and is now idleing
  *
- * @param      base_comm The communicator used for communication
+ * @param      transport The transport used for communication
+ *
+ * @param      cpu_seconds The CPU time the simulation used
  */
-static void MPIDYNRES_notify_worker_done(MPI_Comm base_comm) {
-  int unused = 0;
-  MPI_Ssend(&unused, 1, MPI_INT, 0, MPIDYNRES_TAG_DONE_RUNNING, base_comm);
+static void MPIDYNRES_notify_worker_done(MPIDYNRES_transport *transport,
+                                         double cpu_seconds) {
+  MPIDYNRES_transport_send(transport, &cpu_seconds, sizeof(double), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+}
+
+/**
+ * @brief      Run the warm-up function of a job, if it has one
+ *
+ * @param      job The job
+ *
+ * @param      argc The argc argument that shall be forwarded to the warm-up
+ *
+ * @param      argv The argv argument that shall be forwarded to the warm-up
+ */
+static void MPIDYNRES_SIM_warm_up(MPIDYNRES_SIM_job const *job, int argc,
+                                  char *argv[]) {
+  if (job->sim_warmup != NULL) {
+    job->sim_warmup(argc, argv);
+  }
 }
 
 /**
  * @brief      Start the simulation for a non-scheduler rank (!= 0)
  *
  * @details    Contains the main loop, that waits for commands from the
- * scheduler and then either starts or shuts down
+ * scheduler and then either starts, warms up or shuts down
  *
  * @param      i_config The simulation config
  *
@@ -70,20 +199,30 @@ static void MPIDYNRES_notify_worker_done(MPI_Comm base_comm) {
  * @param      argv The argv argument that shall be forwarded to the simulation
  * entry
  *
- * @param      o_sim_main The main function that should be used as an entry
- * point for the simulation
+ * @param      num_jobs The number of jobs
+ *
+ * @param      i_jobs The jobs, the start command tells which one to run
  */
 static void MPIDYNRES_SIM_start_worker(MPIDYNRES_SIM_config *i_config, int argc, char *argv[],
-                            int o_sim_main(int, char **)) {
+                            int num_jobs, MPIDYNRES_SIM_job const i_jobs[]) {
   MPIDYNRES_idle_command idle_command = {0};
+  int warm_job = MPIDYNRES_NO_JOB;  // the job whose warm-up already ran
+  int myrank;
 
   register_debug_comm(i_config->base_communicator);
+  MPI_Comm_rank(i_config->base_communicator, &myrank);
+  trace_open(MPIDYNRES_scheduler_get_id_of_rank(myrank), 0);
+
+  // mpirun forwards SIGUSR1 to all ranks, only the scheduler takes snapshots
+  if (getenv(SNAPSHOT_ENVVAR) != NULL) {
+    signal(SIGUSR1, SIG_IGN);
+  }
 
   // idle loop
   bool done = false;
   while (!done) {
     // block until next command given
-    MPIDYNRES_SIM_get_idle_command(&idle_command, i_config->base_communicator);
+    MPIDYNRES_SIM_get_idle_command(&idle_command, g_MPIDYNRES_transport);
 
     // decide what to todo based on the command received
     switch (idle_command.command_type) {
@@ -92,17 +231,44 @@ static void MPIDYNRES_SIM_start_worker(MPIDYNRES_SIM_config *i_config, int argc,
         done = true;
         break;
       }
+      case warm: {
+        debug("Got warm signal for job %d\n", idle_command.job_id);
+        if (idle_command.job_id < 0 || idle_command.job_id >= num_jobs) {
+          die("Got warm signal for unknown job %d\n", idle_command.job_id);
+        }
+        if (warm_job != idle_command.job_id) {
+          MPIDYNRES_SIM_warm_up(&i_jobs[idle_command.job_id], argc, argv);
+          warm_job = idle_command.job_id;
+        }
+        break;
+      }
       case start: {
-        debug("Got start signal, let's get rolling...\n");
+        debug("Got start signal for job %d, let's get rolling...\n",
+              idle_command.job_id);
+        if (idle_command.job_id < 0 || idle_command.job_id >= num_jobs) {
+          die("Got start signal for unknown job %d\n", idle_command.job_id);
+        }
+        // crs that were not on standby warm up on the critical path
+        if (warm_job != idle_command.job_id) {
+          MPIDYNRES_SIM_warm_up(&i_jobs[idle_command.job_id], argc, argv);
+        }
+        warm_job = MPIDYNRES_NO_JOB;
+        trace_set_job(idle_command.job_id);
+        tool_set_cr(MPIDYNRES_scheduler_get_id_of_rank(myrank),
+                    idle_command.job_id);
+
+        // volatile as it is read after longjmp
+        volatile double cpu_start = MPIDYNRES_cpu_seconds();
 
         // setup return jump so simulations can call MPIDYNRES_exit()
         int val = setjmp(g_MPIDYNRES_JMP_BUF);
         if (val == 0) {
-          o_sim_main(argc, argv);
+          i_jobs[idle_command.job_id].sim_main(argc, argv);
         }
 
         debug("returned from simulation, notifying manager about it\n");
-        MPIDYNRES_notify_worker_done(i_config->base_communicator);
+        MPIDYNRES_notify_worker_done(g_MPIDYNRES_transport,
+                                     MPIDYNRES_cpu_seconds() - cpu_start);
         break;
       }
       default: {
@@ -111,12 +277,61 @@ static void MPIDYNRES_SIM_start_worker(MPIDYNRES_SIM_config *i_config, int argc,
       }
     }
   }
+  trace_close();
+}
+
+/**
+ * @brief      Query the metrics of the scheduler
+ *
+ * @details    Has to be called by a simulated process. See
+ * MPIDYNRES_scheduler_get_stats for the keys.
+ *
+ * @param      o_stats A new info object with the metrics is returned here, has
+ * to be freed by the caller
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_SIM_get_stats(MPI_Info *o_stats) {
+  int unused = 0;
+  int err;
+
+  err = MPIDYNRES_transport_send(g_MPIDYNRES_transport, &unused, sizeof(int),
+                                 0, MPIDYNRES_TAG_GET_STATS);
+  if (err) {
+    return err;
+  }
+  return MPIDYNRES_transport_recv_info(g_MPIDYNRES_transport, o_stats, 0,
+                                       MPIDYNRES_TAG_GET_STATS_ANSWER_SIZE,
+                                       MPIDYNRES_TAG_GET_STATS_ANSWER);
+}
+
+/**
+ * @brief      Get the utilization of the computing resources during the last
+ * simulation
+ *
+ * @details    Can be called by all ranks of the base communicator after
+ * MPIDYNRES_SIM_start or MPIDYNRES_SIM_start_jobs returned. The job report
+ * (JOB_REPORT_ENVVAR) has the same numbers per job and per cr.
+ *
+ * @param      o_utilization The utilization is returned here
+ *
+ * @return     if != 0, no simulation has finished yet
+ */
+int MPIDYNRES_SIM_get_utilization(MPIDYNRES_SIM_utilization *o_utilization) {
+  if (!g_MPIDYNRES_utilization_valid) {
+    return 1;
+  }
+  *o_utilization = g_MPIDYNRES_utilization;
+  return 0;
 }
 
 /**
  * @brief      Internal cleanup function
  */
-static void cleanup() { free_all_mpi_datatypes(); }
+static void cleanup() {
+  MPIDYNRES_transport_free(g_MPIDYNRES_transport);
+  g_MPIDYNRES_transport = NULL;
+}
 
 /**
  * @brief      get a sane default config for mpidynres
@@ -154,6 +369,38 @@ int MPIDYNRES_SIM_get_default_config(MPIDYNRES_SIM_config *o_config) {
  */
 int MPIDYNRES_SIM_start(MPIDYNRES_SIM_config i_config, int argc, char *argv[],
                         int i_sim_main(int, char **)) {
+  MPIDYNRES_SIM_job job = {
+      .sim_main = i_sim_main,
+      .manager_config = MPI_INFO_NULL,
+      .submit_time = 0.0,
+  };
+  return MPIDYNRES_SIM_start_jobs(i_config, 1, &job, argc, argv);
+}
+
+/**
+ * @brief      Start the mpidynres simulation with several jobs
+ *
+ * @details    This function has to be called by all ranks inside the config
+ * base communicator. The jobs share the crs, every job has its own
+ * mpi://WORLD and manager.
+ *
+ * @param      i_config The mpidynres config that will be used
+ *
+ * @param      num_jobs The number of jobs
+ *
+ * @param      i_jobs The jobs, in the order they are submitted
+ *
+ * @param      argc The argc that should be passed to the entry functions of
+ * the simulated processes
+ *
+ * @param      argv The argv that should be passed to the entry functions of
+ * the simulated processes
+ *
+ * @return     if return value != 0, an error has happened
+ */
+int MPIDYNRES_SIM_start_jobs(MPIDYNRES_SIM_config i_config, int num_jobs,
+                             MPIDYNRES_SIM_job const i_jobs[], int argc,
+                             char *argv[]) {
   int myrank;
   int size;
   int initialized;
@@ -163,9 +410,13 @@ int MPIDYNRES_SIM_start(MPIDYNRES_SIM_config i_config, int argc, char *argv[],
   if (!initialized) {
     die("You need to initialize MPI before calling MPIDYNRES_SIM_start\n");
   }
+  if (num_jobs < 1) {
+    die("At least one job has to be given\n");
+  }
 
   // setup internal global variable (necessary for clean api)
   g_MPIDYNRES_base_comm = i_config.base_communicator;
+  g_MPIDYNRES_transport = MPIDYNRES_transport_create(i_config.base_communicator);
 
   MPI_Comm_size(i_config.base_communicator, &size);
   MPI_Comm_rank(i_config.base_communicator, &myrank);
@@ -175,16 +426,21 @@ int MPIDYNRES_SIM_start(MPIDYNRES_SIM_config i_config, int argc, char *argv[],
   switch (myrank) {
     case 0: {
       debug("Am rank 0, starting scheduler\n");
-      MPIDYNRES_SIM_start_scheduler(&i_config);
+      MPIDYNRES_SIM_start_scheduler(&i_config, num_jobs, i_jobs);
       break;
     }
     default: {
       debug("I'm not rank 0, waiting for commands\n");
-      MPIDYNRES_SIM_start_worker(&i_config, argc, argv, i_sim_main);
+      MPIDYNRES_SIM_start_worker(&i_config, argc, argv, num_jobs, i_jobs);
       break;
     }
   }
 
+  // every rank can query the utilization afterwards
+  MPI_Bcast(&g_MPIDYNRES_utilization, sizeof(g_MPIDYNRES_utilization), MPI_BYTE,
+            0, i_config.base_communicator);
+  g_MPIDYNRES_utilization_valid = true;
+
   cleanup();
 
   // uncomment for debugging
@@ -2,18 +2,60 @@
 // TODO: Improve error handling
 
 #include <mpi.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "call_trace.h"
+#include "checkpoint.h"
 #include "comm.h"
 #include "logging.h"
 #include "mpidynres.h"
 #include "scheduler_handlers.h"
+#include "snapshot.h"
+#include "tool.h"
+#include "trace.h"
 #include "util.h"
 
+// how long the scheduler waits at most before it looks for snapshot and
+// checkpoint requests again, requests, timers and job arrivals end the wait
+// earlier
+#define IDLE_POLL_INTERVAL 1e-3
+// while waiting, the scheduler sleeps between probes, starting with
+// WAIT_MIN_BACKOFF and doubling up to WAIT_MAX_BACKOFF, so a request waits at
+// most WAIT_MAX_BACKOFF. Closer than WAIT_SPIN_THRESHOLD to the deadline, it
+// only yields, so the deadline is not overslept.
+#define WAIT_MIN_BACKOFF 1e-6
+#define WAIT_MAX_BACKOFF 1e-4
+#define WAIT_SPIN_THRESHOLD 1e-5
+
 /*
  * PRIVATE FUNCTIONS
  */
+/**
+ * @brief      Send the "start" command to a cr that belongs to a job
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      cr_id The cr
+ */
+static void send_start_command(MPIDYNRES_scheduler *scheduler, int cr_id) {
+  MPIDYNRES_idle_command command = {
+      .command_type = start,
+      .job_id = scheduler->job_id,
+  };
+  MPIDYNRES_transport_send(scheduler->transport, &command, sizeof(command),
+                           cr_id, MPIDYNRES_TAG_IDLE_COMMAND);
+
+  log_state_event(STATELOG_CR_STARTED);
+  // it may already be shutting down again
+  if (scheduler->pool->cr_state[cr_id] == reserved ||
+      scheduler->pool->cr_state[cr_id] == idle) {
+    MPIDYNRES_scheduler_set_cr_state(scheduler, cr_id, running);
+  }
+}
+
 /**
  * @brief      send the "start" command to a rank and update its process state
  *
@@ -28,10 +70,16 @@
  * @param      origin_rc_info The info passed to the resource change accept
  * function
  *
+ * @param      delay Seconds until the start command is sent (the start
+ * latency), the cr is reserved until then. The cr belongs to the job right
+ * away.
+ *
  */
 void MPIDYNRES_scheduler_start_cr(MPIDYNRES_scheduler *scheduler, int i_cr,
                                   bool dynamic_start, int origin_rc_tag,
-                                  MPI_Info origin_rc_info) {
+                                  MPI_Info origin_rc_info, double delay) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+
   // check that process is neither running nor reserved
   set_process_state_node *res = set_process_state_find(
       &scheduler->process_states, (process_state){.process_id = i_cr});
@@ -40,6 +88,10 @@ void MPIDYNRES_scheduler_start_cr(MPIDYNRES_scheduler *scheduler, int i_cr,
   // check that it's not contained in running_crs
   assert(set_int_count(&scheduler->running_crs, i_cr) == 0);
 
+  // check that no other job uses it
+  assert(pool->owner[i_cr] == MPIDYNRES_NO_JOB ||
+         pool->owner[i_cr] == scheduler->job_id);
+
   process_state new_process_state = {
       .process_id = i_cr,
       .active = true,
@@ -66,17 +118,39 @@ void MPIDYNRES_scheduler_start_cr(MPIDYNRES_scheduler *scheduler, int i_cr,
   // set process state in scheduler
   set_process_state_insert(&scheduler->process_states, new_process_state);
 
-  // send start command
-  MPIDYNRES_idle_command command = {
-      .command_type = start,
-  };
-  MPI_Send(&command, 1, get_idle_command_datatype(), i_cr,
-           MPIDYNRES_TAG_IDLE_COMMAND, scheduler->config->base_communicator);
-
   set_int_insert(&scheduler->running_crs, i_cr);
 
-  set_state(i_cr, running);
-  log_state("Starting cr id %d", i_cr);
+  pool->owner[i_cr] = scheduler->job_id;
+  pool->cr_start_time[i_cr] = MPI_Wtime();
+  pool->num_running++;
+  if (dynamic_start) {
+    pool->metrics.cr_started_ns[i_cr] = MPIDYNRES_now_ns();
+    if (pool->standby[i_cr] == scheduler->job_id) {
+      pool->metrics.standby_hits++;
+    } else {
+      pool->metrics.standby_misses++;
+    }
+  }
+  pool->standby[i_cr] = MPIDYNRES_NO_JOB;
+  if ((int)scheduler->running_crs.size > scheduler->job_stats.max_size) {
+    scheduler->job_stats.max_size = scheduler->running_crs.size;
+  }
+
+  if (delay > 0.0) {
+    if (pool->cr_state[i_cr] != reserved) {
+      log_state_event(STATELOG_PROPOSE_START);
+      MPIDYNRES_scheduler_set_cr_state(scheduler, i_cr, reserved);
+    }
+    MPIDYNRES_scheduler_add_cr_timer(scheduler, delay, TIMER_CR_START, i_cr);
+  } else {
+    send_start_command(scheduler, i_cr);
+  }
+  if (tool_wants(MPIDYNRES_TOOL_CR_STARTED)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_CR_STARTED, scheduler->job_id, i_cr);
+    event.rc_tag = origin_rc_tag;
+    tool_fire(&event);
+  }
 }
 
 /**
@@ -89,276 +163,799 @@ void MPIDYNRES_scheduler_shutdown_all_crs(MPIDYNRES_scheduler *scheduler) {
       .command_type = shutdown,
   };
 
-  assert(scheduler->running_crs.size == 0);
+  assert(scheduler->pool->num_running == 0);
   for (int cr = 1; cr < 1 + scheduler->num_scheduling_processes; cr++) {
-    MPI_Send(&command, 1, get_idle_command_datatype(), cr,
-             MPIDYNRES_TAG_IDLE_COMMAND, scheduler->config->base_communicator);
+    MPIDYNRES_transport_send(scheduler->transport, &command, sizeof(command),
+                             cr, MPIDYNRES_TAG_IDLE_COMMAND);
   }
 }
 
+// different message contents
+union request_msg {
+  int unused;
+  double cpu_seconds;
+  int session_id;
+  int pset_info_msg[2];
+  int pset_lookup_msg[2];
+  int rc_accept_msg[2];
+  MPIDYNRES_pset_op_msg pset_op_msg;
+  MPIDYNRES_pset_free_msg pset_free_msg;
+};
+
 /**
- * @brief      The main loop of the scheduler
+ * @brief      Start the handler for a received request
  *
- * @details    The most important function of the scheduler, it is waiting for
- * different requests, starts the handler and gets back to waiting. when all crs
- * are idle, it will shut them all down and return
- * For the handlers themselves, see scheduler_
+ * @details    The handling time is recorded in the metrics. If the trace is
+ * enabled, the handler becomes a span on the scheduler track
  *
  * @param      scheduler The scheduler
+ *
+ * @param      status The status of the received request
+ *
+ * @param      msg The content of the request
  */
-void MPIDYNRES_scheduler_schedule(MPIDYNRES_scheduler *scheduler) {
-  MPI_Status status;
-  int index;
-
-  // different message contents
-  int unused = {0};
-  int session_id = {0};
-  int pset_info_msg[2] = {0};
-  int pset_lookup_msg[2] = {0};
-  int rc_accept_msg[2] = {0};
-  MPIDYNRES_pset_op_msg pset_op_msg = {0};
-  MPIDYNRES_pset_free_msg pset_free_msg = {0};
-
-  // different requests that we could get
-  enum {
-    worker_done_request,
-
-    session_create_request,
-    session_info_request,
-    session_finalize_request,
-
-    get_psets_request,
-    pset_info_request,
-
-    pset_lookup_request,
-    pset_op_request,
-    pset_free_request,
-
-    sched_hints_request,
-    rc_request,
-    rc_accept_request,
-
-    REQUEST_COUNT
+static void MPIDYNRES_scheduler_dispatch(MPIDYNRES_scheduler *scheduler,
+                                         MPIDYNRES_transport_status *status,
+                                         union request_msg *msg) {
+  uint64_t start = MPIDYNRES_now_ns();
+  debug("Got command %d\n", status->tag);
+
+  MPIDYNRES_metrics_request_received(
+      scheduler, MPIDYNRES_scheduler_get_id_of_rank(status->source), start);
+
+  switch (status->tag) {
+    case MPIDYNRES_TAG_DONE_RUNNING: {
+      // older senders do not report the CPU time
+      MPIDYNRES_scheduler_handle_worker_done(
+          scheduler, status,
+          status->size == sizeof(double) ? msg->cpu_seconds : 0.0);
+      break;
+    }
+
+    case MPIDYNRES_TAG_SESSION_CREATE: {
+      MPIDYNRES_scheduler_handle_session_create(scheduler, status);
+      break;
+    }
+    case MPIDYNRES_TAG_SESSION_INFO: {
+      MPIDYNRES_scheduler_handle_session_info(scheduler, status);
+      break;
+    }
+    case MPIDYNRES_TAG_SESSION_FINALIZE: {
+      MPIDYNRES_scheduler_handle_session_finalize(scheduler, status);
+      break;
+    }
+
+    case MPIDYNRES_TAG_GET_PSETS: {
+      MPIDYNRES_scheduler_handle_get_psets(scheduler, status);
+      break;
+    }
+    case MPIDYNRES_TAG_PSET_INFO: {
+      debug("pset_info_msg: [%d, %d] from %d\n", msg->pset_info_msg[0],
+            msg->pset_info_msg[1], status->source);
+      MPIDYNRES_scheduler_handle_pset_info(scheduler, status,
+                                           msg->pset_info_msg[1]);
+      break;
+    }
+
+    case MPIDYNRES_TAG_PSET_LOOKUP: {
+      MPIDYNRES_scheduler_handle_pset_lookup(scheduler, status,
+                                             msg->pset_lookup_msg[1]);
+      break;
+    }
+    case MPIDYNRES_TAG_PSET_OP: {
+      MPIDYNRES_scheduler_handle_pset_op(scheduler, status,
+                                         &msg->pset_op_msg);
+      break;
+    }
+    case MPIDYNRES_TAG_PSET_FREE: {
+      MPIDYNRES_scheduler_handle_pset_free(scheduler, status,
+                                           &msg->pset_free_msg);
+      break;
+    }
+
+    case MPIDYNRES_TAG_SCHED_HINTS: {
+      MPIDYNRES_scheduler_handle_sched_hints(scheduler, status,
+                                             msg->session_id);
+      break;
+    }
+    case MPIDYNRES_TAG_RC: {
+      MPIDYNRES_scheduler_handle_rc(scheduler, status, msg->session_id);
+      break;
+    }
+    case MPIDYNRES_TAG_RC_ACCEPT: {
+      MPIDYNRES_scheduler_handle_rc_accept(
+          scheduler, status, msg->rc_accept_msg[0], msg->rc_accept_msg[1]);
+      break;
+    }
+    case MPIDYNRES_TAG_GET_STATS: {
+      MPIDYNRES_scheduler_handle_get_stats(scheduler, status);
+      break;
+    }
+    default: {
+      die("Request not implemented: %d\n", status->tag);
+      break;
+    }
   };
 
-  MPI_Request requests[REQUEST_COUNT];
-
-  // setup requests array
-  MPI_Irecv(&unused, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_DONE_RUNNING,
-            scheduler->config->base_communicator,
-            &requests[worker_done_request]);
-
-  MPI_Irecv(&unused, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_SESSION_CREATE,
-            scheduler->config->base_communicator,
-            &requests[session_create_request]);
-  MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_SESSION_INFO,
-            scheduler->config->base_communicator,
-            &requests[session_info_request]);
-  MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE,
-            MPIDYNRES_TAG_SESSION_FINALIZE,
-            scheduler->config->base_communicator,
-            &requests[session_finalize_request]);
-
-  MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_GET_PSETS,
-            scheduler->config->base_communicator, &requests[get_psets_request]);
-  MPI_Irecv(pset_info_msg, 2, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_PSET_INFO,
-            scheduler->config->base_communicator, &requests[pset_info_request]);
-
-  MPI_Irecv(pset_lookup_msg, 2, MPI_INT, MPI_ANY_SOURCE,
-            MPIDYNRES_TAG_PSET_LOOKUP, scheduler->config->base_communicator,
-            &requests[pset_lookup_request]);
-  MPI_Irecv(&pset_op_msg, 1, get_pset_op_datatype(), MPI_ANY_SOURCE,
-            MPIDYNRES_TAG_PSET_OP, scheduler->config->base_communicator,
-            &requests[pset_op_request]);
-  MPI_Irecv(&pset_free_msg, 1, get_pset_free_datatype(), MPI_ANY_SOURCE,
-            MPIDYNRES_TAG_PSET_FREE, scheduler->config->base_communicator,
-            &requests[pset_free_request]);
-
-  MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_SCHED_HINTS,
-            scheduler->config->base_communicator,
-            &requests[sched_hints_request]);
-  MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_RC,
-            scheduler->config->base_communicator, &requests[rc_request]);
-  MPI_Irecv(rc_accept_msg, 2, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_RC_ACCEPT,
-            scheduler->config->base_communicator, &requests[rc_accept_request]);
-
-  while (scheduler->running_crs.size > 0) {
-    debug("Waiting for commands...\n");
-
-    MPI_Waitany(REQUEST_COUNT, requests, &index, &status);
-
-    debug("Got command %d\n", index);
-
-    switch (index) {
-      case worker_done_request: {
-        MPIDYNRES_scheduler_handle_worker_done(scheduler, &status);
-
-        // create new request
-        MPI_Irecv(&unused, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_DONE_RUNNING,
-                  scheduler->config->base_communicator,
-                  &requests[worker_done_request]);
-        break;
-      }
+  MPIDYNRES_metrics_request_handled(scheduler, status->tag, start);
+  if (trace_enabled()) {
+    trace_span(TRACE_PID_SCHEDULER, 0, MPIDYNRES_tag_name(status->tag), start,
+               scheduler->job_id, status->source);
+  }
+}
+
+/**
+ * @brief      Wait for the next request and handle it
+ *
+ * @details    The request can come from a cr of any job of the pool
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_scheduler_handle_next(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_transport_status status;
+  union request_msg msg;
+  int err;
+
+  debug("Waiting for commands...\n");
+
+  err = MPIDYNRES_transport_recv(scheduler->transport, &msg, sizeof(msg),
+                                 MPIDYNRES_ANY_SOURCE, MPIDYNRES_ANY_TAG,
+                                 &status);
+  if (err) {
+    die("Error in MPIDYNRES_transport_recv\n");
+  }
 
-      case session_create_request: {
-        MPIDYNRES_scheduler_handle_session_create(scheduler, &status);
+  // the request is handled by the job the cr belongs to
+  int job_id =
+      scheduler->pool->owner[MPIDYNRES_scheduler_get_id_of_rank(status.source)];
+  if (job_id == MPIDYNRES_NO_JOB) {
+    die("Got request %d from cr %d, which does not run\n", status.tag,
+        status.source);
+  }
+  MPIDYNRES_scheduler_dispatch(scheduler->pool->jobs[job_id], &status, &msg);
+}
 
-        // create new request
-        MPI_Irecv(&unused, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_SESSION_CREATE,
-                  scheduler->config->base_communicator,
-                  &requests[session_create_request]);
-        break;
-      }
-      case session_info_request: {
-        MPIDYNRES_scheduler_handle_session_info(scheduler, &status);
-
-        // create new request
-        MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_SESSION_INFO,
-                  scheduler->config->base_communicator,
-                  &requests[session_info_request]);
-        break;
-      }
-      case session_finalize_request: {
-        MPIDYNRES_scheduler_handle_session_finalize(scheduler, &status);
-
-        // create new request
-        MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_SESSION_FINALIZE,
-                  scheduler->config->base_communicator,
-                  &requests[session_finalize_request]);
-        break;
-      }
+/**
+ * @brief      Handle all requests that already arrived without blocking
+ *
+ * @details    Can be used to drive the scheduler from a loop that also does
+ * other work, e.g. when the crs live in the same process. Expired timers are
+ * passed to the managers first.
+ *
+ * @param      scheduler The scheduler
+ *
+ * @return     The number of handled requests
+ */
+int MPIDYNRES_scheduler_progress(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_transport_status status;
+  int handled = 0;
+  int flag;
+  int err;
+
+  MPIDYNRES_snapshot_poll(scheduler);
+  MPIDYNRES_checkpoint_poll(scheduler);
+  MPIDYNRES_scheduler_run_timers(scheduler);
+  for (;;) {
+    err = MPIDYNRES_transport_iprobe(scheduler->transport,
+                                     MPIDYNRES_ANY_SOURCE, MPIDYNRES_ANY_TAG,
+                                     &flag, &status);
+    if (err) {
+      die("Error in MPIDYNRES_transport_iprobe\n");
+    }
+    if (!flag) {
+      return handled;
+    }
+    MPIDYNRES_scheduler_handle_next(scheduler);
+    handled++;
+  }
+}
 
-      case get_psets_request: {
-        MPIDYNRES_scheduler_handle_get_psets(scheduler, &status);
+/**
+ * @brief      Return whether a job has already arrived
+ *
+ * @param      job The scheduler of the job
+ *
+ * @param      now The current time (MPI_Wtime)
+ *
+ * @return     true if the submit time of the job has passed
+ */
+static bool job_submitted(MPIDYNRES_scheduler *job, double now) {
+  return now - job->pool->start_time >= job->job_stats.submit_time;
+}
 
-        // create new request
-        MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_GET_PSETS, scheduler->config->base_communicator,
-                  &requests[get_psets_request]);
-        break;
+/**
+ * @brief      Count the jobs that did not start yet
+ *
+ * @param      pool The pool
+ *
+ * @param      o_num_unsubmitted The number of jobs that did not arrive yet is
+ * returned here
+ *
+ * @return     The number of jobs that did not start yet
+ */
+static int jobs_not_started(MPIDYNRES_pool *pool, int *o_num_unsubmitted) {
+  double now = MPI_Wtime();
+  int res = 0;
+
+  *o_num_unsubmitted = 0;
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    if (job->job_stats.start_time < 0.0) {
+      res++;
+      *o_num_unsubmitted += !job_submitted(job, now);
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief      Set a timer for the manager of a job
+ *
+ * @details    When the timer expires, MPIDYNRES_manager_handle_timer is called
+ * with timer_id. The scheduler waits for requests only until the deadline of
+ * the next timer, so a timer expires on time unless a request is being
+ * handled at its deadline, then it expires right after that request.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      delay Seconds until the timer expires
+ *
+ * @param      timer_id Passed to the manager
+ *
+ * @return     A handle that can be passed to MPIDYNRES_scheduler_cancel_timer
+ */
+int MPIDYNRES_scheduler_add_timer(MPIDYNRES_scheduler *scheduler,
+                                  double delay, int timer_id) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  timer t = {
+      .deadline = MPI_Wtime() + delay,
+      .handle = pool->next_timer_handle++,
+      .job_id = scheduler->job_id,
+      .timer_id = timer_id,
+      .kind = TIMER_MANAGER,
+      .cr_id = -1,
+  };
+  set_timer_insert(&pool->timers, t);
+  return t.handle;
+}
+
+/**
+ * @brief      Cancel a timer that did not expire yet
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      handle The handle returned by MPIDYNRES_scheduler_add_timer
+ *
+ * @return     false if there is no such timer
+ */
+bool MPIDYNRES_scheduler_cancel_timer(MPIDYNRES_scheduler *scheduler,
+                                      int handle) {
+  set_timer *timers = &scheduler->pool->timers;
+
+  foreach (set_timer, timers, it) {
+    if (it.ref->handle == handle) {
+      set_timer_erase(timers, *it.ref);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief      Get the time until the next timer expires
+ *
+ * @param      pool The pool
+ *
+ * @param      now The current time (MPI_Wtime)
+ *
+ * @return     The seconds until the next deadline (<= 0 if it passed) or -1
+ * if there are no timers
+ */
+static double next_timer(MPIDYNRES_pool *pool, double now) {
+  if (set_timer_empty(&pool->timers)) {
+    return -1.0;
+  }
+  double res = set_timer_node_min(pool->timers.root)->key.deadline - now;
+  return res < 0.0 ? 0.0 : res;
+}
+
+/**
+ * @brief      Act on a timer that was removed from the pool
+ *
+ * @details    Manager timers of jobs that are already finished are dropped
+ *
+ * @param      pool The pool
+ *
+ * @param      t The timer
+ *
+ * @return     Whether the timer was handled
+ */
+static bool fire_timer(MPIDYNRES_pool *pool, timer t) {
+  MPIDYNRES_scheduler *job = pool->jobs[t.job_id];
+
+  switch (t.kind) {
+    case TIMER_MANAGER: {
+      if (job->job_stats.end_time >= 0.0) {
+        return false;
       }
-      case pset_info_request: {
-        debug("pset_info_msg: [%d, %d] from %d\n", pset_info_msg[0],
-              pset_info_msg[1], status.MPI_SOURCE);
-        MPIDYNRES_scheduler_handle_pset_info(scheduler, &status,
-                                             pset_info_msg[1]);
-
-        // create new request
-        MPI_Irecv(pset_info_msg, 2, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_PSET_INFO, scheduler->config->base_communicator,
-                  &requests[pset_info_request]);
-        break;
+      if (MPIDYNRES_manager_handle_timer(job->manager, t.timer_id)) {
+        die("An error happened while handling timer %d of job %d\n",
+            t.timer_id, t.job_id);
       }
+      return true;
+    }
+    case TIMER_CR_START: {
+      send_start_command(job, t.cr_id);
+      return true;
+    }
+    case TIMER_CR_RELEASE: {
+      MPIDYNRES_scheduler_release_cr(job, t.cr_id);
+      return true;
+    }
+  }
+  return false;
+}
 
-      case pset_lookup_request: {
-        MPIDYNRES_scheduler_handle_pset_lookup(scheduler, &status,
-                                               pset_lookup_msg[1]);
+/**
+ * @brief      Handle all expired timers
+ *
+ * @details    Manager timers are passed to the managers, a manager may set
+ * new timers while handling one. Delayed starts and releases of crs are
+ * carried out.
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @return     The number of expired timers
+ */
+int MPIDYNRES_scheduler_run_timers(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  double now = MPI_Wtime();
+  int res = 0;
+
+  while (!set_timer_empty(&pool->timers)) {
+    timer t = set_timer_node_min(pool->timers.root)->key;
+    if (t.deadline > now) {
+      break;
+    }
+    set_timer_erase(&pool->timers, t);
+    res += fire_timer(pool, t);
+  }
+  return res;
+}
 
-        // create new request
-        MPI_Irecv(&pset_lookup_msg, 2, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_PSET_LOOKUP,
-                  scheduler->config->base_communicator,
-                  &requests[pset_lookup_request]);
-        break;
-      }
-      case pset_op_request: {
-        MPIDYNRES_scheduler_handle_pset_op(scheduler, &status, &pset_op_msg);
+/**
+ * @brief      Delay the start or the release of a cr
+ *
+ * @param      scheduler The scheduler of the job the cr belongs to
+ *
+ * @param      delay Seconds until the cr is started or released
+ *
+ * @param      kind TIMER_CR_START or TIMER_CR_RELEASE
+ *
+ * @param      cr_id The cr
+ */
+void MPIDYNRES_scheduler_add_cr_timer(MPIDYNRES_scheduler *scheduler,
+                                      double delay, enum timer_kind kind,
+                                      int cr_id) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  timer t = {
+      .deadline = MPI_Wtime() + delay,
+      .handle = pool->next_timer_handle++,
+      .job_id = scheduler->job_id,
+      .timer_id = -1,
+      .kind = kind,
+      .cr_id = cr_id,
+  };
+  assert(kind != TIMER_MANAGER);
+  set_timer_insert(&pool->timers, t);
+}
 
-        // create new request
-        MPI_Irecv(&pset_op_msg, 1, get_pset_op_datatype(), MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_PSET_OP, scheduler->config->base_communicator,
-                  &requests[pset_op_request]);
+/**
+ * @brief      Start and release all delayed crs right away
+ *
+ * @details    Used by the replay of call traces, which does not wait for the
+ * injected latencies
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @return     The number of started and released crs
+ */
+int MPIDYNRES_scheduler_flush_cr_timers(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int res = 0;
+
+  for (;;) {
+    timer *next = NULL;
+    foreach (set_timer, &pool->timers, it) {
+      if (it.ref->kind != TIMER_MANAGER) {
+        next = it.ref;
         break;
       }
-      case pset_free_request: {
-        MPIDYNRES_scheduler_handle_pset_free(scheduler, &status,
-                                             &pset_free_msg);
+    }
+    if (next == NULL) {
+      return res;
+    }
+    timer t = *next;
+    set_timer_erase(&pool->timers, t);
+    res += fire_timer(pool, t);
+  }
+}
 
-        MPI_Irecv(&pset_free_msg, 1, get_pset_free_datatype(), MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_PSET_FREE, scheduler->config->base_communicator,
-                  &requests[pset_free_request]);
-        break;
-      }
+/**
+ * @brief      Draw a latency and record it in the metrics
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      latency The latency model of the job
+ *
+ * @param      histogram The injected latencies of this kind
+ *
+ * @param      num_crs The number of crs that are started or shut down
+ * together
+ *
+ * @return     The latency in seconds
+ */
+static double draw_latency(MPIDYNRES_scheduler *scheduler,
+                           MPIDYNRES_latency *latency,
+                           MPIDYNRES_histogram *histogram, int num_crs) {
+  if (latency->kind == LATENCY_NONE) {
+    return 0.0;
+  }
+  double res =
+      MPIDYNRES_latency_draw(latency, num_crs, &scheduler->latency_rng_state);
+  MPIDYNRES_histogram_record(histogram, res * 1e9);
+  return res;
+}
 
-      case sched_hints_request: {
-        MPIDYNRES_scheduler_handle_sched_hints(scheduler, &status, session_id);
+/**
+ * @brief      Draw the start latency of crs of a job
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      num_crs The number of crs that are started together
+ *
+ * @return     The latency in seconds (manager_start_latency), 0 if the job
+ * has no start latency
+ */
+double MPIDYNRES_scheduler_draw_start_latency(MPIDYNRES_scheduler *scheduler,
+                                              int num_crs) {
+  return draw_latency(scheduler, &scheduler->start_latency,
+                      &scheduler->pool->metrics.start_latency, num_crs);
+}
 
-        // create new request
-        MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_SCHED_HINTS,
-                  scheduler->config->base_communicator,
-                  &requests[sched_hints_request]);
-        break;
-      }
-      case rc_request: {
-        MPIDYNRES_scheduler_handle_rc(scheduler, &status, session_id);
+/**
+ * @brief      Draw the shutdown latency of a cr of a job
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      num_crs The number of crs that are shut down together
+ *
+ * @return     The latency in seconds (manager_shutdown_latency), 0 if the
+ * job has no shutdown latency
+ */
+double MPIDYNRES_scheduler_draw_shutdown_latency(
+    MPIDYNRES_scheduler *scheduler, int num_crs) {
+  return draw_latency(scheduler, &scheduler->shutdown_latency,
+                      &scheduler->pool->metrics.shutdown_latency, num_crs);
+}
 
-        // create new request
-        MPI_Irecv(&session_id, 1, MPI_INT, MPI_ANY_SOURCE, MPIDYNRES_TAG_RC,
-                  scheduler->config->base_communicator, &requests[rc_request]);
-        break;
-      }
-      case rc_accept_request: {
-        MPIDYNRES_scheduler_handle_rc_accept(
-            scheduler, &status, rc_accept_msg[0], rc_accept_msg[1]);
-
-        // create new request
-        MPI_Irecv(rc_accept_msg, 2, MPI_INT, MPI_ANY_SOURCE,
-                  MPIDYNRES_TAG_RC_ACCEPT, scheduler->config->base_communicator,
-                  &requests[rc_accept_request]);
-        break;
-      }
-      default: {
-        die("Request not implemented: %d\n", index);
-        break;
+/**
+ * @brief      Let an idle cr warm up for a job ahead of time
+ *
+ * @details    Used by managers to nominate crs they are going to add. The cr
+ * runs the warm-up function of the job (see MPIDYNRES_SIM_job) while it is
+ * idle, so an RC_ADD of this job that starts it does not wait for the
+ * warm-up. The cr is reserved for the job until it is started or the job ends:
+ * resource changes of other running jobs can not pick it, jobs that are
+ * started can (see MPIDYNRES_scheduler_cr_is_free). Warming up a cr that is
+ * already warmed up for the job does nothing.
+ * Managers deciding on their own thread (manager_async) can only call it from
+ * the calls that run on the scheduler thread.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      cr_id The cr, has to be free
+ */
+void MPIDYNRES_scheduler_warm_cr(MPIDYNRES_scheduler *scheduler, int cr_id) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+
+  if (scheduler->transport == NULL) {
+    die("Crs can not be warmed up from a manager thread (manager_async)\n");
+  }
+  if (!MPIDYNRES_scheduler_cr_is_free(scheduler, cr_id)) {
+    die("Tried to warm up cr %d, which is not free\n", cr_id);
+  }
+  if (pool->standby[cr_id] == scheduler->job_id) {
+    return;
+  }
+
+  MPIDYNRES_idle_command command = {
+      .command_type = warm,
+      .job_id = scheduler->job_id,
+  };
+  MPIDYNRES_transport_send(scheduler->transport, &command, sizeof(command),
+                           cr_id, MPIDYNRES_TAG_IDLE_COMMAND);
+  pool->standby[cr_id] = scheduler->job_id;
+  pool->metrics.standby_warmed++;
+}
+
+/**
+ * @brief      Keep the standby of all jobs at their manager_standby size
+ *
+ * @details    Running jobs that have less free crs warmed up than their
+ * standby size warm up more free crs, the ones with the lowest ids that are
+ * not warmed up for another running job (the crs MPIDYNRES_manager_pick_crs
+ * picks first). Called whenever the free crs or the standby sizes change:
+ * when a job starts, a resource change reserves or starts crs, a cr is
+ * released and the standby is resized. Jobs without a standby are skipped
+ * without looking at the crs.
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_scheduler_refill_standby(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    if (job->standby_size <= 0 || job->job_stats.start_time < 0.0 ||
+        job->job_stats.end_time >= 0.0) {
+      continue;
+    }
+    int num_warm = 0;
+    for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+      num_warm += pool->standby[cr] == job->job_id &&
+                  MPIDYNRES_scheduler_cr_is_free(job, cr);
+    }
+    for (int cr = 1; cr <= pool->num_scheduling_processes &&
+                     num_warm < job->standby_size;
+         cr++) {
+      int warmed_for = pool->standby[cr];
+      if (!MPIDYNRES_scheduler_cr_is_free(job, cr) ||
+          (warmed_for != MPIDYNRES_NO_JOB &&
+           pool->jobs[warmed_for]->job_stats.end_time < 0.0)) {
+        continue;
       }
-    };
+      MPIDYNRES_scheduler_warm_cr(job, cr);
+      num_warm++;
+    }
   }
+}
 
-  for (size_t i = 0; i < REQUEST_COUNT; i++) {
-    MPI_Request_free(&requests[i]);
+/**
+ * @brief      Change the number of free crs kept warmed up for a job
+ *
+ * @details    Used by managers that know how many crs they are going to add
+ * (manager_standby set to "auto"). Crs warmed up beyond the new size are given
+ * back to the other jobs, the ones with the highest ids first, missing ones
+ * are warmed up right away.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      size The number of crs
+ */
+void MPIDYNRES_scheduler_set_standby_size(MPIDYNRES_scheduler *scheduler,
+                                          int size) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int num_warm = 0;
+
+  scheduler->standby_size = size < 0 ? 0 : size;
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    if (pool->standby[cr] != scheduler->job_id ||
+        pool->owner[cr] != MPIDYNRES_NO_JOB) {
+      continue;
+    }
+    if (++num_warm > scheduler->standby_size) {
+      pool->standby[cr] = MPIDYNRES_NO_JOB;
+    }
   }
+  MPIDYNRES_scheduler_refill_standby(scheduler);
 }
 
-/*
- * PUBLIC METHODS
+/**
+ * @brief      Prepare the answer to the next rc request of a job
+ *
+ * @details    Used by managers to decide ahead of time (e.g. when a timer
+ * expires). The next rc request of the job gets this answer without asking
+ * the manager, unless the crs are not available anymore (then it gets
+ * RC_NONE). A decision that is already staged is replaced.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      rc_type The type of the resource change
+ *
+ * @param      pset The crs to add or remove, the set is taken over
  */
+void MPIDYNRES_scheduler_stage_rc(MPIDYNRES_scheduler *scheduler,
+                                  MPIDYNRES_RC_type rc_type, set_int *pset) {
+  if (scheduler->rc_staged) {
+    set_int_free(&scheduler->staged_rc_pset);
+  }
+  scheduler->rc_staged = true;
+  scheduler->staged_rc_type = rc_type;
+  scheduler->staged_rc_pset = *pset;
+  *pset = set_int_init(int_compare);
+}
 
 /**
- * @brief      Constructor for a new MPIDYNRES_scheduler
+ * @brief      Get the time at which the next job arrives
+ *
+ * @param      pool The pool
+ *
+ * @param      now The current time (MPI_Wtime)
+ *
+ * @return     The arrival time (MPI_Wtime) or a negative value if all jobs
+ * arrived
+ */
+static double next_submit(MPIDYNRES_pool *pool, double now) {
+  double res = -1.0;
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    if (job->job_stats.start_time >= 0.0 || job_submitted(job, now)) {
+      continue;
+    }
+    double submit = pool->start_time + job->job_stats.submit_time;
+    if (res < 0.0 || submit < res) {
+      res = submit;
+    }
+  }
+  return res;
+}
+
+/**
+ * @brief      Wait until a request arrives or a deadline passes
+ *
+ * @details    Probes the transport and sleeps in between, with a backoff of at
+ * most WAIT_MAX_BACKOFF, so rank 0 does not keep a core busy while it waits
+ * for timers or job arrivals. Only the last WAIT_SPIN_THRESHOLD before the
+ * deadline is spent yielding the cpu, so the deadline is met.
+ *
+ * @param      scheduler The scheduler
+ *
+ * @param      deadline The time (MPI_Wtime) to stop waiting at
+ */
+static void wait_for_request(MPIDYNRES_scheduler *scheduler, double deadline) {
+  MPIDYNRES_transport_status status;
+  double backoff = WAIT_MIN_BACKOFF;
+  int flag;
+
+  for (;;) {
+    if (MPIDYNRES_transport_iprobe(scheduler->transport, MPIDYNRES_ANY_SOURCE,
+                                   MPIDYNRES_ANY_TAG, &flag, &status)) {
+      die("Error in MPIDYNRES_transport_iprobe\n");
+    }
+    double left = deadline - MPI_Wtime();
+    if (flag || left <= 0.0) {
+      return;
+    }
+    if (left < WAIT_SPIN_THRESHOLD) {
+      sched_yield();
+      continue;
+    }
+    double sleep = left - WAIT_SPIN_THRESHOLD;
+    sleep = sleep < backoff ? sleep : backoff;
+    struct timespec ts = {.tv_sec = 0, .tv_nsec = (long)(sleep * 1e9)};
+    nanosleep(&ts, NULL);
+    backoff = backoff * 2 < WAIT_MAX_BACKOFF ? backoff * 2 : WAIT_MAX_BACKOFF;
+  }
+}
+
+/**
+ * @brief      The main loop of the scheduler
+ *
+ * @details    The most important function of the scheduler, it is waiting for
+ * different requests, starts the handler and gets back to waiting. when all crs
+ * of all jobs are idle and all jobs were started, it will return
+ * As long as there are jobs that did not arrive yet, timers are set or
+ * snapshots are enabled, the scheduler waits for the next request only until
+ * the next job arrives or timer expires (at most IDLE_POLL_INTERVAL), so
+ * neither requests nor timers are delayed.
+ * For the handlers themselves, see scheduler_handlers.c
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_scheduler_schedule(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int num_unsubmitted;
+
+  for (;;) {
+    MPIDYNRES_checkpoint_poll(scheduler);
+    MPIDYNRES_scheduler_start_pending_jobs(scheduler);
+    int num_not_started = jobs_not_started(pool, &num_unsubmitted);
+    if (pool->num_running == 0 && num_not_started == 0) {
+      break;
+    }
+    double now = MPI_Wtime();
+    double until_timer = next_timer(pool, now);
+    // a blocking receive would not notice a snapshot request
+    if (num_unsubmitted == 0 && until_timer < 0.0 && !snapshot_enabled()) {
+      MPIDYNRES_scheduler_handle_next(scheduler);
+    } else if (MPIDYNRES_scheduler_progress(scheduler) == 0) {
+      double deadline = now + IDLE_POLL_INTERVAL;
+      double submit = next_submit(pool, now);
+      if (until_timer >= 0.0 && now + until_timer < deadline) {
+        deadline = now + until_timer;
+      }
+      if (submit >= 0.0 && submit < deadline) {
+        deadline = submit;
+      }
+      wait_for_request(scheduler, deadline);
+    }
+  }
+}
+
+/**
+ * @brief      Create the scheduler of a job and add it to the pool
  *
  * @param      i_config The config to be used
  *
+ * @param      transport The transport used to talk to the crs
+ *
+ * @param      pool The pool of crs
+ *
  * @return     The newly created scheduler object
  */
-MPIDYNRES_scheduler *MPIDYNRES_scheduler_create(
-    MPIDYNRES_SIM_config *i_config) {
-  int size;
+static MPIDYNRES_scheduler *scheduler_init(MPIDYNRES_SIM_config *i_config,
+                                           MPIDYNRES_transport *transport,
+                                           MPIDYNRES_pool *pool) {
+  char buf[MPI_MAX_INFO_VAL];
   MPIDYNRES_scheduler *result = calloc(1, sizeof(MPIDYNRES_scheduler));
   if (result == NULL) {
     die("Memory Error!\n");
   };
 
-  MPI_Comm_size(i_config->base_communicator, &size);
-  if (size < 2) {
-    die("Cannot schedule on a communicator which contains less than 2 "
-        "ranks\n");
+  pool->jobs =
+      realloc(pool->jobs, (pool->num_jobs + 1) * sizeof(MPIDYNRES_scheduler *));
+  if (pool->jobs == NULL) {
+    die("Memory Error!\n");
   }
+  pool->jobs[pool->num_jobs] = result;
 
-  result->num_scheduling_processes = size - 1;
+  result->num_scheduling_processes = pool->num_scheduling_processes;
+
+  result->job_id = pool->num_jobs++;
+  result->pool = pool;
+  result->initial_size = 0;
+  result->job_stats = (MPIDYNRES_job_stats){
+      .start_time = -1.0,
+      .end_time = -1.0,
+  };
 
   result->config = i_config;
+  result->transport = transport;
+
+  // the decisions of a job are reproducible if manager_seed is set
+  if (MPIDYNRES_manager_config_get(result, MANAGER_SEED_KEY, buf)) {
+    result->rng_state = strtoull(buf, NULL, 0);
+  } else {
+    result->rng_state = (uint64_t)rand();
+  }
+
+  if (MPIDYNRES_manager_config_get(result, MANAGER_STANDBY_KEY, buf)) {
+    result->standby_size = atoi(buf);
+  }
+
+  // the latencies do not change the random decisions of the manager
+  result->latency_rng_state = result->rng_state ^ 0x6c6174656e6379;
+  MPIDYNRES_latency_parse(
+      MPIDYNRES_manager_config_get(result, MANAGER_START_LATENCY_KEY, buf)
+          ? buf
+          : NULL,
+      &result->start_latency);
+  MPIDYNRES_latency_parse(
+      MPIDYNRES_manager_config_get(result, MANAGER_SHUTDOWN_LATENCY_KEY, buf)
+          ? buf
+          : NULL,
+      &result->shutdown_latency);
 
   result->next_session_id = 0;
   result->next_rc_tag = 0;
   result->pending_resource_change = false;
+  result->rc_staged = false;
 
   result->running_crs = set_int_init(int_compare);
   result->pending_shutdowns = set_int_init(int_compare);
+  result->shutting_down_crs = set_int_init(int_compare);
   result->pset_name_map = set_pset_node_init(pset_node_compare);
   result->rc_map = set_rc_info_init(rc_info_compare);
   result->process_states = set_process_state_init(process_state_compare);
@@ -369,22 +966,134 @@ MPIDYNRES_scheduler *MPIDYNRES_scheduler_create(
 }
 
 /**
- * @brief      Destructor for MPIDYNRES_scheduler
+ * @brief      Free the scheduler of a single job
  *
  * @param      scheduler The scheduler
  */
-void MPIDYNRES_scheduler_free(MPIDYNRES_scheduler *scheduler) {
+static void scheduler_free_job(MPIDYNRES_scheduler *scheduler) {
   set_int_free(&scheduler->running_crs);
   set_int_free(&scheduler->pending_shutdowns);
+  set_int_free(&scheduler->shutting_down_crs);
   set_pset_node_free(&scheduler->pset_name_map);
   set_rc_info_free(&scheduler->rc_map);
   set_process_state_free(&scheduler->process_states);
+  if (scheduler->rc_staged) {
+    set_int_free(&scheduler->staged_rc_pset);
+  }
+  MPIDYNRES_latency_free(&scheduler->start_latency);
+  MPIDYNRES_latency_free(&scheduler->shutdown_latency);
 
   MPIDYNRES_manager_free(scheduler->manager);
 
   free(scheduler);
 }
 
+/*
+ * PUBLIC METHODS
+ */
+
+/**
+ * @brief      Constructor for a new MPIDYNRES_scheduler
+ *
+ * @details    Creates a pool containing all crs of the transport and the
+ * scheduler of the first job, further jobs can be added with
+ * MPIDYNRES_scheduler_add_job
+ *
+ * @param      i_config The config to be used
+ *
+ * @param      transport The transport used to talk to the crs
+ *
+ * @return     The newly created scheduler object
+ */
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_create(
+    MPIDYNRES_SIM_config *i_config, MPIDYNRES_transport *transport) {
+  int size;
+  MPIDYNRES_pool *pool = calloc(1, sizeof(MPIDYNRES_pool));
+  if (pool == NULL) {
+    die("Memory Error!\n");
+  };
+
+  size = transport->size;
+  if (size < 2) {
+    die("Cannot schedule on a communicator which contains less than 2 "
+        "ranks\n");
+  }
+
+  pool->num_scheduling_processes = size - 1;
+  pool->num_jobs = 0;
+  pool->jobs = NULL;
+  pool->owner = calloc(size, sizeof(int));
+  pool->cr_start_time = calloc(size, sizeof(double));
+  pool->cr_state = calloc(size, sizeof(enum cr_state));
+  pool->cr_state_since = calloc(size, sizeof(double));
+  pool->cr_state_seconds = calloc(size, sizeof(*pool->cr_state_seconds));
+  pool->cr_cpu_seconds = calloc(size, sizeof(double));
+  pool->standby = calloc(size, sizeof(int));
+  if (pool->owner == NULL || pool->cr_start_time == NULL ||
+      pool->cr_state == NULL || pool->cr_state_since == NULL ||
+      pool->cr_state_seconds == NULL || pool->cr_cpu_seconds == NULL ||
+      pool->standby == NULL) {
+    die("Memory Error!\n");
+  }
+  for (int i = 0; i < size; i++) {
+    pool->owner[i] = MPIDYNRES_NO_JOB;
+    pool->standby[i] = MPIDYNRES_NO_JOB;
+  }
+  pool->num_running = 0;
+  pool->start_time = MPI_Wtime();
+  pool->timers = set_timer_init(timer_compare);
+  pool->next_timer_handle = 0;
+  MPIDYNRES_metrics_init(&pool->metrics, pool->num_scheduling_processes);
+
+  return scheduler_init(i_config, transport, pool);
+}
+
+/**
+ * @brief      Add another job that competes for the crs of the pool
+ *
+ * @details    The job gets its own mpi://WORLD, process sets and manager. Jobs
+ * are started in the order they were added, as soon as there are enough free
+ * crs for their initial process set.
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @param      i_config The config of the new job
+ *
+ * @return     The scheduler of the new job
+ */
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_add_job(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_SIM_config *i_config) {
+  return scheduler_init(i_config, scheduler->transport, scheduler->pool);
+}
+
+/**
+ * @brief      Destructor for MPIDYNRES_scheduler
+ *
+ * @details    Frees the schedulers of all jobs of the pool, after dumping
+ * the metrics (see MPIDYNRES_scheduler_dump_stats)
+ *
+ * @param      scheduler The scheduler
+ */
+void MPIDYNRES_scheduler_free(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+
+  MPIDYNRES_scheduler_dump_stats(scheduler);
+  for (int i = 0; i < pool->num_jobs; i++) {
+    scheduler_free_job(pool->jobs[i]);
+  }
+  MPIDYNRES_metrics_free(&pool->metrics);
+  set_timer_free(&pool->timers);
+  free(pool->jobs);
+  free(pool->owner);
+  free(pool->cr_start_time);
+  free(pool->cr_state);
+  free(pool->cr_state_since);
+  free(pool->cr_state_seconds);
+  free(pool->cr_cpu_seconds);
+  free(pool->standby);
+  free(pool);
+}
+
 /**
  * @brief      Send the start signal to the initial number of crs
  *
@@ -393,7 +1102,12 @@ void MPIDYNRES_scheduler_free(MPIDYNRES_scheduler *scheduler) {
 void MPIDYNRES_start_first_crs(MPIDYNRES_scheduler *scheduler) {
   set_int initial_pset;
 
+  assert(scheduler->job_stats.start_time < 0.0);
+
+  // the job counts as started afterwards, so it may take the standby of others
   MPIDYNRES_manager_get_initial_pset(scheduler->manager, &initial_pset);
+  scheduler->job_stats.start_time = MPI_Wtime();
+  trace_decision(scheduler, 0, DECISION_TRACE_INIT, &initial_pset);
 
   // create initial pset
   pset_node initial_pset_node = {
@@ -406,34 +1120,428 @@ void MPIDYNRES_start_first_crs(MPIDYNRES_scheduler *scheduler) {
   // TODO: what other keys could get in here?
 
   set_pset_node_insert(&scheduler->pset_name_map, initial_pset_node);
+  if (tool_wants(MPIDYNRES_TOOL_PSET_CREATED)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_PSET_CREATED, scheduler->job_id, -1);
+    event.pset_name = initial_pset_node.pset_name;
+    event.pset_size = initial_pset_node.pset.size;
+    tool_fire(&event);
+  }
 
-  // actually start the psets
+  // actually start the psets, they are launched together
+  double delay = MPIDYNRES_scheduler_draw_start_latency(scheduler,
+                                                        initial_pset.size);
   foreach (set_int, &initial_pset, it) {
-    debug("Starting rank %zu with uri %s\n", *it.ref,
+    debug("Starting rank %d with uri %s\n", *it.ref,
           initial_pset_node.pset_name);
     MPIDYNRES_scheduler_start_cr(scheduler, *it.ref, false,
-                                 MPIDYNRES_NO_ORIGIN_RC_TAG, MPI_INFO_NULL);
+                                 MPIDYNRES_NO_ORIGIN_RC_TAG, MPI_INFO_NULL,
+                                 delay);
   }
+  MPIDYNRES_scheduler_refill_standby(scheduler);
+}
+
+/**
+ * @brief      Start the waiting jobs that fit into the free crs
+ *
+ * @details    Jobs are started first come first served, a job that did not
+ * arrive yet blocks all jobs added after it. If the first waiting job does not
+ * fit, the jobs behind it are only started if its manager allows backfilling
+ * (see MPIDYNRES_manager_may_backfill).
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ */
+void MPIDYNRES_scheduler_start_pending_jobs(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_scheduler *head = NULL;
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    if (job->job_stats.start_time >= 0.0) {
+      continue;
+    }
+    if (!job_submitted(job, MPI_Wtime())) {
+      return;
+    }
+    bool fits = MPIDYNRES_manager_initial_number(job) <=
+                MPIDYNRES_scheduler_num_free(job);
+    if (head == NULL && !fits) {
+      head = job;
+      continue;
+    }
+    if (head != NULL &&
+        !(fits && MPIDYNRES_manager_may_backfill(head->manager, job))) {
+      continue;
+    }
+    debug("Starting job %d%s\n", job->job_id,
+          head != NULL ? " (backfilled)" : "");
+    MPIDYNRES_start_first_crs(job);
+  }
+}
+
+/**
+ * @brief      Get the first job that arrived but did not start yet
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @return     The scheduler of the job or NULL if no job is waiting
+ */
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_queue_head(
+    MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  double now = MPI_Wtime();
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    if (pool->jobs[i]->job_stats.start_time < 0.0 &&
+        job_submitted(pool->jobs[i], now)) {
+      return pool->jobs[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief      Return whether there are jobs that arrived but did not start
+ * yet
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @return     true if at least one job is waiting
+ */
+bool MPIDYNRES_scheduler_jobs_waiting(MPIDYNRES_scheduler *scheduler) {
+  return MPIDYNRES_scheduler_queue_head(scheduler) != NULL;
+}
+
+/**
+ * @brief      Return the number of crs a job can use, see
+ * MPIDYNRES_scheduler_cr_is_free
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @return     The number of free crs
+ */
+int MPIDYNRES_scheduler_num_free(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int res = 0;
+
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    res += MPIDYNRES_scheduler_cr_is_free(scheduler, cr);
+  }
+  return res;
+}
+
+/**
+ * @brief      Return whether a job can use a cr
+ *
+ * @details    A cr is free if it is neither running nor reserved by any job
+ * and not on standby for another running job. Jobs that did not start yet
+ * ignore the standby.
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      cr_id The cr id
+ *
+ * @return     true if the cr is free
+ */
+bool MPIDYNRES_scheduler_cr_is_free(MPIDYNRES_scheduler *scheduler,
+                                    int cr_id) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  int warmed_for = pool->standby[cr_id];
+
+  if (pool->owner[cr_id] != MPIDYNRES_NO_JOB) {
+    return false;
+  }
+  // waiting jobs may start on the standby of others, so they never starve
+  return warmed_for == MPIDYNRES_NO_JOB || warmed_for == scheduler->job_id ||
+         scheduler->job_stats.start_time < 0.0 ||
+         pool->jobs[warmed_for]->job_stats.end_time >= 0.0;
+}
+
+/**
+ * @brief      Check whether a resource change decided earlier still fits the
+ * current state of a job
+ *
+ * @details    The crs of an RC_ADD have to be free, the crs of an RC_SUB have
+ * to be running and at least one cr has to be left
+ *
+ * @param      scheduler The scheduler of the job
+ *
+ * @param      rc_type The type of the resource change
+ *
+ * @param      pset The crs to add or remove
+ *
+ * @return     false if the change cannot be made (or is empty or RC_NONE)
+ */
+bool MPIDYNRES_scheduler_rc_fits(MPIDYNRES_scheduler *scheduler,
+                                 MPIDYNRES_RC_type rc_type, set_int *pset) {
+  if (pset->size == 0) {
+    return false;
+  }
+  if (rc_type == MPIDYNRES_RC_SUB &&
+      pset->size >= scheduler->running_crs.size) {
+    return false;
+  }
+  foreach (set_int, pset, it) {
+    bool running = set_int_count(&scheduler->running_crs, *it.ref) == 1;
+    if (rc_type == MPIDYNRES_RC_ADD) {
+      if (running || !MPIDYNRES_scheduler_cr_is_free(scheduler, *it.ref)) {
+        return false;
+      }
+    } else if (rc_type != MPIDYNRES_RC_SUB || !running) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief      Change the state of a cr
+ *
+ * @details    The time the cr spent in its previous state is accounted to the
+ * cr and, unless it was idle, to the job that had the cr. The change is also
+ * written to the state log and the trace (see set_state).
+ *
+ * @param      scheduler The scheduler of the job that has the cr
+ *
+ * @param      cr_id The cr
+ *
+ * @param      state The new state
+ */
+void MPIDYNRES_scheduler_set_cr_state(MPIDYNRES_scheduler *scheduler,
+                                      int cr_id, enum cr_state state) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  enum cr_state old_state = pool->cr_state[cr_id];
+  double now = MPI_Wtime();
+
+  if (old_state != idle) {
+    pool->cr_state_seconds[cr_id][old_state] +=
+        now - pool->cr_state_since[cr_id];
+    scheduler->job_stats.state_seconds[old_state] +=
+        now - pool->cr_state_since[cr_id];
+  }
+  pool->cr_state[cr_id] = state;
+  pool->cr_state_since[cr_id] = now;
+  set_state(scheduler->job_id, cr_id, state);
+}
+
+/**
+ * @brief      Get the time a cr spent in a state
+ *
+ * @details    Idle is the time since the start of the pool that the cr was in
+ * no other state
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      cr_id The cr
+ *
+ * @param      state The state
+ *
+ * @param      now The current time (MPI_Wtime), the current state counts
+ * until then
+ *
+ * @return     The time in seconds
+ */
+double MPIDYNRES_scheduler_cr_state_seconds(MPIDYNRES_scheduler *scheduler,
+                                            int cr_id, enum cr_state state,
+                                            double now) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  double res = 0.0;
+
+  if (state == idle) {
+    res = now - pool->start_time;
+    for (int s = 0; s < NUM_CR_STATES; s++) {
+      if (s != idle) {
+        res -= MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr_id, s, now);
+      }
+    }
+    return res > 0.0 ? res : 0.0;
+  }
+  res = pool->cr_state_seconds[cr_id][state];
+  if (pool->cr_state[cr_id] == state) {
+    res += now - pool->cr_state_since[cr_id];
+  }
+  return res;
+}
+
+/**
+ * @brief      Sum up the time the crs spent per state
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      o_utilization The utilization until now is returned here
+ */
+void MPIDYNRES_scheduler_get_utilization(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_SIM_utilization *o_utilization) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_SIM_utilization *u = o_utilization;
+  double now = MPI_Wtime();
+
+  *u = (MPIDYNRES_SIM_utilization){0};
+  u->num_crs = pool->num_scheduling_processes;
+  u->makespan = now - pool->start_time;
+  u->available_cr_seconds = u->num_crs * u->makespan;
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    double seconds[NUM_CR_STATES];
+    for (int s = 0; s < NUM_CR_STATES; s++) {
+      seconds[s] = MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, s, now);
+    }
+    u->idle_cr_seconds += seconds[idle];
+    u->reserved_cr_seconds += seconds[reserved];
+    u->running_cr_seconds += seconds[running];
+    u->shutdown_cr_seconds +=
+        seconds[proposed_shutdown] + seconds[accepted_shutdown];
+    u->cpu_seconds += pool->cr_cpu_seconds[cr];
+  }
+  u->utilization =
+      u->available_cr_seconds > 0.0
+          ? (u->running_cr_seconds + u->shutdown_cr_seconds) /
+                u->available_cr_seconds
+          : 0.0;
+}
+
+/**
+ * @brief      Write the per job and global utilization as JSON
+ *
+ * @details    The utilization is the share of the cr time (number of crs
+ * times the time since the simulation started) the crs were running. The wait
+ * time of a job is measured from its submit time, its slowdown is
+ * (wait time + run time) / run time. The time per state is given for every
+ * job (reserved and shutting down) and every cr (see
+ * MPIDYNRES_scheduler_cr_state_seconds).
+ *
+ * @param      scheduler The scheduler of any job of the pool
+ *
+ * @param      f The file to write to
+ */
+void MPIDYNRES_scheduler_write_job_report(MPIDYNRES_scheduler *scheduler,
+                                          FILE *f) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  double now = MPI_Wtime();
+  double makespan = now - pool->start_time;
+  double total_cr_seconds = 0.0;
+  double total_wait = 0.0;
+  double total_slowdown = 0.0;
+  MPIDYNRES_SIM_utilization u;
+  double *cr_seconds = calloc(pool->num_jobs, sizeof(double));
+  double (*state_seconds)[NUM_CR_STATES] =
+      calloc(pool->num_jobs, sizeof(*state_seconds));
+  if (cr_seconds == NULL || state_seconds == NULL) {
+    die("Memory Error!\n");
+  }
+
+  MPIDYNRES_scheduler_get_utilization(scheduler, &u);
+  for (int i = 0; i < pool->num_jobs; i++) {
+    memcpy(state_seconds[i], pool->jobs[i]->job_stats.state_seconds,
+           sizeof(state_seconds[i]));
+  }
+  // states that did not end yet
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    if (pool->cr_state[cr] != idle && pool->owner[cr] != MPIDYNRES_NO_JOB) {
+      state_seconds[pool->owner[cr]][pool->cr_state[cr]] +=
+          now - pool->cr_state_since[cr];
+    }
+  }
+
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_scheduler *job = pool->jobs[i];
+    cr_seconds[i] = job->job_stats.cr_seconds;
+    // crs that are still running or shutting down
+    foreach (set_int, &job->running_crs, it) {
+      cr_seconds[i] += now - pool->cr_start_time[*it.ref];
+    }
+    foreach (set_int, &job->shutting_down_crs, it) {
+      cr_seconds[i] += now - pool->cr_start_time[*it.ref];
+    }
+    total_cr_seconds += cr_seconds[i];
+  }
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"num_crs\": %d,\n", pool->num_scheduling_processes);
+  fprintf(f, "  \"makespan_s\": %f,\n", makespan);
+  fprintf(f, "  \"cr_seconds\": %f,\n", total_cr_seconds);
+  fprintf(f, "  \"utilization\": %f,\n",
+          makespan > 0.0
+              ? total_cr_seconds / (pool->num_scheduling_processes * makespan)
+              : 0.0);
+  fprintf(f, "  \"idle_cr_seconds\": %f,\n", u.idle_cr_seconds);
+  fprintf(f, "  \"reserved_cr_seconds\": %f,\n", u.reserved_cr_seconds);
+  fprintf(f, "  \"shutdown_cr_seconds\": %f,\n", u.shutdown_cr_seconds);
+  fprintf(f, "  \"cpu_seconds\": %f,\n", u.cpu_seconds);
+  fprintf(f, "  \"jobs\": [\n");
+  for (int i = 0; i < pool->num_jobs; i++) {
+    MPIDYNRES_job_stats *js = &pool->jobs[i]->job_stats;
+    double submit = pool->start_time + js->submit_time;
+    double start = js->start_time < 0.0 ? now : js->start_time;
+    double end = js->end_time < 0.0 ? now : js->end_time;
+    double wait = start > submit ? start - submit : 0.0;
+    double slowdown = end > start ? (wait + end - start) / (end - start) : 1.0;
+    total_wait += wait;
+    total_slowdown += slowdown;
+    fprintf(f,
+            "    {\"id\": %d, \"submit_s\": %f, \"wait_s\": %f, "
+            "\"run_s\": %f, \"slowdown\": %f, \"cr_seconds\": %f, "
+            "\"avg_size\": %f, \"max_size\": %d, \"num_rc\": %d, "
+            "\"share\": %f, \"reserved_s\": %f, \"shutdown_s\": %f, "
+            "\"cpu_s\": %f}%s\n",
+            i, js->submit_time, wait, end - start, slowdown, cr_seconds[i],
+            end > start ? cr_seconds[i] / (end - start) : 0.0, js->max_size,
+            js->num_rc,
+            total_cr_seconds > 0.0 ? cr_seconds[i] / total_cr_seconds : 0.0,
+            state_seconds[i][reserved],
+            state_seconds[i][proposed_shutdown] +
+                state_seconds[i][accepted_shutdown],
+            js->cpu_seconds, i + 1 < pool->num_jobs ? "," : "");
+  }
+  fprintf(f, "  ],\n");
+  fprintf(f, "  \"crs\": [\n");
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    fprintf(
+        f,
+        "    {\"id\": %d, \"idle_s\": %f, \"reserved_s\": %f, "
+        "\"running_s\": %f, \"shutdown_s\": %f, \"cpu_s\": %f}%s\n",
+        cr, MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, idle, now),
+        MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, reserved, now),
+        MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, running, now),
+        MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, proposed_shutdown,
+                                             now) +
+            MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr,
+                                                 accepted_shutdown, now),
+        pool->cr_cpu_seconds[cr],
+        cr < pool->num_scheduling_processes ? "," : "");
+  }
+  fprintf(f, "  ],\n");
+  fprintf(f, "  \"avg_wait_s\": %f,\n", total_wait / pool->num_jobs);
+  fprintf(f, "  \"avg_slowdown\": %f\n", total_slowdown / pool->num_jobs);
+  fprintf(f, "}\n");
+  free(cr_seconds);
+  free(state_seconds);
 }
 
 /**
  * @brief      start first crs then start scheduling
  *
+ * @details    Starts all jobs of the pool (as soon as they fit) and returns
+ * after all of them are done
+ *
  * @param      scheduler the scheduler
  */
 void MPIDYNRES_scheduler_start(MPIDYNRES_scheduler *scheduler) {
   debug("Starting scheduler...\n");
   init_log(scheduler);
+  MPIDYNRES_snapshot_init();
 
-  MPIDYNRES_start_first_crs(scheduler);
+  scheduler->pool->start_time = MPI_Wtime();
+  MPIDYNRES_scheduler_start_pending_jobs(scheduler);
 
   // run until no more simulated processes running
   MPIDYNRES_scheduler_schedule(scheduler);
+  MPIDYNRES_checkpoint_write(scheduler);
 
   // shutdown crs
   debug("No more running crs. Shutting down everything\n");
   MPIDYNRES_scheduler_shutdown_all_crs(scheduler);
 
+  MPIDYNRES_snapshot_free();
   free_log();
 }
 
@@ -482,13 +1590,15 @@ bool MPIDYNRES_is_reserved_pset_name(char const *pset_name) {
 /**
  * @brief      Generate a random 30-char string with the given prefix
  *
+ * @param      rng_state The state of the random number generator to use
+ *
  * @param      prefix The prefix to use
  *
  * @param      res The result string will be placed here
  *
  * @return     if != 0, an error occured
  */
-int MPIDYNRES_gen_random_uri(char const *prefix,
+int MPIDYNRES_gen_random_uri(uint64_t *rng_state, char const *prefix,
                              char res[MPI_MAX_PSET_NAME_LEN]) {
   // TODO: a collision check might be useful for a long prefix or small n
   char const chars[] = "abcdefghijklmnopqrstuvwxyz0123456789";
@@ -496,7 +1606,7 @@ int MPIDYNRES_gen_random_uri(char const *prefix,
   size_t n = 30;
   strcpy(res, prefix);
   for (size_t i = strlen(prefix); i < n; i++) {
-    res[i] = chars[rand() % (COUNT_OF(chars) - 1)];  // TODO: who calls srand?
+    res[i] = chars[MPIDYNRES_rand(rng_state) % (COUNT_OF(chars) - 1)];
   }
   res[n] = '\0';
   return 0;
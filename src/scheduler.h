@@ -7,26 +7,85 @@
 
 #include <mpi.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 struct MPIDYNRES_scheduler;
 typedef struct MPIDYNRES_scheduler MPIDYNRES_scheduler;
 
+struct MPIDYNRES_pool;
+typedef struct MPIDYNRES_pool MPIDYNRES_pool;
+
+#include "latency.h"
+#include "metrics.h"
 #include "mpidynres_sim.h"
 #include "scheduler_datatypes.h"
 #include "scheduler_mgmt.h"
+#include "statelog.h"
+#include "transport.h"
+
+#define MPIDYNRES_NO_JOB (-1)
+
+/**
+ * @brief      Accounting of a job (an application with its own mpi://WORLD)
+ */
+struct MPIDYNRES_job_stats {
+  double submit_time; ///< seconds after the start of the pool the job arrives
+  double start_time;  ///< when the initial crs were started, < 0 if waiting
+  double end_time;    ///< when the last cr returned, < 0 if not finished
+  double cr_seconds;  ///< time the crs of this job were running
+  int max_size;       ///< maximum number of running crs
+  int num_rc;         ///< number of resource changes proposed
+  double state_seconds[NUM_CR_STATES];  ///< time the crs of this job spent per state (not idle)
+  double cpu_seconds; ///< CPU time the crs reported when they returned
+};
+typedef struct MPIDYNRES_job_stats MPIDYNRES_job_stats;
+
+/**
+ * @brief      The computing resources shared by all jobs of a simulation
+ */
+struct MPIDYNRES_pool {
+  int num_scheduling_processes;  ///< number of crs
+  int num_jobs;
+  MPIDYNRES_scheduler **jobs;    ///< the scheduler of every job, indexed by job id
+  int *owner;                    ///< job id that runs or reserved a cr (index = cr id) or MPIDYNRES_NO_JOB
+  double *cr_start_time;         ///< when a cr was started (index = cr id)
+  enum cr_state *cr_state;       ///< current state of a cr (index = cr id)
+  double *cr_state_since;        ///< when the cr entered its current state (index = cr id)
+  double (*cr_state_seconds)[NUM_CR_STATES];  ///< time spent per state other than idle (index = cr id)
+  double *cr_cpu_seconds;        ///< CPU time the cr reported when its runs returned (index = cr id)
+  int *standby;                  ///< job id an idle cr is warmed up for (index = cr id) or MPIDYNRES_NO_JOB
+  int num_running;               ///< number of running crs of all jobs
+  double start_time;             ///< when the simulation was started
+  set_timer timers;              ///< pending timers of the managers of all jobs
+  int next_timer_handle;
+  MPIDYNRES_metrics metrics;     ///< see MPIDYNRES_scheduler_get_stats
+};
 
 /**
  * @brief      The MPIDYNRES_scheduler struct contains information about the
- * scheduler state
+ * scheduler state of one job
  */
 struct MPIDYNRES_scheduler {
   int num_scheduling_processes;  ///< number of processes available (the scheduler does not count)
 
-  MPIDYNRES_manager *manager; ///< The manager that decides what to do when a rc request arrives
+  int job_id;            ///< the index of this job in the pool
+  MPIDYNRES_pool *pool;  ///< crs shared with the other jobs
+  int initial_size;      ///< number of initial crs, 0 if not decided yet
+  uint64_t rng_state;    ///< state of MPIDYNRES_rand, seeded with manager_seed
+  int standby_size;      ///< number of free crs kept warmed up (manager_standby)
+  MPIDYNRES_latency start_latency;     ///< delays the start of crs (manager_start_latency)
+  MPIDYNRES_latency shutdown_latency;  ///< delays the release of returned crs (manager_shutdown_latency)
+  uint64_t latency_rng_state;          ///< state of MPIDYNRES_rand for the latencies
+  MPIDYNRES_job_stats job_stats;
+
+  MPIDYNRES_manager manager; ///< The manager that decides what to do when a rc request arrives
 
   MPIDYNRES_SIM_config *config;    ///< the scheduler config used
+  MPIDYNRES_transport *transport;  ///< used to talk to the crs
   set_int running_crs;  ///< the set of currently running crs, TODO: think about removing this field and just use process_states
   set_int pending_shutdowns;       ///< the set of accepted, yet not shutdown crs
+  set_int shutting_down_crs;       ///< crs that returned and wait out their shutdown latency, still owned by the job
   set_pset_node pset_name_map;  ///< 
   set_rc_info rc_map;  ///< 
   set_process_state process_states;
@@ -34,16 +93,72 @@ struct MPIDYNRES_scheduler {
   int next_session_id; ///< the next session id to give out
   int next_rc_tag;
   bool pending_resource_change;
+
+  bool rc_staged;                    ///< whether the manager staged the answer to the next rc request
+  MPIDYNRES_RC_type staged_rc_type;
+  set_int staged_rc_pset;
 };
 typedef struct MPIDYNRES_scheduler MPIDYNRES_scheduler;
 
-MPIDYNRES_scheduler *MPIDYNRES_scheduler_create(MPIDYNRES_SIM_config *i_config);
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_create(MPIDYNRES_SIM_config *i_config, MPIDYNRES_transport *transport);
+
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_add_job(MPIDYNRES_scheduler *scheduler, MPIDYNRES_SIM_config *i_config);
 
 void MPIDYNRES_scheduler_free(MPIDYNRES_scheduler *scheduler);
 
 void MPIDYNRES_scheduler_start(MPIDYNRES_scheduler *scheduler);
 
-void MPIDYNRES_scheduler_start_cr(MPIDYNRES_scheduler *scheduler, int i_cr, bool dynamic_start, int origin_rc_tag, MPI_Info origin_rc_info);
+void MPIDYNRES_start_first_crs(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_scheduler_start_pending_jobs(MPIDYNRES_scheduler *scheduler);
+
+MPIDYNRES_scheduler *MPIDYNRES_scheduler_queue_head(MPIDYNRES_scheduler *scheduler);
+
+bool MPIDYNRES_scheduler_jobs_waiting(MPIDYNRES_scheduler *scheduler);
+
+int MPIDYNRES_scheduler_num_free(MPIDYNRES_scheduler *scheduler);
+
+bool MPIDYNRES_scheduler_cr_is_free(MPIDYNRES_scheduler *scheduler, int cr_id);
+
+bool MPIDYNRES_scheduler_rc_fits(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_type rc_type, set_int *pset);
+
+void MPIDYNRES_scheduler_write_job_report(MPIDYNRES_scheduler *scheduler, FILE *f);
+
+void MPIDYNRES_scheduler_set_cr_state(MPIDYNRES_scheduler *scheduler, int cr_id, enum cr_state state);
+
+double MPIDYNRES_scheduler_cr_state_seconds(MPIDYNRES_scheduler *scheduler, int cr_id, enum cr_state state, double now);
+
+void MPIDYNRES_scheduler_get_utilization(MPIDYNRES_scheduler *scheduler, MPIDYNRES_SIM_utilization *o_utilization);
+
+int MPIDYNRES_scheduler_add_timer(MPIDYNRES_scheduler *scheduler, double delay, int timer_id);
+
+bool MPIDYNRES_scheduler_cancel_timer(MPIDYNRES_scheduler *scheduler, int handle);
+
+int MPIDYNRES_scheduler_run_timers(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_scheduler_add_cr_timer(MPIDYNRES_scheduler *scheduler, double delay, enum timer_kind kind, int cr_id);
+
+int MPIDYNRES_scheduler_flush_cr_timers(MPIDYNRES_scheduler *scheduler);
+
+double MPIDYNRES_scheduler_draw_start_latency(MPIDYNRES_scheduler *scheduler, int num_crs);
+
+double MPIDYNRES_scheduler_draw_shutdown_latency(MPIDYNRES_scheduler *scheduler, int num_crs);
+
+void MPIDYNRES_scheduler_warm_cr(MPIDYNRES_scheduler *scheduler, int cr_id);
+
+void MPIDYNRES_scheduler_refill_standby(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_scheduler_set_standby_size(MPIDYNRES_scheduler *scheduler, int size);
+
+void MPIDYNRES_scheduler_stage_rc(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_type rc_type, set_int *pset);
+
+void MPIDYNRES_scheduler_schedule(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_scheduler_handle_next(MPIDYNRES_scheduler *scheduler);
+
+int MPIDYNRES_scheduler_progress(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_scheduler_start_cr(MPIDYNRES_scheduler *scheduler, int i_cr, bool dynamic_start, int origin_rc_tag, MPI_Info origin_rc_info, double delay);
 
 void MPIDYNRES_scheduler_shutdown_all_crs( MPIDYNRES_scheduler *scheduler);
 
@@ -51,6 +166,6 @@ int MPIDYNRES_scheduler_get_id_of_rank(int mpi_rank);
 
 bool MPIDYNRES_is_reserved_pset_name(char const *pset_name);
 
-int MPIDYNRES_gen_random_uri(char const *prefix, char res[MPI_MAX_PSET_NAME_LEN]);
+int MPIDYNRES_gen_random_uri(uint64_t *rng_state, char const *prefix, char res[MPI_MAX_PSET_NAME_LEN]);
 
 #endif
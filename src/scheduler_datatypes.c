@@ -156,3 +156,12 @@ int set_rc_info_find_by_tag(set_rc_info *set, int tag, rc_info **res) {
     return 0;
   }
 }
+
+// TIMER
+
+int timer_compare(timer *a, timer *b) {
+  if (a->deadline != b->deadline) {
+    return a->deadline > b->deadline ? 1 : -1;
+  }
+  return int_compare(&a->handle, &b->handle);
+}
@@ -42,6 +42,7 @@ struct rc_info {
   char new_pset_name[MPI_MAX_PSET_NAME_LEN];
   set_int pset;  // copy if real one is deleted
   MPIDYNRES_RC_type rc_type;
+  uint64_t answer_ns;  // when the rc was sent to the cr (MPIDYNRES_now_ns)
 };
 typedef struct rc_info rc_info;
 void rc_info_free(rc_info *rn);
@@ -74,6 +75,7 @@ struct process_state {
                   // application to be scheduled
   bool pending_shutdown;
   bool dynamic_start;
+  bool restored;  // started again after the scheduler was restored
   int origin_rc_tag;  // can be looked in rc_table
 
   MPI_Info origin_rc_info;
@@ -90,4 +92,25 @@ int process_state_compare(process_state *a, process_state *b);
 int set_process_state_find_by_id(set_process_state *set, int process_id,
                                  process_state **res);
 
+// set_timer
+enum timer_kind {
+  TIMER_MANAGER,     // calls the manager of the job
+  TIMER_CR_START,    // sends the start command after the start latency
+  TIMER_CR_RELEASE,  // releases a returned cr after the shutdown latency
+};
+
+struct timer {
+  double deadline;  // MPI_Wtime when the timer expires
+  int handle;       // unique per pool, orders timers with the same deadline
+  int job_id;       // the job whose manager is called
+  int timer_id;     // passed to the manager
+  enum timer_kind kind;
+  int cr_id;        // the cr to start or release
+};
+typedef struct timer timer;
+#define P
+#define T timer
+int timer_compare(timer *a, timer *b);
+#include <set.h>
+
 #endif
@@ -1,6 +1,8 @@
 #include "logging.h"
 #include "scheduler.h"
+#include "scheduler_handlers.h"
 #include "string.h"
+#include "tool.h"
 #include "util.h"
 
 /**
@@ -25,9 +27,16 @@ static int pset_free(MPIDYNRES_scheduler *scheduler, char *psetname) {
   set_pset_node_find_by_name(&scheduler->pset_name_map, psetname, &psetn);
 
   if (psetn == NULL) {
-    debug("Warning: Tried to free non-existing pset %s\n", psetname);
+    log_warn("Warning: Tried to free non-existing pset %s\n", psetname);
     return 1;
   }
+  if (tool_wants(MPIDYNRES_TOOL_PSET_FREED)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_PSET_FREED, scheduler->job_id, -1);
+    event.pset_name = psetn->pset_name;
+    event.pset_size = psetn->pset.size;
+    tool_fire(&event);
+  }
   set_pset_node_erase(&scheduler->pset_name_map, *psetn);
 
   // remove from process states
@@ -43,6 +52,48 @@ static int pset_free(MPIDYNRES_scheduler *scheduler, char *psetname) {
   return 0;
 }
 
+/**
+ * @brief      Cancel all resource changes that were not accepted yet
+ *
+ * @details    Crs reserved for additions go back to the pool, crs about to be
+ * removed keep running. The process sets of the changes are freed.
+ *
+ * @param      scheduler The scheduler of the job
+ */
+void MPIDYNRES_scheduler_cancel_rcs(MPIDYNRES_scheduler *scheduler) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  pset_node *pn;
+  process_state *ps;
+
+  foreach (set_rc_info, &scheduler->rc_map, it) {
+    foreach (set_int, &it.ref->pset, it2) {
+      int cr = *it2.ref;
+      if (it.ref->rc_type == MPIDYNRES_RC_ADD &&
+          pool->owner[cr] == scheduler->job_id &&
+          set_int_count(&scheduler->running_crs, cr) == 0) {
+        pool->owner[cr] = MPIDYNRES_NO_JOB;
+        MPIDYNRES_scheduler_set_cr_state(scheduler, cr, idle);
+      } else if (it.ref->rc_type == MPIDYNRES_RC_SUB &&
+                 set_int_count(&scheduler->running_crs, cr) == 1) {
+        set_int_erase(&scheduler->pending_shutdowns, cr);
+        set_process_state_find_by_id(&scheduler->process_states, cr, &ps);
+        if (ps != NULL) {
+          ps->pending_shutdown = false;
+        }
+        MPIDYNRES_scheduler_set_cr_state(scheduler, cr, running);
+      }
+    }
+    set_pset_node_find_by_name(&scheduler->pset_name_map,
+                               it.ref->new_pset_name, &pn);
+    if (pn != NULL) {
+      pset_free(scheduler, it.ref->new_pset_name);
+    }
+  }
+  set_rc_info_free(&scheduler->rc_map);
+  scheduler->rc_map = set_rc_info_init(rc_info_compare);
+  scheduler->pending_resource_change = false;
+}
+
 /*
  * HANDLERS
  */
@@ -50,21 +101,61 @@ static int pset_free(MPIDYNRES_scheduler *scheduler, char *psetname) {
 /**
  * @brief      Handle a worker done message
  *
- * @details    Remove the source rank (cr_id) from currently running and change
- * state to idle, also free all process sets that the process was part of
+ * @details    The cr is released right away or, if the job has a shutdown
+ * latency, shuts down until the latency passed (see
+ * MPIDYNRES_scheduler_release_cr). While it shuts down, it is moved from
+ * running_crs to shutting_down_crs, so managers neither count nor remove it,
+ * but it still belongs to the job.
  *
  * @param      scheduler The scheduler
  *
  * @param      status The MPI status of the message
+ *
+ * @param      cpu_seconds The CPU time the run of the cr used
  */
 void MPIDYNRES_scheduler_handle_worker_done(MPIDYNRES_scheduler *scheduler,
-                                            MPI_Status *status) {
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+                                            MPIDYNRES_transport_status *status,
+                                            double cpu_seconds) {
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
+  MPIDYNRES_pool *pool = scheduler->pool;
 
   if (set_int_count(&scheduler->running_crs, cr_id) != 1) {
     die("ERROR: expected %d to not run, but got worker done msg\n", cr_id);
   }
+  pool->cr_cpu_seconds[cr_id] += cpu_seconds;
+  scheduler->job_stats.cpu_seconds += cpu_seconds;
+
+  // crs removed by a resource change shut down together
+  int num_crs = set_int_count(&scheduler->pending_shutdowns, cr_id) == 1
+                    ? (int)scheduler->pending_shutdowns.size
+                    : 1;
+  double delay = MPIDYNRES_scheduler_draw_shutdown_latency(scheduler, num_crs);
+  if (delay > 0.0) {
+    if (pool->cr_state[cr_id] != accepted_shutdown) {
+      log_state_event(STATELOG_CR_EXITED);
+      MPIDYNRES_scheduler_set_cr_state(scheduler, cr_id, accepted_shutdown);
+    }
+    set_int_erase(&scheduler->running_crs, cr_id);
+    set_int_insert(&scheduler->shutting_down_crs, cr_id);
+    MPIDYNRES_scheduler_add_cr_timer(scheduler, delay, TIMER_CR_RELEASE,
+                                     cr_id);
+    return;
+  }
+  MPIDYNRES_scheduler_release_cr(scheduler, cr_id);
+}
 
+/**
+ * @brief      Give a cr that returned back to the pool
+ *
+ * @details    Remove the cr from currently running and change state to idle,
+ * also free all process sets that the process was part of
+ *
+ * @param      scheduler The scheduler of the job the cr belongs to
+ *
+ * @param      cr_id The cr
+ */
+void MPIDYNRES_scheduler_release_cr(MPIDYNRES_scheduler *scheduler,
+                                    int cr_id) {
   // remove from pending shutdowns if in there
   if (set_int_count(&scheduler->pending_shutdowns, cr_id) == 1) {
     debug("Removing %d from pending shutdowns\n", cr_id);
@@ -88,11 +179,34 @@ void MPIDYNRES_scheduler_handle_worker_done(MPIDYNRES_scheduler *scheduler,
   set_process_state_erase(&scheduler->process_states,
                           (process_state){.process_id = cr_id});
 
-  // remove from running processes
+  // remove from running or shutting down processes
   set_int_erase(&scheduler->running_crs, cr_id);
+  set_int_erase(&scheduler->shutting_down_crs, cr_id);
+
+  // give the cr back to the pool
+  MPIDYNRES_pool *pool = scheduler->pool;
+  scheduler->job_stats.cr_seconds += MPI_Wtime() - pool->cr_start_time[cr_id];
+  pool->owner[cr_id] = MPIDYNRES_NO_JOB;
+  pool->num_running--;
+
+  log_state_event(STATELOG_CR_EXITED);
+  MPIDYNRES_scheduler_set_cr_state(scheduler, cr_id, idle);
+  if (tool_wants(MPIDYNRES_TOOL_CR_EXITED)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_CR_EXITED, scheduler->job_id, cr_id);
+    tool_fire(&event);
+  }
+
+  if (scheduler->running_crs.size == 0 &&
+      scheduler->shutting_down_crs.size == 0) {
+    debug("Job %d is done\n", scheduler->job_id);
+    scheduler->job_stats.end_time = MPI_Wtime();
+    // release crs reserved by resource changes that were never accepted
+    MPIDYNRES_scheduler_cancel_rcs(scheduler);
+  }
 
-  set_state(cr_id, idle);
-  log_state("cr id %d returned/exited", cr_id);
+  MPIDYNRES_scheduler_start_pending_jobs(scheduler);
+  MPIDYNRES_scheduler_refill_standby(scheduler);
 }
 
 /**
@@ -102,14 +216,22 @@ void MPIDYNRES_scheduler_handle_worker_done(MPIDYNRES_scheduler *scheduler,
  *
  * @param      status The MPI status of the message that was received
  */
-void MPIDYNRES_scheduler_handle_session_create(MPIDYNRES_scheduler *scheduler,
-                                               MPI_Status *status) {
+void MPIDYNRES_scheduler_handle_session_create(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status) {
   int err;
-  err = MPI_Send(&scheduler->next_session_id, 1, MPI_INT, status->MPI_SOURCE,
-                 MPIDYNRES_TAG_SESSION_CREATE_ANSWER,
-                 scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send(scheduler->transport,
+                                 &scheduler->next_session_id, sizeof(int),
+                                 status->source,
+                                 MPIDYNRES_TAG_SESSION_CREATE_ANSWER);
   if (err) {
-    die("Error in MPI_Send\n");
+    die("Error in MPIDYNRES_transport_send\n");
+  }
+  if (tool_wants(MPIDYNRES_TOOL_SESSION_INIT)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_SESSION_INIT, scheduler->job_id,
+        MPIDYNRES_scheduler_get_id_of_rank(status->source));
+    event.session_id = scheduler->next_session_id;
+    tool_fire(&event);
   }
   scheduler->next_session_id++;
 }
@@ -124,14 +246,16 @@ void MPIDYNRES_scheduler_handle_session_create(MPIDYNRES_scheduler *scheduler,
  *
  * @param      status The MPI status of the message that was received
  */
-void MPIDYNRES_scheduler_handle_session_info(MPIDYNRES_scheduler *scheduler,
-                                             MPI_Status *status) {
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+void MPIDYNRES_scheduler_handle_session_info(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status) {
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
   int err;
   char process_id_str[0x20] = {0};
   char origin_rc_tag_str[0x20] = {0};
+  char job_id_str[0x20] = {0};
   char *pending_shutdown_str;
   char *dynamic_start_str;
+  char *restored_str;
   MPI_Info info;
   process_state *ps;
 
@@ -143,6 +267,7 @@ void MPIDYNRES_scheduler_handle_session_info(MPIDYNRES_scheduler *scheduler,
   snprintf(process_id_str, COUNT_OF(process_id_str) - 1, "%d", ps->process_id);
   pending_shutdown_str = ps->pending_shutdown ? "yes" : "no";
   dynamic_start_str = ps->dynamic_start ? "yes" : "no";
+  restored_str = ps->restored ? "yes" : "no";
   snprintf(origin_rc_tag_str, COUNT_OF(origin_rc_tag_str) - 1, "%d",
            ps->origin_rc_tag);
 
@@ -156,11 +281,15 @@ void MPIDYNRES_scheduler_handle_session_info(MPIDYNRES_scheduler *scheduler,
   MPI_Info_set(info, "mpidynres_process_id", process_id_str);
   MPI_Info_set(info, "mpidynres_pending_shutdown", pending_shutdown_str);
   MPI_Info_set(info, "mpidynres_dynamic_start", dynamic_start_str);
+  MPI_Info_set(info, "mpidynres_restored", restored_str);
   MPI_Info_set(info, "mpidynres_origin_rc_tag", origin_rc_tag_str);
+  snprintf(job_id_str, COUNT_OF(job_id_str) - 1, "%d", scheduler->job_id);
+  MPI_Info_set(info, "mpidynres_job_id", job_id_str);
 
-  err = MPIDYNRES_Send_MPI_Info(
-      info, status->MPI_SOURCE, MPIDYNRES_TAG_SESSION_INFO_ANSWER_SIZE,
-      MPIDYNRES_TAG_SESSION_INFO_ANSWER, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send_info(
+      scheduler->transport, info, status->source,
+      MPIDYNRES_TAG_SESSION_INFO_ANSWER_SIZE,
+      MPIDYNRES_TAG_SESSION_INFO_ANSWER);
   if (err) {
     die("Error in sending mpi info\n");
   }
@@ -176,15 +305,21 @@ void MPIDYNRES_scheduler_handle_session_info(MPIDYNRES_scheduler *scheduler,
  *
  * @param      status The MPI status of the message that was received
  */
-void MPIDYNRES_scheduler_handle_session_finalize(MPIDYNRES_scheduler *scheduler,
-                                                 MPI_Status *status) {
+void MPIDYNRES_scheduler_handle_session_finalize(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status) {
   int err;
   int ok = 0;
-  err = MPI_Send(&ok, 1, MPI_INT, status->MPI_SOURCE,
-                 MPIDYNRES_TAG_SESSION_FINALIZE_ANSWER,
-                 scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send(scheduler->transport, &ok, sizeof(int),
+                                 status->source,
+                                 MPIDYNRES_TAG_SESSION_FINALIZE_ANSWER);
   if (err) {
-    die("Error in MPI_Send\n");
+    die("Error in MPIDYNRES_transport_send\n");
+  }
+  if (tool_wants(MPIDYNRES_TOOL_SESSION_FINALIZE)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_SESSION_FINALIZE, scheduler->job_id,
+        MPIDYNRES_scheduler_get_id_of_rank(status->source));
+    tool_fire(&event);
   }
 }
 
@@ -198,17 +333,16 @@ void MPIDYNRES_scheduler_handle_session_finalize(MPIDYNRES_scheduler *scheduler,
  * @param      status The MPI status of the message that was received
  */
 void MPIDYNRES_scheduler_handle_get_psets(MPIDYNRES_scheduler *scheduler,
-                                          MPI_Status *status) {
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+                                          MPIDYNRES_transport_status *status) {
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
   int err;
   MPI_Info psets_info;
   MPI_Info info;
 
   // receive mpi info
-  err = MPIDYNRES_Recv_MPI_Info(
-      &info, status->MPI_SOURCE, MPIDYNRES_TAG_GET_PSETS_INFO_SIZE,
-      MPIDYNRES_TAG_GET_PSETS_INFO, scheduler->config->base_communicator,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(
+      scheduler->transport, &info, status->source,
+      MPIDYNRES_TAG_GET_PSETS_INFO_SIZE, MPIDYNRES_TAG_GET_PSETS_INFO);
   if (err) {
     die("Error in receiving mpi info\n");
   }
@@ -240,9 +374,9 @@ void MPIDYNRES_scheduler_handle_get_psets(MPIDYNRES_scheduler *scheduler,
     die("Error in MPI_Info_set\n");
   }
 
-  err = MPIDYNRES_Send_MPI_Info(
-      psets_info, status->MPI_SOURCE, MPIDYNRES_TAG_GET_PSETS_ANSWER_SIZE,
-      MPIDYNRES_TAG_GET_PSETS_ANSWER, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send_info(
+      scheduler->transport, psets_info, status->source,
+      MPIDYNRES_TAG_GET_PSETS_ANSWER_SIZE, MPIDYNRES_TAG_GET_PSETS_ANSWER);
   if (err) {
     die("Error in sending mpi info\n");
   }
@@ -262,18 +396,19 @@ void MPIDYNRES_scheduler_handle_get_psets(MPIDYNRES_scheduler *scheduler,
  * computing resource
  */
 void MPIDYNRES_scheduler_handle_pset_info(MPIDYNRES_scheduler *scheduler,
-                                          MPI_Status *status, int strsize) {
+                                          MPIDYNRES_transport_status *status,
+                                          int strsize) {
   assert(strsize <= MPI_MAX_PSET_NAME_LEN);
   int err;
   MPI_Info pset_info;
 
   debug("In handle_pset_info\n");
   char *pset_name = calloc(strsize, sizeof(char));
-  err = MPI_Recv(pset_name, strsize, MPI_CHAR, status->MPI_SOURCE,
-                 MPIDYNRES_TAG_PSET_INFO_NAME,
-                 scheduler->config->base_communicator, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(scheduler->transport, pset_name, strsize,
+                                 status->source, MPIDYNRES_TAG_PSET_INFO_NAME,
+                                 NULL);
   if (err) {
-    die("Error in mpi_recv\n");
+    die("Error in MPIDYNRES_transport_recv\n");
   }
   debug("Info was requested for %s\n", pset_name);
 
@@ -307,9 +442,9 @@ void MPIDYNRES_scheduler_handle_pset_info(MPIDYNRES_scheduler *scheduler,
     };
   }
 
-  err = MPIDYNRES_Send_MPI_Info(
-      pset_info, status->MPI_SOURCE, MPIDYNRES_TAG_PSET_INFO_ANSWER_SIZE,
-      MPIDYNRES_TAG_PSET_INFO_ANSWER, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send_info(
+      scheduler->transport, pset_info, status->source,
+      MPIDYNRES_TAG_PSET_INFO_ANSWER_SIZE, MPIDYNRES_TAG_PSET_INFO_ANSWER);
   if (err) {
     die("Error in sending mpi info\n");
   }
@@ -331,16 +466,16 @@ void MPIDYNRES_scheduler_handle_pset_info(MPIDYNRES_scheduler *scheduler,
  * @param      pset_free_msg Pset free msg that was received
  */
 void MPIDYNRES_scheduler_handle_pset_free(
-    MPIDYNRES_scheduler *scheduler, MPI_Status *status,
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status,
     MPIDYNRES_pset_free_msg *pset_free_msg) {
   (void)status;
   if (strcmp(pset_free_msg->pset_name, "mpi://SELF") == 0) {
-    debug("Warning: Trying to free mpi://SELF");
+    log_warn("Warning: Trying to free mpi://SELF");
   }
   int err;
   err = pset_free(scheduler, pset_free_msg->pset_name);
   if (err) {
-    debug("Warning: Pset free failed\n");
+    log_warn("Warning: Pset free failed\n");
   }
 }
 
@@ -357,9 +492,9 @@ void MPIDYNRES_scheduler_handle_pset_free(
  * @param      name_strsize The size of the name including the null byte
  */
 void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
-                                            MPI_Status *status,
+                                            MPIDYNRES_transport_status *status,
                                             int name_strsize) {
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
   int err;
   size_t answer_size;
   debug("Lookup request from cr_id %d (strsize: %d)\n", cr_id, name_strsize);
@@ -369,18 +504,23 @@ void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
     die("Memory Error\n");
   }
 
-  err = MPI_Recv(name, name_strsize, MPI_CHAR, cr_id,
-                 MPIDYNRES_TAG_PSET_LOOKUP_NAME,
-                 scheduler->config->base_communicator, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv(scheduler->transport, name, name_strsize,
+                                 status->source,
+                                 MPIDYNRES_TAG_PSET_LOOKUP_NAME, NULL);
   if (err) {
     die("Failed to receive\n");
   }
   debug("%d wants to lookup %s\n", cr_id, name);
 
   if (strcmp("mpi://SELF", name) == 0) {
-    MPI_Send(&status->MPI_SOURCE, 1, MPI_INT, status->MPI_SOURCE,
-             MPIDYNRES_TAG_PSET_LOOKUP_ANSWER,
-             scheduler->config->base_communicator);
+    free(name);
+    answer_size = 1;
+    MPIDYNRES_transport_send(scheduler->transport, &answer_size,
+                             sizeof(size_t), status->source,
+                             MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE);
+    MPIDYNRES_transport_send(scheduler->transport, &status->source,
+                             sizeof(int), status->source,
+                             MPIDYNRES_TAG_PSET_LOOKUP_ANSWER);
     return;
   }
 
@@ -393,9 +533,9 @@ void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
 
   debug("Answer size: %zu\n", answer_size);
 
-  MPI_Send(&answer_size, 1, my_MPI_SIZE_T, status->MPI_SOURCE,
-           MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE,
-           scheduler->config->base_communicator);
+  MPIDYNRES_transport_send(scheduler->transport, &answer_size, sizeof(size_t),
+                           status->source,
+                           MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE);
 
   // only send if url valid
   if (in_there) {
@@ -408,12 +548,12 @@ void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
       tmp[i++] = *it.ref;
       debug("%d\n", *it.ref);
     }
-    MPI_Send(tmp, answer_size, MPI_INT, status->MPI_SOURCE,
-             MPIDYNRES_TAG_PSET_LOOKUP_ANSWER,
-             scheduler->config->base_communicator);
+    MPIDYNRES_transport_send(scheduler->transport, tmp,
+                             answer_size * sizeof(int), status->source,
+                             MPIDYNRES_TAG_PSET_LOOKUP_ANSWER);
     free(tmp);
   } else {
-    debug("Warning, cannot lookup pset\n");
+    log_warn("Warning, cannot lookup pset\n");
   }
 }
 
@@ -431,9 +571,9 @@ void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
  * and the operation itself
  */
 void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
-                                        MPI_Status *status,
+                                        MPIDYNRES_transport_status *status,
                                         MPIDYNRES_pset_op_msg *pset_op_msg) {
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
 
   int vlen, flag, err;
   char *pset_name1 = pset_op_msg->pset_name1;
@@ -446,10 +586,9 @@ void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
   MPI_Info info;
 
   // receive mpi info
-  err = MPIDYNRES_Recv_MPI_Info(
-      &info, status->MPI_SOURCE, MPIDYNRES_TAG_PSET_OP_INFO_SIZE,
-      MPIDYNRES_TAG_PSET_OP_INFO, scheduler->config->base_communicator,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(
+      scheduler->transport, &info, status->source,
+      MPIDYNRES_TAG_PSET_OP_INFO_SIZE, MPIDYNRES_TAG_PSET_OP_INFO);
   if (err) {
     die("Error in receiving mpi info\n");
   }
@@ -468,7 +607,8 @@ void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
   }
 
   if (random_name_choice) {
-    MPIDYNRES_gen_random_uri("mpidynres://op_", res_pset_name);
+    MPIDYNRES_gen_random_uri(&scheduler->rng_state, "mpidynres://op_",
+                             res_pset_name);
   }
 
   bool pn1_self = (strcmp(pset_name1, "mpi://SELF") == 0);
@@ -553,7 +693,7 @@ void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
   }
 
   if (new_node.pset.size == 0) {
-    debug("Warning: Pset operation leads to empty result pset\n");
+    log_warn("Warning: Pset operation leads to empty result pset\n");
     set_int_free(&new_node.pset);
     res_pset_name[0] = '\0';
   }
@@ -573,13 +713,21 @@ void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
     }
 
     set_pset_node_insert(&scheduler->pset_name_map, new_node);
+    if (tool_wants(MPIDYNRES_TOOL_PSET_CREATED)) {
+      MPIDYNRES_tool_event event = tool_scheduler_event(
+          MPIDYNRES_TOOL_PSET_CREATED, scheduler->job_id, cr_id);
+      event.session_id = pset_op_msg->session_id;
+      event.pset_name = res_pset_name;
+      event.pset_size = pnn.pset_size;
+      tool_fire(&event);
+    }
   }
 
-  err = MPI_Send(res_pset_name, MPI_MAX_PSET_NAME_LEN, MPI_CHAR,
-                 status->MPI_SOURCE, MPIDYNRES_TAG_PSET_OP_ANSWER,
-                 scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send(scheduler->transport, res_pset_name,
+                                 MPI_MAX_PSET_NAME_LEN, status->source,
+                                 MPIDYNRES_TAG_PSET_OP_ANSWER);
   if (err) {
-    die("Error in mpi_send\n");
+    die("Error in MPIDYNRES_transport_send\n");
   }
 
   // cleanup self sets
@@ -604,18 +752,17 @@ void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
  * @param      session_id The id of the session used (currently ignored)
  */
 void MPIDYNRES_scheduler_handle_sched_hints(MPIDYNRES_scheduler *scheduler,
-                                            MPI_Status *status,
+                                            MPIDYNRES_transport_status *status,
                                             int session_id) {
   (void)session_id;
   int err;
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
   MPI_Info hints_info;
   MPI_Info answer_info;
 
-  err = MPIDYNRES_Recv_MPI_Info(
-      &hints_info, status->MPI_SOURCE, MPIDYNRES_TAG_SCHED_HINTS_SIZE,
-      MPIDYNRES_TAG_SCHED_HINTS_INFO, scheduler->config->base_communicator,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(
+      scheduler->transport, &hints_info, status->source,
+      MPIDYNRES_TAG_SCHED_HINTS_SIZE, MPIDYNRES_TAG_SCHED_HINTS_INFO);
   if (err) {
     die("Error in receiving mpi info\n");
   }
@@ -626,22 +773,53 @@ void MPIDYNRES_scheduler_handle_sched_hints(MPIDYNRES_scheduler *scheduler,
     die("Error while registering scheduling hints\n");
   }
 
-  err = MPIDYNRES_Send_MPI_Info(
-      answer_info, status->MPI_SOURCE, MPIDYNRES_TAG_SCHED_HINTS_ANSWER_SIZE,
-      MPIDYNRES_TAG_SCHED_HINTS_ANSWER, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send_info(
+      scheduler->transport, answer_info, status->source,
+      MPIDYNRES_TAG_SCHED_HINTS_ANSWER_SIZE, MPIDYNRES_TAG_SCHED_HINTS_ANSWER);
   if (err) {
     die("Error in sesnding mpi info\n");
   }
 
-  MPI_Info_free(&hints_info);
-  MPI_Info_free(&answer_info);
+  if (hints_info != MPI_INFO_NULL) {
+    MPI_Info_free(&hints_info);
+  }
+  if (answer_info != MPI_INFO_NULL) {
+    MPI_Info_free(&answer_info);
+  }
+}
+
+/**
+ * @brief      Take the rc decision that was staged by the manager
+ *
+ * @details    The staged crs are checked again, as the state might have
+ * changed since the decision was made. If they do not fit anymore, the
+ * decision becomes RC_NONE (see MPIDYNRES_scheduler_rc_fits)
+ *
+ * @param      scheduler the scheduler
+ *
+ * @param      o_rc_type the staged rc type
+ *
+ * @param      o_new_pset the staged crs, only set if the type is not RC_NONE
+ */
+static void take_staged_rc(MPIDYNRES_scheduler *scheduler,
+                           MPIDYNRES_RC_type *o_rc_type, set_int *o_new_pset) {
+  scheduler->rc_staged = false;
+  if (MPIDYNRES_scheduler_rc_fits(scheduler, scheduler->staged_rc_type,
+                                  &scheduler->staged_rc_pset)) {
+    *o_rc_type = scheduler->staged_rc_type;
+    *o_new_pset = scheduler->staged_rc_pset;
+  } else {
+    debug("Staged rc of job %d does not fit anymore\n", scheduler->job_id);
+    *o_rc_type = MPIDYNRES_RC_NONE;
+    set_int_free(&scheduler->staged_rc_pset);
+  }
 }
 
 /**
  * @brief      Handle a resource change message
  *
  * @details    Query management interface for delta pset and insert it to rc set
- * and send it to cr
+ * and send it to cr. If the manager staged a decision, it is used instead
  *
  * @param      scheduler the scheduler
  *
@@ -650,8 +828,8 @@ void MPIDYNRES_scheduler_handle_sched_hints(MPIDYNRES_scheduler *scheduler,
  * @param      session_id The id of the session used (currently ignored)
  */
 void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
-                                   MPI_Status *status, int session_id) {
-  (void)session_id;
+                                   MPIDYNRES_transport_status *status,
+                                   int session_id) {
   MPIDYNRES_RC_msg rc_msg = {0};
   MPIDYNRES_RC_type rc_type;
   set_int new_pset;
@@ -664,7 +842,8 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
   char pset_name[MPI_MAX_PSET_NAME_LEN];
   char buf[0x100];
   int err;
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
+  bool asked_manager = false;
   char const *const rc_type_names[] = {
       [MPIDYNRES_RC_NONE] = "none",
       [MPIDYNRES_RC_ADD] = "add",
@@ -675,10 +854,15 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
 
   // if pending, shutdowns, return none
   if (scheduler->pending_shutdowns.size > 0) {
-    debug("Warning: RC was requested, but there are still pending shutdowns\n");
+    log_warn(
+        "Warning: RC was requested, but there are still pending shutdowns\n");
     rc_type = MPIDYNRES_RC_NONE;
     info = MPI_INFO_NULL;
+  } else if (scheduler->rc_staged) {
+    asked_manager = true;
+    take_staged_rc(scheduler, &rc_type, &new_pset);
   } else {
+    asked_manager = true;
     err = MPIDYNRES_manager_handle_rc_msg(scheduler->manager, cr_id, &info,
                                           &rc_type, &new_pset);
     if (err) {
@@ -686,9 +870,39 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
     }
   }
 
+  // jobs that wait for their start have priority over growing jobs
+  if (rc_type == MPIDYNRES_RC_ADD &&
+      MPIDYNRES_scheduler_jobs_waiting(scheduler)) {
+    debug("Denying RC_ADD of job %d, there are waiting jobs\n",
+          scheduler->job_id);
+    set_int_free(&new_pset);
+    if (info != MPI_INFO_NULL) {
+      MPI_Info_free(&info);
+    }
+    rc_type = MPIDYNRES_RC_NONE;
+  }
+
   assert(rc_type != MPIDYNRES_RC_NONE || info == MPI_INFO_NULL);
 
+  if (asked_manager) {
+    trace_decision(scheduler, cr_id, rc_type_names[rc_type],
+                   rc_type == MPIDYNRES_RC_NONE ? NULL : &new_pset);
+  }
+
+  if (rc_type == MPIDYNRES_RC_ADD) {
+    // reserve the crs for this job
+    foreach (set_int, &new_pset, it) {
+      if (!MPIDYNRES_scheduler_cr_is_free(scheduler, *it.ref)) {
+        die("Manager tried to add cr %d, which is not free\n", *it.ref);
+      }
+      scheduler->pool->owner[*it.ref] = scheduler->job_id;
+    }
+    // the reserved crs may have been the standby of this job
+    MPIDYNRES_scheduler_refill_standby(scheduler);
+  }
+
   if (rc_type != MPIDYNRES_RC_NONE) {
+    scheduler->job_stats.num_rc++;
     ri.rc_tag = scheduler->next_rc_tag;
     scheduler->next_rc_tag += 1;
     // create new pset name
@@ -697,6 +911,7 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
     // create rc_info and insert into lookup set
     ri.rc_tag = scheduler->next_rc_tag;
     ri.rc_type = rc_type;
+    ri.answer_ns = MPIDYNRES_now_ns();
     ri.pset = set_int_copy(&new_pset);
     strcpy(ri.new_pset_name, pset_name);
     set_rc_info_insert(&scheduler->rc_map, ri);
@@ -718,6 +933,14 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
 
     // insert into pset name map
     set_pset_node_insert(&scheduler->pset_name_map, new_pset_node);
+    if (tool_wants(MPIDYNRES_TOOL_PSET_CREATED)) {
+      MPIDYNRES_tool_event event = tool_scheduler_event(
+          MPIDYNRES_TOOL_PSET_CREATED, scheduler->job_id, cr_id);
+      event.session_id = session_id;
+      event.pset_name = pset_name;
+      event.pset_size = new_pset.size;
+      tool_fire(&event);
+    }
 
     // update psets_containing
     strcpy(pname.name, pset_name);
@@ -745,16 +968,22 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
       ps->pending_shutdown = true;
     }
     // update logging state
-    foreach (set_int, &pn->pset, it) { set_state(*it.ref, proposed_shutdown); }
-    log_state("proposing to shutdown crs");
+    log_state_event(STATELOG_PROPOSE_SHUTDOWN);
+    foreach (set_int, &pn->pset, it) {
+      MPIDYNRES_scheduler_set_cr_state(scheduler, *it.ref, proposed_shutdown);
+    }
   } else if (rc_type == MPIDYNRES_RC_ADD) {
     set_pset_node_find_by_name(&scheduler->pset_name_map, pset_name, &pn);
     assert(pn != NULL);
     // update logging statee
-    foreach (set_int, &pn->pset, it) { set_state(*it.ref, reserved); }
-    log_state("proposing to start crs");
+    log_state_event(STATELOG_PROPOSE_START);
+    foreach (set_int, &pn->pset, it) {
+      MPIDYNRES_scheduler_set_cr_state(scheduler, *it.ref, reserved);
+    }
   }
 
+  scheduler->pool->metrics.rc_decisions[rc_type]++;
+
   // create rc_msg
   if (rc_type == MPIDYNRES_RC_NONE) {
     rc_msg.tag = -1;
@@ -763,12 +992,23 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
     strcpy(rc_msg.pset_name, pset_name);
     rc_msg.tag = ri.rc_tag;
     rc_msg.type = rc_type;
+    if (tool_wants(MPIDYNRES_TOOL_RC_PROPOSED)) {
+      MPIDYNRES_tool_event event = tool_scheduler_event(
+          MPIDYNRES_TOOL_RC_PROPOSED, scheduler->job_id, cr_id);
+      event.session_id = session_id;
+      event.rc_tag = ri.rc_tag;
+      event.rc_type = rc_type;
+      event.pset_name = pset_name;
+      event.pset_size = pn->pset.size;
+      tool_fire(&event);
+    }
   }
 
   // send info answer
-  err = MPIDYNRES_Send_MPI_Info(
-      info, status->MPI_SOURCE, MPIDYNRES_TAG_RC_INFO_SIZE,
-      MPIDYNRES_TAG_RC_INFO, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send_info(scheduler->transport, info,
+                                      status->source,
+                                      MPIDYNRES_TAG_RC_INFO_SIZE,
+                                      MPIDYNRES_TAG_RC_INFO);
   if (err) {
     die("Error in receiving mpi info\n");
   }
@@ -777,8 +1017,8 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
   }
 
   // send rc_msg
-  err = MPI_Send(&rc_msg, 1, get_rc_datatype(), status->MPI_SOURCE,
-                 MPIDYNRES_TAG_RC_ANSWER, scheduler->config->base_communicator);
+  err = MPIDYNRES_transport_send(scheduler->transport, &rc_msg, sizeof(rc_msg),
+                                 status->source, MPIDYNRES_TAG_RC_ANSWER);
   if (err) {
     die("Error in sending rc reply\n");
   }
@@ -802,21 +1042,19 @@ void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
  * @param      rc_tag The tag of the rc that should be accepted
  */
 void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler,
-                                          MPI_Status *status, int session_id,
-                                          int rc_tag) {
-  (void)session_id;
+                                          MPIDYNRES_transport_status *status,
+                                          int session_id, int rc_tag) {
   rc_info *ri;
 
   MPI_Info info = MPI_INFO_NULL, origin_rc_info = MPI_INFO_NULL;
   int err;
-  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->MPI_SOURCE);
+  int cr_id = MPIDYNRES_scheduler_get_id_of_rank(status->source);
 
   debug("RC Accept from %d\n", cr_id);
 
-  err = MPIDYNRES_Recv_MPI_Info(
-      &info, status->MPI_SOURCE, MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
-      MPIDYNRES_TAG_RC_ACCEPT_INFO, scheduler->config->base_communicator,
-      MPI_STATUS_IGNORE, MPI_STATUS_IGNORE);
+  err = MPIDYNRES_transport_recv_info(
+      scheduler->transport, &info, status->source,
+      MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE, MPIDYNRES_TAG_RC_ACCEPT_INFO);
   if (err) {
     die("Error in receiving mpi info\n");
   }
@@ -828,21 +1066,35 @@ void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler,
     die("Invalid rc_accept tag: %d, was already accepted or never created\n",
         rc_tag);
   }
+  MPIDYNRES_histogram_record(&scheduler->pool->metrics.rc_accept,
+                             MPIDYNRES_now_ns() - ri->answer_ns);
+  if (tool_wants(MPIDYNRES_TOOL_RC_ACCEPTED)) {
+    MPIDYNRES_tool_event event = tool_scheduler_event(
+        MPIDYNRES_TOOL_RC_ACCEPTED, scheduler->job_id, cr_id);
+    event.session_id = session_id;
+    event.rc_tag = rc_tag;
+    event.rc_type = ri->rc_type;
+    event.pset_name = ri->new_pset_name;
+    event.pset_size = ri->pset.size;
+    tool_fire(&event);
+  }
 
   switch (ri->rc_type) {
     case MPIDYNRES_RC_ADD: {
-      // start new crs
+      // start new crs, they are launched together
+      double delay =
+          MPIDYNRES_scheduler_draw_start_latency(scheduler, ri->pset.size);
       if (info == MPI_INFO_NULL) {
         origin_rc_info = MPI_INFO_NULL;
         foreach (set_int, &ri->pset, it) {
           MPIDYNRES_scheduler_start_cr(scheduler, *it.ref, true, rc_tag,
-                                       origin_rc_info);
+                                       origin_rc_info, delay);
         }
       } else {
         foreach (set_int, &ri->pset, it) {
           MPI_Info_dup(info, &origin_rc_info);
           MPIDYNRES_scheduler_start_cr(scheduler, *it.ref, true, rc_tag,
-                                       origin_rc_info);
+                                       origin_rc_info, delay);
         }
         MPI_Info_free(&info);
       }
@@ -850,9 +1102,11 @@ void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler,
     }
     case MPIDYNRES_RC_SUB: {
       // update logging state
+      log_state_event(STATELOG_ACCEPT_SHUTDOWN);
       foreach (set_int, &ri->pset, it) {
         if (set_int_find(&scheduler->running_crs, *it.ref) != NULL) {
-          set_state(*it.ref, accepted_shutdown);
+          MPIDYNRES_scheduler_set_cr_state(scheduler, *it.ref,
+                                           accepted_shutdown);
         }
       }
       break;
@@ -867,4 +1121,29 @@ void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler,
   scheduler->pending_resource_change = false;
 
   set_rc_info_erase(&scheduler->rc_map, *ri);
+  MPIDYNRES_scheduler_refill_standby(scheduler);
+}
+
+/**
+ * @brief      Handle a stats request
+ *
+ * @details    Send the metrics of the pool (see MPIDYNRES_scheduler_get_stats)
+ *
+ * @param      scheduler The scheduler
+ *
+ * @param      status The MPI status of the message that was received
+ */
+void MPIDYNRES_scheduler_handle_get_stats(MPIDYNRES_scheduler *scheduler,
+                                          MPIDYNRES_transport_status *status) {
+  MPI_Info stats;
+  int err;
+
+  MPIDYNRES_scheduler_get_stats(scheduler, &stats);
+  err = MPIDYNRES_transport_send_info(
+      scheduler->transport, stats, status->source,
+      MPIDYNRES_TAG_GET_STATS_ANSWER_SIZE, MPIDYNRES_TAG_GET_STATS_ANSWER);
+  if (err) {
+    die("Error in sending mpi info\n");
+  }
+  MPI_Info_free(&stats);
 }
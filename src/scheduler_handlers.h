@@ -2,53 +2,68 @@
 #define SCHEDULER_HANDLERS_H
 
 void MPIDYNRES_scheduler_handle_worker_done(MPIDYNRES_scheduler *scheduler,
-                                            MPI_Status *status);
+                                            MPIDYNRES_transport_status *status,
+                                            double cpu_seconds);
 
+void MPIDYNRES_scheduler_release_cr(MPIDYNRES_scheduler *scheduler,
+                                    int cr_id);
 
+void MPIDYNRES_scheduler_cancel_rcs(MPIDYNRES_scheduler *scheduler);
 
-void MPIDYNRES_scheduler_handle_session_create(MPIDYNRES_scheduler *scheduler,
-                                               MPI_Status *status);
 
-void MPIDYNRES_scheduler_handle_session_info(MPIDYNRES_scheduler *scheduler,
-                                             MPI_Status *status);
 
-void MPIDYNRES_scheduler_handle_session_finalize(MPIDYNRES_scheduler *scheduler,
-                                                 MPI_Status *status);
+void MPIDYNRES_scheduler_handle_session_create(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status);
+
+void MPIDYNRES_scheduler_handle_session_info(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status);
+
+void MPIDYNRES_scheduler_handle_session_finalize(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status);
 
 
 
 
 void MPIDYNRES_scheduler_handle_get_psets(MPIDYNRES_scheduler *scheduler,
-                                          MPI_Status *status);
+                                          MPIDYNRES_transport_status *status);
 
 void MPIDYNRES_scheduler_handle_pset_info(MPIDYNRES_scheduler *scheduler,
-                                          MPI_Status *status, int strsize);
+                                          MPIDYNRES_transport_status *status,
+                                          int strsize);
 
-void MPIDYNRES_scheduler_handle_pset_free(MPIDYNRES_scheduler *scheduler, MPI_Status *status,
-                                          MPIDYNRES_pset_free_msg *pset_free_msg);
+void MPIDYNRES_scheduler_handle_pset_free(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status,
+    MPIDYNRES_pset_free_msg *pset_free_msg);
 
 
 
 void MPIDYNRES_scheduler_handle_pset_lookup(MPIDYNRES_scheduler *scheduler,
-                                            MPI_Status *status,
+                                            MPIDYNRES_transport_status *status,
                                             int name_strsize);
 
 
 // TODO
 void MPIDYNRES_scheduler_handle_pset_op(MPIDYNRES_scheduler *scheduler,
-                                        MPI_Status *status,
+                                        MPIDYNRES_transport_status *status,
                                         MPIDYNRES_pset_op_msg *pset_op_msg);
 
 
 
-void MPIDYNRES_scheduler_handle_sched_hints(MPIDYNRES_scheduler *scheduler, MPI_Status *status, int session_id);
+void MPIDYNRES_scheduler_handle_sched_hints(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status,
+    int session_id);
 
 // TODO
 void MPIDYNRES_scheduler_handle_rc(MPIDYNRES_scheduler *scheduler,
-                                   MPI_Status *status, int session_id);
+                                   MPIDYNRES_transport_status *status,
+                                   int session_id);
 
 // TODO
-void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler, MPI_Status *status,
+void MPIDYNRES_scheduler_handle_rc_accept(MPIDYNRES_scheduler *scheduler,
+                                          MPIDYNRES_transport_status *status,
                                           int session_id, int rc_tag);
 
+void MPIDYNRES_scheduler_handle_get_stats(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport_status *status);
+
 #endif
@@ -1 +0,0 @@
-managers/random_diff_manager.c
\ No newline at end of file
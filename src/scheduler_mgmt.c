@@ -0,0 +1,346 @@
+#include "scheduler_mgmt.h"
+
+#include <dlfcn.h>
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging.h"
+#include "util.h"
+
+#define MAX_MANAGERS 32
+
+/*
+ * The registered manager implementations, the built in ones come first
+ */
+static MPIDYNRES_manager_ops const *managers[MAX_MANAGERS] = {
+    &MPIDYNRES_random_diff_manager_ops,
+    &MPIDYNRES_inc_dec_manager_ops,
+    &MPIDYNRES_scaling_manager_ops,
+    &MPIDYNRES_sla_manager_ops,
+    &MPIDYNRES_backfill_manager_ops,
+    &MPIDYNRES_replay_manager_ops,
+    &MPIDYNRES_timed_manager_ops,
+};
+static size_t num_managers = 7;
+
+/**
+ * @brief      Register a manager implementation
+ *
+ * @details    Afterwards, the manager can be chosen with the manager_name key.
+ * Registering a name twice replaces the previous implementation.
+ *
+ * @param      ops The functions of the manager, have to stay valid
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_register(MPIDYNRES_manager_ops const *ops) {
+  for (size_t i = 0; i < num_managers; i++) {
+    if (strcmp(managers[i]->name, ops->name) == 0) {
+      managers[i] = ops;
+      return 0;
+    }
+  }
+  if (num_managers == MAX_MANAGERS) {
+    return 1;
+  }
+  managers[num_managers++] = ops;
+  return 0;
+}
+
+/**
+ * @brief      Look up a registered manager implementation
+ *
+ * @param      name The name of the manager
+ *
+ * @return     The functions of the manager or NULL if there is none
+ */
+MPIDYNRES_manager_ops const *MPIDYNRES_manager_find(char const *name) {
+  for (size_t i = 0; i < num_managers; i++) {
+    if (strcmp(managers[i]->name, name) == 0) {
+      return managers[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief      Load a manager from a shared object and register it
+ *
+ * @details    The shared object has to export MANAGER_PLUGIN_SYMBOL. It stays
+ * loaded until the program ends.
+ *
+ * @param      path The path of the shared object
+ *
+ * @return     The functions of the loaded manager
+ */
+static MPIDYNRES_manager_ops const *load_plugin(char const *path) {
+  void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (handle == NULL) {
+    die("Could not load manager plugin %s: %s\n", path, dlerror());
+  }
+  MPIDYNRES_manager_ops const *ops = dlsym(handle, MANAGER_PLUGIN_SYMBOL);
+  if (ops == NULL) {
+    die("Manager plugin %s does not export " MANAGER_PLUGIN_SYMBOL "\n", path);
+  }
+  if (MPIDYNRES_manager_register(ops)) {
+    die("Too many managers registered\n");
+  }
+  return ops;
+}
+
+/**
+ * @brief      Get a value of the manager config
+ *
+ * @param      scheduler The scheduler
+ *
+ * @param      key The key to look up
+ *
+ * @param      value The value is returned here
+ *
+ * @return     whether the key is set
+ */
+bool MPIDYNRES_manager_config_get(MPIDYNRES_scheduler *scheduler,
+                                  char const *key,
+                                  char value[MPI_MAX_INFO_VAL]) {
+  int in_there = 0;
+  MPI_Info config = scheduler->config->manager_config;
+
+  if (config != MPI_INFO_NULL) {
+    MPI_Info_get(config, key, MPI_MAX_INFO_VAL - 1, value, &in_there);
+  }
+  return in_there;
+}
+
+/**
+ * @brief      Get the number of crs that should be started initially
+ *
+ * @details    Uses the manager_initial_number key, if
+ * manager_initial_number_random is set instead, a random number is chosen.
+ * Defaults to 1. The number is chosen once per job.
+ *
+ * @param      scheduler The scheduler
+ *
+ * @return     The initial number of crs
+ */
+int MPIDYNRES_manager_initial_number(MPIDYNRES_scheduler *scheduler) {
+  char value[MPI_MAX_INFO_VAL];
+  int num_processes = scheduler->num_scheduling_processes;
+  int num_init = 1;
+
+  if (scheduler->initial_size > 0) {
+    return scheduler->initial_size;
+  }
+
+  if (MPIDYNRES_manager_config_get(scheduler, "manager_initial_number",
+                                   value)) {
+    num_init = atoi(value);
+    if (num_init < 1 || num_init > num_processes) {
+      die("Key manager_initial_number is invalid.\n");
+    }
+  } else if (MPIDYNRES_manager_config_get(
+                 scheduler, "manager_initial_number_random", value) &&
+             num_processes > 1) {
+    num_init = 1 + (MPIDYNRES_rand(&scheduler->rng_state) % (num_processes - 1));
+  }
+  scheduler->initial_size = num_init;
+  return num_init;
+}
+
+/**
+ * @brief      Choose crs for a resource change
+ *
+ * @details    Picks the free crs with the lowest ids (for RC_ADD) or the
+ * running crs with the highest ids (for RC_SUB). Free crs warmed up for the
+ * job are picked first. Crs used or reserved by other jobs are never picked.
+ *
+ * @param      scheduler The scheduler
+ *
+ * @param      count The number of crs
+ *
+ * @param      free_ones whether to pick free or running crs
+ *
+ * @param      o_pset The new set of crs is returned here, has at most count
+ * elements
+ */
+void MPIDYNRES_manager_pick_crs(MPIDYNRES_scheduler *scheduler, int count,
+                                bool free_ones, set_int *o_pset) {
+  set_int *running = &scheduler->running_crs;
+  int num_processes = scheduler->num_scheduling_processes;
+
+  *o_pset = set_int_init(int_compare);
+  if (free_ones) {
+    for (int cr = 1; cr <= num_processes && (int)o_pset->size < count; cr++) {
+      if (scheduler->pool->standby[cr] == scheduler->job_id &&
+          set_int_count(running, cr) == 0 &&
+          MPIDYNRES_scheduler_cr_is_free(scheduler, cr)) {
+        set_int_insert(o_pset, cr);
+      }
+    }
+  }
+  for (int i = 1; i <= num_processes && (int)o_pset->size < count; i++) {
+    int cr = free_ones ? i : num_processes + 1 - i;
+    bool is_free = set_int_count(running, cr) == 0 &&
+                   MPIDYNRES_scheduler_cr_is_free(scheduler, cr);
+    bool is_running = set_int_count(running, cr) == 1;
+    if (free_ones ? is_free : is_running) {
+      set_int_insert(o_pset, cr);
+    }
+  }
+}
+
+/**
+ * @brief      Initialize the manager
+ *
+ * @details    The implementation is chosen by the manager_name key of the
+ * manager config (default: random_diff). If manager_plugin is set, the manager
+ * is loaded from this shared object first and used if no manager_name is
+ * given. If manager_async is set, the manager decides on its own thread (see
+ * MPIDYNRES_async_manager_create), as long as MPI was initialized with
+ * MPI_THREAD_MULTIPLE. Otherwise it runs on the scheduler thread.
+ *
+ * @param      scheduler The scheduler that is using the management interface
+ *
+ * @return     The new manager object
+ */
+MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler) {
+  char name[MPI_MAX_INFO_VAL];
+  char path[MPI_MAX_INFO_VAL];
+  MPIDYNRES_manager_ops const *ops = NULL;
+
+  if (MPIDYNRES_manager_config_get(scheduler, MANAGER_PLUGIN_KEY, path)) {
+    ops = load_plugin(path);
+  }
+  if (MPIDYNRES_manager_config_get(scheduler, MANAGER_NAME_KEY, name)) {
+    ops = MPIDYNRES_manager_find(name);
+    if (ops == NULL) {
+      die("Unknown manager %s in key " MANAGER_NAME_KEY "\n", name);
+    }
+  } else if (ops == NULL) {
+    ops = MPIDYNRES_manager_find(DEFAULT_MANAGER_NAME);
+  }
+
+  if (MPIDYNRES_manager_config_get(scheduler, MANAGER_ASYNC_KEY, name) &&
+      strcmp(name, "false") != 0 && strcmp(name, "0") != 0) {
+    // the manager thread calls MPI (infos, logging) next to the scheduler
+    int provided;
+    MPI_Query_thread(&provided);
+    if (provided == MPI_THREAD_MULTIPLE) {
+      debug("Using manager %s on its own thread\n", ops->name);
+      return MPIDYNRES_async_manager_create(scheduler, ops);
+    }
+    log_warn("Warning: " MANAGER_ASYNC_KEY " needs MPI_THREAD_MULTIPLE, "
+             "running manager %s on the scheduler thread\n",
+             ops->name);
+  }
+
+  MPIDYNRES_manager res = ops->init(scheduler);
+  if (res == NULL) {
+    die("Could not initialize manager %s\n", ops->name);
+  }
+  res->ops = ops;
+  debug("Using manager %s\n", ops->name);
+  return res;
+}
+
+/**
+ * @brief      Free a manger
+ *
+ * @param      manager The manager to be freed
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_free(MPIDYNRES_manager manager) {
+  return manager->ops->free(manager);
+}
+
+/**
+ * @brief      Pass scheduling hints of a cr to the manager
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      scheduling_hints The hints, have to be copied by the manager
+ *
+ * @param      o_answer The answer to the cr is returned here (or MPI_INFO_NULL)
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_register_scheduling_hints(MPIDYNRES_manager manager,
+                                                int src_process_id,
+                                                MPI_Info scheduling_hints,
+                                                MPI_Info *o_answer) {
+  return manager->ops->register_scheduling_hints(manager, src_process_id,
+                                                 scheduling_hints, o_answer);
+}
+
+/**
+ * @brief      Get initial process set
+ *
+ * @param      manager The manager used
+ *
+ * @param      o_initial_pset The initial pset is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_get_initial_pset(MPIDYNRES_manager manager,
+                                       set_int *o_initial_pset) {
+  return manager->ops->get_initial_pset(manager, o_initial_pset);
+}
+
+/**
+ * @brief      Handle a resource change query
+ *
+ * @param      manager The manager used
+ *
+ * @param      src_process_id The cr id of the calling computing resource
+ *
+ * @param      o_rc_info The resource change info that should be returned to the application
+ *
+ * @param      o_rc_type The type of resource change is returned here
+ *
+ * @param      o_new_pset The new process set is returned here
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
+                                    int src_process_id, MPI_Info *o_rc_info,
+                                    MPIDYNRES_RC_type *o_rc_type,
+                                    set_int *o_new_pset) {
+  return manager->ops->handle_rc_msg(manager, src_process_id, o_rc_info,
+                                     o_rc_type, o_new_pset);
+}
+
+/**
+ * @brief      Decide whether a job may start before the first waiting job
+ *
+ * @param      manager The manager of the first waiting job
+ *
+ * @param      candidate The job behind it, which fits into the free crs
+ *
+ * @return     true if the candidate may be started
+ */
+bool MPIDYNRES_manager_may_backfill(MPIDYNRES_manager manager,
+                                    MPIDYNRES_scheduler *candidate) {
+  if (manager->ops->may_backfill == NULL) {
+    return false;
+  }
+  return manager->ops->may_backfill(manager, candidate);
+}
+
+/**
+ * @brief      Pass an expired timer to the manager
+ *
+ * @param      manager The manager that set the timer
+ *
+ * @param      timer_id The id given to MPIDYNRES_scheduler_add_timer
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_manager_handle_timer(MPIDYNRES_manager manager, int timer_id) {
+  if (manager->ops->handle_timer == NULL) {
+    return 0;
+  }
+  return manager->ops->handle_timer(manager, timer_id);
+}
@@ -1,19 +1,110 @@
 #ifndef SCHEDULER_MGMT_H
-#define SCHEUDLER_MGMT_H
+#define SCHEDULER_MGMT_H
 /*
  * This header defines a general interface that can be used to query a
  * scheduling management impelmentation for scheduling decisions
  */
 
+#include <stdbool.h>
+
 /*
  * The MPIDYNRES_manager decides on how to act when cr ids ask for resource
- * changes To allow different management implementations, the manager is
- * typedef'd to a void *
+ * changes. To allow different management implementations, every
+ * implementation embeds struct MPIDYNRES_manager_base as its first member.
  */
-typedef void *MPIDYNRES_manager;
+struct MPIDYNRES_manager_ops;
+typedef struct MPIDYNRES_manager_ops MPIDYNRES_manager_ops;
+
+struct MPIDYNRES_manager_base;
+typedef struct MPIDYNRES_manager_base *MPIDYNRES_manager;
 
 #include "scheduler.h"
 
+/*
+ * manager_config keys used to choose the manager
+ */
+#define MANAGER_NAME_KEY "manager_name"
+#define MANAGER_PLUGIN_KEY "manager_plugin"
+#define DEFAULT_MANAGER_NAME "random_diff"
+
+/*
+ * manager_config key to run the manager on its own thread, so slow decisions
+ * do not block the scheduler. Needs MPI_THREAD_MULTIPLE.
+ */
+#define MANAGER_ASYNC_KEY "manager_async"
+
+/*
+ * manager_config key with the number of free crs that are kept warmed up for
+ * a job (see MPIDYNRES_scheduler_warm_cr), or "auto" to let the manager size
+ * it (see MPIDYNRES_scheduler_set_standby_size)
+ */
+#define MANAGER_STANDBY_KEY "manager_standby"
+
+/*
+ * manager_config keys with the latency models of starting and shutting down
+ * the crs of a job (see latency.h)
+ */
+#define MANAGER_START_LATENCY_KEY "manager_start_latency"
+#define MANAGER_SHUTDOWN_LATENCY_KEY "manager_shutdown_latency"
+
+/*
+ * manager_config key with the seed of the random decisions of a job
+ */
+#define MANAGER_SEED_KEY "manager_seed"
+
+/*
+ * Symbol a manager plugin has to export (of type MPIDYNRES_manager_ops)
+ */
+#define MANAGER_PLUGIN_SYMBOL "MPIDYNRES_manager_plugin_ops"
+
+/**
+ * @brief      The functions of a manager implementation
+ */
+struct MPIDYNRES_manager_ops {
+  char const *name;  ///< name used for the manager_name key
+
+  MPIDYNRES_manager (*init)(MPIDYNRES_scheduler *scheduler);
+  int (*free)(MPIDYNRES_manager manager);
+  /*
+   * scheduling_hints has to be copied, as it will be freed afterwards
+   */
+  int (*register_scheduling_hints)(MPIDYNRES_manager manager,
+                                   int src_process_id,
+                                   MPI_Info scheduling_hints,
+                                   MPI_Info *o_answer);
+  int (*get_initial_pset)(MPIDYNRES_manager manager,
+                          set_int *o_initial_pset);
+  int (*handle_rc_msg)(MPIDYNRES_manager manager, int src_process_id,
+                       MPI_Info *o_rc_info, MPIDYNRES_RC_type *o_rc_type,
+                       set_int *o_new_pset);
+  /*
+   * Optional, called on the manager of the first waiting job to decide
+   * whether a job behind it that fits into the free crs may start first.
+   * Without it, jobs are started strictly first come first served.
+   */
+  bool (*may_backfill)(MPIDYNRES_manager manager,
+                       MPIDYNRES_scheduler *candidate);
+  /*
+   * Optional, called when a timer of the manager set with
+   * MPIDYNRES_scheduler_add_timer expires. The manager can prepare the answer
+   * to the next rc request with MPIDYNRES_scheduler_stage_rc. Timers expire
+   * at their deadline, or right after the request that is being handled at
+   * that time.
+   */
+  int (*handle_timer)(MPIDYNRES_manager manager, int timer_id);
+};
+
+/**
+ * @brief      A manager object, implementations embed this struct as their
+ * first member
+ */
+struct MPIDYNRES_manager_base {
+  MPIDYNRES_manager_ops const *ops;  ///< set by MPIDYNRES_manager_init
+};
+
+/*
+ * Create the manager selected by the manager_name key of the manager config
+ */
 MPIDYNRES_manager MPIDYNRES_manager_init(MPIDYNRES_scheduler *scheduler);
 
 int MPIDYNRES_manager_free(MPIDYNRES_manager manager);
@@ -34,4 +125,46 @@ int MPIDYNRES_manager_handle_rc_msg(MPIDYNRES_manager manager,
                                     MPIDYNRES_RC_type *o_rc_type,
                                     set_int *o_new_pset);
 
+bool MPIDYNRES_manager_may_backfill(MPIDYNRES_manager manager,
+                                    MPIDYNRES_scheduler *candidate);
+
+int MPIDYNRES_manager_handle_timer(MPIDYNRES_manager manager, int timer_id);
+
+/*
+ * Registry
+ */
+int MPIDYNRES_manager_register(MPIDYNRES_manager_ops const *ops);
+
+MPIDYNRES_manager_ops const *MPIDYNRES_manager_find(char const *name);
+
+/*
+ * Helpers for implementations
+ */
+bool MPIDYNRES_manager_config_get(MPIDYNRES_scheduler *scheduler,
+                                  char const *key,
+                                  char value[MPI_MAX_INFO_VAL]);
+
+int MPIDYNRES_manager_initial_number(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_manager_pick_crs(MPIDYNRES_scheduler *scheduler, int count,
+                                bool free_ones, set_int *o_pset);
+
+/*
+ * Implementations
+ */
+extern MPIDYNRES_manager_ops const MPIDYNRES_random_diff_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_inc_dec_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_scaling_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_sla_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_backfill_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_replay_manager_ops;
+extern MPIDYNRES_manager_ops const MPIDYNRES_timed_manager_ops;
+
+/*
+ * Runs the manager created with inner_ops on its own thread (manager_async)
+ */
+MPIDYNRES_manager MPIDYNRES_async_manager_create(
+    MPIDYNRES_scheduler *scheduler, MPIDYNRES_manager_ops const *inner_ops);
+MPIDYNRES_manager MPIDYNRES_async_manager_inner(MPIDYNRES_manager manager);
+
 #endif
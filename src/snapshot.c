@@ -0,0 +1,257 @@
+#include "snapshot.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "call_trace.h"
+#include "comm.h"
+#include "logging.h"
+#include "util.h"
+
+char const *g_snapshot_path = NULL;
+
+static volatile sig_atomic_t g_snapshot_requested = 0;
+static double g_snapshot_interval = 0.0;  // <= 0: only on signal
+static double g_snapshot_last = 0.0;      // MPI_Wtime of the last snapshot
+static struct sigaction g_snapshot_old_action;
+
+static char const *const rc_type_names[] = {
+    [MPIDYNRES_RC_NONE] = "none",
+    [MPIDYNRES_RC_ADD] = "add",
+    [MPIDYNRES_RC_SUB] = "sub",
+};
+
+static void snapshot_signal_handler(int signum) {
+  (void)signum;
+  g_snapshot_requested = 1;
+}
+
+/**
+ * @brief      Write a string as JSON string
+ *
+ * @param      f The file
+ *
+ * @param      s The string
+ */
+static void write_json_string(FILE *f, char const *s) {
+  fputc('"', f);
+  for (; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\') {
+      fprintf(f, "\\%c", *s);
+    } else if ((unsigned char)*s < 0x20) {
+      fprintf(f, "\\u%04x", (unsigned char)*s);
+    } else {
+      fputc(*s, f);
+    }
+  }
+  fputc('"', f);
+}
+
+/**
+ * @brief      Write a set of cr ids as JSON array
+ *
+ * @param      f The file
+ *
+ * @param      set The set
+ */
+static void write_json_crs(FILE *f, set_int *set) {
+  char const *sep = "";
+  fputc('[', f);
+  foreach (set_int, set, it) {
+    fprintf(f, "%s%d", sep, *it.ref);
+    sep = ", ";
+  }
+  fputc(']', f);
+}
+
+/**
+ * @brief      Enable snapshots if SNAPSHOT_ENVVAR is set
+ *
+ * @details    Installs the SIGUSR1 handler, has to be called by the scheduler
+ * before its loop starts
+ */
+void MPIDYNRES_snapshot_init(void) {
+  struct sigaction action = {0};
+  char const *interval = getenv(SNAPSHOT_INTERVAL_ENVVAR);
+
+  g_snapshot_path = getenv(SNAPSHOT_ENVVAR);
+  if (g_snapshot_path == NULL) {
+    return;
+  }
+  g_snapshot_requested = 0;
+  g_snapshot_interval = interval != NULL ? atof(interval) : 0.0;
+  g_snapshot_last = MPI_Wtime();
+
+  action.sa_handler = snapshot_signal_handler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (sigaction(SIGUSR1, &action, &g_snapshot_old_action) != 0) {
+    die("Failed to install the SIGUSR1 handler: %s\n", strerror(errno));
+  }
+  log_info("Writing snapshots to %s on SIGUSR1\n", g_snapshot_path);
+}
+
+/**
+ * @brief      Disable snapshots and restore the previous SIGUSR1 handler
+ */
+void MPIDYNRES_snapshot_free(void) {
+  if (g_snapshot_path == NULL) {
+    return;
+  }
+  sigaction(SIGUSR1, &g_snapshot_old_action, NULL);
+  g_snapshot_path = NULL;
+}
+
+/**
+ * @brief      Write a snapshot if one was requested or the interval elapsed
+ *
+ * @details    Called by the scheduler loop between requests
+ *
+ * @param      scheduler The scheduler of any job
+ */
+void MPIDYNRES_snapshot_poll(MPIDYNRES_scheduler *scheduler) {
+  char tmp_path[0x1000];
+  double now;
+
+  if (!snapshot_enabled()) {
+    return;
+  }
+  now = MPI_Wtime();
+  if (!g_snapshot_requested &&
+      !(g_snapshot_interval > 0.0 &&
+        now - g_snapshot_last >= g_snapshot_interval)) {
+    return;
+  }
+  g_snapshot_requested = 0;
+  g_snapshot_last = now;
+
+  // write to a temporary file next to it and rename it over the old snapshot
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", g_snapshot_path);
+  FILE *f = fopen(tmp_path, "w");
+  if (f == NULL) {
+    log_warn("Warning: Could not open snapshot file %s: %s\n", tmp_path,
+             strerror(errno));
+    return;
+  }
+  MPIDYNRES_snapshot_write(scheduler, f);
+  fclose(f);
+  if (rename(tmp_path, g_snapshot_path) != 0) {
+    log_warn("Warning: Could not rename snapshot to %s: %s\n", g_snapshot_path,
+             strerror(errno));
+  }
+}
+
+/**
+ * @brief      Write the state of the scheduler and all jobs as JSON
+ *
+ * @details    Contains the running crs, pending shutdowns, process sets and
+ * outstanding resource changes of every job, the requests that wait to be
+ * handled per tag (at most one per cr, as the protocol is request/response)
+ * and the counters of the metrics (see MPIDYNRES_scheduler_get_stats)
+ *
+ * @param      scheduler The scheduler of any job
+ *
+ * @param      f The file to write to
+ */
+void MPIDYNRES_snapshot_write(MPIDYNRES_scheduler *scheduler, FILE *f) {
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_metrics *metrics = &pool->metrics;
+  int waiting[MPIDYNRES_NUM_TAGS] = {0};
+  char const *sep;
+
+  // requests that arrived but were not handled yet
+  for (int cr = 1; cr <= pool->num_scheduling_processes; cr++) {
+    MPIDYNRES_transport_status status;
+    int flag = 0;
+    if (MPIDYNRES_transport_iprobe(scheduler->transport, cr, MPIDYNRES_ANY_TAG,
+                                   &flag, &status) == 0 &&
+        flag) {
+      int i = status.tag - MPIDYNRES_TAG_IDLE_COMMAND;
+      if (i >= 0 && i < MPIDYNRES_NUM_TAGS) {
+        waiting[i]++;
+      }
+    }
+  }
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"time_s\": %f,\n", MPI_Wtime() - pool->start_time);
+  fprintf(f, "  \"num_crs\": %d,\n", pool->num_scheduling_processes);
+  fprintf(f, "  \"num_running\": %d,\n", pool->num_running);
+
+  fprintf(f, "  \"waiting_requests\": {");
+  sep = "";
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    if (waiting[i] > 0) {
+      fprintf(f, "%s\"%s\": %d", sep,
+              MPIDYNRES_tag_name(i + MPIDYNRES_TAG_IDLE_COMMAND), waiting[i]);
+      sep = ", ";
+    }
+  }
+  fprintf(f, "},\n");
+
+  fprintf(f, "  \"handled_requests\": {");
+  sep = "";
+  for (int i = 0; i < MPIDYNRES_NUM_TAGS; i++) {
+    if (metrics->requests[i].count > 0) {
+      fprintf(f, "%s\"%s\": %lu", sep,
+              MPIDYNRES_tag_name(i + MPIDYNRES_TAG_IDLE_COMMAND),
+              (unsigned long)metrics->requests[i].count);
+      sep = ", ";
+    }
+  }
+  fprintf(f, "},\n");
+  fprintf(f,
+          "  \"rc_decisions\": {\"none\": %lu, \"add\": %lu, \"sub\": %lu},\n",
+          (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_NONE],
+          (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_ADD],
+          (unsigned long)metrics->rc_decisions[MPIDYNRES_RC_SUB]);
+  fprintf(f, "  \"rc_accepted\": %lu,\n",
+          (unsigned long)metrics->rc_accept.count);
+  fprintf(f, "  \"bytes_in\": %zu,\n", scheduler->transport->bytes_received);
+  fprintf(f, "  \"bytes_out\": %zu,\n", scheduler->transport->bytes_sent);
+
+  fprintf(f, "  \"jobs\": [\n");
+  for (int j = 0; j < pool->num_jobs; j++) {
+    MPIDYNRES_scheduler *job = pool->jobs[j];
+    fprintf(f, "    {\"id\": %d, \"started\": %s, \"finished\": %s,\n", j,
+            job->job_stats.start_time >= 0.0 ? "true" : "false",
+            job->job_stats.end_time >= 0.0 ? "true" : "false");
+    fprintf(f, "     \"running_crs\": ");
+    write_json_crs(f, &job->running_crs);
+    fprintf(f, ",\n     \"pending_shutdowns\": ");
+    write_json_crs(f, &job->pending_shutdowns);
+    fprintf(f, ",\n     \"shutting_down_crs\": ");
+    write_json_crs(f, &job->shutting_down_crs);
+    fprintf(f, ",\n     \"pending_resource_change\": %s,\n",
+            job->pending_resource_change ? "true" : "false");
+
+    fprintf(f, "     \"psets\": [");
+    sep = "";
+    foreach (set_pset_node, &job->pset_name_map, it) {
+      fprintf(f, "%s{\"name\": ", sep);
+      write_json_string(f, it.ref->pset_name);
+      fprintf(f, ", \"size\": %zu}", (size_t)it.ref->pset.size);
+      sep = ", ";
+    }
+    fprintf(f, "],\n");
+
+    fprintf(f, "     \"outstanding_rcs\": [");
+    sep = "";
+    foreach (set_rc_info, &job->rc_map, it) {
+      fprintf(f, "%s{\"tag\": %d, \"type\": \"%s\", \"pset\": ", sep,
+              it.ref->rc_tag, rc_type_names[it.ref->rc_type]);
+      write_json_string(f, it.ref->new_pset_name);
+      fprintf(f, ", \"crs\": ");
+      write_json_crs(f, &it.ref->pset);
+      fprintf(f, ", \"age_s\": %f}",
+              (MPIDYNRES_now_ns() - it.ref->answer_ns) / 1e9);
+      sep = ", ";
+    }
+    fprintf(f, "]}%s\n", j + 1 < pool->num_jobs ? "," : "");
+  }
+  fprintf(f, "  ]\n");
+  fprintf(f, "}\n");
+}
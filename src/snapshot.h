@@ -0,0 +1,40 @@
+#ifndef MPIDYNRES_SNAPSHOT_H
+#define MPIDYNRES_SNAPSHOT_H
+/*
+ * Snapshots of the scheduler state while a simulation runs
+ *
+ * When MPIDYNRES_SNAPSHOT names a file, the scheduler writes its state as
+ * JSON to it whenever it receives SIGUSR1 and, if MPIDYNRES_SNAPSHOT_INTERVAL
+ * is set, every that many seconds. The signal handler only sets a flag, the
+ * snapshot is written by the scheduler loop before it handles the next
+ * request, so it never sees a half handled request. The file is replaced
+ * atomically, readers always see a complete snapshot.
+ *
+ * While snapshots are enabled, the scheduler polls for requests instead of
+ * blocking in the transport, so that it notices the signal.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define SNAPSHOT_ENVVAR "MPIDYNRES_SNAPSHOT"
+#define SNAPSHOT_INTERVAL_ENVVAR "MPIDYNRES_SNAPSHOT_INTERVAL"
+
+/*
+ * Path of the snapshot file, NULL if snapshots are disabled
+ */
+extern char const *g_snapshot_path;
+
+static inline bool snapshot_enabled(void) { return g_snapshot_path != NULL; }
+
+#include "scheduler.h"
+
+void MPIDYNRES_snapshot_init(void);
+
+void MPIDYNRES_snapshot_free(void);
+
+void MPIDYNRES_snapshot_poll(MPIDYNRES_scheduler *scheduler);
+
+void MPIDYNRES_snapshot_write(MPIDYNRES_scheduler *scheduler, FILE *f);
+
+#endif
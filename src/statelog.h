@@ -0,0 +1,100 @@
+/*
+ * Format of the binary state log written when MPIDYNRES_STATELOG is set
+ *
+ * The log starts with a statelog_header, followed by one statelog_record per
+ * state change of a cr, in native byte order. The state changes made for the
+ * same event (e.g. all crs of a proposed resource change) share the
+ * event_seq. tools/mpidynres_statelog.c renders a log as the colored text
+ * view, CSV or a timeline.
+ */
+#ifndef MPIDYNRES_STATELOG_H
+#define MPIDYNRES_STATELOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STATELOG_MAGIC "MDRSTLOG"
+#define STATELOG_VERSION 1
+
+enum cr_state {
+  idle,
+  running,
+  reserved,
+  proposed_shutdown,
+  accepted_shutdown,
+
+  NUM_CR_STATES
+};
+
+/*
+ * Why the state of crs changed
+ */
+enum statelog_event {
+  STATELOG_CR_STARTED,
+  STATELOG_CR_EXITED,
+  STATELOG_PROPOSE_START,
+  STATELOG_PROPOSE_SHUTDOWN,
+  STATELOG_ACCEPT_SHUTDOWN,
+
+  NUM_STATELOG_EVENTS
+};
+
+/**
+ * @brief      The start of a state log
+ */
+struct statelog_header {
+  char magic[8];     ///< STATELOG_MAGIC, not null terminated
+  uint32_t version;  ///< STATELOG_VERSION
+  uint32_t num_crs;  ///< the cr ids are 1 to num_crs
+};
+typedef struct statelog_header statelog_header;
+
+/**
+ * @brief      A state change of a cr
+ */
+struct statelog_record {
+  uint64_t time_ns;    ///< monotonic time since the log was opened
+  uint32_t event_seq;  ///< number of the event, starting at 1
+  int32_t cr_id;
+  uint8_t old_state;   ///< enum cr_state
+  uint8_t new_state;   ///< enum cr_state
+  uint16_t event;      ///< enum statelog_event
+  int32_t job_id;      ///< the job the cr belongs to
+};
+typedef struct statelog_record statelog_record;
+
+/**
+ * @brief      Read and check the header of a state log
+ *
+ * @param      f The log
+ *
+ * @param      o_header The header is returned here
+ *
+ * @return     false if f does not start with a valid header
+ */
+static inline bool statelog_read_header(FILE *f, statelog_header *o_header) {
+  return fread(o_header, sizeof(*o_header), 1, f) == 1 &&
+         memcmp(o_header->magic, STATELOG_MAGIC, sizeof(o_header->magic)) ==
+             0 &&
+         o_header->version == STATELOG_VERSION;
+}
+
+/**
+ * @brief      Read the next record of a state log
+ *
+ * @param      f The log, positioned after the header
+ *
+ * @param      o_record The record is returned here
+ *
+ * @return     false at the end of the log (or if a record is invalid)
+ */
+static inline bool statelog_read_record(FILE *f, statelog_record *o_record) {
+  return fread(o_record, sizeof(*o_record), 1, f) == 1 &&
+         o_record->old_state < NUM_CR_STATES &&
+         o_record->new_state < NUM_CR_STATES &&
+         o_record->event < NUM_STATELOG_EVENTS;
+}
+
+#endif
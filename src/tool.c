@@ -0,0 +1,180 @@
+#include "tool.h"
+
+#include <stddef.h>
+
+#include "util.h"
+
+/**
+ * @brief      A registered callback, callback is NULL for free slots
+ */
+struct tool_slot {
+  MPIDYNRES_tool_event_type type;
+  MPIDYNRES_tool_callback *callback;
+  void *user_data;
+};
+typedef struct tool_slot tool_slot;
+
+uint32_t g_tool_mask = 0;
+
+static tool_slot g_tool_slots[MPIDYNRES_TOOL_MAX_CALLBACKS];
+static int g_tool_cr = -1;   // cr of this process, for client events
+static int g_tool_job = -1;  // job this process is running, for client events
+
+static char const *const event_names[MPIDYNRES_TOOL_NUM_EVENTS] = {
+    [MPIDYNRES_TOOL_SESSION_INIT] = "session_init",
+    [MPIDYNRES_TOOL_SESSION_FINALIZE] = "session_finalize",
+    [MPIDYNRES_TOOL_RC_PROPOSED] = "rc_proposed",
+    [MPIDYNRES_TOOL_RC_ACCEPTED] = "rc_accepted",
+    [MPIDYNRES_TOOL_CR_STARTED] = "cr_started",
+    [MPIDYNRES_TOOL_CR_EXITED] = "cr_exited",
+    [MPIDYNRES_TOOL_PSET_CREATED] = "pset_created",
+    [MPIDYNRES_TOOL_PSET_FREED] = "pset_freed",
+};
+
+/**
+ * @brief      Recompute which event types have callbacks
+ */
+static void tool_update_mask(void) {
+  uint32_t mask = 0;
+  for (int i = 0; i < MPIDYNRES_TOOL_MAX_CALLBACKS; i++) {
+    if (g_tool_slots[i].callback != NULL) {
+      mask |= UINT32_C(1) << g_tool_slots[i].type;
+    }
+  }
+  g_tool_mask = mask;
+}
+
+/**
+ * @brief      Register a callback for an event type
+ *
+ * @param      type The event type
+ *
+ * @param      callback The callback, called with the event and user_data
+ *
+ * @param      user_data Passed to the callback
+ *
+ * @param      o_handle The handle for MPIDYNRES_tool_unregister is returned
+ * here
+ *
+ * @return     if != 0, an error occured (invalid type or no free slot)
+ */
+int MPIDYNRES_tool_register(MPIDYNRES_tool_event_type type,
+                            MPIDYNRES_tool_callback *callback, void *user_data,
+                            int *o_handle) {
+  if ((int)type < 0 || type >= MPIDYNRES_TOOL_NUM_EVENTS || callback == NULL) {
+    return 1;
+  }
+  for (int i = 0; i < MPIDYNRES_TOOL_MAX_CALLBACKS; i++) {
+    if (g_tool_slots[i].callback == NULL) {
+      g_tool_slots[i] = (tool_slot){
+          .type = type,
+          .callback = callback,
+          .user_data = user_data,
+      };
+      tool_update_mask();
+      *o_handle = i;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * @brief      Unregister a callback
+ *
+ * @param      handle The handle returned by MPIDYNRES_tool_register
+ *
+ * @return     if != 0, the handle was invalid
+ */
+int MPIDYNRES_tool_unregister(int handle) {
+  if (handle < 0 || handle >= MPIDYNRES_TOOL_MAX_CALLBACKS ||
+      g_tool_slots[handle].callback == NULL) {
+    return 1;
+  }
+  g_tool_slots[handle].callback = NULL;
+  tool_update_mask();
+  return 0;
+}
+
+/**
+ * @brief      Get the name of an event type
+ *
+ * @param      type The event type
+ *
+ * @return     The name, "unknown" for invalid types
+ */
+char const *MPIDYNRES_tool_event_name(MPIDYNRES_tool_event_type type) {
+  if ((int)type < 0 || type >= MPIDYNRES_TOOL_NUM_EVENTS) {
+    return "unknown";
+  }
+  return event_names[type];
+}
+
+/**
+ * @brief      Set the cr and job the client events of this process are about
+ *
+ * @param      cr_id The cr of this process
+ *
+ * @param      job_id The job this process is running
+ */
+void tool_set_cr(int cr_id, int job_id) {
+  g_tool_cr = cr_id;
+  g_tool_job = job_id;
+}
+
+/**
+ * @brief      Create an event fired by a simulated process
+ *
+ * @param      type The event type
+ *
+ * @return     The event with the cr and job of this process
+ */
+MPIDYNRES_tool_event tool_client_event(MPIDYNRES_tool_event_type type) {
+  return (MPIDYNRES_tool_event){
+      .type = type,
+      .in_scheduler = 0,
+      .job_id = g_tool_job,
+      .cr_id = g_tool_cr,
+      .session_id = -1,
+      .rc_tag = -1,
+      .rc_type = -1,
+      .pset_name = NULL,
+      .pset_size = -1,
+  };
+}
+
+/**
+ * @brief      Create an event fired by the scheduler
+ *
+ * @param      type The event type
+ *
+ * @param      job_id The job of the event
+ *
+ * @param      cr_id The cr the event is about
+ *
+ * @return     The event
+ */
+MPIDYNRES_tool_event tool_scheduler_event(MPIDYNRES_tool_event_type type,
+                                          int job_id, int cr_id) {
+  MPIDYNRES_tool_event event = tool_client_event(type);
+  event.in_scheduler = 1;
+  event.job_id = job_id;
+  event.cr_id = cr_id;
+  return event;
+}
+
+/**
+ * @brief      Call the callbacks registered for an event
+ *
+ * @param      event The event, its time is set here
+ */
+void tool_fire(MPIDYNRES_tool_event *event) {
+  event->time_ns = MPIDYNRES_now_ns();
+  for (int i = 0; i < MPIDYNRES_TOOL_MAX_CALLBACKS; i++) {
+    // read the slot before the call, the callback may unregister itself
+    tool_slot slot = g_tool_slots[i];
+    if (slot.callback != NULL && slot.type == event->type) {
+      slot.callback(event, slot.user_data);
+    }
+  }
+}
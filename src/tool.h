@@ -0,0 +1,30 @@
+/*
+ * Firing of the events of the tools interface (see mpidynres_tool.h)
+ *
+ * The call sites check tool_wants first, so an event costs a load and a test
+ * when no tool is registered for it.
+ */
+#ifndef MPIDYNRES_INTERNAL_TOOL_H
+#define MPIDYNRES_INTERNAL_TOOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mpidynres_tool.h"
+
+/*
+ * Bit i is set if a callback is registered for event type i
+ */
+extern uint32_t g_tool_mask;
+
+static inline bool tool_wants(MPIDYNRES_tool_event_type type) {
+  return g_tool_mask & (UINT32_C(1) << type);
+}
+
+void tool_set_cr(int cr_id, int job_id);
+MPIDYNRES_tool_event tool_client_event(MPIDYNRES_tool_event_type type);
+MPIDYNRES_tool_event tool_scheduler_event(MPIDYNRES_tool_event_type type,
+                                          int job_id, int cr_id);
+void tool_fire(MPIDYNRES_tool_event *event);
+
+#endif
@@ -0,0 +1,262 @@
+#include "trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util.h"
+
+/**
+ * Globals
+ */
+int g_trace_fd = -1;
+
+#define TRACE_BUFFER_SIZE 0x10000
+
+static char g_trace_buf[TRACE_BUFFER_SIZE];
+static size_t g_trace_len = 0;
+static int g_trace_cr = 0;
+static int g_trace_job = 0;
+
+/*
+ * The current state of every cr and since when it is in it, only kept by the
+ * scheduler
+ */
+static int g_trace_num_crs = 0;
+static enum cr_state *g_trace_states = NULL;
+static uint64_t *g_trace_since = NULL;
+static int *g_trace_jobs = NULL;
+
+static char const *const state_names[NUM_CR_STATES] = {
+    [idle] = "idle",
+    [running] = "running",
+    [reserved] = "reserved",
+    [proposed_shutdown] = "proposed_shutdown",
+    [accepted_shutdown] = "accepted_shutdown",
+};
+
+/**
+ * @brief      Write the buffered events to the trace
+ *
+ * @details    The buffer only holds whole lines, so one write keeps the lines
+ * of this rank together
+ */
+static void trace_flush(void) {
+  size_t written = 0;
+
+  while (g_trace_fd != -1 && written < g_trace_len) {
+    ssize_t res =
+        write(g_trace_fd, g_trace_buf + written, g_trace_len - written);
+    if (res < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    written += res;
+  }
+  g_trace_len = 0;
+}
+
+/**
+ * @brief      Add a line to the trace buffer
+ *
+ * @param      fmt A format string
+ */
+__attribute__((format(printf, 1, 2))) static void trace_printf(
+    char const *fmt, ...) {
+  va_list args;
+  int n;
+
+  for (int attempt = 0; attempt < 2; attempt++) {
+    va_start(args, fmt);
+    n = vsnprintf(g_trace_buf + g_trace_len, sizeof(g_trace_buf) - g_trace_len,
+                  fmt, args);
+    va_end(args);
+    if (n >= 0 && (size_t)n < sizeof(g_trace_buf) - g_trace_len) {
+      g_trace_len += n;
+      return;
+    }
+    trace_flush();
+  }
+}
+
+/**
+ * @brief      Add the name of a track to the trace
+ *
+ * @param      kind process_name or thread_name
+ *
+ * @param      pid The process of the track
+ *
+ * @param      tid The thread of the track
+ *
+ * @param      name The name
+ */
+static void trace_name(char const *kind, int pid, int tid, char const *name) {
+  trace_printf(
+      "{\"name\":\"%s\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+      "\"args\":{\"name\":\"%s\"}},\n",
+      kind, pid, tid, name);
+}
+
+/**
+ * @brief      Get the time stamp for trace events
+ *
+ * @return     CLOCK_MONOTONIC in nanoseconds
+ */
+uint64_t trace_now(void) { return MPIDYNRES_now_ns(); }
+
+/**
+ * @brief      Open the trace if TRACE_ENVVAR is set
+ *
+ * @details    The scheduler (cr_id 0) creates the trace and names the tracks,
+ * the other ranks append to it. Must be called by the scheduler before any
+ * cr is started.
+ *
+ * @param      cr_id The cr id of this rank, 0 for the scheduler
+ *
+ * @param      num_crs The number of crs (only used by the scheduler)
+ */
+void trace_open(int cr_id, int num_crs) {
+  static bool registered = false;
+  char *path = getenv(TRACE_ENVVAR);
+  char name[32];
+
+  if (path == NULL || g_trace_fd != -1) {
+    return;
+  }
+  g_trace_fd = open(path,
+                    O_WRONLY | O_CREAT | O_APPEND | (cr_id == 0 ? O_TRUNC : 0),
+                    0644);
+  if (g_trace_fd == -1) {
+    die("Failed to open trace %s: %s\n", path, strerror(errno));
+  }
+  g_trace_cr = cr_id;
+  if (!registered) {
+    atexit(trace_flush);
+    registered = true;
+  }
+  if (cr_id != 0) {
+    return;
+  }
+
+  g_trace_num_crs = num_crs;
+  g_trace_states = calloc(num_crs + 1, sizeof(enum cr_state));
+  g_trace_since = calloc(num_crs + 1, sizeof(uint64_t));
+  g_trace_jobs = calloc(num_crs + 1, sizeof(int));
+  if (g_trace_states == NULL || g_trace_since == NULL ||
+      g_trace_jobs == NULL) {
+    die("Memory Error\n");
+  }
+
+  trace_printf("[\n");
+  trace_name("process_name", TRACE_PID_SCHEDULER, 0, "scheduler");
+  trace_name("thread_name", TRACE_PID_SCHEDULER, 0, "handlers");
+  for (int cr = 1; cr <= num_crs; cr++) {
+    snprintf(name, sizeof(name), "cr %d", cr);
+    trace_name("process_name", cr, TRACE_TID_STATE, name);
+    trace_name("thread_name", cr, TRACE_TID_STATE, "state");
+    trace_name("thread_name", cr, TRACE_TID_CALLS, "calls");
+  }
+  // the header has to be in the file before any cr can append to it
+  trace_flush();
+}
+
+/**
+ * @brief      Close the trace
+ *
+ * @details    States that did not end yet end now
+ */
+void trace_close(void) {
+  if (g_trace_fd == -1) {
+    return;
+  }
+  for (int cr = 1; cr <= g_trace_num_crs; cr++) {
+    trace_cr_state(g_trace_jobs[cr], cr, idle);
+  }
+  trace_flush();
+  close(g_trace_fd);
+  g_trace_fd = -1;
+  g_trace_num_crs = 0;
+  free(g_trace_states);
+  free(g_trace_since);
+  free(g_trace_jobs);
+  g_trace_states = NULL;
+  g_trace_since = NULL;
+  g_trace_jobs = NULL;
+}
+
+/**
+ * @brief      Set the job this rank runs for, it is added to the calls
+ *
+ * @param      job_id The job id
+ */
+void trace_set_job(int job_id) { g_trace_job = job_id; }
+
+/**
+ * @brief      Add a span that ends now to the trace
+ *
+ * @param      pid The process of the track
+ *
+ * @param      tid The thread of the track
+ *
+ * @param      name The name of the span
+ *
+ * @param      start_ns When the span started (see trace_now)
+ *
+ * @param      job_id The job of the span
+ *
+ * @param      cr_id The cr of the span
+ */
+void trace_span(int pid, int tid, char const *name, uint64_t start_ns,
+                int job_id, int cr_id) {
+  if (g_trace_fd == -1) {
+    return;
+  }
+  uint64_t now = trace_now();
+  trace_printf(
+      "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+      "\"dur\":%.3f,\"args\":{\"job\":%d,\"cr\":%d}},\n",
+      name, pid, tid, start_ns / 1e3, (now - start_ns) / 1e3, job_id, cr_id);
+}
+
+/**
+ * @brief      Record the state change of a cr
+ *
+ * @details    The previous state becomes a span, unless it was idle
+ *
+ * @param      job_id The job the cr belongs to
+ *
+ * @param      cr_id The cr
+ *
+ * @param      state The new state
+ */
+void trace_cr_state(int job_id, int cr_id, enum cr_state state) {
+  if (g_trace_states == NULL || cr_id < 1 || cr_id > g_trace_num_crs) {
+    return;
+  }
+  if (g_trace_states[cr_id] != idle) {
+    trace_span(cr_id, TRACE_TID_STATE, state_names[g_trace_states[cr_id]],
+               g_trace_since[cr_id], g_trace_jobs[cr_id], cr_id);
+  }
+  g_trace_states[cr_id] = state;
+  g_trace_since[cr_id] = trace_now();
+  g_trace_jobs[cr_id] = job_id;
+}
+
+/**
+ * @brief      End a span started with TRACE_CALL
+ *
+ * @param      call The call
+ */
+void trace_call_end(trace_call *call) {
+  if (g_trace_fd == -1) {
+    return;
+  }
+  trace_span(g_trace_cr, TRACE_TID_CALLS, call->name, call->start_ns,
+             g_trace_job, g_trace_cr);
+}
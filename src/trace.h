@@ -0,0 +1,71 @@
+/*
+ * Export of a trace in the Chrome trace event format
+ *
+ * When the env var MPIDYNRES_TRACE is set, all ranks append complete ("X")
+ * events to the file it names, which can be opened in chrome://tracing or
+ * https://ui.perfetto.dev. The scheduler truncates the file and writes the
+ * opening bracket and the track names when it starts, the closing bracket is
+ * left out (which the viewers allow), so the ranks do not have to agree on
+ * who finishes the file.
+ *
+ * Tracks:
+ *  - process 0 ("scheduler"), thread 0: one span per handled request, named
+ *    after its tag, with the sending cr and its job
+ *  - process N ("cr N"), thread TRACE_TID_STATE: the states of cr N other
+ *    than idle
+ *  - process N, thread TRACE_TID_CALLS: the blocking calls of cr N into
+ *    libmpidynres (see TRACE_CALL)
+ *
+ * Every rank buffers its events and writes whole lines with O_APPEND, so the
+ * lines of different ranks do not interleave. The time stamps are taken from
+ * CLOCK_MONOTONIC, which is only comparable between ranks on the same node.
+ */
+#ifndef MPIDYNRES_TRACE_H
+#define MPIDYNRES_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "statelog.h"
+
+#define TRACE_ENVVAR "MPIDYNRES_TRACE"
+
+#define TRACE_PID_SCHEDULER 0
+#define TRACE_TID_STATE 0
+#define TRACE_TID_CALLS 1
+
+/*
+ * File descriptor of the trace, -1 if tracing is disabled
+ */
+extern int g_trace_fd;
+
+static inline bool trace_enabled(void) { return g_trace_fd != -1; }
+
+void trace_open(int cr_id, int num_crs);
+void trace_close(void);
+void trace_set_job(int job_id);
+uint64_t trace_now(void);
+void trace_span(int pid, int tid, char const *name, uint64_t start_ns,
+                int job_id, int cr_id);
+void trace_cr_state(int job_id, int cr_id, enum cr_state state);
+
+/**
+ * @brief      A blocking call of a cr, see TRACE_CALL
+ */
+struct trace_call {
+  char const *name;
+  uint64_t start_ns;
+};
+typedef struct trace_call trace_call;
+
+void trace_call_end(trace_call *call);
+
+/*
+ * Trace the calling function as a span on the calls track of this cr. The
+ * span ends when the function returns, on any path.
+ */
+#define TRACE_CALL()                                                \
+  trace_call trace_call_ __attribute__((cleanup(trace_call_end))) = { \
+      __func__, trace_enabled() ? trace_now() : 0}
+
+#endif
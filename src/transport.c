@@ -0,0 +1,124 @@
+#include "transport.h"
+
+#include <mpi.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging.h"
+#include "util.h"
+
+/**
+ * @brief      Create the transport used for the simulation
+ *
+ * @details    The implementation is chosen by the MPIDYNRES_TRANSPORT env var.
+ * "mpi" (the default) uses point-to-point messages on the base communicator,
+ * "shm" uses shared memory mailboxes for ranks on the scheduler's node. All
+ * ranks of base_comm have to call this function and see the same env var.
+ *
+ * @param      base_comm The communicator containing all computing resources
+ *
+ * @return     The new transport endpoint of the calling rank
+ */
+MPIDYNRES_transport *MPIDYNRES_transport_create(MPI_Comm base_comm) {
+  MPIDYNRES_transport *res;
+  char const *name = getenv(TRANSPORT_ENVVAR);
+
+  if (name == NULL || strcmp(name, "mpi") == 0) {
+    res = MPIDYNRES_transport_mpi_create(base_comm);
+  } else if (strcmp(name, "shm") == 0) {
+    res = MPIDYNRES_transport_shm_create(base_comm);
+  } else {
+    die("Unknown transport %s in " TRANSPORT_ENVVAR "\n", name);
+  }
+  debug("Using transport %s\n", res->name);
+  return res;
+}
+
+/**
+ * @brief      Free a transport endpoint
+ *
+ * @param      transport The transport to free
+ */
+void MPIDYNRES_transport_free(MPIDYNRES_transport *transport) {
+  transport->free(transport);
+}
+
+/**
+ * @brief      Send a message
+ *
+ * @param      transport The transport used
+ *
+ * @param      buf The message content
+ *
+ * @param      size The size of the message in bytes
+ *
+ * @param      dest The rank of the recipient
+ *
+ * @param      tag The tag of the message
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_transport_send(MPIDYNRES_transport *transport, void const *buf,
+                             size_t size, int dest, int tag) {
+  transport->bytes_sent += size;
+  return transport->send(transport, buf, size, dest, tag);
+}
+
+/**
+ * @brief      Receive a message
+ *
+ * @details    Blocks until a matching message arrived. The message must not be
+ * larger than the buffer.
+ *
+ * @param      transport The transport used
+ *
+ * @param      buf The buffer the message is written to
+ *
+ * @param      size The size of the buffer in bytes
+ *
+ * @param      source The rank of the sender or MPIDYNRES_ANY_SOURCE
+ *
+ * @param      tag The tag of the message or MPIDYNRES_ANY_TAG
+ *
+ * @param      status Information about the message is returned here, can be
+ * NULL
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_transport_recv(MPIDYNRES_transport *transport, void *buf,
+                             size_t size, int source, int tag,
+                             MPIDYNRES_transport_status *status) {
+  MPIDYNRES_transport_status tmp;
+  if (status == NULL) {
+    status = &tmp;
+  }
+  int err = transport->recv(transport, buf, size, source, tag, status);
+  if (!err) {
+    transport->bytes_received += status->size;
+  }
+  return err;
+}
+
+/**
+ * @brief      Check whether a matching message can be received without blocking
+ *
+ * @param      transport The transport used
+ *
+ * @param      source The rank of the sender or MPIDYNRES_ANY_SOURCE
+ *
+ * @param      tag The tag of the message or MPIDYNRES_ANY_TAG
+ *
+ * @param      flag Set to true if there is a matching message
+ *
+ * @param      status Information about the message is returned here, can be
+ * NULL
+ *
+ * @return     if != 0, an error occured
+ */
+int MPIDYNRES_transport_iprobe(MPIDYNRES_transport *transport, int source,
+                               int tag, int *flag,
+                               MPIDYNRES_transport_status *status) {
+  MPIDYNRES_transport_status tmp;
+  return transport->iprobe(transport, source, tag, flag,
+                           status == NULL ? &tmp : status);
+}
@@ -0,0 +1,87 @@
+/*
+ * Transport layer used for all messages between the scheduler and the
+ * computing resources
+ *
+ * A transport moves opaque byte messages between the ranks of the base
+ * communicator. Every message carries one of the MPIDYNRES_TAG_* tags from
+ * comm.h. The protocol is strictly request/response, so messages between two
+ * ranks are always received in the order they were sent.
+ */
+#ifndef MPIDYNRES_TRANSPORT_H
+#define MPIDYNRES_TRANSPORT_H
+
+#include <mpi.h>
+#include <stddef.h>
+
+#define MPIDYNRES_ANY_SOURCE (-1)
+#define MPIDYNRES_ANY_TAG (-1)
+
+#define TRANSPORT_ENVVAR "MPIDYNRES_TRANSPORT"
+
+/**
+ * @brief      Information about a received message
+ */
+struct MPIDYNRES_transport_status {
+  int source;   ///< rank of the sender
+  int tag;      ///< tag of the message
+  size_t size;  ///< size of the message in bytes
+};
+typedef struct MPIDYNRES_transport_status MPIDYNRES_transport_status;
+
+struct MPIDYNRES_transport;
+typedef struct MPIDYNRES_transport MPIDYNRES_transport;
+
+/**
+ * @brief      A transport endpoint, implementations embed this struct as their
+ * first member
+ */
+struct MPIDYNRES_transport {
+  char const *name;  ///< name of the implementation
+  int rank;          ///< the rank of this endpoint
+  int size;          ///< the number of endpoints
+  size_t bytes_sent;      ///< counted by MPIDYNRES_transport_send
+  size_t bytes_received;  ///< counted by MPIDYNRES_transport_recv
+
+  int (*send)(MPIDYNRES_transport *transport, void const *buf, size_t size,
+              int dest, int tag);
+  int (*recv)(MPIDYNRES_transport *transport, void *buf, size_t size,
+              int source, int tag, MPIDYNRES_transport_status *status);
+  int (*iprobe)(MPIDYNRES_transport *transport, int source, int tag,
+                int *flag, MPIDYNRES_transport_status *status);
+  void (*free)(MPIDYNRES_transport *transport);
+};
+
+/*
+ * Create the transport selected by the MPIDYNRES_TRANSPORT env var ("mpi" or
+ * "shm"), has to be called by all ranks of base_comm
+ */
+MPIDYNRES_transport *MPIDYNRES_transport_create(MPI_Comm base_comm);
+
+void MPIDYNRES_transport_free(MPIDYNRES_transport *transport);
+
+int MPIDYNRES_transport_send(MPIDYNRES_transport *transport, void const *buf,
+                             size_t size, int dest, int tag);
+
+int MPIDYNRES_transport_recv(MPIDYNRES_transport *transport, void *buf,
+                             size_t size, int source, int tag,
+                             MPIDYNRES_transport_status *status);
+
+int MPIDYNRES_transport_iprobe(MPIDYNRES_transport *transport, int source,
+                               int tag, int *flag,
+                               MPIDYNRES_transport_status *status);
+
+/*
+ * Implementations
+ */
+MPIDYNRES_transport *MPIDYNRES_transport_mpi_create(MPI_Comm base_comm);
+MPIDYNRES_transport *MPIDYNRES_transport_shm_create(MPI_Comm base_comm);
+
+/*
+ * Create size connected in-process endpoints, endpoint i has rank i. No MPI
+ * communication is involved, so the scheduler can be driven by a single
+ * process. The endpoints can be used from different threads.
+ */
+void MPIDYNRES_transport_loopback_create(int size,
+                                         MPIDYNRES_transport *o_endpoints[]);
+
+#endif
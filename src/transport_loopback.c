@@ -0,0 +1,213 @@
+/*
+ * Transport implementation connecting endpoints inside a single process
+ *
+ * All endpoints share a hub with one message queue per endpoint. Sends append
+ * to the queue of the recipient, receives take the first matching message. A
+ * mutex and a condition variable protect the hub, so the endpoints can be
+ * used from different threads.
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "transport.h"
+#include "util.h"
+
+struct loopback_msg {
+  struct loopback_msg *next;
+  int source;
+  int tag;
+  size_t size;
+  unsigned char data[];
+};
+typedef struct loopback_msg loopback_msg;
+
+struct loopback_queue {
+  loopback_msg *head;
+  loopback_msg *tail;
+};
+typedef struct loopback_queue loopback_queue;
+
+struct loopback_hub {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int refcount;
+  int size;
+  loopback_queue queues[];
+};
+typedef struct loopback_hub loopback_hub;
+
+struct transport_loopback {
+  MPIDYNRES_transport base;
+  loopback_hub *hub;
+};
+typedef struct transport_loopback transport_loopback;
+
+/**
+ * @brief      Find the first message in a queue matching source and tag, the
+ * hub has to be locked
+ *
+ * @return     Pointer to the link pointing to the message or NULL
+ */
+static loopback_msg **loopback_find(loopback_queue *queue, int source,
+                                    int tag) {
+  for (loopback_msg **it = &queue->head; *it != NULL; it = &(*it)->next) {
+    if ((source == MPIDYNRES_ANY_SOURCE || (*it)->source == source) &&
+        (tag == MPIDYNRES_ANY_TAG || (*it)->tag == tag)) {
+      return it;
+    }
+  }
+  return NULL;
+}
+
+static int transport_loopback_send(MPIDYNRES_transport *transport,
+                                   void const *buf, size_t size, int dest,
+                                   int tag) {
+  transport_loopback *t = (transport_loopback *)transport;
+  loopback_hub *hub = t->hub;
+
+  if (dest < 0 || dest >= hub->size) {
+    die("Invalid destination rank %d for the loopback transport\n", dest);
+  }
+  loopback_msg *msg = malloc(sizeof(loopback_msg) + size);
+  if (msg == NULL) {
+    die("Memory Error!\n");
+  }
+  msg->next = NULL;
+  msg->source = t->base.rank;
+  msg->tag = tag;
+  msg->size = size;
+  memcpy(msg->data, buf, size);
+
+  pthread_mutex_lock(&hub->lock);
+  loopback_queue *queue = &hub->queues[dest];
+  if (queue->tail == NULL) {
+    queue->head = msg;
+  } else {
+    queue->tail->next = msg;
+  }
+  queue->tail = msg;
+  pthread_cond_broadcast(&hub->cond);
+  pthread_mutex_unlock(&hub->lock);
+  return 0;
+}
+
+static int transport_loopback_recv(MPIDYNRES_transport *transport, void *buf,
+                                   size_t size, int source, int tag,
+                                   MPIDYNRES_transport_status *status) {
+  transport_loopback *t = (transport_loopback *)transport;
+  loopback_hub *hub = t->hub;
+  loopback_queue *queue = &hub->queues[t->base.rank];
+  loopback_msg **link;
+
+  pthread_mutex_lock(&hub->lock);
+  while ((link = loopback_find(queue, source, tag)) == NULL) {
+    pthread_cond_wait(&hub->cond, &hub->lock);
+  }
+  loopback_msg *msg = *link;
+  *link = msg->next;
+  if (queue->tail == msg) {
+    // recompute the tail, the queues are short
+    queue->tail = queue->head;
+    while (queue->tail != NULL && queue->tail->next != NULL) {
+      queue->tail = queue->tail->next;
+    }
+  }
+  pthread_mutex_unlock(&hub->lock);
+
+  if (msg->size > size) {
+    die("Message of %zu bytes does not fit into buffer of %zu bytes\n",
+        msg->size, size);
+  }
+  memcpy(buf, msg->data, msg->size);
+  status->source = msg->source;
+  status->tag = msg->tag;
+  status->size = msg->size;
+  free(msg);
+  return 0;
+}
+
+static int transport_loopback_iprobe(MPIDYNRES_transport *transport,
+                                     int source, int tag, int *flag,
+                                     MPIDYNRES_transport_status *status) {
+  transport_loopback *t = (transport_loopback *)transport;
+  loopback_hub *hub = t->hub;
+  loopback_msg **link;
+
+  pthread_mutex_lock(&hub->lock);
+  link = loopback_find(&hub->queues[t->base.rank], source, tag);
+  *flag = link != NULL;
+  if (*flag) {
+    status->source = (*link)->source;
+    status->tag = (*link)->tag;
+    status->size = (*link)->size;
+  }
+  pthread_mutex_unlock(&hub->lock);
+  return 0;
+}
+
+static void transport_loopback_free(MPIDYNRES_transport *transport) {
+  transport_loopback *t = (transport_loopback *)transport;
+  loopback_hub *hub = t->hub;
+  bool last;
+
+  pthread_mutex_lock(&hub->lock);
+  last = --hub->refcount == 0;
+  pthread_mutex_unlock(&hub->lock);
+
+  if (last) {
+    for (int i = 0; i < hub->size; i++) {
+      loopback_msg *msg = hub->queues[i].head;
+      while (msg != NULL) {
+        loopback_msg *next = msg->next;
+        free(msg);
+        msg = next;
+      }
+    }
+    pthread_cond_destroy(&hub->cond);
+    pthread_mutex_destroy(&hub->lock);
+    free(hub);
+  }
+  free(t);
+}
+
+/**
+ * @brief      Create connected transport endpoints inside this process
+ *
+ * @details    Endpoint i has rank i. The endpoints share a hub that is freed
+ * together with the last endpoint.
+ *
+ * @param      size The number of endpoints to create
+ *
+ * @param      o_endpoints Array of at least size elements that is filled with
+ * the new endpoints
+ */
+void MPIDYNRES_transport_loopback_create(int size,
+                                         MPIDYNRES_transport *o_endpoints[]) {
+  loopback_hub *hub =
+      calloc(1, sizeof(loopback_hub) + size * sizeof(loopback_queue));
+  if (hub == NULL) {
+    die("Memory Error!\n");
+  }
+  pthread_mutex_init(&hub->lock, NULL);
+  pthread_cond_init(&hub->cond, NULL);
+  hub->refcount = size;
+  hub->size = size;
+
+  for (int i = 0; i < size; i++) {
+    transport_loopback *res = calloc(1, sizeof(transport_loopback));
+    if (res == NULL) {
+      die("Memory Error!\n");
+    }
+    res->base.name = "loopback";
+    res->base.rank = i;
+    res->base.size = size;
+    res->base.send = transport_loopback_send;
+    res->base.recv = transport_loopback_recv;
+    res->base.iprobe = transport_loopback_iprobe;
+    res->base.free = transport_loopback_free;
+    res->hub = hub;
+    o_endpoints[i] = &res->base;
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ * Transport implementation using MPI point-to-point messages on the base
+ * communicator
+ */
+#include <limits.h>
+#include <mpi.h>
+#include <stdlib.h>
+
+#include "transport.h"
+#include "util.h"
+
+struct transport_mpi {
+  MPIDYNRES_transport base;
+  MPI_Comm comm;
+};
+typedef struct transport_mpi transport_mpi;
+
+static int transport_mpi_send(MPIDYNRES_transport *transport, void const *buf,
+                              size_t size, int dest, int tag) {
+  transport_mpi *t = (transport_mpi *)transport;
+  if (size > INT_MAX) {
+    die("Message of %zu bytes is too large for the mpi transport\n", size);
+  }
+  return MPI_Send(buf, size, MPI_BYTE, dest, tag, t->comm);
+}
+
+static int transport_mpi_recv(MPIDYNRES_transport *transport, void *buf,
+                              size_t size, int source, int tag,
+                              MPIDYNRES_transport_status *status) {
+  transport_mpi *t = (transport_mpi *)transport;
+  MPI_Status mpi_status;
+  int count;
+  int err;
+
+  if (size > INT_MAX) {
+    size = INT_MAX;
+  }
+  err = MPI_Recv(buf, size, MPI_BYTE,
+                 source == MPIDYNRES_ANY_SOURCE ? MPI_ANY_SOURCE : source,
+                 tag == MPIDYNRES_ANY_TAG ? MPI_ANY_TAG : tag, t->comm,
+                 &mpi_status);
+  if (err) {
+    return err;
+  }
+  MPI_Get_count(&mpi_status, MPI_BYTE, &count);
+  status->source = mpi_status.MPI_SOURCE;
+  status->tag = mpi_status.MPI_TAG;
+  status->size = count;
+  return 0;
+}
+
+static int transport_mpi_iprobe(MPIDYNRES_transport *transport, int source,
+                                int tag, int *flag,
+                                MPIDYNRES_transport_status *status) {
+  transport_mpi *t = (transport_mpi *)transport;
+  MPI_Status mpi_status;
+  int count;
+  int err;
+
+  err = MPI_Iprobe(source == MPIDYNRES_ANY_SOURCE ? MPI_ANY_SOURCE : source,
+                   tag == MPIDYNRES_ANY_TAG ? MPI_ANY_TAG : tag, t->comm, flag,
+                   &mpi_status);
+  if (err || !*flag) {
+    return err;
+  }
+  MPI_Get_count(&mpi_status, MPI_BYTE, &count);
+  status->source = mpi_status.MPI_SOURCE;
+  status->tag = mpi_status.MPI_TAG;
+  status->size = count;
+  return 0;
+}
+
+static void transport_mpi_free(MPIDYNRES_transport *transport) {
+  free(transport);
+}
+
+/**
+ * @brief      Create a transport that sends every message via MPI
+ *
+ * @param      base_comm The communicator used for all messages
+ *
+ * @return     The new transport endpoint
+ */
+MPIDYNRES_transport *MPIDYNRES_transport_mpi_create(MPI_Comm base_comm) {
+  transport_mpi *res = calloc(1, sizeof(transport_mpi));
+  if (res == NULL) {
+    die("Memory Error!\n");
+  }
+  res->base.name = "mpi";
+  MPI_Comm_rank(base_comm, &res->base.rank);
+  MPI_Comm_size(base_comm, &res->base.size);
+  res->base.send = transport_mpi_send;
+  res->base.recv = transport_mpi_recv;
+  res->base.iprobe = transport_mpi_iprobe;
+  res->base.free = transport_mpi_free;
+  res->comm = base_comm;
+  return &res->base;
+}
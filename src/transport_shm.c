@@ -0,0 +1,485 @@
+/*
+ * Transport implementation using shared memory mailboxes for ranks that are
+ * located on the same node as the scheduler
+ *
+ * The scheduler allocates an MPI-3 shared memory window containing one mailbox
+ * per rank of its node. A mailbox consists of two lock-free single producer
+ * single consumer rings, one for each direction. Messages from and to ranks on
+ * other nodes are forwarded to the mpi transport.
+ *
+ * Like with mpi, a receive matches the first message of a source with the
+ * requested tag. Messages with another tag in front of it are moved out of the
+ * ring into a private list ("parked") and are received from there later.
+ */
+#include <limits.h>
+#include <mpi.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging.h"
+#include "transport.h"
+#include "util.h"
+
+#define SHM_RING_SIZE (1 << 16)  // has to be a power of 2
+#define SHM_CACHE_LINE 64
+#define SHM_SPINS_BEFORE_YIELD 1024
+
+struct shm_ring {
+  alignas(SHM_CACHE_LINE) atomic_size_t head;  // only written by the consumer
+  alignas(SHM_CACHE_LINE) atomic_size_t tail;  // only written by the producer
+  alignas(SHM_CACHE_LINE) uint8_t data[SHM_RING_SIZE];
+};
+typedef struct shm_ring shm_ring;
+
+struct shm_mailbox {
+  shm_ring to_scheduler;
+  shm_ring from_scheduler;
+};
+typedef struct shm_mailbox shm_mailbox;
+
+struct shm_msg_header {
+  size_t size;
+  int tag;
+};
+typedef struct shm_msg_header shm_msg_header;
+
+struct shm_parked_msg {
+  shm_msg_header header;
+  struct shm_parked_msg *next;
+  uint8_t data[];
+};
+typedef struct shm_parked_msg shm_parked_msg;
+
+struct transport_shm {
+  MPIDYNRES_transport base;
+  MPIDYNRES_transport *remote;  ///< used for ranks not on the scheduler's node
+  MPI_Comm base_comm;
+  MPI_Comm node_comm;      ///< MPI_COMM_NULL if not on the scheduler's node
+  MPI_Win win;             ///< the window containing the mailboxes
+  shm_mailbox *mailboxes;  ///< one mailbox per rank in node_comm
+  int *slots;              ///< base rank -> mailbox index, -1 if remote
+  int next_poll;           ///< round robin start for any source receives
+  shm_parked_msg **parked;  ///< per base rank, messages taken out of the ring
+                            ///< while looking for another tag, oldest first
+};
+typedef struct transport_shm transport_shm;
+
+/**
+ * @brief      Back off while waiting for the other side of a ring
+ *
+ * @param      spins The number of unsuccessful polls so far
+ */
+static void shm_backoff(unsigned *spins) {
+  if (++(*spins) >= SHM_SPINS_BEFORE_YIELD) {
+    *spins = 0;
+    sched_yield();
+  }
+}
+
+/**
+ * @brief      Number of bytes that can be read from a ring
+ */
+static size_t shm_ring_available(shm_ring *ring) {
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+  size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  return tail - head;
+}
+
+/**
+ * @brief      Write n bytes into a ring, blocks while the ring is full
+ *
+ * @details    Messages larger than the ring are streamed, so the consumer has
+ * to be reading at the same time
+ */
+static void shm_ring_write(shm_ring *ring, void const *src, size_t n) {
+  uint8_t const *p = src;
+  size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  unsigned spins = 0;
+
+  while (n > 0) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t free_bytes = SHM_RING_SIZE - (tail - head);
+    if (free_bytes == 0) {
+      shm_backoff(&spins);
+      continue;
+    }
+    size_t offset = tail & (SHM_RING_SIZE - 1);
+    size_t chunk = n < free_bytes ? n : free_bytes;
+    if (chunk > SHM_RING_SIZE - offset) {
+      chunk = SHM_RING_SIZE - offset;
+    }
+    memcpy(&ring->data[offset], p, chunk);
+    p += chunk;
+    n -= chunk;
+    tail += chunk;
+    atomic_store_explicit(&ring->tail, tail, memory_order_release);
+  }
+}
+
+/**
+ * @brief      Read n bytes from a ring, blocks while the ring is empty
+ */
+static void shm_ring_read(shm_ring *ring, void *dst, size_t n) {
+  uint8_t *p = dst;
+  size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  unsigned spins = 0;
+
+  while (n > 0) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t available = tail - head;
+    if (available == 0) {
+      shm_backoff(&spins);
+      continue;
+    }
+    size_t offset = head & (SHM_RING_SIZE - 1);
+    size_t chunk = n < available ? n : available;
+    if (chunk > SHM_RING_SIZE - offset) {
+      chunk = SHM_RING_SIZE - offset;
+    }
+    memcpy(p, &ring->data[offset], chunk);
+    p += chunk;
+    n -= chunk;
+    head += chunk;
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+  }
+}
+
+/**
+ * @brief      Copy n bytes from the start of a ring without consuming them,
+ * the bytes have to be available
+ */
+static void shm_ring_peek(shm_ring *ring, void *dst, size_t n) {
+  uint8_t *p = dst;
+  size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  for (size_t i = 0; i < n; i++) {
+    p[i] = ring->data[(head + i) & (SHM_RING_SIZE - 1)];
+  }
+}
+
+/**
+ * @brief      Check whether a message fits the requested tag
+ */
+static bool shm_tag_matches(int tag, int msg_tag) {
+  return tag == MPIDYNRES_ANY_TAG || msg_tag == tag;
+}
+
+/**
+ * @brief      Look for the first message from peer with a matching tag
+ *
+ * @details    Parked messages were sent before the ones in the ring, so they
+ * are checked first. Complete messages with another tag at the start of the
+ * ring are parked until a matching header is found or the ring is empty.
+ *
+ * @param      t The transport
+ *
+ * @param      peer The base rank of the other side of the ring
+ *
+ * @param      ring The ring to receive from
+ *
+ * @param      tag The requested tag or MPIDYNRES_ANY_TAG
+ *
+ * @param      o_link If the message is parked, the link pointing to it is
+ * returned here, NULL if it is at the start of the ring
+ *
+ * @param      status The status of the message is returned here
+ *
+ * @return     whether a matching message was found
+ */
+static bool shm_find(transport_shm *t, int peer, shm_ring *ring, int tag,
+                     shm_parked_msg ***o_link,
+                     MPIDYNRES_transport_status *status) {
+  shm_parked_msg **link = &t->parked[peer];
+  shm_msg_header header;
+
+  for (; *link != NULL; link = &(*link)->next) {
+    if (shm_tag_matches(tag, (*link)->header.tag)) {
+      *o_link = link;
+      status->source = peer;
+      status->tag = (*link)->header.tag;
+      status->size = (*link)->header.size;
+      return true;
+    }
+  }
+
+  while (shm_ring_available(ring) >= sizeof(header)) {
+    shm_ring_peek(ring, &header, sizeof(header));
+    if (shm_tag_matches(tag, header.tag)) {
+      *o_link = NULL;
+      status->source = peer;
+      status->tag = header.tag;
+      status->size = header.size;
+      return true;
+    }
+    shm_parked_msg *msg = malloc(sizeof(shm_parked_msg) + header.size);
+    if (msg == NULL) {
+      die("Memory Error!\n");
+    }
+    shm_ring_read(ring, &msg->header, sizeof(header));
+    shm_ring_read(ring, msg->data, header.size);
+    msg->next = NULL;
+    *link = msg;
+    link = &msg->next;
+  }
+  return false;
+}
+
+/**
+ * @brief      Receive a message found by shm_find
+ */
+static void shm_take(int peer, shm_ring *ring, shm_parked_msg **link,
+                     void *buf, size_t size,
+                     MPIDYNRES_transport_status *status) {
+  if (status->size > size) {
+    die("Message of %zu bytes from %d does not fit into %zu bytes\n",
+        status->size, peer, size);
+  }
+  if (link == NULL) {
+    shm_msg_header header;
+    shm_ring_read(ring, &header, sizeof(header));
+    shm_ring_read(ring, buf, header.size);
+    return;
+  }
+  shm_parked_msg *msg = *link;
+  memcpy(buf, msg->data, msg->header.size);
+  *link = msg->next;
+  free(msg);
+}
+
+/**
+ * @brief      Get the ring used for messages between the calling rank and peer
+ *
+ * @return     The ring or NULL if the message has to go through mpi
+ */
+static shm_ring *shm_get_ring(transport_shm *t, int peer, bool sending) {
+  if (t->node_comm == MPI_COMM_NULL) {
+    return NULL;
+  }
+  if (t->base.rank == 0 && peer != 0 && t->slots[peer] != -1) {
+    shm_mailbox *mb = &t->mailboxes[t->slots[peer]];
+    return sending ? &mb->from_scheduler : &mb->to_scheduler;
+  }
+  if (t->base.rank != 0 && peer == 0) {
+    shm_mailbox *mb = &t->mailboxes[t->slots[t->base.rank]];
+    return sending ? &mb->to_scheduler : &mb->from_scheduler;
+  }
+  return NULL;
+}
+
+static int transport_shm_send(MPIDYNRES_transport *transport, void const *buf,
+                              size_t size, int dest, int tag) {
+  transport_shm *t = (transport_shm *)transport;
+  shm_ring *ring = shm_get_ring(t, dest, true);
+
+  if (ring == NULL) {
+    return MPIDYNRES_transport_send(t->remote, buf, size, dest, tag);
+  }
+  shm_msg_header header = {.size = size, .tag = tag};
+  shm_ring_write(ring, &header, sizeof(header));
+  shm_ring_write(ring, buf, size);
+  return 0;
+}
+
+/**
+ * @brief      Receive from any source on the scheduler rank
+ *
+ * @details    Polls all mailboxes round robin and probes the base communicator
+ * for messages of remote ranks. Messages with another tag are parked for a
+ * later receive
+ */
+static int transport_shm_recv_any(transport_shm *t, void *buf, size_t size,
+                                  int tag, MPIDYNRES_transport_status *status) {
+  int node_size;
+  unsigned spins = 0;
+
+  MPI_Comm_size(t->node_comm, &node_size);
+
+  for (;;) {
+    for (int i = 0; i < t->base.size - 1; i++) {
+      int src = 1 + (t->next_poll + i) % (t->base.size - 1);
+      if (t->slots[src] == -1) {
+        continue;
+      }
+      shm_ring *ring = &t->mailboxes[t->slots[src]].to_scheduler;
+      shm_parked_msg **link;
+      if (shm_find(t, src, ring, tag, &link, status)) {
+        t->next_poll = src;  // next poll starts after this source
+        shm_take(src, ring, link, buf, size, status);
+        return 0;
+      }
+    }
+    if (node_size < t->base.size) {
+      int flag;
+      MPI_Status mpi_status;
+      MPI_Iprobe(MPI_ANY_SOURCE, tag == MPIDYNRES_ANY_TAG ? MPI_ANY_TAG : tag,
+                 t->base_comm, &flag, &mpi_status);
+      if (flag) {
+        return MPIDYNRES_transport_recv(t->remote, buf, size,
+                                        mpi_status.MPI_SOURCE,
+                                        mpi_status.MPI_TAG, status);
+      }
+    }
+    shm_backoff(&spins);
+  }
+}
+
+static int transport_shm_recv(MPIDYNRES_transport *transport, void *buf,
+                              size_t size, int source, int tag,
+                              MPIDYNRES_transport_status *status) {
+  transport_shm *t = (transport_shm *)transport;
+  shm_parked_msg **link;
+  unsigned spins = 0;
+
+  if (source == MPIDYNRES_ANY_SOURCE) {
+    if (t->base.rank != 0 || t->node_comm == MPI_COMM_NULL) {
+      return MPIDYNRES_transport_recv(t->remote, buf, size, source, tag,
+                                      status);
+    }
+    return transport_shm_recv_any(t, buf, size, tag, status);
+  }
+
+  shm_ring *ring = shm_get_ring(t, source, false);
+  if (ring == NULL) {
+    return MPIDYNRES_transport_recv(t->remote, buf, size, source, tag, status);
+  }
+  while (!shm_find(t, source, ring, tag, &link, status)) {
+    shm_backoff(&spins);
+  }
+  shm_take(source, ring, link, buf, size, status);
+  return 0;
+}
+
+static int transport_shm_iprobe(MPIDYNRES_transport *transport, int source,
+                                int tag, int *flag,
+                                MPIDYNRES_transport_status *status) {
+  transport_shm *t = (transport_shm *)transport;
+
+  if (source == MPIDYNRES_ANY_SOURCE) {
+    if (t->base.rank == 0 && t->node_comm != MPI_COMM_NULL) {
+      for (int src = 1; src < t->base.size; src++) {
+        if (t->slots[src] == -1) {
+          continue;
+        }
+        shm_parked_msg **link;
+        if (shm_find(t, src, &t->mailboxes[t->slots[src]].to_scheduler, tag,
+                     &link, status)) {
+          *flag = true;
+          return 0;
+        }
+      }
+    }
+    return MPIDYNRES_transport_iprobe(t->remote, source, tag, flag, status);
+  }
+
+  shm_ring *ring = shm_get_ring(t, source, false);
+  if (ring == NULL) {
+    return MPIDYNRES_transport_iprobe(t->remote, source, tag, flag, status);
+  }
+  shm_parked_msg **link;
+  *flag = shm_find(t, source, ring, tag, &link, status);
+  return 0;
+}
+
+static void transport_shm_free(MPIDYNRES_transport *transport) {
+  transport_shm *t = (transport_shm *)transport;
+  if (t->node_comm != MPI_COMM_NULL) {
+    MPI_Win_unlock_all(t->win);
+    MPI_Win_free(&t->win);
+    MPI_Comm_free(&t->node_comm);
+  }
+  MPIDYNRES_transport_free(t->remote);
+  for (int i = 0; i < t->base.size; i++) {
+    while (t->parked[i] != NULL) {
+      shm_parked_msg *next = t->parked[i]->next;
+      free(t->parked[i]);
+      t->parked[i] = next;
+    }
+  }
+  free(t->parked);
+  free(t->slots);
+  free(t);
+}
+
+/**
+ * @brief      Create a transport that uses shared memory mailboxes for ranks
+ * on the scheduler's node
+ *
+ * @details    Has to be called by all ranks of base_comm, the scheduler is
+ * expected to be rank 0
+ *
+ * @param      base_comm The communicator containing all computing resources
+ *
+ * @return     The new transport endpoint
+ */
+MPIDYNRES_transport *MPIDYNRES_transport_shm_create(MPI_Comm base_comm) {
+  int node_rank, node_size;
+  int on_scheduler_node;
+  int my_slot;
+  MPI_Aint win_size;
+  int disp_unit;
+  transport_shm *res = calloc(1, sizeof(transport_shm));
+  if (res == NULL) {
+    die("Memory Error!\n");
+  }
+  res->base.name = "shm";
+  MPI_Comm_rank(base_comm, &res->base.rank);
+  MPI_Comm_size(base_comm, &res->base.size);
+  res->base.send = transport_shm_send;
+  res->base.recv = transport_shm_recv;
+  res->base.iprobe = transport_shm_iprobe;
+  res->base.free = transport_shm_free;
+  res->remote = MPIDYNRES_transport_mpi_create(base_comm);
+  res->base_comm = base_comm;
+  res->next_poll = 0;
+
+  res->slots = calloc(res->base.size, sizeof(int));
+  res->parked = calloc(res->base.size, sizeof(shm_parked_msg *));
+  if (res->slots == NULL || res->parked == NULL) {
+    die("Memory Error!\n");
+  }
+
+  // find out which ranks share the node with the scheduler
+  MPI_Comm_split_type(base_comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                      &res->node_comm);
+  MPI_Comm_rank(res->node_comm, &node_rank);
+  MPI_Comm_size(res->node_comm, &node_size);
+  on_scheduler_node = (res->base.rank == 0);
+  MPI_Allreduce(MPI_IN_PLACE, &on_scheduler_node, 1, MPI_INT, MPI_MAX,
+                res->node_comm);
+  my_slot = on_scheduler_node ? node_rank : -1;
+  MPI_Allgather(&my_slot, 1, MPI_INT, res->slots, 1, MPI_INT, base_comm);
+
+  if (!on_scheduler_node) {
+    MPI_Comm_free(&res->node_comm);
+    res->node_comm = MPI_COMM_NULL;
+    return &res->base;
+  }
+
+  // the scheduler allocates all mailboxes, the others map them
+  win_size = res->base.rank == 0 ? node_size * sizeof(shm_mailbox) : 0;
+  MPI_Win_allocate_shared(win_size, 1, MPI_INFO_NULL, res->node_comm,
+                          &res->mailboxes, &res->win);
+  MPI_Win_shared_query(res->win, res->slots[0], &win_size, &disp_unit,
+                       &res->mailboxes);
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, res->win);
+  if (res->base.rank == 0) {
+    for (int i = 0; i < node_size; i++) {
+      atomic_init(&res->mailboxes[i].to_scheduler.head, 0);
+      atomic_init(&res->mailboxes[i].to_scheduler.tail, 0);
+      atomic_init(&res->mailboxes[i].from_scheduler.head, 0);
+      atomic_init(&res->mailboxes[i].from_scheduler.tail, 0);
+    }
+  }
+  MPI_Win_sync(res->win);
+  MPI_Barrier(res->node_comm);
+  MPI_Win_sync(res->win);
+
+  debug("Shared memory mailboxes for %d of %d ranks\n", node_size,
+        res->base.size);
+  return &res->base;
+}
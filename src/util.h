@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <limits.h>
 #include <signal.h>
+#include <time.h>
 
 // https://stackoverflow.com/questions/40807833/sending-size-t-type-data-with-mpi
 #if SIZE_MAX == UCHAR_MAX
@@ -33,11 +34,58 @@
 #define COUNT_OF(x) \
   ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
 
+/*
+ * Write the buffered debug output (see logging.c). Called by die() before it
+ * breaks, without a debugger the trap ends the process before atexit handlers
+ * run.
+ */
+void flush_debug(void);
+
 #define die(fmt, ...)                                                    \
   do {                                                                   \
+    flush_debug();                                                       \
     fprintf(stderr, __FILE__ " line %d: " fmt, __LINE__, ##__VA_ARGS__); \
     BREAK();                                                             \
     exit(EXIT_FAILURE);                                                  \
   } while (0)
 
+/**
+ * @brief      Get the next number of a small random number generator
+ *
+ * @details    splitmix64, the state is kept by the caller. Unlike rand(), the
+ * sequence only depends on the seed and not on other users of rand().
+ *
+ * @param      state The state of the generator, any value is a valid seed
+ *
+ * @return     A random 64 bit number
+ */
+static inline uint64_t MPIDYNRES_rand(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief      Get a random number in (0, 1]
+ *
+ * @param      state The state of the generator
+ *
+ * @return     The random number
+ */
+static inline double MPIDYNRES_rand_double(uint64_t *state) {
+  return ((MPIDYNRES_rand(state) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief      Get a time stamp for measuring durations
+ *
+ * @return     CLOCK_MONOTONIC in nanoseconds
+ */
+static inline uint64_t MPIDYNRES_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
 #endif
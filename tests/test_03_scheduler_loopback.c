@@ -0,0 +1,96 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Drive the scheduler inside a single process using the loopback transport
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 3
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+  CHECK(scheduler->running_crs.size == 2);
+
+  for (int i = 1; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_idle_command command;
+    cr_recv(endpoints[i], &command, sizeof(command),
+            MPIDYNRES_TAG_IDLE_COMMAND);
+    CHECK(command.command_type == start);
+  }
+
+  MPIDYNRES_transport *cr = endpoints[1];
+  int session_id = create_session(scheduler, cr);
+
+  // get psets
+  MPI_Info psets;
+  char value[0x10] = {0};
+  int flag;
+  MPIDYNRES_transport_send(cr, &session_id, sizeof(int), 0,
+                           MPIDYNRES_TAG_GET_PSETS);
+  MPIDYNRES_transport_send_info(cr, MPI_INFO_NULL, 0,
+                                MPIDYNRES_TAG_GET_PSETS_INFO_SIZE,
+                                MPIDYNRES_TAG_GET_PSETS_INFO);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  MPIDYNRES_transport_recv_info(cr, &psets, 0,
+                                MPIDYNRES_TAG_GET_PSETS_ANSWER_SIZE,
+                                MPIDYNRES_TAG_GET_PSETS_ANSWER);
+  MPI_Info_get(psets, "mpi://WORLD", sizeof(value) - 1, value, &flag);
+  CHECK(flag && strcmp(value, "2") == 0);
+  MPI_Info_free(&psets);
+
+  // lookup mpi://WORLD
+  char name[] = "mpi://WORLD";
+  int lookup_msg[2] = {session_id, sizeof(name)};
+  size_t answer_size;
+  int members[2];
+  MPIDYNRES_transport_send(cr, lookup_msg, sizeof(lookup_msg), 0,
+                           MPIDYNRES_TAG_PSET_LOOKUP);
+  MPIDYNRES_transport_send(cr, name, sizeof(name), 0,
+                           MPIDYNRES_TAG_PSET_LOOKUP_NAME);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  cr_recv(cr, &answer_size, sizeof(size_t),
+          MPIDYNRES_TAG_PSET_LOOKUP_ANSWER_SIZE);
+  CHECK(answer_size == 2);
+  cr_recv(cr, members, sizeof(members), MPIDYNRES_TAG_PSET_LOOKUP_ANSWER);
+  CHECK(members[0] == 1 && members[1] == 2);
+
+  // both crs are done
+  for (int i = 1; i < NUM_ENDPOINTS; i++) {
+    done(endpoints[i]);
+  }
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 2);
+  CHECK(scheduler->running_crs.size == 0);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 0);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
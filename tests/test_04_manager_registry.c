@@ -0,0 +1,98 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Choose the manager with the manager_name key
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/scheduler.h"
+#include "../src/scheduler_mgmt.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 4
+
+static int custom_inits = 0;
+
+static MPIDYNRES_manager custom_init(MPIDYNRES_scheduler *scheduler) {
+  (void)scheduler;
+  custom_inits++;
+  return calloc(1, sizeof(struct MPIDYNRES_manager_base));
+}
+
+static int custom_free(MPIDYNRES_manager manager) {
+  free(manager);
+  return 0;
+}
+
+static MPIDYNRES_manager_ops const custom_ops = {
+    .name = "custom",
+    .init = custom_init,
+    .free = custom_free,
+};
+
+MPIDYNRES_scheduler *create(MPIDYNRES_transport *endpoint, MPI_Info config) {
+  static MPIDYNRES_SIM_config sim_config;
+  MPIDYNRES_SIM_get_default_config(&sim_config);
+  sim_config.manager_config = config;
+  return MPIDYNRES_scheduler_create(&sim_config, endpoint);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPI_Info config;
+  MPI_Info_create(&config);
+
+  // default
+  MPIDYNRES_scheduler *scheduler = create(endpoints[0], config);
+  CHECK(strcmp(scheduler->manager->ops->name, DEFAULT_MANAGER_NAME) == 0);
+  MPIDYNRES_scheduler_free(scheduler);
+
+  // inc_dec adds the crs in order
+  MPI_Info_set(config, MANAGER_NAME_KEY, "inc_dec");
+  MPI_Info_set(config, "manager_initial_number", "2");
+  scheduler = create(endpoints[0], config);
+  CHECK(scheduler->manager->ops == &MPIDYNRES_inc_dec_manager_ops);
+
+  set_int initial_pset;
+  MPIDYNRES_manager_get_initial_pset(scheduler->manager, &initial_pset);
+  CHECK(initial_pset.size == 2);
+  set_int_free(&initial_pset);
+
+  MPI_Info rc_info;
+  MPIDYNRES_RC_type rc_type;
+  set_int new_pset;
+  MPIDYNRES_manager_handle_rc_msg(scheduler->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == MPIDYNRES_RC_ADD);
+  CHECK(new_pset.size == 1 && set_int_count(&new_pset, 3) == 1);
+  set_int_free(&new_pset);
+  MPIDYNRES_scheduler_free(scheduler);
+
+  // registered at run time
+  CHECK(MPIDYNRES_manager_register(&custom_ops) == 0);
+  CHECK(MPIDYNRES_manager_find("custom") == &custom_ops);
+  MPI_Info_set(config, MANAGER_NAME_KEY, "custom");
+  scheduler = create(endpoints[0], config);
+  CHECK(custom_inits == 1);
+  CHECK(scheduler->manager->ops == &custom_ops);
+  MPIDYNRES_scheduler_free(scheduler);
+
+  MPI_Info_free(&config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Feed performance hints to the scaling manager and check its decisions
+ */
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/scheduler.h"
+#include "../src/scheduler_mgmt.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 8
+
+// Amdahl's law with serial fraction 0.25
+double iter_time(int p) { return 0.25 + 0.75 / p; }
+
+int hint(MPIDYNRES_scheduler *scheduler, char const *key, char const *value,
+         double *o_serial_fraction) {
+  MPI_Info hints, answer;
+  char buf[MPI_MAX_INFO_VAL];
+  int flag;
+
+  MPI_Info_create(&hints);
+  MPI_Info_set(hints, key, value);
+  CHECK(MPIDYNRES_manager_register_scheduling_hints(scheduler->manager, 1,
+                                                    hints, &answer) == 0);
+  MPI_Info_free(&hints);
+  CHECK(answer != MPI_INFO_NULL);
+  MPI_Info_get(answer, "mpidynres_serial_fraction", MPI_MAX_INFO_VAL - 1, buf,
+               &flag);
+  *o_serial_fraction = flag ? strtod(buf, NULL) : NAN;
+  MPI_Info_get(answer, "mpidynres_target_procs", MPI_MAX_INFO_VAL - 1, buf,
+               &flag);
+  CHECK(flag);
+  MPI_Info_free(&answer);
+  return atoi(buf);
+}
+
+int hint_time(MPIDYNRES_scheduler *scheduler, double *o_serial_fraction) {
+  char buf[0x20];
+  snprintf(buf, sizeof(buf), "%f", iter_time(scheduler->running_crs.size));
+  return hint(scheduler, "mpidynres_iter_time", buf, o_serial_fraction);
+}
+
+void check_rc(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_type type,
+              int first, int last) {
+  MPI_Info rc_info;
+  MPIDYNRES_RC_type rc_type;
+  set_int new_pset;
+
+  MPIDYNRES_manager_handle_rc_msg(scheduler->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == type);
+  CHECK(rc_info == MPI_INFO_NULL);
+  if (type == MPIDYNRES_RC_NONE) {
+    return;
+  }
+  CHECK((int)new_pset.size == last - first + 1);
+  for (int i = first; i <= last; i++) {
+    CHECK(set_int_count(&new_pset, i) == 1);
+  }
+  set_int_free(&new_pset);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "scaling");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, "manager_standby", "auto");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+  CHECK(scheduler->running_crs.size == 2);
+  double serial_fraction;
+
+  // no hints, no change
+  check_rc(scheduler, MPIDYNRES_RC_NONE, 0, 0);
+
+  // one size known, explore the next one
+  CHECK(hint_time(scheduler, &serial_fraction) == 3);
+  CHECK(isnan(serial_fraction));
+  // the cr to be added is kept warmed up
+  CHECK(scheduler->standby_size == 1);
+  CHECK(scheduler->pool->standby[3] == 0);
+  check_rc(scheduler, MPIDYNRES_RC_ADD, 3, 3);
+  set_int_insert(&scheduler->running_crs, 3);
+
+  // fitted: E(p) >= 0.5 up to p = 1 + 1 / 0.25
+  CHECK(hint_time(scheduler, &serial_fraction) == 5);
+  CHECK(fabs(serial_fraction - 0.25) < 1e-3);
+  CHECK(scheduler->standby_size == 2);
+  check_rc(scheduler, MPIDYNRES_RC_ADD, 4, 5);
+  set_int_insert(&scheduler->running_crs, 4);
+  set_int_insert(&scheduler->running_crs, 5);
+  set_int_insert(&scheduler->running_crs, 6);
+
+  // too many, remove the highest id
+  CHECK(hint_time(scheduler, &serial_fraction) == 5);
+  check_rc(scheduler, MPIDYNRES_RC_SUB, 6, 6);
+
+  // the declared bounds are respected
+  CHECK(hint(scheduler, "mpidynres_max_procs", "4", &serial_fraction) == 4);
+  check_rc(scheduler, MPIDYNRES_RC_SUB, 5, 6);
+
+  // gustafson needs the serial time, E(p) >= 1 - s > 0.5 for any p
+  CHECK(hint(scheduler, "mpidynres_max_procs", "7", &serial_fraction) == 5);
+  CHECK(hint(scheduler, "mpidynres_scaling_model", "gustafson",
+             &serial_fraction) == 6);
+  CHECK(isnan(serial_fraction));
+  // without it the iteration times can not be fitted, the job keeps its size
+  CHECK(hint_time(scheduler, &serial_fraction) == 6);
+  check_rc(scheduler, MPIDYNRES_RC_NONE, 0, 0);
+  CHECK(hint(scheduler, "mpidynres_serial_time", "0.1", &serial_fraction) == 7);
+  CHECK(fabs(serial_fraction - 0.1 / iter_time(6)) < 1e-3);
+  check_rc(scheduler, MPIDYNRES_RC_ADD, 7, 7);
+
+  // contradicting bounds are rejected and change nothing
+  MPI_Info hints, answer;
+  MPI_Info_create(&hints);
+  MPI_Info_set(hints, "mpidynres_scaling_model", "amdahl");
+  MPI_Info_set(hints, "mpidynres_min_procs", "6");
+  MPI_Info_set(hints, "mpidynres_max_procs", "3");
+  CHECK(MPIDYNRES_manager_register_scheduling_hints(scheduler->manager, 1,
+                                                    hints, &answer) != 0);
+  MPI_Info_free(&hints);
+  CHECK(hint(scheduler, "mpidynres_serial_time", "0.1", &serial_fraction) == 7);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
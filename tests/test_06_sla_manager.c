@@ -0,0 +1,118 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Hold a target iteration time with the sla manager
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/scheduler.h"
+#include "../src/scheduler_mgmt.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 8
+
+int report(MPIDYNRES_scheduler *scheduler, char const *iter_time) {
+  MPI_Info hints, answer;
+  char buf[MPI_MAX_INFO_VAL];
+  int flag;
+
+  MPI_Info_create(&hints);
+  MPI_Info_set(hints, "mpidynres_target_time", "1.0");
+  MPI_Info_set(hints, "mpidynres_iter_time", iter_time);
+  CHECK(MPIDYNRES_manager_register_scheduling_hints(scheduler->manager, 1,
+                                                    hints, &answer) == 0);
+  MPI_Info_free(&hints);
+  MPI_Info_get(answer, "mpidynres_target_procs", MPI_MAX_INFO_VAL - 1, buf,
+               &flag);
+  CHECK(flag);
+  MPI_Info_free(&answer);
+  return atoi(buf);
+}
+
+void check_rc(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_type type,
+              int first, int last) {
+  MPI_Info rc_info;
+  MPIDYNRES_RC_type rc_type;
+  set_int new_pset;
+
+  MPIDYNRES_manager_handle_rc_msg(scheduler->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == type);
+  if (type == MPIDYNRES_RC_NONE) {
+    return;
+  }
+  CHECK((int)new_pset.size == last - first + 1);
+  for (int i = first; i <= last; i++) {
+    CHECK(set_int_count(&new_pset, i) == 1);
+  }
+  set_int_free(&new_pset);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "sla");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, "manager_ki", "0");
+  MPI_Info_set(config.manager_config, "manager_cooldown", "1");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+  CHECK(scheduler->running_crs.size == 2);
+
+  // twice as slow as the target, grow by the max step
+  CHECK(report(scheduler, "2.0") == 4);
+  check_rc(scheduler, MPIDYNRES_RC_ADD, 3, 4);
+  set_int_insert(&scheduler->running_crs, 3);
+  set_int_insert(&scheduler->running_crs, 4);
+
+  // cooldown
+  CHECK(report(scheduler, "1.5") == 4);
+  check_rc(scheduler, MPIDYNRES_RC_NONE, 0, 0);
+
+  // inside the dead band
+  CHECK(report(scheduler, "1.05") == 4);
+  check_rc(scheduler, MPIDYNRES_RC_NONE, 0, 0);
+
+  // much faster than needed, shrink
+  CHECK(report(scheduler, "0.2") == 2);
+  check_rc(scheduler, MPIDYNRES_RC_SUB, 3, 4);
+  set_int_erase(&scheduler->running_crs, 3);
+  set_int_erase(&scheduler->running_crs, 4);
+
+  // cooldown
+  CHECK(report(scheduler, "1.5") == 2);
+
+  // another job takes all free crs before the query, the change is kept
+  CHECK(report(scheduler, "2.0") == 4);
+  for (int i = 3; i < NUM_ENDPOINTS; i++) {
+    set_int_insert(&scheduler->running_crs, i);
+  }
+  check_rc(scheduler, MPIDYNRES_RC_NONE, 0, 0);
+  set_int_erase(&scheduler->running_crs, 6);
+  set_int_erase(&scheduler->running_crs, 7);
+  check_rc(scheduler, MPIDYNRES_RC_ADD, 6, 7);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
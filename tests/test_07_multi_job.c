@@ -0,0 +1,109 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Two jobs share the crs, the second one waits until enough crs are free
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config[2];
+  for (int i = 0; i < 2; i++) {
+    MPIDYNRES_SIM_get_default_config(&config[i]);
+    MPI_Info_create(&config[i].manager_config);
+    MPI_Info_set(config[i].manager_config, "manager_name", "inc_dec");
+  }
+  MPI_Info_set(config[0].manager_config, "manager_initial_number", "3");
+  MPI_Info_set(config[1].manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *job0 =
+      MPIDYNRES_scheduler_create(&config[0], endpoints[0]);
+  MPIDYNRES_scheduler *job1 = MPIDYNRES_scheduler_add_job(job0, &config[1]);
+  CHECK(job0->pool == job1->pool);
+  CHECK(job1->job_id == 1);
+
+  // only job 0 fits
+  MPIDYNRES_scheduler_start_pending_jobs(job0);
+  CHECK(job0->running_crs.size == 3);
+  CHECK(job1->running_crs.size == 0);
+  CHECK(MPIDYNRES_scheduler_jobs_waiting(job0));
+  CHECK(MPIDYNRES_scheduler_num_free(job0) == 1);
+  for (int i = 1; i <= 3; i++) {
+    check_started(endpoints[i], 0);
+  }
+
+  // job 0 may not grow while job 1 is waiting
+  MPIDYNRES_RC_msg rc_msg = request_rc(job0, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+
+  // job 1 starts as soon as there are enough free crs
+  done(endpoints[1]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 1);
+  CHECK(job1->running_crs.size == 2);
+  CHECK(set_int_count(&job1->running_crs, 1) == 1);
+  CHECK(set_int_count(&job1->running_crs, 4) == 1);
+  CHECK(!MPIDYNRES_scheduler_jobs_waiting(job0));
+  check_started(endpoints[1], 1);
+  check_started(endpoints[4], 1);
+
+  for (int i = 2; i <= 3; i++) {
+    done(endpoints[i]);
+  }
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 2);
+  CHECK(job0->running_crs.size == 0);
+  CHECK(job0->job_stats.end_time >= job0->job_stats.start_time);
+
+  // now job 1 can grow
+  rc_msg = request_rc(job1, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  CHECK(!MPIDYNRES_scheduler_cr_is_free(job1, 3));
+  CHECK(job1->job_stats.num_rc == 1);
+
+  // the unaccepted reservation is released when job 1 is done
+  done(endpoints[1]);
+  done(endpoints[4]);
+  CHECK(MPIDYNRES_scheduler_progress(job1) == 2);
+  CHECK(MPIDYNRES_scheduler_num_free(job1) == NUM_ENDPOINTS - 1);
+  CHECK(job1->rc_map.size == 0);
+  CHECK(job1->pset_name_map.size == 0);
+  CHECK(!job1->pending_resource_change);
+  CHECK(job0->pool->num_running == 0);
+  CHECK(job0->job_stats.max_size == 3 && job1->job_stats.max_size == 2);
+
+  char *report = NULL;
+  size_t report_size = 0;
+  FILE *f = open_memstream(&report, &report_size);
+  MPIDYNRES_scheduler_write_job_report(job0, f);
+  fclose(f);
+  CHECK(strstr(report, "\"utilization\"") != NULL);
+  CHECK(strstr(report, "\"id\": 1") != NULL);
+  free(report);
+
+  MPIDYNRES_scheduler_free(job0);
+  for (int i = 0; i < 2; i++) {
+    MPI_Info_free(&config[i].manager_config);
+  }
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Backfill a small job and shrink a malleable job for the first waiting job
+ */
+#include <mpi.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+void check_pset(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_msg *rc_msg,
+                int first, int last) {
+  pset_node *pn;
+  set_pset_node_find_by_name(&scheduler->pset_name_map, rc_msg->pset_name,
+                             &pn);
+  CHECK(pn != NULL);
+  CHECK((int)pn->pset.size == last - first + 1);
+  for (int i = first; i <= last; i++) {
+    CHECK(set_int_count(&pn->pset, i) == 1);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  CHECK(provided == MPI_THREAD_MULTIPLE);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  char const *initial_numbers[3] = {"3", "2", "1"};
+  MPIDYNRES_SIM_config config[3];
+  for (int i = 0; i < 3; i++) {
+    MPIDYNRES_SIM_get_default_config(&config[i]);
+    MPI_Info_create(&config[i].manager_config);
+    MPI_Info_set(config[i].manager_config, "manager_name", "backfill");
+    MPI_Info_set(config[i].manager_config, "manager_initial_number",
+                 initial_numbers[i]);
+  }
+
+  MPIDYNRES_scheduler *job0 =
+      MPIDYNRES_scheduler_create(&config[0], endpoints[0]);
+  MPIDYNRES_scheduler *job1 = MPIDYNRES_scheduler_add_job(job0, &config[1]);
+  MPIDYNRES_scheduler *job2 = MPIDYNRES_scheduler_add_job(job0, &config[2]);
+
+  // job 1 does not fit, job 2 does and job 0 can give back enough crs
+  MPIDYNRES_scheduler_start_pending_jobs(job0);
+  CHECK(job0->running_crs.size == 3);
+  CHECK(job1->running_crs.size == 0);
+  CHECK(job2->running_crs.size == 1);
+  CHECK(MPIDYNRES_scheduler_queue_head(job0) == job1);
+  for (int i = 1; i <= 3; i++) {
+    check_started(endpoints[i], 0);
+  }
+  check_started(endpoints[4], 2);
+
+  // job 0 is shrunk to make room for job 1
+  MPIDYNRES_RC_msg rc_msg = request_rc(job0, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_SUB);
+  check_pset(job0, &rc_msg, 2, 3);
+  accept_rc(job0, endpoints[1], rc_msg.tag);
+
+  // job 2 may not grow while job 1 is waiting
+  rc_msg = request_rc(job2, endpoints[4]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+
+  // job 1 starts on the crs given back
+  done(endpoints[2]);
+  done(endpoints[3]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 2);
+  CHECK(job1->running_crs.size == 2);
+  CHECK(MPIDYNRES_scheduler_queue_head(job0) == NULL);
+  check_started(endpoints[2], 1);
+  check_started(endpoints[3], 1);
+
+  // job 2 expands into the idle cr when job 0 is done
+  done(endpoints[1]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 1);
+  rc_msg = request_rc(job2, endpoints[4]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  check_pset(job2, &rc_msg, 1, 1);
+  accept_rc(job2, endpoints[4], rc_msg.tag);
+  check_started(endpoints[1], 2);
+
+  // a rigid job is never changed
+  MPI_Info_set(config[1].manager_config, "manager_malleable", "false");
+  MPIDYNRES_scheduler *job3 = MPIDYNRES_scheduler_add_job(job0, &config[1]);
+  done(endpoints[1]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 1);
+  CHECK(job3->running_crs.size == 0);
+
+  for (int i = 2; i <= 4; i++) {
+    done(endpoints[i]);
+  }
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 3);
+  CHECK(job3->running_crs.size == 2);
+  check_started(endpoints[1], 3);
+  check_started(endpoints[2], 3);
+  rc_msg = request_rc(job3, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+  done(endpoints[1]);
+  done(endpoints[2]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 2);
+  CHECK(job0->pool->num_running == 0);
+
+  MPIDYNRES_scheduler_free(job0);
+
+  // the crs a malleable job can give back are found on its own thread too
+  MPI_Info_set(config[0].manager_config, "manager_async", "true");
+  job0 = MPIDYNRES_scheduler_create(&config[0], endpoints[0]);
+  job1 = MPIDYNRES_scheduler_add_job(job0, &config[1]);
+  job2 = MPIDYNRES_scheduler_add_job(job0, &config[2]);
+  MPIDYNRES_scheduler_start_pending_jobs(job0);
+  CHECK(strcmp(job0->manager->ops->name, "async") == 0);
+  CHECK(job0->running_crs.size == 3);
+  CHECK(job1->running_crs.size == 0);
+  CHECK(job2->running_crs.size == 1);
+  for (int i = 1; i <= 3; i++) {
+    check_started(endpoints[i], 0);
+    done(endpoints[i]);
+  }
+  check_started(endpoints[4], 2);
+  done(endpoints[4]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 4);
+  check_started(endpoints[1], 1);
+  check_started(endpoints[2], 1);
+  for (int i = 1; i <= 2; i++) {
+    done(endpoints[i]);
+  }
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 2);
+  CHECK(job0->pool->num_running == 0);
+  MPIDYNRES_scheduler_free(job0);
+
+  // two jobs deciding on their own threads, job 0 shrinks for job 1 on a copy
+  // of the pool
+  MPI_Info_set(config[1].manager_config, "manager_malleable", "true");
+  MPI_Info_set(config[1].manager_config, "manager_async", "true");
+  job0 = MPIDYNRES_scheduler_create(&config[0], endpoints[0]);
+  job1 = MPIDYNRES_scheduler_add_job(job0, &config[1]);
+  MPIDYNRES_scheduler_start_pending_jobs(job0);
+  CHECK(strcmp(job1->manager->ops->name, "async") == 0);
+  CHECK(job0->running_crs.size == 3);
+  CHECK(job1->running_crs.size == 0);
+  for (int i = 1; i <= 3; i++) {
+    check_started(endpoints[i], 0);
+  }
+  // the first query only starts the decision on the manager thread
+  rc_msg = request_rc(job0, endpoints[1]);
+  for (int i = 0; i < 1000 && rc_msg.type == MPIDYNRES_RC_NONE; i++) {
+    sched_yield();
+    rc_msg = request_rc(job0, endpoints[1]);
+  }
+  CHECK(rc_msg.type == MPIDYNRES_RC_SUB);
+  check_pset(job0, &rc_msg, 3, 3);
+  accept_rc(job0, endpoints[1], rc_msg.tag);
+  done(endpoints[3]);
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 1);
+  CHECK(job1->running_crs.size == 2);
+  check_started(endpoints[3], 1);
+  check_started(endpoints[4], 1);
+  for (int i = 1; i <= 4; i++) {
+    done(endpoints[i]);
+  }
+  CHECK(MPIDYNRES_scheduler_progress(job0) == 4);
+  CHECK(job0->pool->num_running == 0);
+  MPIDYNRES_scheduler_free(job0);
+
+  for (int i = 0; i < 3; i++) {
+    MPI_Info_free(&config[i].manager_config);
+  }
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
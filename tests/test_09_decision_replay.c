@@ -0,0 +1,146 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Record the decisions of a seeded random_diff manager and replay them
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/logging.h"
+#include "../src/scheduler.h"
+#include "../src/scheduler_mgmt.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 9
+
+set_int *rc_pset(MPIDYNRES_scheduler *scheduler, MPIDYNRES_RC_msg *rc_msg) {
+  pset_node *pn;
+  set_pset_node_find_by_name(&scheduler->pset_name_map, rc_msg->pset_name,
+                             &pn);
+  CHECK(pn != NULL);
+  return &pn->pset;
+}
+
+bool same_set(set_int *a, set_int *b) {
+  if (a->size != b->size) {
+    return false;
+  }
+  foreach (set_int, a, it) {
+    if (set_int_count(b, *it.ref) != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+MPIDYNRES_scheduler *create(MPIDYNRES_SIM_config *config,
+                            MPIDYNRES_transport *endpoints[NUM_ENDPOINTS]) {
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+  return MPIDYNRES_scheduler_create(config, endpoints[0]);
+}
+
+void destroy(MPIDYNRES_scheduler *scheduler,
+             MPIDYNRES_transport *endpoints[NUM_ENDPOINTS]) {
+  MPIDYNRES_scheduler_free(scheduler);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  char trace[] = "/tmp/mpidynres_test_trace_XXXXXX";
+  int fd = mkstemp(trace);
+  CHECK(fd != -1);
+  close(fd);
+  setenv(DECISION_TRACE_ENVVAR, trace, 1);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "random_diff");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "4");
+  MPI_Info_set(config.manager_config, MANAGER_SEED_KEY, "42");
+
+  // record
+  MPIDYNRES_scheduler *recorded = create(&config, endpoints);
+  init_log(recorded);
+  MPIDYNRES_start_first_crs(recorded);
+  MPIDYNRES_RC_msg recorded_msg = request_rc(recorded, endpoints[1]);
+  CHECK(recorded_msg.type != MPIDYNRES_RC_NONE);
+  free_log();
+  unsetenv(DECISION_TRACE_ENVVAR);
+
+  // the same seed gives the same decision
+  MPIDYNRES_transport *endpoints2[NUM_ENDPOINTS];
+  MPIDYNRES_scheduler *seeded = create(&config, endpoints2);
+  MPIDYNRES_start_first_crs(seeded);
+  MPIDYNRES_RC_msg seeded_msg = request_rc(seeded, endpoints2[1]);
+  CHECK(seeded_msg.type == recorded_msg.type);
+  CHECK(same_set(rc_pset(seeded, &seeded_msg),
+                 rc_pset(recorded, &recorded_msg)));
+  destroy(seeded, endpoints2);
+
+  // replay, the initial size is taken from the trace
+  MPIDYNRES_SIM_config replay_config;
+  MPIDYNRES_SIM_get_default_config(&replay_config);
+  MPI_Info_create(&replay_config.manager_config);
+  MPI_Info_set(replay_config.manager_config, "manager_name", "replay");
+  MPI_Info_set(replay_config.manager_config, "manager_replay_file", trace);
+
+  MPIDYNRES_transport *endpoints3[NUM_ENDPOINTS];
+  MPIDYNRES_scheduler *replayed = create(&replay_config, endpoints3);
+  CHECK(MPIDYNRES_manager_initial_number(replayed) == 4);
+  MPIDYNRES_start_first_crs(replayed);
+  CHECK(same_set(&replayed->running_crs, &recorded->running_crs));
+  MPIDYNRES_RC_msg replayed_msg = request_rc(replayed, endpoints3[1]);
+  CHECK(replayed_msg.type == recorded_msg.type);
+  CHECK(same_set(rc_pset(replayed, &replayed_msg),
+                 rc_pset(recorded, &recorded_msg)));
+
+  // the trace is exhausted
+  MPI_Info rc_info;
+  MPIDYNRES_RC_type rc_type;
+  set_int new_pset;
+  MPIDYNRES_manager_handle_rc_msg(replayed->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == MPIDYNRES_RC_NONE);
+  destroy(replayed, endpoints3);
+
+  // a recorded decision that does not fit is skipped
+  FILE *f = fopen(trace, "w");
+  CHECK(f != NULL);
+  fprintf(f, "0.0 0 0 init 2 1 2\n0.1 1 1 sub 1 5\n0.2 0 1 add 1 2\n"
+             "0.3 0 1 add 2 3 4\n");
+  fclose(f);
+  replayed = create(&replay_config, endpoints3);
+  MPIDYNRES_start_first_crs(replayed);
+  CHECK(replayed->running_crs.size == 2);
+  MPIDYNRES_manager_handle_rc_msg(replayed->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == MPIDYNRES_RC_NONE);
+  MPIDYNRES_manager_handle_rc_msg(replayed->manager, 1, &rc_info, &rc_type,
+                                  &new_pset);
+  CHECK(rc_type == MPIDYNRES_RC_ADD);
+  CHECK(new_pset.size == 2 && set_int_count(&new_pset, 3) == 1);
+  set_int_free(&new_pset);
+  destroy(replayed, endpoints3);
+
+  destroy(recorded, endpoints);
+  unlink(trace);
+  MPI_Info_free(&config.manager_config);
+  MPI_Info_free(&replay_config.manager_config);
+
+  MPI_Finalize();
+  return 0;
+}
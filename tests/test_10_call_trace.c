@@ -0,0 +1,107 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Record the calls a scheduler receives and replay them into another one
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/call_trace.h"
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+void accept_rc_with_info(MPIDYNRES_scheduler *scheduler,
+                         MPIDYNRES_transport *cr, int rc_tag) {
+  int msg[2] = {0, rc_tag};
+  MPI_Info info;
+
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "key", "value");
+  MPIDYNRES_transport_send(cr, msg, sizeof(msg), 0, MPIDYNRES_TAG_RC_ACCEPT);
+  MPIDYNRES_transport_send_info(cr, info, 0, MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
+                                MPIDYNRES_TAG_RC_ACCEPT_INFO);
+  MPI_Info_free(&info);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  CHECK(strcmp(MPIDYNRES_tag_name(MPIDYNRES_TAG_PSET_OP), "PSET_OP") == 0);
+
+  FILE *trace = tmpfile();
+  CHECK(trace != NULL);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  // record
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+  MPIDYNRES_transport *recorder =
+      MPIDYNRES_call_trace_recorder_create(endpoints[0], trace);
+  MPIDYNRES_scheduler *recorded =
+      MPIDYNRES_scheduler_create(&config, recorder);
+  MPIDYNRES_call_trace_write_header(trace, recorded);
+  MPIDYNRES_start_first_crs(recorded);
+
+  MPIDYNRES_RC_msg rc_msg = request_rc(recorded, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc_with_info(recorded, endpoints[1], rc_msg.tag);
+  CHECK(recorded->running_crs.size == 3);
+
+  // replay
+  MPIDYNRES_call_trace_header header;
+  MPIDYNRES_call_trace_stats stats;
+  rewind(trace);
+  MPIDYNRES_call_trace_read_header(trace, &header);
+  CHECK(header.num_crs == NUM_ENDPOINTS - 1);
+  CHECK(header.num_jobs == 1);
+
+  MPIDYNRES_SIM_config replay_config;
+  MPIDYNRES_SIM_get_default_config(&replay_config);
+  replay_config.manager_config = header.manager_configs[0];
+
+  MPIDYNRES_transport *endpoints2[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints2);
+  MPIDYNRES_scheduler *replayed =
+      MPIDYNRES_scheduler_create(&replay_config, endpoints2[0]);
+  MPIDYNRES_call_trace_replay(replayed, endpoints2, trace, -1, &stats);
+
+  CHECK(!stats.diverged);
+  CHECK(stats.num_calls == 2);
+  CHECK(stats.num_messages == 4);
+  CHECK(stats.calls[MPIDYNRES_TAG_RC - MPIDYNRES_TAG_IDLE_COMMAND] == 1);
+  CHECK(replayed->running_crs.size == recorded->running_crs.size);
+  foreach (set_int, &recorded->running_crs, it) {
+    CHECK(set_int_count(&replayed->running_crs, *it.ref) == 1);
+  }
+  CHECK(replayed->pset_name_map.size == recorded->pset_name_map.size);
+  CHECK(replayed->job_stats.num_rc == recorded->job_stats.num_rc);
+
+  MPIDYNRES_scheduler_free(replayed);
+  MPIDYNRES_scheduler_free(recorded);
+  MPIDYNRES_transport_free(recorder);
+  MPIDYNRES_call_trace_header_free(&header);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+    MPIDYNRES_transport_free(endpoints2[i]);
+  }
+  fclose(trace);
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Scheduler timers and decisions staged by the timed manager
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "timed");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, "manager_changes", "0:2, 1000:-1");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+  CHECK(scheduler->running_crs.size == 2);
+  CHECK(scheduler->pool->timers.size == 2);
+
+  // the first change is due immediately, progress runs it before the request
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(scheduler->pool->timers.size == 1);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  CHECK(!scheduler->rc_staged);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(scheduler->running_crs.size == 4);
+
+  // cancel
+  int handle = MPIDYNRES_scheduler_add_timer(scheduler, 1000.0, 0);
+  CHECK(scheduler->pool->timers.size == 2);
+  CHECK(MPIDYNRES_scheduler_cancel_timer(scheduler, handle));
+  CHECK(!MPIDYNRES_scheduler_cancel_timer(scheduler, handle));
+  CHECK(scheduler->pool->timers.size == 1);
+  CHECK(MPIDYNRES_scheduler_run_timers(scheduler) == 0);
+
+  // a staged decision that does not fit anymore becomes RC_NONE
+  set_int pset = set_int_init(int_compare);
+  set_int_insert(&pset, 1);
+  MPIDYNRES_scheduler_stage_rc(scheduler, MPIDYNRES_RC_ADD, &pset);
+  set_int_free(&pset);
+  rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+  CHECK(scheduler->running_crs.size == 4);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
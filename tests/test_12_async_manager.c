@@ -0,0 +1,139 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * A slow manager on its own thread does not delay rc requests
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/scheduler_mgmt.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+#define DECISION_TIME_NS 200000000
+
+struct slow_manager {
+  struct MPIDYNRES_manager_base base;
+  MPIDYNRES_scheduler *scheduler;
+};
+
+static MPIDYNRES_manager slow_init(MPIDYNRES_scheduler *scheduler) {
+  struct slow_manager *res = calloc(1, sizeof(struct slow_manager));
+  res->scheduler = scheduler;
+  return &res->base;
+}
+
+static int slow_free(MPIDYNRES_manager manager) {
+  free(manager);
+  return 0;
+}
+
+static int slow_register_scheduling_hints(MPIDYNRES_manager manager,
+                                          int src_process_id,
+                                          MPI_Info scheduling_hints,
+                                          MPI_Info *o_answer) {
+  (void)manager, (void)src_process_id, (void)scheduling_hints;
+  *o_answer = MPI_INFO_NULL;
+  return 0;
+}
+
+static int slow_get_initial_pset(MPIDYNRES_manager manager,
+                                 set_int *o_initial_pset) {
+  struct slow_manager *mgr = (struct slow_manager *)manager;
+  MPIDYNRES_manager_pick_crs(mgr->scheduler,
+                             MPIDYNRES_manager_initial_number(mgr->scheduler),
+                             true, o_initial_pset);
+  return 0;
+}
+
+// always adds the free cr with the lowest id, after thinking about it
+static int slow_handle_rc_msg(MPIDYNRES_manager manager, int src_process_id,
+                              MPI_Info *o_rc_info, MPIDYNRES_RC_type *o_rc_type,
+                              set_int *o_new_pset) {
+  (void)src_process_id;
+  struct slow_manager *mgr = (struct slow_manager *)manager;
+  struct timespec decision_time = {.tv_sec = 0, .tv_nsec = DECISION_TIME_NS};
+
+  nanosleep(&decision_time, NULL);
+  *o_rc_info = MPI_INFO_NULL;
+  MPIDYNRES_manager_pick_crs(mgr->scheduler, 1, true, o_new_pset);
+  if (o_new_pset->size == 0) {
+    set_int_free(o_new_pset);
+    *o_rc_type = MPIDYNRES_RC_NONE;
+  } else {
+    *o_rc_type = MPIDYNRES_RC_ADD;
+  }
+  return 0;
+}
+
+static MPIDYNRES_manager_ops const slow_manager_ops = {
+    .name = "slow",
+    .init = slow_init,
+    .free = slow_free,
+    .register_scheduling_hints = slow_register_scheduling_hints,
+    .get_initial_pset = slow_get_initial_pset,
+    .handle_rc_msg = slow_handle_rc_msg,
+};
+
+int main(int argc, char *argv[]) {
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  CHECK(provided == MPI_THREAD_MULTIPLE);
+  util_init();
+
+  CHECK(MPIDYNRES_manager_register(&slow_manager_ops) == 0);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "slow");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, MANAGER_ASYNC_KEY, "true");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  CHECK(strcmp(scheduler->manager->ops->name, "async") == 0);
+  MPIDYNRES_start_first_crs(scheduler);
+  CHECK(scheduler->running_crs.size == 2);
+
+  // no decision is ready, the requests are answered without waiting
+  double start = MPI_Wtime();
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+  rc_msg = request_rc(scheduler, endpoints[2]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_NONE);
+  CHECK(MPI_Wtime() - start < DECISION_TIME_NS * 1e-9 / 2);
+
+  // the decision is returned once it is ready
+  for (int i = 0; i < 100 && rc_msg.type == MPIDYNRES_RC_NONE; i++) {
+    struct timespec wait = {.tv_sec = 0, .tv_nsec = DECISION_TIME_NS / 10};
+    nanosleep(&wait, NULL);
+    rc_msg = request_rc(scheduler, endpoints[1]);
+  }
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(scheduler->running_crs.size == 3);
+  CHECK(set_int_count(&scheduler->running_crs, 3) == 1);
+
+  // the manager thread is still deciding for the last request
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
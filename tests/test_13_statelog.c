@@ -0,0 +1,89 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * The binary state log records every state change of the crs
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/logging.h"
+#include "../src/scheduler.h"
+#include "../src/statelog.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  char log[] = "/tmp/mpidynres_test_statelog_XXXXXX";
+  int fd = mkstemp(log);
+  CHECK(fd != -1);
+  close(fd);
+  setenv(STATELOG_ENVVAR, log, 1);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  init_log(scheduler);
+  MPIDYNRES_start_first_crs(scheduler);
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  free_log();
+  unsetenv(STATELOG_ENVVAR);
+
+  statelog_header header;
+  statelog_record record;
+  FILE *f = fopen(log, "rb");
+  CHECK(f != NULL);
+  CHECK(statelog_read_header(f, &header));
+  CHECK(header.num_crs == NUM_ENDPOINTS - 1);
+
+  // the initial crs are started one by one
+  uint64_t last_time = 0;
+  for (int cr = 1; cr <= 2; cr++) {
+    CHECK(statelog_read_record(f, &record));
+    CHECK(record.event == STATELOG_CR_STARTED);
+    CHECK(record.event_seq == (uint32_t)cr);
+    CHECK(record.cr_id == cr);
+    CHECK(record.old_state == idle && record.new_state == running);
+    CHECK(record.job_id == 0);
+    CHECK(record.time_ns >= last_time);
+    last_time = record.time_ns;
+  }
+
+  // inc_dec proposes to add cr 3
+  CHECK(statelog_read_record(f, &record));
+  CHECK(record.event == STATELOG_PROPOSE_START);
+  CHECK(record.event_seq == 3);
+  CHECK(record.cr_id == 3);
+  CHECK(record.old_state == idle && record.new_state == reserved);
+  CHECK(!statelog_read_record(f, &record));
+  fclose(f);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+  unlink(log);
+
+  MPI_Finalize();
+  return 0;
+}
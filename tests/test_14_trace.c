@@ -0,0 +1,96 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * The trace has the handler spans of the scheduler and the state spans of
+ * the crs in the Chrome trace event format
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/logging.h"
+#include "../src/scheduler.h"
+#include "../src/trace.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+/*
+ * Return how many events of the trace contain all of the given strings
+ */
+int count_events(char const *path, char const *a, char const *b) {
+  char line[0x400];
+  int res = 0;
+  FILE *f = fopen(path, "r");
+  CHECK(f != NULL);
+  CHECK(fgets(line, sizeof(line), f) != NULL);
+  CHECK(strcmp(line, "[\n") == 0);
+  while (fgets(line, sizeof(line), f) != NULL) {
+    // one complete event per line
+    CHECK(line[0] == '{' && strcmp(line + strlen(line) - 3, "},\n") == 0);
+    res += strstr(line, a) != NULL && strstr(line, b) != NULL;
+  }
+  fclose(f);
+  return res;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  char trace[] = "/tmp/mpidynres_test_trace_XXXXXX";
+  int fd = mkstemp(trace);
+  CHECK(fd != -1);
+  close(fd);
+  setenv(TRACE_ENVVAR, trace, 1);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  init_log(scheduler);
+  CHECK(trace_enabled());
+  MPIDYNRES_start_first_crs(scheduler);
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  free_log();
+  CHECK(!trace_enabled());
+  unsetenv(TRACE_ENVVAR);
+
+  // the tracks are named
+  CHECK(count_events(trace, "\"process_name\"", "\"scheduler\"") == 1);
+  CHECK(count_events(trace, "\"process_name\"", "\"cr 4\"") == 1);
+
+  // the request is a span on the scheduler track
+  CHECK(count_events(trace, "\"name\":\"RC\",\"ph\":\"X\",\"pid\":0",
+                     "\"cr\":1}") == 1);
+
+  // the running crs and the reserved cr end when the trace is closed
+  CHECK(count_events(trace, "\"name\":\"running\"", "\"pid\":1,") == 1);
+  CHECK(count_events(trace, "\"name\":\"running\"", "\"pid\":2,") == 1);
+  CHECK(count_events(trace, "\"name\":\"reserved\"", "\"pid\":3,") == 1);
+  CHECK(count_events(trace, "\"ph\":\"X\"", "\"pid\":4,") == 0);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+  unlink(trace);
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * The scheduler metrics count requests, resource changes and their latencies
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/metrics.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+MPI_Info get_stats(MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport *cr) {
+  int unused = 0;
+  MPI_Info stats;
+
+  MPIDYNRES_transport_send(cr, &unused, sizeof(int), 0,
+                           MPIDYNRES_TAG_GET_STATS);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  CHECK(MPIDYNRES_transport_recv_info(cr, &stats, 0,
+                                      MPIDYNRES_TAG_GET_STATS_ANSWER_SIZE,
+                                      MPIDYNRES_TAG_GET_STATS_ANSWER) == 0);
+  return stats;
+}
+
+long get_long(MPI_Info stats, char const *key) {
+  char value[MPI_MAX_INFO_VAL + 1];
+  int flag;
+
+  MPI_Info_get(stats, key, MPI_MAX_INFO_VAL, value, &flag);
+  CHECK(flag);
+  return atol(value);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  // percentiles are exact up to the bucket width
+  MPIDYNRES_histogram histogram = {0};
+  for (uint64_t i = 1; i <= 1000; i++) {
+    MPIDYNRES_histogram_record(&histogram, i * 1000);
+  }
+  CHECK(histogram.count == 1000);
+  CHECK(histogram.max_ns == 1000000);
+  uint64_t p50 = MPIDYNRES_histogram_percentile(&histogram, 50);
+  CHECK(p50 >= 500000 && p50 <= 500000 + 500000 / 16);
+  uint64_t p99 = MPIDYNRES_histogram_percentile(&histogram, 99);
+  CHECK(p99 >= 990000 && p99 <= 1000000);
+  CHECK(MPIDYNRES_histogram_percentile(&histogram, 100) == 1000000);
+  free(histogram.buckets);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(set_int_count(&scheduler->running_crs, 3) == 1);
+
+  // the first request of the started cr
+  MPI_Info stats = get_stats(scheduler, endpoints[3]);
+  CHECK(get_long(stats, "requests") == 2);
+  CHECK(get_long(stats, "request.rc.count") == 1);
+  CHECK(get_long(stats, "request.rc_accept.count") == 1);
+  CHECK(get_long(stats, "rc.add") == 1);
+  CHECK(get_long(stats, "rc.none") == 0);
+  CHECK(get_long(stats, "rc_accept.count") == 1);
+  CHECK(get_long(stats, "rc_start.count") == 1);
+  CHECK(get_long(stats, "running_crs") == 3);
+  CHECK(get_long(stats, "psets") == 2);  // mpi://WORLD and the rc pset
+  CHECK(get_long(stats, "pset_members") == 3);
+  CHECK(get_long(stats, "bytes_in") > 0);
+  CHECK(get_long(stats, "bytes_out") > 0);
+  MPI_Info_free(&stats);
+
+  // the stats request itself is counted now
+  stats = get_stats(scheduler, endpoints[3]);
+  CHECK(get_long(stats, "requests") == 3);
+  CHECK(get_long(stats, "request.get_stats.count") == 1);
+  CHECK(get_long(stats, "rc_start.count") == 1);
+  MPI_Info_free(&stats);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * The time of the crs is accounted per state to the crs and the jobs
+ */
+#include <math.h>
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+void done_running(MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport *cr,
+                  double cpu_seconds) {
+  MPIDYNRES_transport_send(cr, &cpu_seconds, sizeof(double), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_start_first_crs(scheduler);
+
+  // cr 3 is reserved, then started
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  usleep(10000);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(pool->cr_state[3] == running);
+  CHECK(pool->cr_state_seconds[3][reserved] >= 0.01);
+  CHECK(scheduler->job_stats.state_seconds[reserved] >= 0.01);
+
+  usleep(10000);
+  done_running(scheduler, endpoints[3], 1.5);
+  CHECK(pool->cr_state[3] == idle);
+  CHECK(pool->cr_cpu_seconds[3] == 1.5);
+  CHECK(scheduler->job_stats.cpu_seconds == 1.5);
+  CHECK(scheduler->job_stats.state_seconds[running] >= 0.01);
+
+  // the states of a cr add up to the makespan
+  double now = MPI_Wtime();
+  for (int cr = 1; cr < NUM_ENDPOINTS; cr++) {
+    double sum = 0.0;
+    for (int s = 0; s < NUM_CR_STATES; s++) {
+      sum += MPIDYNRES_scheduler_cr_state_seconds(scheduler, cr, s, now);
+    }
+    CHECK(fabs(sum - (now - pool->start_time)) < 1e-6);
+  }
+  CHECK(MPIDYNRES_scheduler_cr_state_seconds(scheduler, 4, idle, now) ==
+        now - pool->start_time);
+
+  MPIDYNRES_SIM_utilization u;
+  MPIDYNRES_scheduler_get_utilization(scheduler, &u);
+  CHECK(u.num_crs == NUM_ENDPOINTS - 1);
+  CHECK(u.cpu_seconds == 1.5);
+  CHECK(fabs(u.idle_cr_seconds + u.reserved_cr_seconds + u.running_cr_seconds +
+             u.shutdown_cr_seconds - u.available_cr_seconds) < 1e-3);
+  CHECK(u.reserved_cr_seconds >= 0.01);
+  // crs 1 and 2 ran all the time
+  CHECK(u.running_cr_seconds >= 2 * 0.02);
+  CHECK(u.utilization > 0.0 && u.utilization <= 1.0);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Tools are called back for the events of the scheduler
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/mpidynres_tool.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+#define MAX_EVENTS 64
+
+MPIDYNRES_tool_event events[MAX_EVENTS];
+char pset_names[MAX_EVENTS][MPI_MAX_PSET_NAME_LEN];
+int num_events = 0;
+
+void record(MPIDYNRES_tool_event const *event, void *user_data) {
+  CHECK(user_data == (void *)events);
+  CHECK(event->in_scheduler == 1);
+  CHECK(num_events < MAX_EVENTS);
+  events[num_events] = *event;
+  pset_names[num_events][0] = '\0';
+  if (event->pset_name != NULL) {
+    strcpy(pset_names[num_events], event->pset_name);
+  }
+  num_events++;
+}
+
+/*
+ * Return the index of the next recorded event of a type starting at *i, -1 if
+ * there is none
+ */
+int next_event(int *i, MPIDYNRES_tool_event_type type) {
+  for (; *i < num_events; (*i)++) {
+    if (events[*i].type == type) {
+      return (*i)++;
+    }
+  }
+  return -1;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  int handles[MPIDYNRES_TOOL_NUM_EVENTS];
+  int handle;
+  for (int type = 0; type < MPIDYNRES_TOOL_NUM_EVENTS; type++) {
+    CHECK(MPIDYNRES_tool_register(type, record, events, &handles[type]) == 0);
+  }
+  CHECK(MPIDYNRES_tool_register(MPIDYNRES_TOOL_NUM_EVENTS, record, NULL,
+                                &handle) != 0);
+  CHECK(MPIDYNRES_tool_unregister(-1) != 0);
+  CHECK(strcmp(MPIDYNRES_tool_event_name(MPIDYNRES_TOOL_RC_PROPOSED),
+               "rc_proposed") == 0);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_start_first_crs(scheduler);
+
+  int i = 0;
+  int e = next_event(&i, MPIDYNRES_TOOL_PSET_CREATED);
+  CHECK(e != -1 && strcmp(pset_names[e], "mpi://WORLD") == 0);
+  CHECK(events[e].pset_size == 2 && events[e].job_id == 0);
+  e = next_event(&i, MPIDYNRES_TOOL_CR_STARTED);
+  CHECK(e != -1 && events[e].cr_id == 1);
+  e = next_event(&i, MPIDYNRES_TOOL_CR_STARTED);
+  CHECK(e != -1 && events[e].cr_id == 2);
+
+  // session of cr 1
+  int session_id = create_session(scheduler, endpoints[1]);
+  e = next_event(&i, MPIDYNRES_TOOL_SESSION_INIT);
+  CHECK(e != -1 && events[e].cr_id == 1 && events[e].session_id == session_id);
+
+  // the resource change adds cr 3
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  e = next_event(&i, MPIDYNRES_TOOL_RC_PROPOSED);
+  CHECK(e != -1 && events[e].cr_id == 1 && events[e].rc_tag == rc_msg.tag);
+  CHECK(events[e].rc_type == MPIDYNRES_RC_ADD && events[e].pset_size == 1);
+  CHECK(strcmp(pset_names[e], rc_msg.pset_name) == 0);
+
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  e = next_event(&i, MPIDYNRES_TOOL_RC_ACCEPTED);
+  CHECK(e != -1 && events[e].rc_tag == rc_msg.tag);
+  e = next_event(&i, MPIDYNRES_TOOL_CR_STARTED);
+  CHECK(e != -1 && events[e].cr_id == 3 && events[e].rc_tag == rc_msg.tag);
+
+  // cr 3 returns, the rc pset goes away with it
+  done(endpoints[3]);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  int j = i;
+  e = next_event(&j, MPIDYNRES_TOOL_PSET_FREED);
+  CHECK(e != -1 && strcmp(pset_names[e], rc_msg.pset_name) == 0);
+  e = next_event(&i, MPIDYNRES_TOOL_CR_EXITED);
+  CHECK(e != -1 && events[e].cr_id == 3);
+
+  // events are in time order
+  for (int k = 1; k < num_events; k++) {
+    CHECK(events[k].time_ns >= events[k - 1].time_ns);
+  }
+
+  // unregistered callbacks are not called anymore
+  for (int type = 0; type < MPIDYNRES_TOOL_NUM_EVENTS; type++) {
+    CHECK(MPIDYNRES_tool_unregister(handles[type]) == 0);
+  }
+  CHECK(MPIDYNRES_tool_unregister(handles[0]) != 0);
+  int before = num_events;
+  request_rc(scheduler, endpoints[1]);
+  CHECK(num_events == before);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int k = 0; k < NUM_ENDPOINTS; k++) {
+    MPIDYNRES_transport_free(endpoints[k]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * SIGUSR1 makes the scheduler write a snapshot of its state at the next
+ * progress
+ */
+#include <mpi.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/snapshot.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+/*
+ * Read the whole snapshot, NULL if there is none
+ */
+char *read_snapshot(char const *path) {
+  static char buf[0x4000];
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    return NULL;
+  }
+  size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+  buf[len] = '\0';
+  fclose(f);
+  return buf;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  char path[] = "/tmp/mpidynres_test_snapshot_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd != -1);
+  close(fd);
+  unlink(path);
+  setenv(SNAPSHOT_ENVVAR, path, 1);
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_snapshot_init();
+  CHECK(snapshot_enabled());
+  MPIDYNRES_start_first_crs(scheduler);
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+
+  // nothing is written without a request
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 0);
+  CHECK(read_snapshot(path) == NULL);
+
+  // the request of cr 2 waits while the snapshot is written
+  int unused = 0;
+  MPIDYNRES_transport_send(endpoints[2], &unused, sizeof(int), 0,
+                           MPIDYNRES_TAG_SESSION_CREATE);
+  raise(SIGUSR1);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+
+  char *snapshot = read_snapshot(path);
+  CHECK(snapshot != NULL);
+  CHECK(snapshot[0] == '{' && strstr(snapshot, "\n}\n") != NULL);
+  CHECK(strstr(snapshot, "\"num_running\": 2,") != NULL);
+  CHECK(strstr(snapshot, "\"waiting_requests\": {\"SESSION_CREATE\": 1}") !=
+        NULL);
+  CHECK(strstr(snapshot, "\"RC\": 1") != NULL);
+  CHECK(strstr(snapshot, "\"running_crs\": [1, 2]") != NULL);
+  CHECK(strstr(snapshot, "\"pending_resource_change\": true") != NULL);
+  CHECK(strstr(snapshot, "{\"name\": \"mpi://WORLD\", \"size\": 2}") != NULL);
+  char expected[0x200];
+  snprintf(expected, sizeof(expected),
+           "{\"tag\": %d, \"type\": \"add\", \"pset\": \"%s\", \"crs\": [3]",
+           rc_msg.tag, rc_msg.pset_name);
+  CHECK(strstr(snapshot, expected) != NULL);
+
+  // the snapshot was moved into place
+  char tmp_path[sizeof(path) + 4];
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+  CHECK(access(tmp_path, F_OK) != 0);
+
+  MPIDYNRES_snapshot_free();
+  CHECK(!snapshot_enabled());
+  unsetenv(SNAPSHOT_ENVVAR);
+  unlink(path);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * The scheduler is restored from the journal up to its last checkpoint
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/checkpoint.h"
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+int count_lines(char const *path, char const *prefix) {
+  char line[0x400];
+  int res = 0;
+  FILE *f = fopen(path, "r");
+  CHECK(f != NULL);
+  while (fgets(line, sizeof(line), f) != NULL) {
+    res += strncmp(line, prefix, strlen(prefix)) == 0;
+  }
+  fclose(f);
+  return res;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  char path[] = "/tmp/mpidynres_test_journal_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK(fd != -1);
+  close(fd);
+  setenv(CHECKPOINT_ENVVAR, path, 1);
+  setenv(CHECKPOINT_INTERVAL_ENVVAR, "1000", 1);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+
+  // the run that crashes
+  MPIDYNRES_call_trace_header header;
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+  FILE *journal = MPIDYNRES_checkpoint_open(&header);
+  CHECK(journal != NULL && header.num_jobs == 0);
+  MPIDYNRES_transport *recorder =
+      MPIDYNRES_call_trace_recorder_create(endpoints[0], journal);
+  MPIDYNRES_scheduler *crashed = MPIDYNRES_scheduler_create(&config, recorder);
+  MPIDYNRES_checkpoint_start(crashed, &header);
+  MPIDYNRES_start_first_crs(crashed);
+
+  MPIDYNRES_RC_msg rc_msg = request_rc(crashed, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(crashed, endpoints[1], rc_msg.tag);
+  // cr 4 is reserved by a resource change that is not accepted
+  rc_msg = request_rc(crashed, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  MPIDYNRES_checkpoint_write(crashed);
+  int next_session_id = crashed->next_session_id;
+  int next_rc_tag = crashed->next_rc_tag;
+  size_t num_psets = crashed->pset_name_map.size;
+
+  // lost, it comes after the last checkpoint
+  create_session(crashed, endpoints[2]);
+  CHECK(count_lines(path, "# checkpoint calls 3 owners 0 0 0 0") == 1);
+
+  MPIDYNRES_transport_free(recorder);
+  MPIDYNRES_checkpoint_close();
+  MPIDYNRES_scheduler_free(crashed);
+
+  // the restored run
+  setenv(RESTORE_ENVVAR, "1", 1);
+  MPIDYNRES_transport *endpoints2[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints2);
+  journal = MPIDYNRES_checkpoint_open(&header);
+  CHECK(journal != NULL && header.num_jobs == 1 && header.num_crs == 4);
+  MPIDYNRES_SIM_config restored_config = config;
+  restored_config.manager_config = header.manager_configs[0];
+  recorder = MPIDYNRES_call_trace_recorder_create(endpoints2[0], journal);
+  MPIDYNRES_scheduler *restored =
+      MPIDYNRES_scheduler_create(&restored_config, recorder);
+  MPIDYNRES_checkpoint_start(restored, &header);
+
+  CHECK(restored->running_crs.size == 3);
+  CHECK(restored->next_session_id == next_session_id);
+  CHECK(restored->next_rc_tag == next_rc_tag);
+  CHECK(restored->pset_name_map.size == num_psets);
+  // the pending resource change was cancelled
+  CHECK(restored->rc_map.size == 0);
+  CHECK(!restored->pending_resource_change);
+  CHECK(restored->pool->owner[4] == MPIDYNRES_NO_JOB);
+
+  // the running crs were started again
+  for (int cr = 1; cr <= 3; cr++) {
+    MPIDYNRES_idle_command command;
+    CHECK(MPIDYNRES_transport_recv(endpoints2[cr], &command, sizeof(command),
+                                   0, MPIDYNRES_TAG_IDLE_COMMAND, NULL) == 0);
+    CHECK(command.command_type == start && command.job_id == 0);
+  }
+  int flag;
+  MPIDYNRES_transport_iprobe(endpoints2[4], 0, MPIDYNRES_ANY_TAG, &flag, NULL);
+  CHECK(!flag);
+
+  // and know about it
+  int session_id = create_session(restored, endpoints2[1]);
+  MPI_Info info;
+  char value[MPI_MAX_INFO_VAL + 1];
+  MPIDYNRES_transport_send(endpoints2[1], &session_id, sizeof(int), 0,
+                           MPIDYNRES_TAG_SESSION_INFO);
+  CHECK(MPIDYNRES_scheduler_progress(restored) == 1);
+  MPIDYNRES_transport_recv_info(endpoints2[1], &info, 0,
+                                MPIDYNRES_TAG_SESSION_INFO_ANSWER_SIZE,
+                                MPIDYNRES_TAG_SESSION_INFO_ANSWER);
+  MPI_Info_get(info, "mpidynres_restored", MPI_MAX_INFO_VAL, value, &flag);
+  CHECK(flag && strcmp(value, "yes") == 0);
+  MPI_Info_free(&info);
+
+  // the journal continues after the checkpoint
+  MPIDYNRES_checkpoint_write(restored);
+  MPIDYNRES_transport_free(recorder);
+  MPIDYNRES_checkpoint_close();
+  CHECK(count_lines(path, "# checkpoint") == 2);
+  CHECK(count_lines(path, "# checkpoint calls 5 ") == 1);
+
+  MPIDYNRES_scheduler_free(restored);
+  MPIDYNRES_call_trace_header_free(&header);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+    MPIDYNRES_transport_free(endpoints2[i]);
+  }
+  unsetenv(RESTORE_ENVVAR);
+  unsetenv(CHECKPOINT_ENVVAR);
+  unsetenv(CHECKPOINT_INTERVAL_ENVVAR);
+  unlink(path);
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Idle crs are warmed up for a job ahead of the resource changes that start
+ * them
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+
+/*
+ * Return the type of the next idle command of a cr for a job, -1 if there is
+ * none
+ */
+int next_command(MPIDYNRES_transport *cr, int job_id) {
+  MPIDYNRES_idle_command command;
+  MPIDYNRES_transport_status status;
+  int flag;
+
+  MPIDYNRES_transport_iprobe(cr, 0, MPIDYNRES_TAG_IDLE_COMMAND, &flag,
+                             &status);
+  if (!flag) {
+    return -1;
+  }
+  MPIDYNRES_transport_recv(cr, &command, sizeof(command), 0,
+                           MPIDYNRES_TAG_IDLE_COMMAND, NULL);
+  CHECK(command.job_id == job_id);
+  return command.command_type;
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, "manager_standby", "1");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  CHECK(scheduler->standby_size == 1);
+  MPIDYNRES_start_first_crs(scheduler);
+
+  // the next free cr is warmed up when the job starts
+  CHECK(next_command(endpoints[1], 0) == start);
+  CHECK(next_command(endpoints[2], 0) == start);
+  CHECK(next_command(endpoints[3], 0) == warm);
+  CHECK(next_command(endpoints[4], 0) == -1);
+  CHECK(scheduler->pool->standby[3] == 0);
+  CHECK(MPIDYNRES_scheduler_cr_is_free(scheduler, 3));
+
+  // once it is reserved, the next one takes its place
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  CHECK(next_command(endpoints[4], 0) == warm);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(next_command(endpoints[3], 0) == start);
+  CHECK(scheduler->pool->standby[3] == MPIDYNRES_NO_JOB);
+  CHECK(scheduler->pool->metrics.standby_hits == 1);
+
+  // warming up a cr twice sends nothing
+  MPIDYNRES_scheduler_warm_cr(scheduler, 4);
+  CHECK(next_command(endpoints[4], 0) == -1);
+  CHECK(scheduler->pool->metrics.standby_warmed == 2);
+
+  rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(next_command(endpoints[4], 0) == start);
+  CHECK(scheduler->pool->metrics.standby_hits == 2);
+  CHECK(scheduler->pool->metrics.standby_misses == 0);
+
+  // no free crs are left
+  CHECK(scheduler->pool->metrics.standby_warmed == 2);
+
+  MPIDYNRES_scheduler_free(scheduler);
+
+  // the standby of a job is kept from the resource changes of other jobs
+  MPIDYNRES_SIM_config other_config;
+  MPIDYNRES_SIM_get_default_config(&other_config);
+  MPI_Info_create(&other_config.manager_config);
+  MPI_Info_set(other_config.manager_config, "manager_name", "backfill");
+  MPI_Info_set(other_config.manager_config, "manager_initial_number", "1");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "1");
+  scheduler = MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_scheduler *other =
+      MPIDYNRES_scheduler_add_job(scheduler, &other_config);
+  MPIDYNRES_scheduler_start_pending_jobs(scheduler);
+
+  // the starting job may take the standby, it is refilled with the next cr
+  CHECK(next_command(endpoints[1], 0) == start);
+  CHECK(next_command(endpoints[2], 0) == warm);
+  CHECK(next_command(endpoints[2], 1) == start);
+  CHECK(next_command(endpoints[3], 0) == warm);
+  CHECK(!MPIDYNRES_scheduler_cr_is_free(other, 3));
+  CHECK(MPIDYNRES_scheduler_num_free(other) == 1);
+  CHECK(MPIDYNRES_scheduler_num_free(scheduler) == 2);
+
+  rc_msg = request_rc(other, endpoints[2]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  CHECK(scheduler->pool->owner[4] == 1);
+  CHECK(scheduler->pool->owner[3] == MPIDYNRES_NO_JOB);
+  accept_rc(other, endpoints[2], rc_msg.tag);
+  CHECK(next_command(endpoints[4], 1) == start);
+
+  // a smaller standby gives the cr back
+  MPIDYNRES_scheduler_set_standby_size(scheduler, 0);
+  CHECK(scheduler->pool->standby[3] == MPIDYNRES_NO_JOB);
+  CHECK(MPIDYNRES_scheduler_cr_is_free(other, 3));
+  MPIDYNRES_scheduler_set_standby_size(scheduler, 1);
+  CHECK(next_command(endpoints[3], 0) == warm);
+  CHECK(scheduler->pool->standby[3] == 0);
+
+  // the job adds its own standby first
+  rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(next_command(endpoints[3], 0) == start);
+  CHECK(scheduler->pool->metrics.standby_hits == 1);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&other_config.manager_config);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 1
+ *
+ * Injected latencies delay the start and the release of crs
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "util_test.h"
+
+#include "../src/comm.h"
+#include "../src/latency.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
+#define NUM_ENDPOINTS 5
+#define LATENCY 0.05
+
+bool has_command(MPIDYNRES_transport *cr) {
+  MPIDYNRES_transport_status status;
+  MPIDYNRES_idle_command command;
+  int flag;
+
+  MPIDYNRES_transport_iprobe(cr, 0, MPIDYNRES_TAG_IDLE_COMMAND, &flag,
+                             &status);
+  if (flag) {
+    MPIDYNRES_transport_recv(cr, &command, sizeof(command), 0,
+                             MPIDYNRES_TAG_IDLE_COMMAND, NULL);
+    CHECK(command.command_type == start);
+  }
+  return flag;
+}
+
+/*
+ * Drive the scheduler until the latency passed
+ */
+void wait_latency(MPIDYNRES_scheduler *scheduler) {
+  double end = MPI_Wtime() + 2 * LATENCY;
+  while (MPI_Wtime() < end) {
+    MPIDYNRES_scheduler_progress(scheduler);
+    usleep(1000);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  MPI_Init(&argc, &argv);
+  util_init();
+
+  // the models
+  MPIDYNRES_latency latency;
+  uint64_t rng_state = 1;
+  MPIDYNRES_latency_parse(NULL, &latency);
+  CHECK(MPIDYNRES_latency_draw(&latency, 4, &rng_state) == 0.0);
+  MPIDYNRES_latency_parse("1.5", &latency);
+  CHECK(MPIDYNRES_latency_draw(&latency, 4, &rng_state) == 1.5);
+  MPIDYNRES_latency_parse("table:1:1,3:3,7:4", &latency);
+  CHECK(MPIDYNRES_latency_draw(&latency, 1, &rng_state) == 1.0);
+  CHECK(MPIDYNRES_latency_draw(&latency, 2, &rng_state) == 2.0);
+  CHECK(MPIDYNRES_latency_draw(&latency, 5, &rng_state) == 3.5);
+  CHECK(MPIDYNRES_latency_draw(&latency, 100, &rng_state) == 4.0);
+  MPIDYNRES_latency_free(&latency);
+  MPIDYNRES_latency_parse("uniform:1:2", &latency);
+  double sum = 0.0;
+  for (int i = 0; i < 1000; i++) {
+    double l = MPIDYNRES_latency_draw(&latency, 1, &rng_state);
+    CHECK(l >= 1.0 && l <= 2.0);
+    sum += l;
+  }
+  CHECK(sum / 1000 > 1.4 && sum / 1000 < 1.6);
+  MPIDYNRES_latency_parse("exp:2", &latency);
+  sum = 0.0;
+  for (int i = 0; i < 1000; i++) {
+    double l = MPIDYNRES_latency_draw(&latency, 1, &rng_state);
+    CHECK(l >= 0.0);
+    sum += l;
+  }
+  CHECK(sum / 1000 > 1.7 && sum / 1000 < 2.3);
+  MPIDYNRES_latency_parse("normal:0:1", &latency);
+  for (int i = 0; i < 1000; i++) {
+    CHECK(MPIDYNRES_latency_draw(&latency, 1, &rng_state) >= 0.0);
+  }
+
+  MPIDYNRES_transport *endpoints[NUM_ENDPOINTS];
+  MPIDYNRES_transport_loopback_create(NUM_ENDPOINTS, endpoints);
+
+  MPIDYNRES_SIM_config config;
+  MPIDYNRES_SIM_get_default_config(&config);
+  MPI_Info_create(&config.manager_config);
+  MPI_Info_set(config.manager_config, "manager_name", "inc_dec");
+  MPI_Info_set(config.manager_config, "manager_initial_number", "2");
+  MPI_Info_set(config.manager_config, "manager_start_latency", "0.05");
+  MPI_Info_set(config.manager_config, "manager_shutdown_latency", "0.05");
+
+  MPIDYNRES_scheduler *scheduler =
+      MPIDYNRES_scheduler_create(&config, endpoints[0]);
+  MPIDYNRES_pool *pool = scheduler->pool;
+  MPIDYNRES_start_first_crs(scheduler);
+
+  // the initial crs belong to the job, but are started later
+  CHECK(pool->owner[1] == 0 && pool->owner[2] == 0);
+  CHECK(pool->cr_state[1] == reserved);
+  CHECK(!has_command(endpoints[1]) && !has_command(endpoints[2]));
+  wait_latency(scheduler);
+  CHECK(has_command(endpoints[1]) && has_command(endpoints[2]));
+  CHECK(pool->cr_state[1] == running);
+
+  // so are the crs of a resource change
+  MPIDYNRES_RC_msg rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_ADD);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+  CHECK(set_int_count(&scheduler->running_crs, 3) == 1);
+  CHECK(!has_command(endpoints[3]));
+  wait_latency(scheduler);
+  CHECK(has_command(endpoints[3]));
+
+  // a cr that returned is released later
+  double cpu_seconds = 0.0;
+  MPIDYNRES_transport_send(endpoints[3], &cpu_seconds, sizeof(double), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  CHECK(pool->owner[3] == 0);
+  CHECK(pool->cr_state[3] == accepted_shutdown);
+
+  // while it shuts down, resource changes neither count nor remove it
+  CHECK(set_int_count(&scheduler->running_crs, 3) == 0);
+  CHECK(set_int_count(&scheduler->shutting_down_crs, 3) == 1);
+  set_int pset;
+  MPIDYNRES_manager_pick_crs(scheduler, 2, false, &pset);
+  CHECK(pset.size == 2 && set_int_count(&pset, 3) == 0);
+  set_int_free(&pset);
+  MPIDYNRES_manager_pick_crs(scheduler, 1, false, &pset);
+  CHECK(pset.size == 1 && set_int_count(&pset, 2) == 1);
+  MPIDYNRES_scheduler_stage_rc(scheduler, MPIDYNRES_RC_SUB, &pset);
+  set_int_free(&pset);
+  rc_msg = request_rc(scheduler, endpoints[1]);
+  CHECK(rc_msg.type == MPIDYNRES_RC_SUB);
+  CHECK(scheduler->pending_shutdowns.size == 1);
+  CHECK(set_int_count(&scheduler->pending_shutdowns, 2) == 1);
+  accept_rc(scheduler, endpoints[1], rc_msg.tag);
+
+  wait_latency(scheduler);
+  CHECK(pool->owner[3] == MPIDYNRES_NO_JOB);
+  CHECK(pool->cr_state[3] == idle);
+  CHECK(set_int_count(&scheduler->running_crs, 3) == 0);
+  CHECK(scheduler->shutting_down_crs.size == 0);
+
+  // the removed cr shuts down the same way, the job goes on
+  MPIDYNRES_transport_send(endpoints[2], &cpu_seconds, sizeof(double), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  CHECK(scheduler->running_crs.size == 1);
+  wait_latency(scheduler);
+  CHECK(pool->owner[2] == MPIDYNRES_NO_JOB);
+  CHECK(scheduler->pending_shutdowns.size == 0);
+  CHECK(scheduler->job_stats.end_time < 0.0);
+
+  // one start latency per launch
+  CHECK(pool->metrics.start_latency.count == 2);
+  CHECK(pool->metrics.shutdown_latency.count == 2);
+  CHECK(pool->metrics.start_latency.max_ns == 50000000);
+
+  MPIDYNRES_scheduler_free(scheduler);
+  MPI_Info_free(&config.manager_config);
+  for (int i = 0; i < NUM_ENDPOINTS; i++) {
+    MPIDYNRES_transport_free(endpoints[i]);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
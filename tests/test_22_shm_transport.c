@@ -0,0 +1,164 @@
+/*
+ * TEST_NEEDS_MPI
+ * TEST_MPI_RANKS 3
+ *
+ * Messages between the scheduler and the other ranks go through the shared
+ * memory mailboxes
+ */
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_test.h"
+
+#include "../src/transport.h"
+
+#define TAG_WANTED 1
+#define TAG_OTHER 2
+#define LARGE_SIZE (1 << 18)  // larger than a ring
+
+/*
+ * Rank 1 has a message with another tag waiting in its mailbox while rank 2
+ * sends the requested one, an any source receive must skip rank 1
+ */
+void test_skip_other_tag(MPIDYNRES_transport *t, int rank) {
+  MPIDYNRES_transport_status status;
+  int value;
+  int flag;
+
+  if (rank == 1) {
+    value = 10;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 0, TAG_OTHER);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+  if (rank == 2) {
+    value = 20;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 0, TAG_WANTED);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (rank == 0) {
+    MPIDYNRES_transport_iprobe(t, MPIDYNRES_ANY_SOURCE, TAG_WANTED, &flag,
+                               &status);
+    CHECK(flag);
+    CHECK(status.source == 2);
+
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int),
+                                   MPIDYNRES_ANY_SOURCE, TAG_WANTED,
+                                   &status) == 0);
+    CHECK(status.source == 2);
+    CHECK(status.tag == TAG_WANTED);
+    CHECK(status.size == sizeof(int));
+    CHECK(value == 20);
+
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int),
+                                   MPIDYNRES_ANY_SOURCE, MPIDYNRES_ANY_TAG,
+                                   &status) == 0);
+    CHECK(status.source == 1);
+    CHECK(status.tag == TAG_OTHER);
+    CHECK(value == 10);
+
+    MPIDYNRES_transport_iprobe(t, MPIDYNRES_ANY_SOURCE, MPIDYNRES_ANY_TAG,
+                               &flag, &status);
+    CHECK(!flag);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+/*
+ * A receive from a specific source matches a later message with the requested
+ * tag, in both directions
+ */
+void test_same_source_other_tag(MPIDYNRES_transport *t, int rank) {
+  MPIDYNRES_transport_status status;
+  int value;
+  int flag;
+
+  if (rank == 1) {
+    value = 11;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 0, TAG_OTHER);
+    value = 12;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 0, TAG_WANTED);
+
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int), 0, TAG_WANTED,
+                                   &status) == 0);
+    CHECK(status.tag == TAG_WANTED);
+    CHECK(value == 22);
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int), 0, TAG_OTHER,
+                                   &status) == 0);
+    CHECK(value == 21);
+  } else if (rank == 0) {
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int), 1, TAG_WANTED,
+                                   &status) == 0);
+    CHECK(status.source == 1);
+    CHECK(status.tag == TAG_WANTED);
+    CHECK(value == 12);
+
+    MPIDYNRES_transport_iprobe(t, 1, TAG_WANTED, &flag, &status);
+    CHECK(!flag);
+    MPIDYNRES_transport_iprobe(t, MPIDYNRES_ANY_SOURCE, TAG_OTHER, &flag,
+                               &status);
+    CHECK(flag);
+    CHECK(status.source == 1);
+    CHECK(MPIDYNRES_transport_recv(t, &value, sizeof(int), 1,
+                                   MPIDYNRES_ANY_TAG, &status) == 0);
+    CHECK(status.tag == TAG_OTHER);
+    CHECK(value == 11);
+
+    value = 21;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 1, TAG_OTHER);
+    value = 22;
+    MPIDYNRES_transport_send(t, &value, sizeof(int), 1, TAG_WANTED);
+  }
+  MPI_Barrier(MPI_COMM_WORLD);
+}
+
+/*
+ * A message larger than the ring is streamed while the receiver reads it
+ */
+void test_large_message(MPIDYNRES_transport *t, int rank) {
+  MPIDYNRES_transport_status status;
+  unsigned char *buf = malloc(LARGE_SIZE);
+
+  if (rank == 1) {
+    for (size_t i = 0; i < LARGE_SIZE; i++) {
+      buf[i] = i % 251;
+    }
+    MPIDYNRES_transport_send(t, buf, LARGE_SIZE, 0, TAG_WANTED);
+    MPIDYNRES_transport_recv(t, buf, LARGE_SIZE, 0, TAG_WANTED, &status);
+    CHECK(status.size == LARGE_SIZE);
+    for (size_t i = 0; i < LARGE_SIZE; i++) {
+      CHECK(buf[i] == (i + 1) % 251);
+    }
+  } else if (rank == 0) {
+    CHECK(MPIDYNRES_transport_recv(t, buf, LARGE_SIZE, 1, TAG_WANTED,
+                                   &status) == 0);
+    CHECK(status.size == LARGE_SIZE);
+    for (size_t i = 0; i < LARGE_SIZE; i++) {
+      CHECK(buf[i] == i % 251);
+      buf[i] = (i + 1) % 251;
+    }
+    MPIDYNRES_transport_send(t, buf, LARGE_SIZE, 1, TAG_WANTED);
+  }
+  free(buf);
+}
+
+int main(int argc, char *argv[static argc + 1]) {
+  int rank;
+
+  MPI_Init(&argc, &argv);
+  util_init();
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  MPIDYNRES_transport *t = MPIDYNRES_transport_shm_create(MPI_COMM_WORLD);
+
+  test_skip_other_tag(t, rank);
+  test_same_source_other_tag(t, rank);
+  test_large_message(t, rank);
+
+  MPI_Barrier(MPI_COMM_WORLD);
+  MPIDYNRES_transport_free(t);
+  MPI_Finalize();
+  return 0;
+}
@@ -2,19 +2,109 @@
 #define TEST_UTIL_H
 
 #include <mpi.h>
+#include <stdio.h>
 #include <stdlib.h>
 
+#include "../src/comm.h"
+#include "../src/scheduler.h"
+#include "../src/transport.h"
+
 #define COUNT_OF(x) \
   ((sizeof(x) / sizeof(0 [x])) / ((size_t)(!(sizeof(x) % sizeof(0 [x])))))
 
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      printf("Check failed in line %d: %s\n", __LINE__, #cond);         \
+      MPI_Finalize();                                                   \
+      exit(1);                                                          \
+    }                                                                   \
+  } while (0)
+
 
 void util_init() {
-  setvbuf(stdout, NULL, _IONBF, 0); 
+  setvbuf(stdout, NULL, _IONBF, 0);
   int err = MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_ARE_FATAL);
   if (err) {
     exit(1);
   }
 }
 
+/*
+ * Receive a message of exactly size bytes from the scheduler
+ */
+void cr_recv(MPIDYNRES_transport *cr, void *buf, size_t size, int tag) {
+  MPIDYNRES_transport_status status;
+  int err = MPIDYNRES_transport_recv(cr, buf, size, 0, tag, &status);
+  CHECK(err == 0);
+  CHECK(status.size == size);
+}
+
+/*
+ * Receive the next idle command of a cr and check that it starts a job
+ */
+void check_started(MPIDYNRES_transport *cr, int job_id) {
+  MPIDYNRES_idle_command command;
+  cr_recv(cr, &command, sizeof(command), MPIDYNRES_TAG_IDLE_COMMAND);
+  CHECK(command.command_type == start);
+  CHECK(command.job_id == job_id);
+}
+
+/*
+ * Create a session for a cr and return its id
+ */
+int create_session(MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport *cr) {
+  int unused = 0;
+  int session_id;
+
+  MPIDYNRES_transport_send(cr, &unused, sizeof(int), 0,
+                           MPIDYNRES_TAG_SESSION_CREATE);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  cr_recv(cr, &session_id, sizeof(int), MPIDYNRES_TAG_SESSION_CREATE_ANSWER);
+  return session_id;
+}
+
+/*
+ * Query a resource change for a cr, none of the managers sends an info with it
+ */
+MPIDYNRES_RC_msg request_rc(MPIDYNRES_scheduler *scheduler,
+                            MPIDYNRES_transport *cr) {
+  int session_id = 0;
+  MPI_Info info;
+  MPIDYNRES_RC_msg rc_msg;
+
+  MPIDYNRES_transport_send(cr, &session_id, sizeof(int), 0,
+                           MPIDYNRES_TAG_RC);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+  MPIDYNRES_transport_recv_info(cr, &info, 0, MPIDYNRES_TAG_RC_INFO_SIZE,
+                                MPIDYNRES_TAG_RC_INFO);
+  CHECK(info == MPI_INFO_NULL);
+  cr_recv(cr, &rc_msg, sizeof(rc_msg), MPIDYNRES_TAG_RC_ANSWER);
+  return rc_msg;
+}
+
+/*
+ * Accept a resource change without an info
+ */
+void accept_rc(MPIDYNRES_scheduler *scheduler, MPIDYNRES_transport *cr,
+               int rc_tag) {
+  int msg[2] = {0, rc_tag};
+
+  MPIDYNRES_transport_send(cr, msg, sizeof(msg), 0, MPIDYNRES_TAG_RC_ACCEPT);
+  MPIDYNRES_transport_send_info(cr, MPI_INFO_NULL, 0,
+                                MPIDYNRES_TAG_RC_ACCEPT_INFO_SIZE,
+                                MPIDYNRES_TAG_RC_ACCEPT_INFO);
+  CHECK(MPIDYNRES_scheduler_progress(scheduler) == 1);
+}
+
+/*
+ * Tell the scheduler that a cr is done, without progressing it
+ */
+void done(MPIDYNRES_transport *cr) {
+  int unused = 0;
+  MPIDYNRES_transport_send(cr, &unused, sizeof(int), 0,
+                           MPIDYNRES_TAG_DONE_RUNNING);
+}
+
 
 #endif
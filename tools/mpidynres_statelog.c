@@ -0,0 +1,259 @@
+/*
+ * Render a binary state log written with MPIDYNRES_STATELOG
+ *
+ * Usage: mpidynres_statelog [options] LOG
+ *   --format FORMAT  text (default): one line per event with the state of
+ *                    every cr, colored unless --no-color is given
+ *                    csv: one line per state change
+ *                    timeline: one line per interval a cr spent in a state
+ *                    other than idle, e.g. for a gantt chart
+ *   --no-color       plain text output
+ */
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/statelog.h"
+
+#define RESET "\033[0m"
+
+static char const *const colors[NUM_CR_STATES] = {
+    [idle] = "\033[0;34m",
+    [running] = "\033[0;31m",
+    [reserved] = "\033[0;32m",
+    [proposed_shutdown] = "\033[0;32m",
+    [accepted_shutdown] = "\033[0;36m",
+};
+
+static int const chars[NUM_CR_STATES] = {
+    [idle] = 'I',
+    [running] = 'R',
+    [reserved] = 'P',
+    [proposed_shutdown] = 'S',
+    [accepted_shutdown] = 'A',
+};
+
+static char const *const state_names[NUM_CR_STATES] = {
+    [idle] = "idle",
+    [running] = "running",
+    [reserved] = "reserved",
+    [proposed_shutdown] = "proposed_shutdown",
+    [accepted_shutdown] = "accepted_shutdown",
+};
+
+static char const *const event_names[NUM_STATELOG_EVENTS] = {
+    [STATELOG_CR_STARTED] = "cr_started",
+    [STATELOG_CR_EXITED] = "cr_exited",
+    [STATELOG_PROPOSE_START] = "propose_start",
+    [STATELOG_PROPOSE_SHUTDOWN] = "propose_shutdown",
+    [STATELOG_ACCEPT_SHUTDOWN] = "accept_shutdown",
+};
+
+struct options {
+  char const *format;
+  bool color;
+  char const *path;
+};
+
+/**
+ * @brief      Print header of the text view
+ *
+ * @details    Print states header into file, with the following columns:
+ * timestamp, cr state and event
+ *
+ * @param      f The file to print the header to
+ *
+ * @param      num_states The number of crs that are tracked
+ */
+static void print_states_header(FILE *f, size_t num_states) {
+  size_t max_num_digits =
+      floor(log10(num_states + 1)) + 1;  // highest id is num_states + 1
+  fprintf(f, "TIME       STATE  ");
+  if (num_states >= 18) {
+    for (size_t i = 0; i < num_states - 4; i++) {
+      putc(' ', f);
+    }
+  }
+  fprintf(f, "EVENT\n");
+  for (size_t i = 0; i < num_states + 12 + 20; i++) {
+    putc('-', f);
+  }
+  putc('\n', f);
+  for (ssize_t ndigit = max_num_digits - 1; ndigit >= 0; ndigit--) {
+    fprintf(f, "           ");
+    for (size_t cr_id = 1; cr_id <= num_states; cr_id++) {
+      size_t e = 1;
+      for (ssize_t i = 0; i < ndigit; i++) e *= 10;
+      int digit = (cr_id / e) % 10;
+      if (cr_id >= e) {
+        putc('0' + digit, f);
+      } else {
+        putc(' ', f);
+      }
+    }
+    putc('\n', f);
+  }
+  for (size_t i = 0; i < num_states + 12 + 20; i++) {
+    putc('=', f);
+  }
+  putc('\n', f);
+}
+
+/**
+ * @brief      Print the line of an event of the text view
+ *
+ * @param      f The file to write into
+ *
+ * @param      num_states The number of crs
+ *
+ * @param      states The states after the event
+ *
+ * @param      record The last record of the event
+ *
+ * @param      color whether to use colors
+ */
+static void print_states(FILE *f, size_t num_states, enum cr_state *states,
+                         statelog_record *record, bool color) {
+  double diff_ms = record->time_ns / 1e6;
+  if (diff_ms < 1000000.0) {
+    fprintf(f, "%8gms ", diff_ms);
+  } else {
+    fprintf(f, "%8gs  ", diff_ms / 1000.0);
+  }
+  for (size_t i = 0; i < num_states; i++) {
+    if (color) {
+      fprintf(f, "%s%c%s", colors[states[i]], chars[states[i]], RESET);
+    } else {
+      putc(chars[states[i]], f);
+    }
+  }
+  putc(' ', f);
+  switch (record->event) {
+    case STATELOG_CR_STARTED:
+      fprintf(f, "Starting cr id %d", record->cr_id);
+      break;
+    case STATELOG_CR_EXITED:
+      fprintf(f, "cr id %d returned/exited", record->cr_id);
+      break;
+    case STATELOG_PROPOSE_START:
+      fprintf(f, "proposing to start crs");
+      break;
+    case STATELOG_PROPOSE_SHUTDOWN:
+      fprintf(f, "proposing to shutdown crs");
+      break;
+    case STATELOG_ACCEPT_SHUTDOWN:
+      fprintf(f, "accepted shutdown of crs");
+      break;
+  }
+  fprintf(f, " (job %d)\n", record->job_id);
+}
+
+static void parse_options(int argc, char *argv[], struct options *o_options) {
+  o_options->format = "text";
+  o_options->color = true;
+  o_options->path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      o_options->format = argv[++i];
+    } else if (strcmp(argv[i], "--no-color") == 0) {
+      o_options->color = false;
+    } else if (argv[i][0] != '-' && o_options->path == NULL) {
+      o_options->path = argv[i];
+    } else {
+      o_options->path = NULL;
+      break;
+    }
+  }
+  if (o_options->path == NULL ||
+      (strcmp(o_options->format, "text") != 0 &&
+       strcmp(o_options->format, "csv") != 0 &&
+       strcmp(o_options->format, "timeline") != 0)) {
+    fprintf(stderr,
+            "Usage: %s [--format text|csv|timeline] [--no-color] LOG\n",
+            argv[0]);
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  struct options options;
+  statelog_header header;
+  statelog_record record, last = {0};
+  bool have_last = false;
+
+  parse_options(argc, argv, &options);
+  FILE *f = fopen(options.path, "rb");
+  if (f == NULL) {
+    perror("Cannot open state log");
+    return EXIT_FAILURE;
+  }
+  if (!statelog_read_header(f, &header)) {
+    fprintf(stderr, "%s is not a state log\n", options.path);
+    return EXIT_FAILURE;
+  }
+
+  bool text = strcmp(options.format, "text") == 0;
+  bool csv = strcmp(options.format, "csv") == 0;
+  enum cr_state *states = calloc(header.num_crs + 1, sizeof(enum cr_state));
+  uint64_t *since = calloc(header.num_crs + 1, sizeof(uint64_t));
+  int *jobs = calloc(header.num_crs + 1, sizeof(int));
+  if (states == NULL || since == NULL || jobs == NULL) {
+    fprintf(stderr, "Memory Error\n");
+    return EXIT_FAILURE;
+  }
+
+  if (text) {
+    print_states_header(stdout, header.num_crs);
+  } else if (csv) {
+    printf("time_s,event_seq,event,job,cr,old_state,new_state\n");
+  } else {
+    printf("cr,job,state,start_s,end_s\n");
+  }
+
+  while (statelog_read_record(f, &record)) {
+    if (record.cr_id < 1 || record.cr_id > (int)header.num_crs) {
+      fprintf(stderr, "Invalid cr id %d in state log\n", record.cr_id);
+      return EXIT_FAILURE;
+    }
+    // the line of an event is printed once all its changes are known
+    if (text && have_last && record.event_seq != last.event_seq) {
+      print_states(stdout, header.num_crs, states + 1, &last, options.color);
+    }
+    if (csv) {
+      printf("%.9f,%u,%s,%d,%d,%s,%s\n", record.time_ns / 1e9,
+             record.event_seq, event_names[record.event], record.job_id,
+             record.cr_id, state_names[record.old_state],
+             state_names[record.new_state]);
+    } else if (!text && states[record.cr_id] != idle) {
+      printf("%d,%d,%s,%.9f,%.9f\n", record.cr_id, jobs[record.cr_id],
+             state_names[states[record.cr_id]], since[record.cr_id] / 1e9,
+             record.time_ns / 1e9);
+    }
+    states[record.cr_id] = record.new_state;
+    since[record.cr_id] = record.time_ns;
+    jobs[record.cr_id] = record.job_id;
+    last = record;
+    have_last = true;
+  }
+
+  if (text && have_last) {
+    print_states(stdout, header.num_crs, states + 1, &last, options.color);
+  } else if (!text && !csv) {
+    // intervals that did not end until the end of the log
+    for (uint32_t cr = 1; cr <= header.num_crs; cr++) {
+      if (states[cr] != idle) {
+        printf("%u,%d,%s,%.9f,%.9f\n", cr, jobs[cr], state_names[states[cr]],
+               since[cr] / 1e9, last.time_ns / 1e9);
+      }
+    }
+  }
+
+  free(states);
+  free(since);
+  free(jobs);
+  fclose(f);
+  return EXIT_SUCCESS;
+}